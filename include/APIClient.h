@@ -26,7 +26,6 @@ struct DeviceStatusData {
 
 class APIClient {
 private:
-    HTTPClient http;
     String supabaseUrl;
     String supabaseKey;
     String deviceId;
@@ -0,0 +1,63 @@
+#ifndef ADC_DMA_SAMPLER_H
+#define ADC_DMA_SAMPLER_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "DecimationFilter.h"
+
+// ===== CONFIGURAÇÕES DO ADC CONTÍNUO =====
+#define ADC_DMA_SAMPLE_FREQ_HZ 20000          // Mínimo do ESP32 (dividido entre os canais)
+#define ADC_DMA_FRAME_BYTES 256               // Bytes por interrupção de DMA
+#define ADC_DMA_STORE_BYTES 2048              // Buffer interno do driver
+
+/**
+ * @brief Amostragem contínua (DMA) de pH e TDS no ADC1
+ *
+ * Substitui as chamadas analogRead por amostra: o controlador digital
+ * do ADC converte GPIO35 (ADC1_CH7, pH) e GPIO34 (ADC1_CH6, TDS)
+ * alternadamente e entrega os resultados por DMA. poll() esvazia o
+ * buffer sem bloquear e alimenta um DecimationFilter por canal.
+ *
+ * Enquanto o modo contínuo estiver ativo, analogRead no ADC1 não pode
+ * ser usado.
+ */
+class AdcDmaSampler {
+public:
+    enum Channel {
+        CHANNEL_PH = 0,
+        CHANNEL_TDS,
+        CHANNEL_COUNT
+    };
+
+    AdcDmaSampler();
+    ~AdcDmaSampler();
+
+    // ===== CONTROLE =====
+    bool begin();
+    void end();
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Consome o que o DMA já entregou (não bloqueante)
+     */
+    void poll();
+
+    // ===== DADOS =====
+    bool hasValue(Channel channel) const;
+    float getRaw(Channel channel) const;           // Contagens filtradas (0-4095)
+    uint32_t getSampleCount(Channel channel) const;
+    uint32_t getOverflowCount() const { return overflow_count; }
+    void printStatus();
+
+private:
+    bool running;
+    DecimationFilter filters[CHANNEL_COUNT];
+    uint32_t sample_counts[CHANNEL_COUNT];
+    uint32_t overflow_count;
+    int8_t adc_channels[CHANNEL_COUNT];   // Canal do ADC1 de cada entrada
+    uint8_t read_buffer[ADC_DMA_FRAME_BYTES];
+
+    int channelFor(uint8_t adc_channel) const;
+};
+
+#endif // ADC_DMA_SAMPLER_H
@@ -0,0 +1,89 @@
+#ifndef ADMIN_FRAME_ENCODER_H
+#define ADMIN_FRAME_ENCODER_H
+
+#include <Arduino.h>
+
+// ===== FRAMES BINÁRIOS DO PAINEL ADMIN =====
+#define ADMIN_MAX_PEERS 8
+#define ADMIN_FRAME_SIZE 160
+#define ADMIN_SENSOR_NONE INT16_MIN           // Sensor ausente
+
+/**
+ * @brief Sensores do stream (valor escalado em int16, ver ADMIN_SENSOR_SCALE)
+ */
+enum AdminSensor : uint8_t {
+    ADMIN_SENSOR_PH = 0,          // x100
+    ADMIN_SENSOR_EC,              // x1 (µS/cm)
+    ADMIN_SENSOR_WATER_TEMP,      // x100 (°C)
+    ADMIN_SENSOR_AIR_TEMP,        // x100 (°C)
+    ADMIN_SENSOR_HUMIDITY,        // x100 (%)
+    ADMIN_SENSOR_COUNT
+};
+
+// ===== CAMPOS DO PROTOCOLO BINÁRIO (espelhados em data/admin-panel.html) =====
+enum AdminFrameType : uint8_t {
+    ADMIN_FRAME_SNAPSHOT = 1,
+    ADMIN_FRAME_DELTA = 2
+};
+
+enum AdminField : uint8_t {
+    FIELD_HEAP_FREE = 0x01,     // u32
+    FIELD_MAX_BLOCK = 0x02,     // u32
+    FIELD_HEAP_TOTAL = 0x03,    // u32
+    FIELD_UPTIME = 0x04,        // u32 (s)
+    FIELD_RSSI = 0x05,          // i8
+    FIELD_WS_CLIENTS = 0x06,    // u8
+    FIELD_RELAY_MASK = 0x07,    // u16
+    FIELD_PEER_COUNT = 0x08,    // u8
+    FIELD_SENSOR_BASE = 0x10,   // i16 (0x10 + AdminSensor)
+    FIELD_PEER = 0x20           // [índice u8][mac 6][online u8][rssi i8]
+};
+
+/**
+ * @brief Estado amostrado para o stream binário
+ */
+struct AdminTelemetry {
+    uint32_t heapFree;
+    uint32_t maxBlock;
+    uint32_t heapTotal;
+    uint32_t uptime;              // segundos
+    int8_t rssi;
+    uint8_t wsClients;
+    bool hasRelays;
+    uint16_t relayMask;           // bit n = relé n ligado
+    int16_t sensors[ADMIN_SENSOR_COUNT];
+    uint8_t peerCount;
+    struct {
+        uint8_t mac[6];
+        bool online;
+        int8_t rssi;
+    } peers[ADMIN_MAX_PEERS];
+};
+
+/**
+ * @brief Codificador de snapshot/delta do stream do AdminWebSocketServer
+ *
+ * Guarda o último valor enviado de cada campo (baseline); o delta leva
+ * só os campos que passaram da banda morta. Sem hardware nem rede:
+ * testado no host (test/test_admin_frame_encoder).
+ */
+class AdminFrameEncoder {
+public:
+    AdminFrameEncoder();
+
+    /**
+     * @brief Codifica o frame em out (little endian)
+     * @param full Snapshot com todos os campos
+     * @return Tamanho do frame (0 se nada mudou ou out < ADMIN_FRAME_SIZE)
+     */
+    size_t encode(const AdminTelemetry& current, bool full, uint8_t* out, size_t size);
+
+    void reset();
+    uint8_t getSequence() const { return sequence; }
+
+private:
+    AdminTelemetry baseline;
+    uint8_t sequence;
+};
+
+#endif // ADMIN_FRAME_ENCODER_H
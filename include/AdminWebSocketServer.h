@@ -8,11 +8,43 @@
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
+#include <functional>
+#include "StaticAssets.h"
+#include "HistoryAPI.h"
+#include "AdminFrameEncoder.h"
 
+// ===== STREAM BINÁRIO DE TELEMETRIA =====
+#define ADMIN_STREAM_INTERVAL_MS 100          // Até 10 Hz
+#define ADMIN_KEYFRAME_INTERVAL_MS 30000      // Snapshot completo periódico (ressincroniza)
+#define ADMIN_SOURCE_INTERVAL_MS 500          // Leitura do provedor (sensores, relés, peers)
+
+/**
+ * @brief Preenche sensores, relés e peers (quem tem esses dados é o dono do servidor)
+ */
+typedef std::function<void(AdminTelemetry& frame)> AdminTelemetryProvider;
+
+/**
+ * AdminWebSocketServer - Painel admin com stream binário
+ *
+ * Protocolo (little endian), frames binários em /ws:
+ *   [tipo u8: 1=snapshot, 2=delta][seq u8] + campos [id u8][valor]
+ * Snapshot traz todos os campos; delta só os que mudaram além da banda
+ * morta de cada campo. Valores são absolutos, então um delta perdido
+ * é corrigido pela próxima mudança ou pelo snapshot periódico.
+ * Mensagens JSON (texto) continuam para comandos e avisos.
+ */
 class AdminWebSocketServer {
 private:
     AsyncWebServer* httpServer;
     AsyncWebSocket* webSocket;
+    StaticAssets assets;
+    
+    // Histórico gravado pelo sistema hidropônico (somente leitura neste modo;
+    // o SensorBus local só fornece chaves e resolução dos canais)
+    SensorBus historyBus;
+    TimeSeriesStore history;
+    HistoryAPI historyApi;
+    
     bool serverActive;
     unsigned long startTime;
     
@@ -22,6 +54,19 @@ private:
     uint32_t lastFragmentationSent;
     unsigned long lastDataSent;
     
+    // Stream binário
+    AdminTelemetryProvider telemetryProvider;
+    AdminFrameEncoder encoder;        // Guarda o último valor enviado de cada campo
+    AdminTelemetry sourceCache;       // Campos do provedor (amostrados a cada ADMIN_SOURCE_INTERVAL_MS)
+    uint8_t frameBuffer[ADMIN_FRAME_SIZE];
+    volatile bool keyframePending;
+    unsigned long lastStreamSent;
+    unsigned long lastKeyframe;
+    unsigned long lastSourceSample;
+    uint32_t framesSent;
+    uint32_t bytesSent;
+    uint32_t framesSkipped;
+    
     // Configurações de push
     static const uint32_t HEAP_CHANGE_THRESHOLD = 5000;      // 5KB mudança
     static const uint32_t FRAGMENTATION_CHANGE_THRESHOLD = 5; // 5% mudança
@@ -29,7 +74,7 @@ private:
     
     // Limites
     static const unsigned long AUTO_SHUTDOWN_TIME = 300000;   // 5 min
-    static const uint8_t MAX_WS_CLIENTS = 2;                  // Máximo 2 clientes WS
+    static const uint8_t MAX_WS_CLIENTS = 4;                  // Frames binários pequenos: cabem 4 clientes
     
 public:
     AdminWebSocketServer();
@@ -50,6 +95,9 @@ public:
     void pushMemoryUpdate();
     void pushSystemStatus();
     void pushMessage(const String& message);
+    void pushTelemetry();
+    
+    void setTelemetryProvider(AdminTelemetryProvider provider) { telemetryProvider = provider; }
     
 private:
     // Handlers WebSocket
@@ -63,6 +111,7 @@ private:
     String buildMemoryJSON();
     String buildSystemStatusJSON();
     bool shouldPushMemoryUpdate();
+    void sampleTelemetry(AdminTelemetry& frame);
     void broadcastToClients(const String& message);
     
     // Proteção
@@ -0,0 +1,37 @@
+#ifndef CACHED_REQUEST_HANDLER_H
+#define CACHED_REQUEST_HANDLER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#define CACHED_HANDLER_MAX_HEADERS 2
+
+/**
+ * @brief Rota GET que preserva os cabeçalhos de validação de cache
+ *
+ * O ESPAsyncWebServer 1.2.x só guarda os cabeçalhos da requisição que
+ * algum handler declarou de interesse antes do parsing; com
+ * server->on() o If-None-Match (e o Accept-Encoding) são descartados e
+ * o 304 nunca acontece. canHandle() roda logo após a linha da
+ * requisição, então é ali que os cabeçalhos são declarados.
+ */
+class CachedRequestHandler : public AsyncWebHandler {
+public:
+    CachedRequestHandler(const char* uri, ArRequestHandlerFunction handler);
+
+    /**
+     * @brief Cabeçalho da requisição que o handler precisa ler
+     */
+    CachedRequestHandler& keepHeader(const char* name);
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+    String uri;
+    ArRequestHandlerFunction handler;
+    const char* headers[CACHED_HANDLER_MAX_HEADERS];
+    uint8_t header_count;
+};
+
+#endif // CACHED_REQUEST_HANDLER_H
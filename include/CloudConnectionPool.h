@@ -0,0 +1,108 @@
+#ifndef CLOUD_CONNECTION_POOL_H
+#define CLOUD_CONNECTION_POOL_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Config.h"
+
+// ===== CONFIGURAÇÕES DO POOL =====
+#define CLOUD_POOL_SIZE 2                     // Sessões TLS mantidas (~40KB cada)
+#define CLOUD_IDLE_TIMEOUT_MS 45000           // Fecha sessão ociosa (servidor corta ~60s)
+#define CLOUD_CONNECT_TIMEOUT_MS 10000
+#define CLOUD_MIN_HEAP_IDLE 40000             // Abaixo disso fecha sessões ociosas já
+
+/**
+ * @brief Cabeçalho HTTP sem alocação (ponteiros para texto fixo)
+ */
+struct CloudHeader {
+    const char* name;
+    const char* value;
+};
+
+/**
+ * @brief Conexões HTTPS keep-alive compartilhadas pelos clientes de nuvem
+ *
+ * O handshake TLS é o custo dominante de cada requisição (latência de
+ * centenas de ms e pico de ~40KB de heap). O pool mantém até
+ * CLOUD_POOL_SIZE sessões abertas por host, com HTTP keep-alive, e fecha
+ * as que ficam ociosas por CLOUD_IDLE_TIMEOUT_MS ou quando o heap aperta.
+ *
+ * As estatísticas separam requisições com handshake das que reusaram a
+ * sessão (latência média/máxima e heap retido), o que dá a comparação
+ * antes/depois no próprio dispositivo.
+ */
+class CloudConnectionPool {
+public:
+    /**
+     * @brief Instância única usada por SupabaseClient, DeviceRegistration e APIClient
+     */
+    static CloudConnectionPool& shared();
+
+    /**
+     * @brief Executa uma requisição numa sessão do pool
+     * @param method "GET", "POST", "PATCH"...
+     * @param response Corpo da resposta (opcional; se nulo o corpo é descartado)
+     * @return Código HTTP (negativo = erro de conexão, como no HTTPClient)
+     */
+    int request(const char* method, const String& url, const String& payload,
+                const CloudHeader* headers, uint8_t header_count,
+                String* response = nullptr, uint16_t timeout_ms = SUPABASE_TIMEOUT_MS);
+
+    /**
+     * @brief Mesma requisição com corpo num buffer fixo (sem String intermediária)
+     */
+    int request(const char* method, const char* url, const char* body, size_t length,
+                const CloudHeader* headers, uint8_t header_count,
+                String* response = nullptr, uint16_t timeout_ms = SUPABASE_TIMEOUT_MS);
+
+    /**
+     * @brief Fecha sessões ociosas (chamar do loop principal)
+     */
+    void loop();
+    void closeAll();
+
+    // ===== STATUS =====
+    uint8_t getOpenConnections() const;
+    String getStatusJSON() const;
+    void printStatus() const;
+
+private:
+    struct Slot {
+        WiFiClientSecure client;
+        HTTPClient http;
+        char host[64];
+        unsigned long last_used;
+        uint32_t requests;
+    };
+
+    struct Timing {
+        uint32_t count;
+        uint32_t total_ms;
+        uint32_t max_ms;
+        int32_t heap_total;         // Heap retido após a requisição (soma)
+    };
+
+    Slot slots[CLOUD_POOL_SIZE];
+    SemaphoreHandle_t mutex;
+
+    Timing handshake;               // Requisições que abriram sessão TLS
+    Timing reused;                  // Requisições em sessão já aberta
+    uint32_t failures;
+    uint32_t evictions;
+    uint32_t idle_closes;
+    uint32_t min_free_heap;
+
+    CloudConnectionPool();
+    CloudConnectionPool(const CloudConnectionPool&) = delete;
+    CloudConnectionPool& operator=(const CloudConnectionPool&) = delete;
+
+    Slot& acquire(const char* url);
+    static void record(Timing& timing, uint32_t elapsed_ms, int32_t heap_delta);
+    void lock();
+    void unlock();
+};
+
+#endif // CLOUD_CONNECTION_POOL_H
@@ -0,0 +1,107 @@
+#ifndef COMMAND_ACK_QUEUE_H
+#define COMMAND_ACK_QUEUE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Config.h"
+
+// ===== CONFIGURAÇÕES DAS CONFIRMAÇÕES =====
+#define COMMAND_ACK_CAPACITY 32               // Confirmações aguardando envio (RAM)
+#define COMMAND_ACK_BATCH_MAX 12              // IDs por PATCH (limite da URL id=in.(...))
+#define COMMAND_ACK_FLUSH_WINDOW_MS 400       // Janela de coalescência após a primeira confirmação
+#define COMMAND_ACK_RETRY_MS 5000             // Espera após PATCH com falha
+#define COMMAND_ACK_ERROR_SIZE 48
+
+/**
+ * @brief Estados reportados em relay_commands (ordem = progressão)
+ */
+enum CommandAckStatus : uint8_t {
+    COMMAND_ACK_SENT = 0,
+    COMMAND_ACK_COMPLETED,
+    COMMAND_ACK_FAILED
+};
+
+/**
+ * @brief Pipeline de confirmações de comandos de relé
+ *
+ * Em vez de um PATCH por transição (sent, completed, failed), as
+ * confirmações ficam numa janela curta e saem agrupadas: todos os
+ * comandos com o mesmo estado (e mesma mensagem de erro) vão num único
+ * PATCH com filtro id=in.(...).
+ * - Transições do mesmo comando se fundem: sent seguido de completed
+ *   dentro da janela vira só completed
+ * - Com o Realtime conectado, a conclusão também é enviada pelo socket
+ *   (broadcast), então o dashboard vê o resultado antes do PATCH
+ * - PATCH com falha mantém as confirmações para nova tentativa
+ * - Cheia, a fila tenta esvaziar na hora; se não conseguir recusa a nova
+ *   confirmação (nenhuma aceita é descartada) e o chamador a repete
+ *
+ * O PATCH é injetado (BatchSender): HydroSupaManager e RelayBridge usam
+ * SupabaseClient::markCommands; os testes do host, um sender falso.
+ */
+class CommandAckQueue {
+public:
+    /**
+     * @brief Envio imediato pelo socket; retorna false se indisponível
+     */
+    typedef std::function<bool(int commandId, const char* status)> PushSender;
+
+    /**
+     * @brief Mesmo estado para vários comandos num único PATCH; false = tentar depois
+     */
+    typedef std::function<bool(const int* commandIds, uint8_t count, const char* status,
+                               const char* errorMessage)> BatchSender;
+
+    explicit CommandAckQueue(BatchSender sender);
+
+    // ===== CONTROLE =====
+    /**
+     * @brief Registra uma transição de estado do comando
+     * @return false se a fila continua cheia após tentar enviar (não registrada)
+     */
+    bool add(int commandId, CommandAckStatus status, const char* errorMessage = nullptr);
+    void loop();
+
+    /**
+     * @brief Envia tudo o que estiver pendente, ignorando a janela
+     * @return true se a fila ficou vazia
+     */
+    bool flush();
+
+    void setPushSender(PushSender sender) { push_sender = sender; }
+
+    // ===== STATUS =====
+    uint8_t pending() const { return count; }
+    bool isFull() const { return count == COMMAND_ACK_CAPACITY; }
+    String getStatusJSON() const;
+    void printStatus() const;
+
+    static const char* statusName(CommandAckStatus status);
+
+private:
+    struct PendingAck {
+        int id;
+        CommandAckStatus status;
+        char error[COMMAND_ACK_ERROR_SIZE];
+    };
+
+    BatchSender batch_sender;
+    PushSender push_sender;
+    PendingAck entries[COMMAND_ACK_CAPACITY];
+    uint8_t count;
+    unsigned long window_start;
+    unsigned long retry_at;
+
+    // Estatísticas
+    uint32_t acks_added;
+    uint32_t coalesced;
+    uint32_t requests;
+    uint32_t push_acks;
+    uint32_t failures;
+    uint32_t refused;
+
+    int find(int commandId) const;
+    void remove(const bool* sent);
+};
+
+#endif // COMMAND_ACK_QUEUE_H
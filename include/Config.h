@@ -35,6 +35,14 @@
 #define SUPABASE_CONTENT_TYPE "application/json"
 #define SUPABASE_PREFER "return=minimal"
 
+// Envio em lote (PostgREST bulk insert: um POST por tabela)
+#define SUPABASE_BATCH_SIZE 10                // Linhas por tabela antes de enviar
+#define SUPABASE_BATCH_INTERVAL_MS 300000     // Envia mesmo incompleto após 5 min
+
+// Relógio (created_at das leituras guardadas offline)
+#define NTP_PRIMARY_SERVER "pool.ntp.org"
+#define NTP_SECONDARY_SERVER "time.google.com"
+
 // ===== LIMITES DO SISTEMA =====
 #define MAX_RELAYS 8   // Sistema Master ESP-NOW com 8 relés
 #define MAX_SENSORS 8
@@ -164,6 +172,34 @@ static const RelayPinMap RELAY_PIN_MAPPING[MAX_RELAYS] = {
 // Se o pino P3 do PCF1 estiver quebrado, mude para:
 // {0, 3, false},  // Relé 3 -> PCF1 P3 (DEFEITUOSO)
 
+// ===== CONFIGURAÇÕES DE DOSAGEM =====
+// Modelo padrão das bombas dosadoras (relé 1 = nutrientes, 2 = pH+, 3 = pH-)
+// Calibração real deve ser gravada via DosingLimiter::configurePump (persistida na NVS)
+#define DOSING_PUMP_RELAYS {1, 2, 3}
+#define DOSING_DEFAULT_ML_PER_SEC 1.0      // Vazão típica de bomba peristáltica
+#define DOSING_MAX_ML_PER_HOUR 20.0        // Capacidade do token bucket horário
+#define DOSING_MAX_ML_PER_DAY 100.0        // Limite em 24h
+#define DOSING_MIN_MIX_DELAY_MS 300000     // 5 minutos entre doses para mistura
+
+// ===== CONFIGURAÇÕES DE SAÚDE DOS SENSORES =====
+// Regras que leem um sensor degradado não são executadas
+#define SENSOR_HEALTH_STALE_MS 15000              // Sem amostra nova = falha
+#define SENSOR_HEALTH_STUCK_MS 600000             // 10 min sem variar = aviso (degrada se a dose não mover)
+#define SENSOR_HEALTH_RESPONSE_TIMEOUT_MS 600000  // Prazo para reagir a uma dose
+#define SENSOR_HEALTH_RESPONSE_FAILURES 2         // Doses seguidas sem resposta até degradar
+#define SENSOR_HEALTH_RESPONSE_RETRY_MS 7200000   // Degradado por no_response há 2h: libera 1 dose de prova
+#define SENSOR_HEALTH_CAL_MAX_HOURS 720.0         // Calibração de pH vence em 30 dias
+#define SENSOR_HEALTH_PH_PUMP_RELAYS {2, 3}       // Doses que devem mover o pH
+#define SENSOR_HEALTH_NUTRIENT_PUMP_RELAYS {1}    // Doses que devem mover o TDS
+// Limiares: ruído (desvio padrão), variação mínima na janela, resposta mínima à dose
+#define SENSOR_HEALTH_PH_NOISE_MAX 0.15
+#define SENSOR_HEALTH_PH_STUCK_EPSILON 0.002
+#define SENSOR_HEALTH_PH_MIN_RESPONSE 0.05
+#define SENSOR_HEALTH_TDS_NOISE_MAX 40.0
+#define SENSOR_HEALTH_TDS_STUCK_EPSILON 0.1
+#define SENSOR_HEALTH_TDS_MIN_RESPONSE 10.0
+#define SENSOR_HEALTH_TEMP_NOISE_MAX 0.5          // Água estável: sem verificação de valor parado
+
 // ===== CONFIGURAÇÕES DA API E BANCO DE DADOS =====
 
 // ===== CONFIGURAÇÕES DO SAVEMANAGER =====
@@ -26,4 +26,44 @@
   #define HYDRO_VERBOSE_PRINTLN(x)
 #endif
 
-#endif // DEBUG_CONFIG_H 
\ No newline at end of file
+// ===== NÍVEIS DE LOG (Logger.h) =====
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_VERBOSE 5
+
+// Nível global; chamadas acima dele nem são compiladas.
+// Sobrescrever em platformio.ini, ex.: build_flags = -DLOG_LEVEL_HYDRO=4
+#ifndef LOG_LEVEL
+  #if !ENABLE_SERIAL_DEBUG
+    #define LOG_LEVEL LOG_LEVEL_NONE
+  #elif ENABLE_VERBOSE_LOGGING
+    #define LOG_LEVEL LOG_LEVEL_VERBOSE
+  #else
+    #define LOG_LEVEL LOG_LEVEL_INFO
+  #endif
+#endif
+
+// Nível por módulo (padrão: o global)
+#ifndef LOG_LEVEL_ESPNOW
+  #define LOG_LEVEL_ESPNOW LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_SUPABASE
+  #define LOG_LEVEL_SUPABASE LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_HYDRO
+  #define LOG_LEVEL_HYDRO LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_RULES
+  #define LOG_LEVEL_RULES LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_WEB
+  #define LOG_LEVEL_WEB LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_SYSTEM
+  #define LOG_LEVEL_SYSTEM LOG_LEVEL
+#endif
+
+#endif // DEBUG_CONFIG_H
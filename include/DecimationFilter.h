@@ -0,0 +1,47 @@
+#ifndef DECIMATION_FILTER_H
+#define DECIMATION_FILTER_H
+
+#include <Arduino.h>
+
+// ===== CONFIGURAÇÕES DO FILTRO DE DECIMAÇÃO =====
+#define ADC_DMA_DECIMATION 64                 // Amostras por bloco (boxcar)
+#define ADC_DMA_IIR_ALPHA 0.05                // Passa-baixa após a decimação
+
+/**
+ * @brief Filtro de decimação para amostras do ADC
+ *
+ * Três estágios: média em blocos de N amostras (boxcar/CIC de 1 estágio),
+ * mediana dos últimos 3 blocos (remove picos isolados) e passa-baixa IIR
+ * de 1 polo. Sem hardware: testado no host (test/test_decimation_filter).
+ */
+class DecimationFilter {
+public:
+    DecimationFilter(uint16_t factor = ADC_DMA_DECIMATION, float alpha = ADC_DMA_IIR_ALPHA);
+
+    /**
+     * @brief Adiciona uma amostra bruta
+     * @return true se um novo valor filtrado foi produzido
+     */
+    bool push(uint16_t raw);
+    void reset();
+
+    float getOutput() const { return output; }
+    bool hasOutput() const { return primed; }
+    uint32_t getOutputCount() const { return output_count; }
+
+private:
+    uint16_t factor;
+    float alpha;
+    uint32_t accumulator;
+    uint16_t count;
+    float history[3];
+    uint8_t history_size;
+    uint8_t history_index;
+    float output;
+    bool primed;
+    uint32_t output_count;
+
+    float medianOfHistory() const;
+};
+
+#endif // DECIMATION_FILTER_H
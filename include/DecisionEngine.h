@@ -7,6 +7,7 @@
 #include <vector>
 #include "DataTypes.h"
 #include "Config.h"
+#include "EventLog.h"
 
 // ===== ESTRUTURAS DO MOTOR DE DECISÕES =====
 
@@ -183,6 +184,7 @@ private:
     unsigned long total_evaluations;
     unsigned long total_actions_executed;
     unsigned long total_safety_blocks;
+    unsigned long total_health_blocks;
     
     // Configurações
     static const size_t MAX_RULES = 50;
@@ -232,18 +234,30 @@ public:
     
     // ===== CALLBACKS =====
     typedef std::function<void(int relay, bool state, unsigned long duration)> RelayControlCallback;
+    typedef std::function<void(int relay, float duty_percent, unsigned long period_ms, unsigned long duration_ms)> PWMControlCallback;
     typedef std::function<void(const String& message, bool is_critical)> AlertCallback;
     typedef std::function<void(const String& event, const String& data)> LogCallback;
+    typedef std::function<void(EventCode code, const String& rule_id)> RuleEventCallback;
+    typedef std::function<bool(const String& sensor_name)> SensorHealthCallback;
+    typedef std::function<bool(const String& sensor_name, float& value)> SensorValueCallback;
     
     void setRelayControlCallback(RelayControlCallback callback) { relay_control_callback = callback; }
+    void setPWMControlCallback(PWMControlCallback callback) { pwm_control_callback = callback; }
     void setAlertCallback(AlertCallback callback) { alert_callback = callback; }
     void setLogCallback(LogCallback callback) { log_callback = callback; }
+    void setRuleEventCallback(RuleEventCallback callback) { rule_event_callback = callback; }
+    void setSensorHealthCallback(SensorHealthCallback callback) { sensor_health_callback = callback; }
+    void setSensorValueCallback(SensorValueCallback callback) { sensor_value_callback = callback; }
 
 private:
     // ===== CALLBACKS INTERNOS =====
     RelayControlCallback relay_control_callback;
+    PWMControlCallback pwm_control_callback;
     AlertCallback alert_callback;
     LogCallback log_callback;
+    RuleEventCallback rule_event_callback;         // Eventos estruturados (sem texto)
+    SensorHealthCallback sensor_health_callback;
+    SensorValueCallback sensor_value_callback;     // Sensores registrados fora do SystemState
     
     // ===== MÉTODOS INTERNOS =====
     bool parseRuleFromJSON(const JsonObject& json_rule, DecisionRule& rule);
@@ -255,8 +269,9 @@ private:
     
     float getSensorValue(const String& sensor_name, const SystemState& state);
     bool compareValues(float sensor_value, CompareOperator op, float target_min, float target_max);
+    bool findUnhealthySensor(const RuleCondition& condition, String& sensor_name);
     
-    void logRuleExecution(const String& rule_id, const String& action, bool success);
+    void logRuleExecution(const String& rule_id, EventCode code);
     void updateExecutionCounts(DecisionRule& rule);
     bool isInCooldown(const DecisionRule& rule);
     bool hasExceededHourlyLimit(const DecisionRule& rule);
@@ -5,6 +5,8 @@
 #include "HydroControl.h"
 #include "SupabaseClient.h"
 #include "DataTypes.h"
+#include "RelayPWMScheduler.h"
+#include "DosingLimiter.h"
 
 /**
  * @brief Classe de integração entre DecisionEngine e sistema ESP-HIDROWAVE
@@ -23,15 +25,28 @@ private:
     bool manual_override_active;
     std::vector<int> locked_relays;
     
+    // PWM lento para dosagem proporcional (ações RELAY_PWM)
+    RelayPWMScheduler pwm_scheduler;
+    
+    // Modelo das bombas dosadoras e limitador de volume
+    DosingLimiter dosing_limiter;
+    
+    // Últimos valores recebidos do barramento de sensores
+    SystemState sensor_state;
+    uint32_t sensor_timestamps[SENSOR_CHANNEL_COUNT];
+    int sensor_subscription;
+    
     // Estatísticas de integração
     unsigned long total_relay_commands;
     unsigned long total_alerts_sent;
     unsigned long total_supabase_updates;
     
-    // Buffers para logs
-    static const size_t LOG_BUFFER_SIZE = 10;
-    String execution_log[LOG_BUFFER_SIZE];
-    size_t log_index;
+    // Ouvinte dos disparos de regras (ex.: stream SSE do painel)
+    std::function<void(const String& event, const String& data)> rule_event_listener;
+    
+    // Log estruturado (anel binário na RAM, despejado na flash)
+    static const size_t RECENT_LOG_SIZE = 10;
+    EventLog event_log;
     
 public:
     DecisionEngineIntegration(DecisionEngine* engine, HydroControl* hydro, SupabaseClient* supa);
@@ -53,18 +68,23 @@ public:
     void unlockRelay(int relay_id);
     void unlockAllRelays();
     bool isRelayLocked(int relay_id);
+    RelayPWMScheduler& getPWMScheduler() { return pwm_scheduler; }
+    DosingLimiter& getDosingLimiter() { return dosing_limiter; }
     
     // ===== ATUALIZAÇÃO DE ESTADO =====
     void updateSystemStateFromSensors();
     SystemState getCurrentSystemState();
     
     // ===== LOGS E TELEMETRIA =====
+    void setRuleEventListener(std::function<void(const String& event, const String& data)> listener) { rule_event_listener = listener; }
     void sendTelemetryToSupabase();
     String getExecutionLogJSON();
+    String getEventLogJSON(size_t limit = EVENT_LOG_QUERY_LIMIT);
+    EventLog& getEventLog() { return event_log; }
     void printIntegrationStatistics();
     
     // ===== VALIDAÇÃO E SEGURANÇA =====
-    bool validateRelayCommand(int relay_id, bool state, unsigned long duration);
+    bool validateRelayCommand(int relay_id, bool state, unsigned long duration, unsigned long run_ms = 0);  // run_ms 0 = duration
     void performSafetyChecks();
     void emergencyShutdown(const String& reason);
     
@@ -76,10 +96,15 @@ private:
     
     // ===== MÉTODOS INTERNOS =====
     void handleRelayControl(int relay, bool state, unsigned long duration);
+    void handleRelayPWM(int relay, float duty_percent, unsigned long period_ms, unsigned long duration_ms);
     void handleAlert(const String& message, bool is_critical);
     void handleLogEvent(const String& event, const String& data);
+    void handleRuleEvent(EventCode code, const String& rule_id);
+    void handleSensorReading(const SensorReading& reading);
+    bool isSensorUsable(const String& sensor_name);
+    bool readRegisteredSensor(const String& sensor_name, float& value);
     
-    void addToExecutionLog(const String& log_entry);
+    String resolveRuleKey(uint16_t rule_key);
     bool isSystemHealthy();
     void updateSupabaseWithRuleExecution(const String& rule_id, const String& action, bool success);
     
@@ -19,7 +19,6 @@
  */
 class DeviceRegistration {
 private:
-    HTTPClient http;
     String supabaseUrl;
     String supabaseKey;
     
@@ -7,6 +7,8 @@
 #include <ArduinoJson.h>
 #include "Config.h"
 #include "DataTypes.h"
+#include "SnapshotCache.h"
+#include "StaticAssets.h"
 
 class DiagWebServer {
 private:
@@ -16,11 +18,19 @@ private:
     SensorData* sensorData;
     bool* relayStates;
     
+    // Snapshots: uma serialização por mudança de estado, não por requisição
+    SnapshotCache snapshots;
+    StaticAssets assets;
+    int8_t statusTopic;
+    int8_t sensorsTopic;
+    int8_t relaysTopic;
+    
     // Funções auxiliares
     void initSPIFFS();
     void setupStaticFiles();
     void setupAPIEndpoints();
     void setupConfigEndpoints();
+    void setupSnapshots();
     
     // Handlers de API
     void handleStatus(AsyncWebServerRequest *request);
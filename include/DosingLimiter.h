@@ -0,0 +1,127 @@
+#ifndef DOSING_LIMITER_H
+#define DOSING_LIMITER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Config.h"
+
+struct DosingWindow;
+
+/**
+ * @brief Modelo de uma bomba dosadora ligada a um relé
+ */
+struct PumpModel {
+    bool enabled;                   // Relé é uma bomba dosadora
+    float ml_per_second;            // Vazão calibrada
+    float max_ml_per_hour;          // Capacidade do token bucket
+    float max_ml_per_day;           // Limite em 24h (janela deslizante)
+    unsigned long min_mix_delay_ms; // Espera mínima entre doses (mistura)
+
+    PumpModel() : enabled(false), ml_per_second(1.0), max_ml_per_hour(0),
+                  max_ml_per_day(0), min_mix_delay_ms(0) {}
+};
+
+/**
+ * @brief Limitador de dosagem por relé
+ *
+ * Converte a duração de um pulso em volume (ml) pelo modelo da bomba e
+ * só autoriza a dose se houver saldo no token bucket horário, no limite
+ * diário e se o tempo de mistura desde a última dose já passou.
+ * Contadores acumulados (ml e doses) ficam na NVS e sobrevivem a reboots.
+ *
+ * A janela (saldo do bucket, 24 fatias horárias e mistura em curso)
+ * também sobrevive: cópia na RTC a cada dose e a cada
+ * SNAPSHOT_INTERVAL_MS (reset por software, watchdog, pânico) e na NVS
+ * a cada dose, com a hora de parede (falta de energia). O tempo parado
+ * só é creditado quando o NTP dá a hora; sem estado algum o boot é
+ * conservador: bucket vazio e mistura correndo.
+ */
+class DosingLimiter {
+public:
+    static const unsigned long HOUR_MS = 3600000;
+    static const uint8_t DAY_SLOTS = 24;                  // Janela diária em fatias de 1h
+    static const unsigned long SAVE_INTERVAL_MS = 300000; // Gravação na NVS no máximo a cada 5min
+    static const unsigned long SNAPSHOT_INTERVAL_MS = 10000; // Cópia da janela na RTC
+
+    DosingLimiter();
+
+    // ===== CONTROLE =====
+    bool begin();
+    void loop();
+    void end();
+
+    // ===== CONFIGURAÇÃO =====
+    bool configurePump(int relay, const PumpModel& model);
+    const PumpModel& getPumpModel(int relay) const;
+    bool isDosingPump(int relay) const;
+
+    // ===== LIMITAÇÃO =====
+    /**
+     * @brief Verifica e, se permitido, debita a dose
+     * @param relay Número do relé
+     * @param dose_ms Tempo efetivamente ligado (0 = indefinido, negado para bombas)
+     * @param run_ms Duração total do acionamento; no PWM a bomba cicla por
+     *               run_ms e fica ligada só dose_ms. A mistura conta do fim dele.
+     * @param now Timestamp atual (millis)
+     * @param reason Motivo da recusa (opcional)
+     * @return true se a dose foi autorizada e contabilizada
+     */
+    bool tryDose(int relay, unsigned long dose_ms, unsigned long run_ms, unsigned long now, String* reason = nullptr);
+    bool tryDose(int relay, unsigned long duration_ms) { return tryDose(relay, duration_ms, duration_ms, millis()); }
+
+    float estimateVolumeMl(int relay, unsigned long duration_ms) const;
+    float getAvailableMl(int relay, unsigned long now);
+    float getDailyMl(int relay, unsigned long now);
+
+    // ===== ESTATÍSTICAS =====
+    float getTotalMl(int relay) const;
+    uint32_t getTotalDoses(int relay) const;
+    uint32_t getTotalBlocked(int relay) const;
+    void resetCounters();
+    void saveCounters();
+    String getStatusJSON();
+    void printStatus();
+
+private:
+    struct PumpState {
+        float tokens_ml;                // Saldo do bucket horário
+        unsigned long last_refill;
+        unsigned long last_dose_end;    // Fim do acionamento da última dose
+        bool has_dosed;
+        float day_slots_ml[DAY_SLOTS];  // Volume por hora (janela de 24h)
+        uint8_t slot_index;             // Slot da hora em andamento
+        unsigned long slot_start;       // millis() do início dessa hora
+
+        // Persistidos
+        float total_ml;
+        uint32_t total_doses;
+        uint32_t total_blocked;
+    };
+
+    PumpModel models[MAX_RELAYS];
+    PumpState states[MAX_RELAYS];
+    Preferences prefs;
+    bool initialized;
+    bool counters_dirty;
+    unsigned long last_save;
+    unsigned long last_snapshot;
+    unsigned long boot_ms;
+    uint32_t saved_epoch;           // Hora da cópia restaurada, até creditar o tempo parado
+
+    static const char* NVS_NAMESPACE;
+
+    void refill(int relay, unsigned long now);
+    void rotateDaySlots(int relay, unsigned long now);
+    void resetState(int relay);
+    void captureWindow(int relay, unsigned long now, DosingWindow& window);
+    void applyWindow(int relay, const DosingWindow& window, unsigned long now);
+    void restoreWindows();
+    void snapshotWindows(unsigned long now);
+    void creditDowntime(unsigned long now);
+    static uint32_t epochNow();
+    void loadFromNVS();
+    void savePumpModel(int relay);
+    bool isValidRelay(int relay) const { return relay >= 0 && relay < MAX_RELAYS; }
+};
+
+#endif // DOSING_LIMITER_H
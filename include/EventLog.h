@@ -0,0 +1,153 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "SegmentRing.h"
+
+// ===== CONFIGURAÇÕES DO LOG DE EVENTOS =====
+#define EVENT_LOG_RAM_RECORDS 64              // 1KB na RAM (registros de 16 bytes)
+#define EVENT_LOG_SEGMENTS 16                 // Arquivos de segmento do anel na flash
+#define EVENT_LOG_SEGMENT_RECORDS 256         // 4KB por segmento
+#define EVENT_LOG_FLASH_RECORDS (EVENT_LOG_SEGMENTS * EVENT_LOG_SEGMENT_RECORDS) // 64KB na flash
+#define EVENT_LOG_SPILL_BATCH 32              // Grava na flash a cada 32 eventos (512 bytes)
+#define EVENT_LOG_SPILL_INTERVAL_MS 300000    // ...ou a cada 5 min com eventos pendentes
+#define EVENT_LOG_QUERY_LIMIT 100             // Máximo de eventos por consulta JSON
+#define EVENT_LOG_TEXT_SIZE 80
+#define EVENT_LOG_DIRECTORY "/ev"
+#define EVENT_LOG_LEGACY_PATH "/events.bin"   // Anel antigo, regravado no lugar
+#define EVENT_LOG_NO_RELAY -1
+#define EVENT_LOG_NO_RULE 0
+
+/**
+ * @brief Códigos de evento (o texto só é montado na consulta)
+ */
+enum EventCode : uint8_t {
+    EVENT_NONE = 0,                  // Slot vazio
+    // Regras
+    EVENT_RULE_EXECUTED,
+    EVENT_RULE_BLOCKED_HEALTH,
+    EVENT_RULE_BLOCKED_SAFETY,
+    EVENT_RULE_LOG,
+    EVENT_RULE_SUPABASE,
+    // Relés (value = duração em ms ou duty em %)
+    EVENT_RELAY_ON,
+    EVENT_RELAY_OFF,
+    EVENT_RELAY_PULSE,
+    EVENT_RELAY_PWM,
+    EVENT_RELAY_BLOCKED_EMERGENCY,
+    EVENT_RELAY_BLOCKED_LOCK,
+    EVENT_RELAY_INVALID,
+    EVENT_PWM_BLOCKED_EMERGENCY,
+    EVENT_PWM_BLOCKED_LOCK,
+    EVENT_PWM_INVALID,
+    EVENT_DOSING_BLOCKED,
+    EVENT_RELAY_LOCKED,
+    EVENT_RELAY_UNLOCKED,
+    EVENT_RELAYS_UNLOCKED_ALL,       // value = quantidade
+    // Sistema (value = 1 ativado / 0 desativado)
+    EVENT_EMERGENCY_MODE,
+    EVENT_MANUAL_OVERRIDE,
+    EVENT_EMERGENCY_SHUTDOWN,
+    EVENT_ALERT,
+    EVENT_ALERT_CRITICAL,
+    EVENT_CODE_COUNT
+};
+
+/**
+ * @brief Registro binário de tamanho fixo
+ */
+struct EventRecord {
+    uint32_t sequence;               // Monotônica (continua entre boots)
+    uint32_t timestamp;              // millis() do registro
+    uint16_t rule;                   // EventLog::ruleKey(id) ou EVENT_LOG_NO_RULE
+    uint8_t code;                    // EventCode
+    int8_t relay;                    // EVENT_LOG_NO_RELAY se não se aplica
+    float value;
+} __attribute__((packed));
+
+/**
+ * @brief Log estruturado de eventos em anel fixo, com despejo na flash
+ *
+ * record() só copia 16 bytes para o anel na RAM (sem String, sem heap).
+ * loop() despeja os eventos pendentes em lotes, anexados a um
+ * SegmentRing no LittleFS da partição "history" (montada por HistoryFS;
+ * índice = sequência), então o histórico chega a milhares de eventos
+ * com 1KB de RAM. Se o anel da RAM encher antes do despejo (ou sem
+ * flash) os mais antigos são perdidos.
+ *
+ * Texto e JSON são montados apenas nas consultas. A regra é guardada
+ * como uma chave de 16 bits do id; quem consulta fornece um
+ * RuleResolver para voltar ao id (ex.: procurando nas regras ativas).
+ */
+class EventLog {
+public:
+    typedef std::function<bool(const EventRecord& record)> Visitor;
+    typedef std::function<String(uint16_t rule_key)> RuleResolver;
+
+    EventLog();
+    ~EventLog();
+
+    // ===== CONTROLE =====
+    /**
+     * @brief Ativa o despejo na flash (nullptr = só RAM)
+     */
+    bool begin(fs::FS* filesystem = &LittleFS);
+    void loop();
+    void flush();
+
+    // ===== REGISTRO =====
+    void record(EventCode code, int relay = EVENT_LOG_NO_RELAY, float value = 0.0,
+                uint16_t rule = EVENT_LOG_NO_RULE);
+
+    // ===== CONSULTA =====
+    /**
+     * @brief Percorre eventos a partir de uma sequência (mais antigo primeiro)
+     * @return Número de eventos entregues
+     */
+    size_t forEach(uint32_t from_sequence, size_t max_events, Visitor visitor);
+
+    /**
+     * @brief Últimos limit eventos em JSON
+     */
+    String getJSON(size_t limit, RuleResolver resolver = nullptr);
+
+    /**
+     * @brief Texto legível de um evento ("Relay 3 ON")
+     */
+    static size_t describe(const EventRecord& record, char* out, size_t size, const char* rule_id);
+    static const char* codeName(uint8_t code);
+    static uint16_t ruleKey(const String& rule_id);
+
+    // ===== STATUS =====
+    uint32_t getNextSequence() const { return next_sequence; }
+    uint32_t getOldestSequence() const;
+    uint32_t getDropped() const { return dropped; }
+    String getStatusJSON() const;
+
+private:
+    EventRecord ring[EVENT_LOG_RAM_RECORDS];
+    uint32_t next_sequence;          // Próximo a ser gravado
+    uint32_t spilled_sequence;       // Tudo abaixo disso está na flash
+    uint32_t ram_first;              // Primeiro registro desta sessão
+    uint32_t dropped;                // Perdidos por anel cheio sem despejo
+    uint32_t spill_writes;
+    unsigned long last_spill;
+
+    fs::FS* fs;
+    SegmentRing flash;
+    SemaphoreHandle_t mutex;
+
+    uint32_t ramOldest() const;
+    bool readFlash(uint32_t sequence, EventRecord& out);
+    void spill();
+    void recover();
+    void lock() const;
+    void unlock() const;
+};
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,108 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "SensorBus.h"
+
+class HydroControl;
+
+// ===== CONFIGURAÇÕES DO STREAM SSE =====
+#define EVENT_STREAM_LIVE_PATH "/events"
+#define EVENT_STREAM_KIOSK_PATH "/events/kiosk"
+#define EVENT_STREAM_LIVE_INTERVAL_MS 250     // Janela de coalescência do stream ao vivo
+#define EVENT_STREAM_KIOSK_INTERVAL_MS 2000   // Displays de estufa: 1 atualização a cada 2s
+#define EVENT_STREAM_MAX_CLIENTS 4            // Por endpoint
+#define EVENT_STREAM_MAX_BACKLOG 6            // Média de mensagens na fila acima disso: adia o flush
+#define EVENT_STREAM_RETRY_MS 3000            // Reconexão sugerida ao EventSource do navegador
+#define EVENT_STREAM_RULE_QUEUE 8
+#define EVENT_STREAM_RULE_TEXT_SIZE 64
+#define EVENT_STREAM_BUFFER_SIZE 640
+
+/**
+ * @brief Server-Sent Events com sensores, relés e disparos de regras
+ *
+ * Dois endpoints no mesmo AsyncWebServer, cada um com sua taxa máxima:
+ * - /events        ao vivo (uma mensagem de cada tipo a cada 250ms no máximo)
+ * - /events/kiosk  displays somente leitura (a cada 2s)
+ *
+ * Nada é enviado por leitura: o barramento de sensores, o contador de
+ * gerações dos relés e publishRule() só marcam o que mudou. No flush
+ * de cada endpoint sai um evento "sensors" com os canais alterados
+ * (último valor vence), um "relays" se algum relé mudou e um "rules"
+ * com todos os disparos da janela (repetições consecutivas viram
+ * contagem; o que não cabe no buffer do evento sai no flush seguinte).
+ * Se a fila TCP dos clientes está cheia o flush é adiado e
+ * as mudanças continuam acumulando, em vez de enfileirar mais mensagens.
+ *
+ * Um cliente novo recebe "hello" na conexão e, no flush seguinte,
+ * todos os sensores e relés (estado completo).
+ */
+class EventStream {
+public:
+    EventStream();
+    ~EventStream();
+
+    /**
+     * @brief Registra os endpoints (o servidor passa a ser dono dos handlers)
+     */
+    void begin(AsyncWebServer* server, HydroControl& hydro);
+
+    /**
+     * @brief Coalesce e envia (chamar do loop principal)
+     */
+    void loop();
+
+    /**
+     * @brief Disparo de regra (evento e detalhe do log do DecisionEngine)
+     */
+    void publishRule(const String& event, const String& detail);
+
+    // ===== STATUS =====
+    size_t getClientCount() const;
+    String getStatusJSON() const;
+
+private:
+    struct Endpoint {
+        const char* path;
+        AsyncEventSource* source;
+        uint32_t interval_ms;
+        unsigned long last_flush;
+        SensorBus::ChannelMask dirty_sensors;
+        uint32_t sent_relay_generation;
+        uint32_t rule_cursor;              // Próximo disparo a enviar (sequência global)
+        volatile bool snapshot_pending;    // Cliente novo (setado na task do AsyncTCP)
+        uint32_t events_sent;
+        uint32_t flushes_deferred;
+        uint32_t clients_rejected;
+        uint32_t rules_deferred;           // Flushes em que parte dos disparos não coube no buffer
+    };
+
+    struct RuleEvent {
+        char event[EVENT_STREAM_RULE_TEXT_SIZE];
+        char detail[EVENT_STREAM_RULE_TEXT_SIZE];
+        unsigned long timestamp;
+        uint16_t count;                    // Repetições coalescidas
+    };
+
+    HydroControl* hydro;
+    Endpoint endpoints[2];
+    SensorReading latest[SENSOR_MAX_CHANNELS];
+    int sensor_subscription;
+
+    RuleEvent rules[EVENT_STREAM_RULE_QUEUE];
+    uint32_t rule_sequence;                // Total de disparos distintos publicados
+
+    uint32_t event_id;
+    char buffer[EVENT_STREAM_BUFFER_SIZE];
+
+    void setupEndpoint(Endpoint& endpoint, AsyncWebServer* server, const char* path, uint32_t interval_ms);
+    void onSensorReading(const SensorReading& reading);
+    void flush(Endpoint& endpoint, unsigned long now);
+    void send(Endpoint& endpoint, const char* event);
+    size_t buildSensors(SensorBus::ChannelMask channels);
+    size_t buildRelays();
+    size_t buildRules(Endpoint& endpoint);
+};
+
+#endif // EVENT_STREAM_H
@@ -0,0 +1,202 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ===== CONFIGURAÇÕES DO MONITOR DE HEAP =====
+#ifndef HEAP_TAGGING_ENABLED
+  #define HEAP_TAGGING_ENABLED 1              // 0 = HEAP_TAG não gera código (testes no host)
+#endif
+#define HEAP_SAMPLE_INTERVAL_MS 10000
+#define HEAP_RECENT_SAMPLES 90                // 15 min a cada 10s
+#define HEAP_HOURLY_SAMPLES 168               // 7 dias: o ciclo dos reboots semanais
+#define HEAP_MAX_TAGS 16
+#define HEAP_TAG_NAME_SIZE 16
+#define HEAP_REPORT_TAGS 4                    // Maiores culpados guardados para o próximo boot
+#define HEAP_DEFAULT_MIN_FREE 30000           // Mesmo valor de MIN_HEAP_FOR_HTTPS
+#define HEAP_DEFAULT_MIN_BLOCK 16384          // Buffer de registro TLS do mbedTLS
+#define HEAP_TREND_HORIZON_HOURS 24           // Alerta se a projeção cruza o limite antes disso
+#define HEAP_TREND_MIN_HOURS 3                // Horas fechadas antes de projetar
+
+#define HEAP_CONCAT_(a, b) a##b
+#define HEAP_CONCAT(a, b) HEAP_CONCAT_(a, b)
+
+// Atribui ao subsistema o que o restante do bloco deixou no heap:
+// HEAP_TAG("cloud.https"); O nome precisa ser um literal.
+// Escopos aninhados somam também o que o interno reteve.
+#if HEAP_TAGGING_ENABLED
+  #define HEAP_TAG(name) \
+      static const int8_t HEAP_CONCAT(_heap_tag_, __LINE__) = HeapMonitor::shared().tag(name); \
+      ScopedHeapTag HEAP_CONCAT(_heap_scope_, __LINE__)(HEAP_CONCAT(_heap_tag_, __LINE__))
+#else
+  #define HEAP_TAG(name)
+#endif
+
+enum HeapAlert : uint8_t {
+    HEAP_ALERT_OK = 0,
+    HEAP_ALERT_TREND,                // Projeção cruza o limite dentro do horizonte
+    HEAP_ALERT_LOW                   // Já abaixo do limite
+};
+
+/**
+ * @brief Fragmentação do heap, tendência e quem a provoca
+ *
+ * - Amostras: a cada HEAP_SAMPLE_INTERVAL_MS guarda heap livre e maior
+ *   bloco livre (anel de 15 min) e o mínimo de cada hora (anel de 7
+ *   dias). Fragmentação = 1 - maior bloco / livre.
+ * - Tendência: regressão linear dos mínimos por hora do heap livre e do
+ *   maior bloco (os picos de uma requisição HTTPS não entram como
+ *   tendência). Com HEAP_TREND_MIN_HOURS fechadas, se a projeção cruza
+ *   min_free ou min_block em menos de HEAP_TREND_HORIZON_HOURS o alerta
+ *   sobe para "trend", antes de o HydroSystemCore desligar o HTTPS.
+ * - Tags: HEAP_TAG mede o heap livre e o maior bloco na entrada e na
+ *   saída do escopo; a diferença acumulada por subsistema mostra quem
+ *   retém memória e quem quebra o maior bloco. Outras tasks alocando ao
+ *   mesmo tempo entram na conta: vale a tendência, não o valor de uma
+ *   chamada. TaggedJsonDocument conta também os bytes de JSON.
+ * - Reboot: recordRestart() guarda os maiores culpados em RTC (sobrevive
+ *   ao ESP.restart, sem gravar flash); aparecem em "previous_boot".
+ *
+ * GET /api/heap (ou /heap no DiagWebServer): ?history=1 inclui os anéis,
+ * ?reset=1 zera as tags.
+ */
+class HeapMonitor {
+public:
+    static HeapMonitor& shared();
+
+    /**
+     * @brief Recupera o relatório do boot anterior (chamar no setup)
+     */
+    void begin();
+
+    /**
+     * @brief Amostra quando o intervalo venceu; barato nas demais chamadas
+     */
+    void loop();
+    void sample();
+
+    /**
+     * @brief Limites do alerta (o HydroSystemCore passa MIN_HEAP_FOR_HTTPS)
+     */
+    void setThresholds(uint32_t min_free, uint32_t min_block);
+
+    // ===== TAGS =====
+    /**
+     * @brief Índice da tag (criada no primeiro uso); -1 se a tabela encheu
+     */
+    int8_t tag(const char* name);
+    void recordScope(int8_t id, uint32_t free_before, uint32_t block_before);
+    void recordJsonAlloc(int8_t id, size_t bytes, bool ok);
+    void recordJsonFree(int8_t id, size_t bytes);
+
+    // ===== CONSULTA =====
+    HeapAlert getAlert() const { return alert; }
+    uint32_t getLargestBlock() const { return last_block; }
+    uint8_t getFragmentation() const;
+    const char* getTopTag() const;        // Maior retenção acumulada (nullptr sem dados)
+
+    /**
+     * @brief Registra a causa e os maiores culpados antes de ESP.restart()
+     */
+    void recordRestart(const char* reason);
+    void printReport();
+
+    void attach(AsyncWebServer* server, const char* uri);
+    String getJSON(bool history);
+    void reset();
+
+private:
+    struct Sample {
+        uint32_t free_bytes;
+        uint32_t largest_block;
+    };
+
+    struct TagStats {
+        const char* name;
+        uint32_t calls;
+        int64_t retained;                 // Soma de (livre na entrada - livre na saída)
+        int32_t max_retained;             // Maior retenção numa chamada
+        uint64_t block_loss;              // Soma do quanto o maior bloco encolheu
+        uint32_t json_live;               // Bytes de TaggedJsonDocument ainda alocados
+        uint32_t json_peak;
+        uint32_t json_failed;             // Documentos sem memória para o pool
+    };
+
+    HeapMonitor();
+    HeapMonitor(const HeapMonitor&) = delete;
+    HeapMonitor& operator=(const HeapMonitor&) = delete;
+
+    portMUX_TYPE spinlock;
+
+    Sample recent[HEAP_RECENT_SAMPLES];
+    uint32_t recent_count;
+    Sample hourly[HEAP_HOURLY_SAMPLES];
+    uint32_t hourly_count;
+    Sample hour_min;                      // Mínimos da hora em andamento
+    uint16_t hour_samples;
+    unsigned long last_sample;
+
+    uint32_t last_free;
+    uint32_t last_block;
+    uint32_t free_blocks;
+    uint32_t min_free;
+    uint32_t min_block;
+
+    float free_slope;                     // Bytes por hora
+    float block_slope;
+    HeapAlert alert;
+
+    TagStats tags[HEAP_MAX_TAGS];
+    uint8_t tag_count;
+
+    void updateTrend();
+    void updateAlert();
+    float slopePerHour(bool largest) const;
+    static float hoursUntil(uint32_t current, uint32_t limit, float slope);
+    uint8_t topTags(uint8_t* order, uint8_t max) const;
+};
+
+/**
+ * @brief Mede o heap do construtor ao destrutor (use HEAP_TAG)
+ */
+class ScopedHeapTag {
+public:
+    explicit ScopedHeapTag(int8_t id);
+    ~ScopedHeapTag();
+
+private:
+    int8_t id;
+    uint32_t free_before;
+    uint32_t block_before;
+};
+
+/**
+ * @brief Alocador do ArduinoJson que conta o pool do documento na tag
+ */
+class HeapTagAllocator {
+public:
+    explicit HeapTagAllocator(int8_t id = -1) : id(id), size(0) {}
+
+    void* allocate(size_t bytes);
+    void deallocate(void* pointer);
+    void* reallocate(void* pointer, size_t bytes);
+
+private:
+    int8_t id;
+    size_t size;                          // Um pool por documento
+};
+
+/**
+ * @brief DynamicJsonDocument contabilizado: TaggedJsonDocument doc("web.api", 512);
+ */
+class TaggedJsonDocument : public BasicJsonDocument<HeapTagAllocator> {
+public:
+    TaggedJsonDocument(const char* tag, size_t capacity) :
+        BasicJsonDocument<HeapTagAllocator>(capacity, HeapTagAllocator(HeapMonitor::shared().tag(tag))) {}
+};
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,60 @@
+#ifndef HISTORY_API_H
+#define HISTORY_API_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "TimeSeriesStore.h"
+
+// ===== CONFIGURAÇÕES DA API DE HISTÓRICO =====
+#define HISTORY_DEFAULT_RANGE_S 3600          // Sem from/range: última hora
+#define HISTORY_DEFAULT_POINTS 240            // Pontos por série (largura típica de um gráfico)
+#define HISTORY_MAX_POINTS 1000
+#define HISTORY_PAGE_LIMIT 500                // Linhas por página quando points=0 (sem downsampling)
+#define HISTORY_MAX_STREAMS 2                 // Respostas em andamento ao mesmo tempo
+#define HISTORY_LINE_SIZE 256                 // Maior trecho de JSON montado de uma vez
+#define HISTORY_CHUNK_ROWS 8                  // Linhas copiadas do store por vez (fora do mutex ao formatar)
+
+/**
+ * @brief Endpoints HTTP de consulta ao histórico local (TimeSeriesStore)
+ *
+ * GET /api/history?channels=ph,ec&range=21600&points=240
+ *   Série reduzida para gráficos. O intervalo é dado por from/to (relógio
+ *   do dispositivo, em segundos; "now" vem na resposta) ou por range
+ *   (segundos até to). O nível (bruto, 1 min, 15 min) é o mais fino que
+ *   cobre o intervalo; cada ponto agrega um passo de (to - from) / points
+ *   segundos: média, e mín/máx com minmax=1.
+ *   Com points=0 as linhas do nível saem sem redução, paginadas por
+ *   limit; a resposta traz "next" para pedir a página seguinte.
+ *
+ * GET /api/history/summary?channel=ph&range=3600  (mín/máx/média)
+ * GET /api/history/status                          (níveis e páginas)
+ *
+ * A série é enviada em chunked transfer: cada chamada do AsyncTCP copia
+ * um lote pequeno de linhas da flash a partir de um cursor (só então com
+ * o mutex do store) e escreve os pontos direto no buffer do TCP. Nem o
+ * JSON inteiro nem a série ficam na heap, então horas de pH/EC cabem
+ * mesmo com pouca memória livre.
+ */
+class HistoryAPI {
+public:
+    HistoryAPI();
+
+    /**
+     * @brief Registra as rotas (o store precisa viver mais que o servidor)
+     */
+    void begin(AsyncWebServer* server, TimeSeriesStore& store);
+
+    uint8_t getActiveStreams() const { return active_streams; }
+
+private:
+    TimeSeriesStore* store;
+    volatile uint8_t active_streams;
+
+    void handleSeries(AsyncWebServerRequest* request);
+    void handleSummary(AsyncWebServerRequest* request);
+    bool parseRange(AsyncWebServerRequest* request, uint32_t& from, uint32_t& to);
+    static uint32_t paramU32(AsyncWebServerRequest* request, const char* name, uint32_t fallback);
+    static void sendError(AsyncWebServerRequest* request, int code, const char* message);
+};
+
+#endif // HISTORY_API_H
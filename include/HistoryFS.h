@@ -0,0 +1,35 @@
+#ifndef HISTORY_FS_H
+#define HISTORY_FS_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ===== PARTIÇÃO DE HISTÓRICO =====
+// Definida em partitions_hydro.csv. A partição "spiffs" continua com o
+// SPIFFS das páginas web e do estado; o LittleFS fica só com esta.
+#define HISTORY_FS_PARTITION "history"
+#define HISTORY_FS_BASE_PATH "/littlefs"
+#define HISTORY_FS_MAX_FILES 10
+
+/**
+ * @brief Montagem única do LittleFS na partição de histórico
+ *
+ * TimeSeriesStore, TelemetryQueue, EventLog e as regras do DecisionEngine
+ * usam o mesmo objeto LittleFS. Montar cada um com LittleFS.begin() sem
+ * rótulo apontava para a partição "spiffs", já montada pelo SPIFFS.
+ * Chamadas repetidas devolvem o resultado da primeira montagem bem
+ * sucedida; se a partição não existe (tabela antiga), falha com erro claro.
+ */
+namespace HistoryFS {
+
+/**
+ * @brief Monta (formata na primeira vez) a partição de histórico
+ * @param owner Nome do módulo, para o log
+ */
+bool mount(const char* owner);
+
+bool isMounted();
+
+} // namespace HistoryFS
+
+#endif // HISTORY_FS_H
@@ -11,6 +11,10 @@
 #include "PHSensor.h"
 #include "TDSReaderSerial.h"
 #include "LevelSensor.h"
+#include "SensorTask.h"
+#include "PHCalibration.h"
+#include "SensorHealth.h"
+#include "SensorBus.h"
 
 class HydroControl {
 public:
@@ -22,12 +26,17 @@ public:
     void update();
     void showMessage(String msg);
     void toggleRelay(int relay, int seconds = 0);
+    bool setRelay(int relay, bool state);
     void updateSensorData(float temp, float humidity, float ph, float tds);
     void updateRelayTimers();
     bool* getRelayStates() { return relayStates; }
     bool areSensorsWorking() { return sensorsOk; }
     bool isWaterLevelOk() { return tankLevelOk; }
     
+    // Gerações: avançam a cada mudança (cache de snapshots da API)
+    uint32_t getRelayGeneration() const { return relayGeneration; }
+    uint32_t getSensorGeneration() const { return sensorGeneration; }
+    
     // Getters para leituras dos sensores
     float& getTemperature() { return temperature; }
     float& getpH() { return pH; }
@@ -35,6 +44,18 @@ public:
     float& getEC() { return ec; }
     String getTankStatus();
     float getWaterTemp();
+    
+    // Últimas amostras com timestamp (publicadas pela task de sensores)
+    const SensorSampleStore& getSensorStore() const { return sensorBus.getStore(); }
+    
+    // Registro de sensores e assinaturas (entregues no loop principal)
+    SensorBus& getSensorBus() { return sensorBus; }
+
+    // Calibração multiponto do pH
+    PHCalibration& getPHCalibration() { return phCalibration; }
+
+    // Saúde por sensor (ruído, valor parado, resposta à dosagem, desgaste)
+    SensorHealthMonitor& getSensorHealth() { return sensorHealth; }
 
 private:
     // Hardware
@@ -43,8 +64,13 @@ private:
     DallasTemperature sensors;
     PCF8574 pcf1, pcf2;
     phSensor* pHSensor;
+    PHCalibration phCalibration;
+    SensorHealthMonitor sensorHealth;
     TDSReaderSerial* tdsSensor;
     LevelSensor* tankSensor;
+    AdcDmaSampler adcSampler;
+    SensorBus sensorBus;
+    SensorTask sensorTask;
     
     // Status dos PCF8574
     bool pcf1_ok;
@@ -64,9 +90,12 @@ private:
     bool relayStates[NUM_RELAYS];
     unsigned long startTimes[NUM_RELAYS];
     int timerSeconds[NUM_RELAYS];
+    volatile uint32_t relayGeneration;
+    volatile uint32_t sensorGeneration;
     
     // Funções internas
     void updateSensors();
+    void onSensorReading(const SensorReading& reading);
     void updateDisplay();
     void checkRelayTimers();
 };
@@ -3,92 +3,130 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <Preferences.h>
+#include <functional>
 #include "SupabaseClient.h"
 #include "SupabaseRealtimeClient.h"
+#include "CommandAckQueue.h"
 #include "Config.h"
 
 /**
- * HydroSupaManager - Sistema Híbrido de Comunicação
- * 
- * Combina HTTP e WebSocket para comunicação otimizada:
- * - HTTP: Dados periódicos, status, heartbeat
- * - WebSocket: Comandos em tempo real, notificações
- * - Fallback: HTTP polling se WebSocket falhar
- * 
- * Características:
- * - Auto-detecção de problemas de memória
- * - Reconexão automática
- * - Fallback inteligente
- * - Proteção contra falhas
+ * HydroSupaManager - Caminho de comandos de relé
+ *
+ * Realtime (WebSocket) é o caminho principal: o INSERT em relay_commands
+ * chega por push e o relé é acionado em menos de um segundo.
+ * - HTTP polling só enquanto o socket estiver fora, com intervalo adaptativo
+ *   (curto logo após atividade, recuando até HTTP_POLL_MAX_INTERVAL)
+ * - Uma consulta de recuperação a cada (re)inscrição no canal, para os
+ *   comandos criados enquanto o socket estava caído
+ * - Execução única: IDs recentes ficam num anel e comandos repetidos
+ *   (push + polling, reentrega do servidor) são ignorados. O anel é
+ *   gravado na NVS antes de acionar o relé, então um reboot no meio do
+ *   caminho não repete a dose (no máximo uma vez; sem conclusão gravada
+ *   o comando é confirmado como falha)
+ *
+ * - Confirmações passam pela CommandAckQueue: um PATCH por janela para
+ *   vários comandos, e a conclusão segue antes pelo socket. Com a fila
+ *   cheia, o resultado fica marcado no anel e é reenviado no loop()
+ *
+ * O cliente HTTP é compartilhado com o HydroSystemCore (mesma sessão TLS).
  */
 class HydroSupaManager {
+public:
+    /**
+     * @brief Executa o comando nos relés; retorna sucesso
+     */
+    typedef std::function<bool(const RelayCommand& cmd)> CommandHandler;
+
 private:
     // Clientes de comunicação
-    SupabaseClient httpClient;
+    SupabaseClient& httpClient;
     SupabaseRealtimeClient realtimeClient;
-    
+    CommandHandler commandHandler;
+    CommandAckQueue ackQueue;
+
     // Configuração
     String baseUrl;
     String apiKey;
     String deviceId;
     bool isInitialized;
-    
+
     // Estado do sistema
     bool useWebSocket;
-    unsigned long lastHttpSend;
-    unsigned long lastStatusUpdate;
+    bool wasSubscribed;
+    bool catchUpPending;
     unsigned long lastCommandCheck;
+    unsigned long pollInterval;
     unsigned long lastWebSocketRetry;
-    
-    // Controle de falhas
-    int httpFailures;
+
+    // Deduplicação por ID de comando (persistida na NVS)
+    static const uint8_t COMMAND_DEDUPE_SIZE = 32;
+    static const char* NVS_NAMESPACE;
+    Preferences prefs;
+    int32_t recentCommandIds[COMMAND_DEDUPE_SIZE];
+    uint8_t recentCommandOk[COMMAND_DEDUPE_SIZE];
+    bool recentCommandReported[COMMAND_DEDUPE_SIZE];  // Aceito pela CommandAckQueue (RAM)
+    uint8_t recentCommandIndex;
+    bool unreportedCommands;
+
+    // Controle de falhas e estatísticas
     int wsFailures;
-    
+    uint32_t realtimeCommands;
+    uint32_t polledCommands;
+    uint32_t duplicateCommands;
+    uint32_t httpPolls;
+
     // Constantes
-    static const unsigned long HTTP_SEND_INTERVAL = 30000;    // 30s - dados via HTTP
-    static const unsigned long STATUS_UPDATE_INTERVAL = 60000; // 60s - status completo
-    static const unsigned long HTTP_POLL_INTERVAL = 10000;    // 10s - polling HTTP (fallback)
-    static const unsigned long WS_RETRY_INTERVAL = 120000;    // 2min - tentar reativar WS
-    
-    static const int MAX_HTTP_FAILURES = 5;
+    static const unsigned long HTTP_POLL_MIN_INTERVAL = 10000;  // 10s - logo após atividade
+    static const unsigned long HTTP_POLL_MAX_INTERVAL = 120000; // 2min - sem comandos
+    static const unsigned long WS_RETRY_INTERVAL = 120000;      // 2min - tentar reativar WS
+
     static const int MAX_WS_FAILURES = 3;
-    
+
     // Métodos privados
     bool initializeWebSocket();
-    void sendHttpData();
-    void updateDeviceStatus();
-    void checkHttpCommands();
-    void handleWebSocketCommand(int relay, String action, int duration);
+    void checkHttpCommands(const char* reason);
+    void handleWebSocketCommand(int commandId, int relay, String action, int duration);
     void handleWebSocketError(String error);
     void processCommand(const RelayCommand& cmd, const String& source);
     bool executeRelayCommand(int relay, const String& action, int duration);
-    
+    int findProcessed(int commandId) const;
+    int rememberCommand(int commandId, bool success);
+    void setCommandResult(int slot, bool success);
+    void loadRecentCommands();
+    void saveRecentCommands();
+    bool reportResult(int commandId, bool success);
+    void retryUnreported();
+
 public:
-    HydroSupaManager();
+    explicit HydroSupaManager(SupabaseClient& client);
     ~HydroSupaManager();
-    
+
     // Controle principal
     bool begin(const String& url, const String& key);
     void loop();
     void end();
-    
+
+    void setCommandHandler(CommandHandler handler) { commandHandler = handler; }
+
     // Status e diagnóstico
     bool isReady() const { return isInitialized && httpClient.isReady(); }
     bool isWebSocketActive() const { return useWebSocket && realtimeClient.isConnected(); }
     bool isHttpActive() const { return httpClient.isReady(); }
-    
+
     void printStatus();
-    
+
     // Acesso aos clientes (para casos especiais)
     SupabaseClient& getHttpClient() { return httpClient; }
     const SupabaseClient& getHttpClient() const { return httpClient; }
+    CommandAckQueue& getAckQueue() { return ackQueue; }
     SupabaseRealtimeClient& getRealtimeClient() { return realtimeClient; }
     const SupabaseRealtimeClient& getRealtimeClient() const { return realtimeClient; }
-    
+
     // Controle manual
     void forceWebSocketReconnect();
     void disableWebSocket() { useWebSocket = false; realtimeClient.end(); }
-    void enableWebSocket() { if (!useWebSocket) initializeWebSocket(); }
+    void enableWebSocket() { if (!useWebSocket) useWebSocket = initializeWebSocket(); }
 };
 
 #endif // HYBRID_SUPABASE_MANAGER_H
@@ -7,6 +7,10 @@
 #include "SupabaseClient.h"
 #include "HydroSupaManager.h"
 #include "RelayCommandBox.h"
+#include "TimeSeriesStore.h"
+#include "TelemetryQueue.h"
+#include "SupabaseBatchUploader.h"
+#include "WebServerManager.h"
 #include "Config.h"
 
 class HydroSystemCore {
@@ -14,7 +18,11 @@ private:
     HydroControl hydroControl;
     RelayCommandBox relayController;  // ✅ Controlador de relés (8 relés)
     SupabaseClient supabase;
-    HydroSupaManager hybridSupabase;  // ✅ Manager híbrido
+    HydroSupaManager hybridSupabase;  // ✅ Comandos: Realtime + polling de reserva
+    TimeSeriesStore timeSeries;       // ✅ Histórico local de sensores
+    TelemetryQueue telemetryQueue;    // ✅ Leituras guardadas durante quedas
+    SupabaseBatchUploader batchUploader;  // ✅ Bulk insert por tabela
+    WebServerManager webServer;       // ✅ Painel admin + SSE (depois de hydroControl: destruído antes)
     
     // Estados do sistema
     bool systemReady;
@@ -25,14 +33,12 @@ private:
     unsigned long lastSensorSend;
     unsigned long lastStatusSend;
     unsigned long lastStatusPrint;
-    unsigned long lastSupabaseCheck;
     unsigned long lastMemoryProtection;
     
     // Intervalos otimizados
     static const unsigned long SENSOR_SEND_INTERVAL = 30000;      // 30s
     static const unsigned long STATUS_SEND_INTERVAL = 60000;      // 1 min
     static const unsigned long STATUS_PRINT_INTERVAL = 30000;     // 30s
-    static const unsigned long SUPABASE_CHECK_INTERVAL = 30000;   // 30s
     static const unsigned long MEMORY_CHECK_INTERVAL = 10000;     // 10s
     
     // Proteção de memória específica para HTTPS
@@ -55,6 +61,9 @@ public:
     // Acesso aos módulos (para comandos seriais)
     HydroControl& getHydroControl() { return hydroControl; }
     SupabaseClient& getSupabase() { return supabase; }
+    TimeSeriesStore& getTimeSeries() { return timeSeries; }
+    TelemetryQueue& getTelemetryQueue() { return telemetryQueue; }
+    SupabaseBatchUploader& getBatchUploader() { return batchUploader; }
     
     // Debug e comandos
     void printSystemStatus();
@@ -63,14 +72,14 @@ public:
     
 private:
     // Operações principais
-    void checkSupabaseCommands();
-    void processRelayCommand(const RelayCommand& cmd);
+    bool executeRelayCommand(const RelayCommand& cmd);
     void sendSensorDataToSupabase();
     void sendDeviceStatusToSupabase();
     void performMemoryProtection();
     
     // Utilities
     bool hasEnoughMemoryForHTTPS();
+    bool isCloudReachable();
     void printPeriodicStatus();
 };
 
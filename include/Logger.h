@@ -0,0 +1,113 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/stream_buffer.h>
+#include "DebugConfig.h"
+
+// ===== CONFIGURAÇÕES DO LOGGER =====
+#define LOG_LINE_SIZE 192                     // Maior linha formatada (o resto é cortado)
+#define LOGGER_QUEUE_BYTES 4096               // Fila para a UART (~0,35s a 115200 baud)
+#define LOG_DRAIN_CHUNK 128
+#define LOG_TASK_STACK_SIZE 2560
+#define LOG_TASK_PRIORITY 1                   // Abaixo de sensores e ESP-NOW
+#define LOG_TASK_CORE 0
+#define LOG_RATE_LINES_PER_S 40               // Reposição do balde de linhas
+#define LOG_RATE_BURST 80                     // Rajada máxima antes de suprimir
+#define LOG_LOCK_TIMEOUT_MS 5
+
+// ===== MACROS =====
+// O teste de nível é constante: acima do nível do módulo o compilador
+// elimina a chamada e os argumentos nem são avaliados.
+#define HYDRO_LOG(module, level, format, ...) \
+    do { \
+        if ((level) <= LOG_LEVEL_##module) { \
+            Logger::shared().write((level), #module, format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOGE(module, format, ...) HYDRO_LOG(module, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define LOGW(module, format, ...) HYDRO_LOG(module, LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOGI(module, format, ...) HYDRO_LOG(module, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOGD(module, format, ...) HYDRO_LOG(module, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOGV(module, format, ...) HYDRO_LOG(module, LOG_LEVEL_VERBOSE, format, ##__VA_ARGS__)
+
+// No máximo uma linha a cada interval_ms neste ponto do código
+#define LOG_EVERY_MS(module, level, interval_ms, format, ...) \
+    do { \
+        if ((level) <= LOG_LEVEL_##module) { \
+            static unsigned long _log_last = 0; \
+            unsigned long _log_now = millis(); \
+            if (_log_last == 0 || _log_now - _log_last >= (interval_ms)) { \
+                _log_last = _log_now; \
+                Logger::shared().write((level), #module, format, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// MAC sem String temporária: LOGI(ESPNOW, "de " LOG_MAC_FMT, LOG_MAC_ARGS(mac))
+#define LOG_MAC_FMT "%02X:%02X:%02X:%02X:%02X:%02X"
+#define LOG_MAC_ARGS(mac) (mac)[0], (mac)[1], (mac)[2], (mac)[3], (mac)[4], (mac)[5]
+
+/**
+ * @brief Log formatado que nunca bloqueia quem chama
+ *
+ * write() formata num buffer estático (printf, sem String) e copia a
+ * linha para um stream buffer; uma task de baixa prioridade drena para
+ * a Serial. A 115200 baud cada caractere leva ~87us, então o custo da
+ * UART sai do loop de controle. Com a fila cheia a linha é descartada e
+ * contada. Um balde de LOG_RATE_LINES_PER_S linhas/s limita rajadas
+ * (erros passam sempre); as suprimidas são informadas na linha seguinte.
+ *
+ * Antes de begin() (ou se a task não puder ser criada) escreve direto
+ * na Serial, como antes.
+ */
+class Logger {
+public:
+    static Logger& shared();
+
+    /**
+     * @brief Cria a fila e a task de drenagem (chamar após Serial.begin)
+     */
+    bool begin();
+
+    void write(uint8_t level, const char* module, const char* format, ...) __attribute__((format(printf, 4, 5)));
+
+    /**
+     * @brief Espera a fila esvaziar (antes de reiniciar)
+     */
+    void flush(uint32_t timeout_ms = 500);
+
+    // ===== STATUS =====
+    uint32_t getLinesWritten() const { return lines_written; }
+    uint32_t getLinesDropped() const { return lines_dropped; }
+    uint32_t getLinesSuppressed() const { return lines_suppressed; }
+    String getStatusJSON() const;
+
+private:
+    Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    SemaphoreHandle_t mutex;
+    StreamBufferHandle_t stream;
+    TaskHandle_t taskHandle;
+
+    char line[LOG_LINE_SIZE];
+    float tokens;
+    unsigned long last_refill;
+    uint32_t pending_suppressed;          // Ainda não informadas na saída
+
+    uint32_t lines_written;
+    uint32_t lines_dropped;
+    uint32_t lines_suppressed;
+    size_t min_free_space;
+
+    bool takeToken(uint8_t level);
+    void emit(const char* text, size_t length);
+    static void taskFunction(void* parameter);
+};
+
+#endif // LOGGER_H
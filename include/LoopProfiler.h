@@ -0,0 +1,131 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ===== CONFIGURAÇÕES DO PROFILER =====
+#define PROFILER_ENABLED 1                    // 0 = PROFILE_SCOPE não gera código
+#define PROFILER_MAX_SECTIONS 24
+#define PROFILER_LOOP_HISTORY 64              // Últimas durações do loop()
+#define PROFILER_MAX_TASKS 24                 // uxTaskGetSystemState falha se houver mais tasks
+#define PROFILER_TASK_SAMPLE_MS 5000          // Janela do uso de CPU por task
+#define PROFILER_TASK_NAME_SIZE 16
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+// Cronometra o restante do bloco: PROFILE_SCOPE("hydro.update");
+// O nome precisa ser um literal (o ponteiro é guardado).
+#if PROFILER_ENABLED
+  #define PROFILE_SCOPE(name) \
+      static const int8_t PROFILER_CONCAT(_profile_id_, __LINE__) = LoopProfiler::shared().section(name); \
+      ScopedTimer PROFILER_CONCAT(_profile_timer_, __LINE__)(PROFILER_CONCAT(_profile_id_, __LINE__))
+#else
+  #define PROFILE_SCOPE(name)
+#endif
+
+/**
+ * @brief Tempos por subsistema, duração do loop e uso das tasks
+ *
+ * - Seções: PROFILE_SCOPE mede com micros() e acumula contagem, média,
+ *   máximo e último valor (o índice da seção é resolvido uma vez por
+ *   ponto do código, numa variável estática).
+ * - Loop: loopStart()/loopEnd() em volta do loop() guardam as últimas
+ *   PROFILER_LOOP_HISTORY durações num anel.
+ * - Tasks: a cada PROFILER_TASK_SAMPLE_MS o uso de CPU de cada task
+ *   (contadores de run-time do FreeRTOS, quando habilitados no sdkconfig)
+ *   e a menor folga de stack já vista.
+ *
+ * Medir não aloca; o JSON só é montado em /perf (ou /api/perf). Com
+ * TRACE_ENABLED cada escopo também vai para o timeline (TraceRecorder).
+ */
+class LoopProfiler {
+public:
+    static LoopProfiler& shared();
+
+    // ===== LOOP PRINCIPAL =====
+    void loopStart();
+    void loopEnd();
+
+    // ===== SEÇÕES =====
+    /**
+     * @brief Índice da seção (criada no primeiro uso); -1 se a tabela encheu
+     */
+    int8_t section(const char* name);
+    void record(int8_t id, uint32_t start_us, uint32_t elapsed_us);
+    uint8_t getSectionCount() const { return section_count; }
+    const char* getSectionName(uint8_t id) const { return id < section_count ? sections[id].name : nullptr; }
+
+    // ===== TASKS =====
+    /**
+     * @brief Task acompanhada mesmo sem uxTaskGetSystemState (stack livre)
+     */
+    void registerTask(TaskHandle_t handle);
+    void sampleTasks();
+
+    // ===== CONSULTA =====
+    void attach(AsyncWebServer* server, const char* uri);
+    String getJSON();
+    void reset();
+
+private:
+    struct Section {
+        const char* name;
+        uint32_t count;
+        uint64_t total_us;
+        uint32_t max_us;
+        uint32_t last_us;
+    };
+
+    struct TaskSample {
+        char name[PROFILER_TASK_NAME_SIZE];
+        TaskHandle_t handle;
+        uint32_t number;
+        uint32_t last_runtime;
+        uint16_t cpu_permille;             // Na última janela
+        uint32_t stack_free;               // Menor folga (bytes)
+        uint8_t priority;
+        int8_t core;
+        bool seen;
+    };
+
+    LoopProfiler();
+    LoopProfiler(const LoopProfiler&) = delete;
+    LoopProfiler& operator=(const LoopProfiler&) = delete;
+
+    portMUX_TYPE spinlock;
+
+    Section sections[PROFILER_MAX_SECTIONS];
+    uint8_t section_count;
+
+    uint32_t loop_history[PROFILER_LOOP_HISTORY];
+    uint32_t loop_count;
+    uint32_t loop_start_us;
+    uint32_t loop_max_us;
+    uint64_t loop_total_us;
+
+    TaskSample tasks[PROFILER_MAX_TASKS];
+    uint8_t task_count;
+    uint32_t last_total_runtime;
+    unsigned long last_task_sample;
+
+    TaskSample* findTask(TaskHandle_t handle, uint32_t number);
+};
+
+/**
+ * @brief Mede do construtor ao destrutor (use PROFILE_SCOPE)
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(int8_t id) : id(id), start_us(micros()) {}
+    ~ScopedTimer() { LoopProfiler::shared().record(id, start_us, micros() - start_us); }
+
+private:
+    int8_t id;
+    uint32_t start_us;
+};
+
+#endif // LOOP_PROFILER_H
@@ -0,0 +1,144 @@
+#ifndef PH_CALIBRATION_H
+#define PH_CALIBRATION_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Config.h"
+
+// ===== CONFIGURAÇÕES DE CALIBRAÇÃO =====
+#define PH_CAL_MAX_POINTS 3                   // Soluções tampão (4, 7, 10)
+#define PH_CAL_HISTORY_SIZE 8                 // Calibrações guardadas para tendência
+#define PH_CAL_REFERENCE_TEMP 25.0            // Temperatura padrão (°C)
+#define PH_CAL_MIN_SLOPE_PERCENT 80.0         // Abaixo disso a sonda está gasta
+#define PH_CAL_MAX_SLOPE_PERCENT 110.0        // Acima disso a calibração é suspeita
+#define PH_CAL_HOURS_SAVE_INTERVAL_MS 3600000 // Horas de uso gravadas a cada 1h
+
+/**
+ * @brief Tipo de ajuste da curva tensão -> pH
+ */
+enum PHFitMode : uint8_t {
+    PH_FIT_PIECEWISE = 0,      // Segmentos entre pontos vizinhos
+    PH_FIT_LEAST_SQUARES       // Reta de mínimos quadrados
+};
+
+/**
+ * @brief Ponto medido numa solução tampão
+ */
+struct PHCalPoint {
+    float ph;                  // pH nominal do tampão
+    float voltage;             // Tensão lida (V)
+    float temperature;         // Temperatura da água na leitura (°C)
+};
+
+/**
+ * @brief Calibração persistida na NVS
+ */
+struct PHCalibrationRecord {
+    uint8_t version;
+    uint8_t point_count;
+    PHFitMode mode;
+    PHCalPoint points[PH_CAL_MAX_POINTS];   // Ordenados por pH
+    float cal_temperature;                  // Média das temperaturas dos pontos
+    float slope;                            // pH/V (reta global)
+    float offset;
+    float slope_percent;                    // Inclinação relativa à sonda nova
+    float probe_hours_at_cal;               // Horas de uso da sonda na calibração
+    uint16_t calibration_count;
+} __attribute__((packed));
+
+/**
+ * @brief Calibração multiponto do pH com compensação de temperatura
+ *
+ * Suporta 2 ou 3 pontos (segmentos ou mínimos quadrados) e aplica a
+ * compensação de Nernst: a inclinação do eletrodo é proporcional à
+ * temperatura absoluta, com ponto isopotencial em pH 7.
+ *
+ * Acompanha o envelhecimento da sonda pela inclinação relativa à
+ * primeira calibração depois da instalação e pelas horas de uso
+ * (sem RTC, contadas pelo uptime acumulado).
+ */
+class PHCalibration {
+public:
+    PHCalibration();
+    ~PHCalibration();
+
+    // ===== CONTROLE =====
+    bool begin();
+    void loop();
+
+    // ===== CONVERSÃO =====
+    /**
+     * @brief Converte tensão em pH compensado pela temperatura
+     * @param voltage Tensão do módulo (V)
+     * @param temperature Temperatura da água (°C); NAN = sem compensação
+     */
+    float toPH(float voltage, float temperature) const;
+
+    // ===== SESSÃO DE CALIBRAÇÃO =====
+    void startSession();
+    bool addPoint(float buffer_ph, float voltage, float temperature, String& error);
+    bool commit(PHFitMode mode, String& error);
+    void cancelSession();
+    uint8_t getSessionPointCount() const { return session_count; }
+
+    // ===== SONDA =====
+    void markNewProbe();
+    float getProbeHours() const;
+    float getSlopePercent() const;
+    float getHoursSinceCalibration() const;
+    bool isProbeWorn() const;
+
+    // ===== STATUS =====
+    PHCalibrationRecord getRecord() const;
+    String getStatusJSON() const;
+    void printStatus() const;
+
+private:
+    struct HistoryEntry {
+        float slope_percent;
+        float probe_hours;
+    } __attribute__((packed));
+
+    // Curva ativa (protegida por mutex: web escreve, task de sensores lê)
+    PHCalibrationRecord record;
+    SemaphoreHandle_t mutex;
+
+    // Sessão, sonda, histórico e Preferences: as rotas /api/ph-calibration/*
+    // rodam na task do AsyncTCP e loop() no loop principal. Recursivo porque
+    // commit() e markNewProbe() chamam saveToNVS()/saveProbeHours().
+    // Ordem: state_mutex antes de mutex, nunca o contrário.
+    SemaphoreHandle_t state_mutex;
+
+    // Sessão em andamento
+    PHCalPoint session_points[PH_CAL_MAX_POINTS];
+    uint8_t session_count;
+
+    // Envelhecimento da sonda
+    float reference_slope;          // Inclinação da primeira calibração da sonda
+    float probe_hours;              // Horas de uso já gravadas
+    unsigned long last_hours_update;
+    HistoryEntry history[PH_CAL_HISTORY_SIZE];
+    uint8_t history_count;
+
+    Preferences prefs;
+    static const char* NVS_NAMESPACE;
+    static const uint8_t RECORD_VERSION = 1;
+
+    void loadDefaults();
+    // Chamados com state_mutex tomado
+    void loadFromNVS();
+    void saveToNVS();
+    void saveProbeHours();
+    bool insertPoint(float buffer_ph, float voltage, float temperature, String& error);
+    bool commitSession(PHFitMode mode, String& error);
+    bool fit(PHCalibrationRecord& target, String& error) const;
+    float rawPH(const PHCalibrationRecord& rec, float voltage) const;
+    void lock() const;
+    void unlock() const;
+    void lockState() const;
+    void unlockState() const;
+};
+
+#endif // PH_CALIBRATION_H
@@ -2,13 +2,20 @@
 #define PHSENSOR_H
 
 #include <Arduino.h>
+#include "PHCalibration.h"
 
 class phSensor {
 public:
     phSensor();
     void calibrate(float cal_ph7, float cal_ph4, float cal_ph10 = 0.0, bool use_ph10 = false);
     float readPH(uint8_t pin);
+    bool collectSample(uint8_t pin);   // Leitura não bloqueante: uma amostra por chamada
+    float getBufferedPH();             // pH do lote coletado por collectSample
+    float readPHFromRaw(float raw);    // pH a partir de contagens já filtradas (ADC DMA)
     void printSerialPH(uint8_t pin);
+    void setCalibration(PHCalibration* cal) { calibration = cal; }   // Curva multiponto (substitui m/b)
+    void setTemperature(float temp) { temperature = temp; }           // Compensação de Nernst
+    float getLastVoltage() const { return lastVoltage; }
 
 private:
     float calibracao_ph7;
@@ -17,9 +24,14 @@ private:
     bool UTILIZAR_PH_10;
     float m, b;
     int buf[10];
+    int sampleIndex;
+    PHCalibration* calibration;
+    float temperature;
+    float lastVoltage;
 
     float calculatePH(float voltage);
     float getAverage(uint8_t pin);
+    float averageBuffer();
 };
 
 #endif 
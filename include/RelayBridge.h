@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "SupabaseClient.h"    // RelayCommand (Supabase)
+#include "CommandAckQueue.h"   // Confirmaciones agrupadas
 #include "ESPNowTypes.h"        // ESPNowRelayCommand (ESP-NOW)
 #include "ESPNowTask.h"         // Para enviar comandos via ESP-NOW
 
@@ -28,6 +29,7 @@ public:
      * @param espnowTask Puntero a la task ESP-NOW
      */
     RelayBridge(SupabaseClient* supabase, ESPNowTask* espnowTask);
+    ~RelayBridge();
     
     /**
      * @brief Inicializar el bridge
@@ -120,6 +122,7 @@ private:
     // Punteros a componentes
     SupabaseClient* supabase;
     ESPNowTask* espnowTask;
+    CommandAckQueue* acks;  // sent/completed/failed agrupados en un PATCH por ventana
     
     // Estado
     bool enabled;
@@ -0,0 +1,84 @@
+#ifndef RELAY_PWM_SCHEDULER_H
+#define RELAY_PWM_SCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Config.h"
+
+/**
+ * @brief Agendador de PWM lento (time-proportioning) para relés
+ *
+ * Cada canal mantém o relé ligado durante duty * período dentro de uma
+ * janela fixa (ex.: 20% de 60 s = 12 s ligado, 48 s desligado). Vários
+ * relés rodam ao mesmo tempo, com a primeira janela de cada um defasada
+ * para que as bombas não partam juntas (corrente de partida).
+ *
+ * O estado comandado de todos os canais fica num registrador sombra
+ * (bitmask) e apenas as transições são escritas no hardware.
+ */
+class RelayPWMScheduler {
+public:
+    typedef std::function<void(int relay, bool state)> RelayWriteCallback;
+
+    // Configurações
+    static const unsigned long DEFAULT_PERIOD_MS = 60000;   // Janela padrão (60s)
+    static const unsigned long MIN_PERIOD_MS = 5000;        // Janela mínima (5s)
+    static const unsigned long MIN_SWITCH_MS = 1000;        // Tempo mínimo ligado/desligado
+    static const unsigned long PHASE_STAGGER_MS = 2000;     // Defasagem entre canais
+
+    RelayPWMScheduler();
+
+    // ===== CONTROLE =====
+    /**
+     * @brief Inicia (ou reconfigura) o PWM de um relé
+     * @param relay Número do relé (0 a MAX_RELAYS-1)
+     * @param duty_percent Ciclo de trabalho (0-100%)
+     * @param period_ms Duração da janela (0 = DEFAULT_PERIOD_MS)
+     * @param run_time_ms Tempo total de execução (0 = até stop())
+     * @return true se o canal foi configurado
+     */
+    bool start(int relay, float duty_percent, unsigned long period_ms = 0, unsigned long run_time_ms = 0);
+    void stop(int relay);
+    void stopAll();
+
+    /**
+     * @brief Avança todos os canais (chamar no loop principal)
+     */
+    void update();
+    void update(unsigned long now);
+
+    // ===== STATUS =====
+    bool isActive(int relay) const;
+    float getDutyPercent(int relay) const;
+    uint8_t getActiveCount() const;
+    uint16_t getShadowMask() const { return shadow_mask; }
+
+    void setRelayWriteCallback(RelayWriteCallback callback) { write_callback = callback; }
+    void printStatus();
+
+private:
+    struct PWMChannel {
+        bool active;
+        float duty;                 // 0.0 - 1.0
+        unsigned long period_ms;
+        unsigned long window_start; // Início da janela atual
+        unsigned long on_time_ms;   // Tempo ligado na janela atual
+        long carry_ms;              // Resto acumulado (arredondamento por MIN_SWITCH_MS)
+        unsigned long start_time;
+        unsigned long run_time_ms;
+
+        PWMChannel() : active(false), duty(0.0), period_ms(DEFAULT_PERIOD_MS),
+                      window_start(0), on_time_ms(0), carry_ms(0),
+                      start_time(0), run_time_ms(0) {}
+    };
+
+    PWMChannel channels[MAX_RELAYS];
+    uint16_t shadow_mask;
+    RelayWriteCallback write_callback;
+
+    void beginWindow(PWMChannel& channel);
+    void applyState(int relay, bool state);
+    bool isValidRelay(int relay) const { return relay >= 0 && relay < MAX_RELAYS; }
+};
+
+#endif // RELAY_PWM_SCHEDULER_H
@@ -0,0 +1,83 @@
+#ifndef SEGMENT_RING_H
+#define SEGMENT_RING_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define SEGMENT_RING_PATH_SIZE 32
+
+/**
+ * @brief Anel de registros fixos em arquivos de segmento só-anexo
+ *
+ * O LittleFS é copy-on-write: gravar no meio de um arquivo copia do bloco
+ * alterado até o fim do arquivo. Por isso o anel não é um arquivo único
+ * regravado no lugar, e sim segment_count arquivos "<diretório>/<n>.seg"
+ * de records_per_segment registros. Registros novos são sempre anexados
+ * ao segmento corrente; quando o anel dá a volta o segmento seguinte é
+ * reciclado inteiro (reaberto com "w", que trunca). Cada gravação custa
+ * os bytes novos mais, no máximo, o bloco parcial no fim do segmento.
+ *
+ * O dono endereça os registros por um índice monotônico (a sua
+ * sequência): slot = índice % capacidade. Reciclar descarta de uma vez
+ * os records_per_segment registros mais antigos; oldestKept() diz o que
+ * continua guardado. Usado pela TelemetryQueue, pelo EventLog e pelo
+ * TimeSeriesStore.
+ */
+class SegmentRing {
+public:
+    SegmentRing(const char* directory, size_t record_size, uint16_t records_per_segment, uint16_t segment_count);
+
+    /**
+     * @brief Cria o diretório dos segmentos (o pai já deve existir)
+     */
+    bool begin(fs::FS* filesystem);
+
+    // ===== GRAVAÇÃO =====
+    /**
+     * @brief Anexa count registros consecutivos a partir de index
+     *
+     * Início de segmento recicla o arquivo. Segmento mais curto que a
+     * posição (índices pulados) é completado com zeros; mais longo
+     * (gravação interrompida antes de um reboot) é cortado na posição.
+     */
+    bool append(uint32_t index, const uint8_t* data, size_t count = 1);
+
+    /**
+     * @brief Apaga todos os segmentos
+     */
+    void clear();
+
+    // ===== LEITURA =====
+    /**
+     * @brief Lê o registro de um slot [0, capacidade) sem validar o conteúdo
+     *
+     * O segmento fica aberto para a leitura seguinte; endRead() fecha.
+     */
+    bool readSlot(uint32_t slot, uint8_t* out);
+    bool read(uint32_t index, uint8_t* out) { return readSlot(index % capacity(), out); }
+    void endRead();
+
+    /**
+     * @brief Menor índice ainda guardado depois de anexar newest
+     */
+    uint32_t oldestKept(uint32_t newest) const;
+
+    uint32_t capacity() const { return (uint32_t)per_segment * segments; }
+    uint16_t recordsPerSegment() const { return per_segment; }
+
+private:
+    const char* directory;
+    size_t record_size;
+    uint16_t per_segment;
+    uint16_t segments;
+
+    fs::FS* fs;
+    File reader;
+    int reader_segment;
+
+    void segmentPath(uint16_t segment, char* out) const;
+    File openAt(const char* path, uint16_t position);
+    bool truncate(const char* path, size_t length);
+};
+
+#endif // SEGMENT_RING_H
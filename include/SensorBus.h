@@ -0,0 +1,137 @@
+#ifndef SENSOR_BUS_H
+#define SENSOR_BUS_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Config.h"
+#include "SensorSampleStore.h"
+#include "SensorHealth.h"
+
+// ===== CONFIGURAÇÕES DO BARRAMENTO =====
+#define SENSOR_BUS_MAX_SUBSCRIBERS 8          // LCD, DecisionEngine, uploaders, web...
+#define SENSOR_CHANNEL_INVALID ((SensorChannel)-1)
+
+/**
+ * @brief Qualidade de uma leitura (bitmask; 0 = boa)
+ */
+enum SampleQuality : uint8_t {
+    SAMPLE_QUALITY_GOOD = 0,
+    SAMPLE_QUALITY_INVALID = 1 << 0,       // Driver marcou inválida ou fora da faixa do canal
+    SAMPLE_QUALITY_STALE = 1 << 1,         // Mais antiga que max_age_ms do canal
+    SAMPLE_QUALITY_DEGRADED = 1 << 2,      // SensorHealthMonitor não confia no sensor
+    SAMPLE_QUALITY_NO_DATA = 1 << 3        // Nada publicado ainda
+};
+
+/**
+ * @brief Descrição de um canal no registro
+ */
+struct SensorDescriptor {
+    const char* key;            // Nome usado em regras e JSON ("ph", "orp")
+    const char* label;          // Nome para exibição
+    const char* unit;           // "pH", "ppm", "°C", "mV"...
+    float min_value;            // Faixa física aceita
+    float max_value;
+    uint32_t max_age_ms;        // Acima disso a leitura é STALE
+    uint8_t decimals;           // Casas decimais para exibição
+    bool registered;
+};
+
+/**
+ * @brief Leitura entregue aos assinantes
+ */
+struct SensorReading {
+    SensorChannel channel;
+    const SensorDescriptor* descriptor;
+    float value;
+    uint32_t timestamp;         // millis() da publicação
+    uint32_t sequence;
+    uint8_t quality;            // SampleQuality
+
+    SensorReading() : channel(SENSOR_CHANNEL_INVALID), descriptor(nullptr), value(0.0),
+                      timestamp(0), sequence(0), quality(SAMPLE_QUALITY_NO_DATA) {}
+
+    bool isGood() const { return quality == SAMPLE_QUALITY_GOOD; }
+};
+
+/**
+ * @brief Registro de sensores e barramento de amostras
+ *
+ * O registro descreve cada canal (chave, unidade, faixa, validade); os
+ * canais fixos vêm pré-registrados e sensores novos (ORP, OD, vazão)
+ * ganham um id com registerChannel() e publicam com publish().
+ *
+ * As amostras continuam no SensorSampleStore (seqlock, escritor na task
+ * de sensores). dispatch() roda no loop principal: entrega a cada
+ * assinante apenas os canais do seu filtro que têm amostra nova ou cuja
+ * qualidade mudou (ex.: ficou STALE). Assim os callbacks nunca rodam na
+ * task de aquisição e ninguém precisa copiar e comparar valores.
+ */
+class SensorBus {
+public:
+    typedef std::function<void(const SensorReading& reading)> Subscriber;
+    typedef uint32_t ChannelMask;
+
+    SensorBus();
+
+    static ChannelMask maskOf(SensorChannel channel) { return 1UL << channel; }
+
+    // ===== REGISTRO =====
+    /**
+     * @brief Registra um canal novo
+     * @return Id do canal ou SENSOR_CHANNEL_INVALID se não houver espaço / chave repetida
+     */
+    SensorChannel registerChannel(const char* key, const char* label, const char* unit,
+                                  float min_value, float max_value, uint32_t max_age_ms,
+                                  uint8_t decimals = 2);
+    const SensorDescriptor* describe(SensorChannel channel) const;
+    SensorChannel findChannel(const String& key) const;
+
+    // ===== PUBLICAÇÃO =====
+    /**
+     * @brief Publica uma amostra (um único escritor por canal)
+     */
+    void publish(SensorChannel channel, float value, uint32_t timestamp);
+    SensorSampleStore& getStore() { return store; }
+    const SensorSampleStore& getStore() const { return store; }
+    void setHealthMonitor(const SensorHealthMonitor* monitor) { health = monitor; }
+
+    // ===== ASSINATURA =====
+    int subscribe(ChannelMask channels, Subscriber callback);
+    void unsubscribe(int subscription_id);
+
+    /**
+     * @brief Entrega as novidades aos assinantes (chamar do loop principal)
+     */
+    void dispatch(uint32_t now);
+
+    // ===== LEITURA DIRETA =====
+    bool read(SensorChannel channel, SensorReading& out, uint32_t now) const;
+    String getStatusJSON(uint32_t now) const;
+
+private:
+    struct Subscription {
+        ChannelMask channels;
+        Subscriber callback;
+        bool active;
+
+        Subscription() : channels(0), active(false) {}
+    };
+
+    SensorSampleStore store;
+    SensorDescriptor descriptors[SENSOR_MAX_CHANNELS];
+    uint8_t channel_count;
+    const SensorHealthMonitor* health;
+
+    Subscription subscribers[SENSOR_BUS_MAX_SUBSCRIBERS];
+    ChannelMask subscribed_channels;
+
+    // Última entrega por canal (sequência e qualidade)
+    uint32_t dispatched_sequence[SENSOR_MAX_CHANNELS];
+    uint8_t dispatched_quality[SENSOR_MAX_CHANNELS];
+
+    void registerBuiltin(SensorChannel channel, const char* key, const char* label, const char* unit,
+                         float min_value, float max_value, uint32_t max_age_ms, uint8_t decimals);
+    uint8_t evaluateQuality(SensorChannel channel, const SensorSample& sample, uint32_t now) const;
+};
+
+#endif // SENSOR_BUS_H
@@ -0,0 +1,172 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Config.h"
+#include "SensorSampleStore.h"
+#include "SignalFilters.h"
+#include "PHCalibration.h"
+
+// ===== CONFIGURAÇÕES DO MONITOR =====
+#define SENSOR_HEALTH_WINDOW 30               // Amostras na janela estatística
+#define SENSOR_HEALTH_INTERVAL_MS 1000        // Avaliação a cada 1s (cadência do pH)
+
+/**
+ * @brief Nível de saúde de um sensor
+ *
+ * A partir de DEGRADED as regras que dependem do sensor são bloqueadas.
+ */
+enum SensorHealthLevel : uint8_t {
+    SENSOR_HEALTH_OK = 0,
+    SENSOR_HEALTH_WARNING,       // Usável, mas precisa de atenção (calibração vencida, valor parado)
+    SENSOR_HEALTH_DEGRADED,      // Dados suspeitos (ruído, sem resposta, sonda gasta)
+    SENSOR_HEALTH_FAILED         // Sem dados úteis (inválido, sem publicação)
+};
+
+/**
+ * @brief Motivos de degradação (bitmask)
+ */
+enum SensorHealthFlag : uint16_t {
+    SENSOR_FLAG_STALE = 1 << 0,          // Sem amostra recente
+    SENSOR_FLAG_INVALID = 1 << 1,        // Última amostra fora da faixa física
+    SENSOR_FLAG_STUCK = 1 << 2,          // Valor constante por muito tempo (suspeita)
+    SENSOR_FLAG_NOISY = 1 << 3,          // Ruído acima do limite
+    SENSOR_FLAG_NO_RESPONSE = 1 << 4,    // Não reagiu às últimas dosagens
+    SENSOR_FLAG_SLOPE_DRIFT = 1 << 5,    // Inclinação da sonda abaixo do mínimo
+    SENSOR_FLAG_CAL_OVERDUE = 1 << 6     // Calibração antiga
+};
+
+/**
+ * @brief Estado de saúde de um canal monitorado
+ */
+struct SensorHealthStatus {
+    SensorHealthLevel level;
+    uint16_t flags;
+    float noise;                         // Desvio padrão estimado (unidade do sensor)
+    float median;                        // Mediana da janela
+    unsigned long last_response_ms;      // Tempo de resposta da última dose (0 = sem medida)
+    uint8_t response_failures;           // Doses seguidas sem resposta
+
+    SensorHealthStatus() : level(SENSOR_HEALTH_OK), flags(0), noise(0.0), median(0.0),
+                           last_response_ms(0), response_failures(0) {}
+};
+
+/**
+ * @brief Saúde e deriva das sondas de pH, TDS e temperatura
+ *
+ * Consome as amostras do SensorSampleStore e mantém, por canal, uma janela
+ * com mediana móvel e estimativa de ruído pelas diferenças sucessivas (não
+ * é afetada por tendências lentas, como a mudança após uma dosagem).
+ *
+ * Detecta:
+ * - valor parado (máx - mín da janela abaixo do limiar por tempo demais).
+ *   Só um aviso: depois da decimação e do IIR um tanque calmo também fica
+ *   assim. Parado e com uma dose sem resposta, o sensor é degradado;
+ * - ruído excessivo (com histerese para não oscilar);
+ * - falta de resposta: após cada dose a mediana precisa se afastar da
+ *   linha de base dentro do prazo; falhas seguidas degradam o sensor.
+ *   Degradado, o sensor bloqueia as doses que provariam a resposta; após
+ *   SENSOR_HEALTH_RESPONSE_RETRY_MS uma falha é perdoada e a próxima dose
+ *   serve de prova (sem resposta, volta a degradar). acknowledgeResponse()
+ *   zera as falhas na hora (sonda limpa ou trocada);
+ * - desgaste da sonda de pH pela inclinação da PHCalibration.
+ *
+ * O DecisionEngine consulta isUsable() e não executa regras cujas
+ * condições leiam um sensor degradado.
+ */
+class SensorHealthMonitor {
+public:
+    typedef std::function<void(SensorChannel channel, SensorHealthLevel level, const String& reason)> HealthChangeCallback;
+
+    SensorHealthMonitor();
+
+    // ===== CONTROLE =====
+    void setCalibration(const PHCalibration* calibration) { ph_calibration = calibration; }
+    void setHealthChangeCallback(HealthChangeCallback callback) { change_callback = callback; }
+
+    /**
+     * @brief Consome as amostras novas e reavalia os canais
+     */
+    void update(const SensorSampleStore& store, unsigned long now);
+
+    /**
+     * @brief Informa uma dosagem autorizada (inicia a janela de resposta)
+     */
+    void notifyDosing(int relay, unsigned long now);
+
+    /**
+     * @brief Reconhecimento manual: zera as falhas de resposta do canal
+     *
+     * Pode ser chamado da task do AsyncTCP; aplicado no próximo update().
+     * SENSOR_CHANNEL_COUNT = todos os canais.
+     */
+    void acknowledgeResponse(SensorChannel channel);
+
+    // ===== CONSULTA =====
+    const SensorHealthStatus& getStatus(SensorChannel channel) const;
+    bool isUsable(SensorChannel channel) const;
+    bool isUsable(const String& sensor_name) const;
+    bool hasFailure() const;
+
+    // ===== STATUS =====
+    String getStatusJSON() const;
+    void printStatus() const;
+
+    static const char* levelToString(SensorHealthLevel level);
+    static const char* channelName(SensorChannel id);   // Nome usado nas regras ("ph", "tds"...)
+
+private:
+    /**
+     * @brief Limiares por canal
+     */
+    struct Limits {
+        float noise_max;             // Desvio padrão máximo
+        float stuck_epsilon;         // Variação mínima esperada na janela (0 = não verificar)
+        float min_response;          // Variação esperada após dose (0 = não verificar)
+    };
+
+    struct Channel {
+        SensorChannel id;
+        Limits limits;
+        SensorHealthStatus status;
+        SignalFilters::RunningMedian<float, SENSOR_HEALTH_WINDOW> window;
+
+        // Diferenças sucessivas para o ruído
+        float last_value;
+        float diff_sq[SENSOR_HEALTH_WINDOW];
+        uint8_t diff_head;
+        uint8_t diff_count;
+        float diff_sum;
+
+        uint32_t last_sequence;
+        unsigned long stuck_since;   // 0 = variando
+
+        // Janela de resposta à dosagem
+        bool response_pending;
+        float response_baseline;
+        unsigned long dose_time;
+        unsigned long last_failure;          // Última dose sem resposta (prazo da dose de prova)
+        volatile bool acknowledge_requested; // Reconhecimento vindo da web
+
+        Channel() : id(SENSOR_PH), last_value(0.0), diff_head(0), diff_count(0), diff_sum(0.0),
+                    last_sequence(0), stuck_since(0), response_pending(false),
+                    response_baseline(0.0), dose_time(0), last_failure(0),
+                    acknowledge_requested(false) {}
+    };
+
+    static const uint8_t CHANNEL_COUNT = 3;
+    Channel channels[CHANNEL_COUNT];
+    const PHCalibration* ph_calibration;
+    HealthChangeCallback change_callback;
+    unsigned long last_update;
+
+    Channel* findChannel(SensorChannel id);
+    const Channel* findChannel(SensorChannel id) const;
+    void addSample(Channel& channel, float value, unsigned long now);
+    void evaluate(Channel& channel, const SensorSample& sample, unsigned long now);
+    void checkResponse(Channel& channel, unsigned long now);
+    String describeFlags(uint16_t flags) const;
+};
+
+#endif // SENSOR_HEALTH_H
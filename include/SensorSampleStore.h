@@ -0,0 +1,65 @@
+#ifndef SENSOR_SAMPLE_STORE_H
+#define SENSOR_SAMPLE_STORE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Canais publicados pela task de aquisição de sensores
+ */
+enum SensorChannel {
+    SENSOR_WATER_TEMP = 0,   // DS18B20 (°C)
+    SENSOR_PH,               // pH
+    SENSOR_TDS,              // ppm
+    SENSOR_EC,               // µS/cm
+    SENSOR_WATER_LEVEL,      // 1 = OK, 0 = baixo/erro
+    SENSOR_PH_VOLTAGE,       // Tensão do eletrodo de pH (V), usada na calibração
+    SENSOR_CHANNEL_COUNT,    // Canais fixos; os seguintes são registrados no SensorBus
+    SENSOR_MAX_CHANNELS = 16 // Fixos + registrados em execução (ORP, OD, vazão...)
+};
+
+/**
+ * @brief Amostra com timestamp (millis) e indicador de validade
+ */
+struct SensorSample {
+    float value;
+    uint32_t timestamp;
+    uint32_t sequence;       // Incrementa a cada publicação
+    bool valid;
+
+    SensorSample() : value(0.0), timestamp(0), sequence(0), valid(false) {}
+};
+
+/**
+ * @brief Armazena o último valor de cada canal sem locks
+ *
+ * Um único escritor por canal (task de sensores ou o driver de um canal
+ * registrado no SensorBus) e vários leitores (loop principal,
+ * DecisionEngine, servidores web). Cada canal usa um seqlock: o escritor
+ * deixa o contador ímpar durante a escrita e o leitor repete a cópia se o
+ * contador mudou ou estava ímpar. O escritor nunca espera pelos leitores.
+ */
+class SensorSampleStore {
+public:
+    SensorSampleStore();
+
+    // ===== ESCRITA (apenas o escritor do canal) =====
+    void publish(SensorChannel channel, float value, bool valid, uint32_t timestamp);
+
+    // ===== LEITURA (qualquer task) =====
+    bool read(SensorChannel channel, SensorSample& out) const;
+    float getValue(SensorChannel channel, float fallback = 0.0) const;
+    bool isFresh(SensorChannel channel, uint32_t max_age_ms, uint32_t now) const;
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        SensorSample sample;
+
+        Slot() : seq(0) {}
+    };
+
+    Slot slots[SENSOR_MAX_CHANNELS];
+};
+
+#endif // SENSOR_SAMPLE_STORE_H
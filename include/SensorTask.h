@@ -0,0 +1,103 @@
+#ifndef SENSOR_TASK_H
+#define SENSOR_TASK_H
+
+#include <Arduino.h>
+#include <DallasTemperature.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Config.h"
+#include "PHSensor.h"
+#include "TDSReaderSerial.h"
+#include "LevelSensor.h"
+#include "SensorSampleStore.h"
+#include "AdcDmaSampler.h"
+
+// ===== CONFIGURAÇÕES DA TASK =====
+#define SENSOR_TASK_CORE 0                    // Core 0 (loop do Arduino roda no core 1)
+#define SENSOR_TASK_STACK_SIZE 4096           // Stack size
+#define SENSOR_TASK_PRIORITY 2                // Abaixo da task ESP-NOW
+#define SENSOR_TASK_TICK_MS 10                // Passo das máquinas de estado
+
+// ===== CONFIGURAÇÕES DE TIMING =====
+#define SENSOR_TEMP_INTERVAL_MS 2000          // Nova conversão DS18B20 a cada 2s
+#define SENSOR_TEMP_TIMEOUT_MS 1000           // Conversão 12 bits leva ~750ms
+#define SENSOR_PH_INTERVAL_MS 1000            // Novo lote de amostras de pH a cada 1s
+#define SENSOR_TDS_INTERVAL_MS 800            // Novo valor de TDS (ADC DMA) a cada 800ms
+#define SENSOR_LEVEL_INTERVAL_MS 1000         // Sensor de nível a cada 1s
+
+/**
+ * @brief Aquisição de sensores fora do loop principal
+ *
+ * Cada sensor é uma máquina de estados que nunca bloqueia: o DS18B20
+ * inicia a conversão e é lido só quando ela termina, o pH coleta uma
+ * amostra por passo e o TDS continua com a sua própria temporização.
+ * Os resultados vão para o SensorSampleStore do SensorBus, que os
+ * distribui aos assinantes no loop principal.
+ *
+ * Com o AdcDmaSampler ativo, pH e TDS vêm dos filtros de decimação do
+ * ADC contínuo e os caminhos com analogRead ficam desativados.
+ *
+ * Se a task não puder ser criada, step() pode ser chamado do loop.
+ */
+class SensorTask {
+public:
+    explicit SensorTask(SensorSampleStore& store);
+    ~SensorTask();
+
+    // ===== INICIALIZAÇÃO =====
+    bool begin(DallasTemperature* temp, phSensor* ph, TDSReaderSerial* tds, LevelSensor* level,
+               AdcDmaSampler* adc = nullptr);
+    void end();
+    bool isRunning() const { return taskHandle != nullptr; }
+    bool isUsingAdcDma() const { return adcSampler && adcSampler->isRunning(); }
+
+    /**
+     * @brief Avança todas as máquinas de estado (não bloqueante)
+     */
+    void step(unsigned long now);
+
+    // ===== TASK MANAGEMENT =====
+    static void taskFunction(void* parameter);
+
+private:
+    enum TempState {
+        TEMP_IDLE,
+        TEMP_CONVERTING
+    };
+
+    enum PHState {
+        PH_IDLE,
+        PH_SAMPLING
+    };
+
+    // ===== VARIÁVEIS DA TASK =====
+    TaskHandle_t taskHandle;
+    SensorSampleStore& store;
+
+    // ===== SENSORES =====
+    DallasTemperature* tempSensor;
+    phSensor* pHSensor;
+    TDSReaderSerial* tdsSensor;
+    LevelSensor* levelSensor;
+    AdcDmaSampler* adcSampler;
+
+    // ===== MÁQUINAS DE ESTADO =====
+    TempState tempState;
+    unsigned long tempRequestTime;
+    unsigned long lastTempCycle;
+    float lastWaterTemp;
+
+    PHState phState;
+    unsigned long lastPHSample;
+    unsigned long lastPHCycle;
+    unsigned long lastTDSCycle;
+
+    unsigned long lastLevelCheck;
+
+    void stepTemperature(unsigned long now);
+    void stepPH(unsigned long now);
+    void stepTDS(unsigned long now);
+    void stepLevel(unsigned long now);
+};
+
+#endif // SENSOR_TASK_H
@@ -0,0 +1,233 @@
+#ifndef SIGNAL_FILTERS_H
+#define SIGNAL_FILTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @brief Filtros de sinal compartilhados pelos drivers de sensores
+ *
+ * Tudo em tempo linear (ou O(N) por amostra nos filtros de janela), sem
+ * alocação dinâmica e sem dependência do Arduino: o tamanho das janelas
+ * é parâmetro de template e o mesmo código compila no host.
+ */
+namespace SignalFilters {
+
+// ===== SELEÇÃO =====
+
+/**
+ * @brief Quickselect: coloca em data[k] o k-ésimo menor valor de [lo, hi)
+ *
+ * Ao final, data[lo..k) <= data[k] <= data(k..hi). Altera a ordem do array.
+ * Pivô pela mediana de 3 para evitar o pior caso em dados já ordenados.
+ * Partição em três faixas (bandeira holandesa): leituras quantizadas do
+ * ADC repetem muito o mesmo valor, e com a faixa dos iguais ao pivô o
+ * laço termina assim que k cai nela, em vez de degradar para O(n^2).
+ */
+template <typename T>
+void select(T* data, size_t lo, size_t hi, size_t k) {
+    while (hi - lo > 1) {
+        // Mediana de 3 (só o valor; a partição posiciona)
+        T a = data[lo], b = data[lo + (hi - lo) / 2], c = data[hi - 1];
+        if (b < a) { T t = a; a = b; b = t; }
+        if (c < b) { b = c; }
+        T pivot = (b < a) ? a : b;
+
+        // [lo, lt) < pivô, [lt, gt) == pivô, [gt, hi) > pivô
+        size_t lt = lo, i = lo, gt = hi;
+        while (i < gt) {
+            if (data[i] < pivot) {
+                T t = data[i]; data[i] = data[lt]; data[lt] = t;
+                lt++;
+                i++;
+            } else if (pivot < data[i]) {
+                gt--;
+                T t = data[i]; data[i] = data[gt]; data[gt] = t;
+            } else {
+                i++;
+            }
+        }
+
+        if (k < lt) {
+            hi = lt;
+        } else if (k >= gt) {
+            lo = gt;
+        } else {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Mediana em O(n) (altera a ordem do array)
+ */
+template <typename T>
+float median(T* data, size_t n) {
+    if (n == 0) return 0.0f;
+
+    size_t upper = n / 2;
+    select(data, 0, n, upper);
+    if (n & 1) {
+        return (float)data[upper];
+    }
+
+    // n par: o maior da metade inferior completa o par central
+    T lower = data[0];
+    for (size_t i = 1; i < upper; i++) {
+        if (lower < data[i]) lower = data[i];
+    }
+    return ((float)lower + (float)data[upper]) / 2.0f;
+}
+
+/**
+ * @brief Mediana sem alterar a entrada (copia para 'scratch')
+ */
+template <typename T>
+float medianCopy(const T* data, T* scratch, size_t n) {
+    memcpy(scratch, data, n * sizeof(T));
+    return median(scratch, n);
+}
+
+/**
+ * @brief Média descartando 'trim' valores em cada extremo, em O(n)
+ *
+ * Duas seleções isolam os extremos; a ordem dentro do miolo não importa
+ * para a soma. Altera a ordem do array.
+ */
+template <typename T>
+float trimmedMean(T* data, size_t n, size_t trim) {
+    if (n == 0) return 0.0f;
+    if (2 * trim >= n) return median(data, n);
+
+    if (trim > 0) {
+        select(data, 0, n, trim);              // 'trim' menores à esquerda
+        select(data, trim, n, n - trim - 1);   // 'trim' maiores à direita
+    }
+
+    float sum = 0.0f;
+    for (size_t i = trim; i < n - trim; i++) {
+        sum += (float)data[i];
+    }
+    return sum / (float)(n - 2 * trim);
+}
+
+// ===== FILTROS DE JANELA =====
+
+/**
+ * @brief Mediana móvel sobre as últimas N amostras
+ *
+ * Mantém a janela ordenada: cada push remove a amostra mais antiga e
+ * insere a nova por busca binária + deslocamento, O(N) sem alocação.
+ */
+template <typename T, size_t N>
+class RunningMedian {
+public:
+    RunningMedian() : count(0), head(0) {}
+
+    void push(T value) {
+        if (count == N) {
+            // Remover a amostra mais antiga da janela ordenada
+            T oldest = ring[head];
+            size_t pos = lowerBound(oldest);
+            memmove(&sorted[pos], &sorted[pos + 1], (count - pos - 1) * sizeof(T));
+            count--;
+        }
+
+        ring[head] = value;
+        head = (head + 1) % N;
+
+        size_t pos = lowerBound(value);
+        memmove(&sorted[pos + 1], &sorted[pos], (count - pos) * sizeof(T));
+        sorted[pos] = value;
+        count++;
+    }
+
+    float get() const {
+        if (count == 0) return 0.0f;
+        if (count & 1) return (float)sorted[count / 2];
+        return ((float)sorted[count / 2 - 1] + (float)sorted[count / 2]) / 2.0f;
+    }
+
+    T sortedAt(size_t i) const { return sorted[i]; }   // i-ésimo menor da janela
+    T getMin() const { return count ? sorted[0] : T(); }
+    T getMax() const { return count ? sorted[count - 1] : T(); }
+    size_t size() const { return count; }
+    bool isFull() const { return count == N; }
+    void reset() { count = 0; head = 0; }
+
+private:
+    T ring[N];      // Ordem de chegada
+    T sorted[N];    // Mesmos valores, ordenados
+    size_t count;
+    size_t head;
+
+    size_t lowerBound(T value) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (sorted[mid] < value) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+};
+
+/**
+ * @brief Filtro de Hampel causal (rejeição de outliers)
+ *
+ * Compara cada amostra nova com a mediana das últimas N; se o desvio
+ * passar de k * 1.4826 * MAD a amostra é trocada pela mediana.
+ * 1.4826 torna o MAD comparável ao desvio padrão para ruído gaussiano.
+ * Em sinais quantizados (ADC) o MAD pode ser zero; 'min_deviation' define
+ * o menor desvio absoluto tratado como outlier.
+ */
+template <typename T, size_t N>
+class HampelFilter {
+public:
+    explicit HampelFilter(float k = 3.0f, float min_deviation = 0.0f) :
+        threshold(k), min_deviation(min_deviation), outliers(0) {}
+
+    /**
+     * @brief Filtra uma amostra
+     * @return Amostra original ou mediana da janela, se for outlier
+     */
+    float filter(T value) {
+        float result = (float)value;
+
+        if (window.size() >= 3) {
+            float med = window.get();
+            float limit = threshold * 1.4826f * medianAbsoluteDeviation(med);
+            if (limit < min_deviation) limit = min_deviation;
+            if (fabsf(result - med) > limit) {
+                result = med;
+                outliers++;
+            }
+        }
+
+        window.push(value);
+        return result;
+    }
+
+    uint32_t getOutlierCount() const { return outliers; }
+    void reset() { window.reset(); outliers = 0; }
+
+private:
+    RunningMedian<T, N> window;
+    float threshold;
+    float min_deviation;
+    uint32_t outliers;
+    float deviations[N];
+
+    float medianAbsoluteDeviation(float med) {
+        size_t n = window.size();
+        for (size_t i = 0; i < n; i++) {
+            deviations[i] = fabsf((float)window.sortedAt(i) - med);
+        }
+        return median(deviations, n);
+    }
+};
+
+} // namespace SignalFilters
+
+#endif // SIGNAL_FILTERS_H
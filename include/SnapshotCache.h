@@ -0,0 +1,112 @@
+#ifndef SNAPSHOT_CACHE_H
+#define SNAPSHOT_CACHE_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include <memory>
+
+// ===== CONFIGURAÇÕES DO CACHE =====
+#define SNAPSHOT_MAX_TOPICS 12
+#define SNAPSHOT_INVALID_TOPIC -1
+
+/**
+ * @brief Snapshot serializado, compartilhado por referência (refcount)
+ */
+typedef std::shared_ptr<const String> SnapshotBuffer;
+
+/**
+ * @brief Serializa o estado atual do tópico em out
+ */
+typedef std::function<void(String& out)> SnapshotBuilder;
+
+/**
+ * @brief Versão do estado de origem (muda quando o estado muda)
+ */
+typedef std::function<uint32_t()> SnapshotVersion;
+
+/**
+ * @brief Cache de snapshots versionados para HTTP e WebSocket
+ *
+ * Cada tópico (ex.: /api/sensors) é serializado uma única vez por
+ * geração e o mesmo buffer atende todas as requisições até o estado
+ * mudar. A geração avança quando:
+ * - invalidate() é chamado pelo dono do estado
+ * - a função de versão do tópico retorna outro valor
+ * - max_age_ms expira (campos como uptime e heap livre)
+ *
+ * As respostas HTTP seguram o buffer por shared_ptr enquanto enviam,
+ * então uma reconstrução no meio do envio não corrompe a resposta.
+ * ETag = geração: cliente com If-None-Match igual recebe 304 sem corpo.
+ * As rotas precisam ser registradas por attach() (CachedRequestHandler):
+ * com server->on() o ESPAsyncWebServer descarta o If-None-Match.
+ */
+class SnapshotCache {
+public:
+    SnapshotCache();
+    ~SnapshotCache();
+
+    // ===== TÓPICOS =====
+    /**
+     * @return ID do tópico, ou SNAPSHOT_INVALID_TOPIC se não houver espaço
+     */
+    int8_t registerTopic(const char* name, SnapshotBuilder builder,
+                         SnapshotVersion version = nullptr, uint32_t max_age_ms = 0);
+    void invalidate(int8_t topic);
+    void invalidateAll();
+
+    // ===== LEITURA =====
+    /**
+     * @brief Snapshot da geração atual (construído apenas se mudou)
+     */
+    SnapshotBuffer get(int8_t topic);
+    uint32_t getGeneration(int8_t topic);
+
+    /**
+     * @brief Responde a requisição com o snapshot (ou 304 pelo ETag)
+     */
+    void send(AsyncWebServerRequest* request, int8_t topic, const char* content_type = "application/json");
+
+    /**
+     * @brief Registra GET uri -> send(topic), preservando o If-None-Match
+     */
+    void attach(AsyncWebServer* server, const char* uri, int8_t topic);
+
+    /**
+     * @brief Registra GET uri com handler próprio (que termina em send())
+     */
+    void attach(AsyncWebServer* server, const char* uri, ArRequestHandlerFunction handler);
+
+    // ===== STATUS =====
+    String getStatusJSON();
+
+private:
+    struct Topic {
+        const char* name;
+        SnapshotBuilder builder;
+        SnapshotVersion version;
+        uint32_t max_age_ms;
+        uint32_t generation;        // Avança a cada mudança de estado
+        uint32_t built_generation;  // Geração do buffer atual
+        uint32_t source_version;    // Último valor de version()
+        unsigned long built_at;
+        SnapshotBuffer buffer;
+        uint32_t hits;
+        uint32_t builds;
+        uint32_t not_modified;
+    };
+
+    Topic topics[SNAPSHOT_MAX_TOPICS];
+    uint8_t topic_count;
+    SemaphoreHandle_t mutex;
+    uint16_t boot_salt;
+
+    bool valid(int8_t topic) const { return topic >= 0 && topic < topic_count; }
+    void refresh(Topic& entry);
+    void lock();
+    void unlock();
+};
+
+#endif // SNAPSHOT_CACHE_H
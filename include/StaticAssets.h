@@ -0,0 +1,90 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <SPIFFS.h>
+#include "CachedRequestHandler.h"
+
+// ===== CONFIGURAÇÕES DOS ASSETS =====
+#define ASSET_MANIFEST_PATH "/assets.idx"   // Gerado por scripts/build_assets.py
+#define ASSET_MAX_ENTRIES 16
+#define ASSET_PATH_SIZE 32                  // Limite de nome do SPIFFS
+#define ASSET_HASH_SIZE 17                  // 16 hex + '\0'
+#define ASSET_CACHE_CONTROL "public, max-age=604800"   // 7 dias para CSS/JS/JSON
+
+/**
+ * @brief Serve arquivos do SPIFFS comprimidos e com validação de cache
+ *
+ * O build do filesystem (scripts/build_assets.py) grava ao lado de cada
+ * arquivo de texto uma variante .gz e um manifesto com o hash SHA-256
+ * do conteúdo original. Com isso cada resposta:
+ * - usa o .gz (Content-Encoding: gzip) quando o cliente aceita
+ * - leva ETag forte derivado do hash (diferente para raw e gzip)
+ * - responde 304 sem corpo quando If-None-Match ainda vale
+ *
+ * HTML é sempre revalidado (no-cache): as URLs não carregam o hash,
+ * então só o ETag garante que uma página nova seja vista após o upload.
+ * Sem manifesto (filesystem gravado sem o script) o arquivo é servido
+ * como antes, sem ETag.
+ *
+ * As rotas precisam passar por attach() (CachedRequestHandler): com
+ * server->on() o 1.2.x descarta Accept-Encoding e If-None-Match.
+ */
+class StaticAssets {
+public:
+    StaticAssets();
+
+    /**
+     * @brief Carrega o manifesto do SPIFFS (SPIFFS já montado)
+     * @return true se o manifesto foi encontrado
+     */
+    bool begin();
+
+    /**
+     * @brief Responde com o arquivo (gzip/304 quando possível)
+     * @return false se o arquivo não existe (o chamador decide o fallback)
+     */
+    bool serve(AsyncWebServerRequest* request, const char* path, const char* content_type = nullptr);
+
+    /**
+     * @brief Registra GET uri -> serve(path)
+     */
+    void attach(AsyncWebServer* server, const char* uri, const char* path);
+
+    /**
+     * @brief Registra GET uri com handler próprio que chama serve()
+     *        (para rotas com fallback ou limite de conexões)
+     */
+    void attach(AsyncWebServer* server, const char* uri, ArRequestHandlerFunction handler);
+
+    /**
+     * @brief serveStatic do restante do SPIFFS, sem expor o manifesto
+     *        (registrar depois das rotas de attach())
+     */
+    void attachFallback(AsyncWebServer* server);
+
+    // ===== STATUS =====
+    uint8_t getEntryCount() const { return entry_count; }
+    String getStatusJSON() const;
+
+private:
+    struct Entry {
+        char path[ASSET_PATH_SIZE];
+        char hash[ASSET_HASH_SIZE];
+        bool gzip;
+    };
+
+    Entry entries[ASSET_MAX_ENTRIES];
+    uint8_t entry_count;
+    uint32_t served_gzip;
+    uint32_t served_raw;
+    uint32_t not_modified;
+
+    const Entry* find(const char* path) const;
+    static const char* contentTypeFor(const char* path);
+    static bool isHTML(const char* path);
+    static bool acceptsGzip(AsyncWebServerRequest* request);
+};
+
+#endif // STATIC_ASSETS_H
@@ -0,0 +1,84 @@
+#ifndef SUPABASE_BATCH_UPLOADER_H
+#define SUPABASE_BATCH_UPLOADER_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "TelemetryQueue.h"
+
+// ===== CONFIGURAÇÕES DO LOTE =====
+#define SUPABASE_BATCH_MAX_ROWS 30            // Teto do lote por tabela (RAM)
+
+/**
+ * @brief Acumula leituras e envia em lote para o Supabase
+ *
+ * Cada tabela tem um lote em RAM; ao atingir o tamanho configurado ou o
+ * intervalo máximo, as linhas vão num único POST com array JSON (bulk
+ * insert do PostgREST), em vez de um POST com handshake TLS por leitura.
+ * Cada linha leva created_at da captura, então o atraso do lote não
+ * altera o histórico.
+ *
+ * O envio é injetado (setSender, o mesmo Sender da TelemetryQueue); sem
+ * ele os lotes vão direto para a fila. Se o envio falhar ou a nuvem
+ * estiver fora, o lote vai para a
+ * TelemetryQueue (flash) e é reenviado por ela quando a conexão voltar.
+ * Enquanto a fila tiver atraso, lotes novos também entram nela (atrás
+ * dos antigos), para o banco receber as leituras na ordem da captura.
+ */
+class SupabaseBatchUploader {
+public:
+    typedef TelemetryQueue::Sender Sender;
+
+    explicit SupabaseBatchUploader(TelemetryQueue& queue);
+
+    // ===== CONTROLE =====
+    /**
+     * @brief Acrescenta uma leitura ao lote da tabela
+     * @param online Estado atual da nuvem (usado se o lote cheio for enviado agora)
+     */
+    void add(TelemetryTable table, const char* payload, bool online);
+    void loop(bool online);
+
+    /**
+     * @brief Envia (ou guarda na fila) tudo o que estiver pendente
+     */
+    void flush(bool online);
+    void setSender(Sender callback) { sender = callback; }
+
+    // ===== CONFIGURAÇÃO =====
+    void setBatchSize(uint8_t rows);
+    void setFlushInterval(unsigned long interval_ms) { flush_interval = interval_ms; }
+
+    // ===== STATUS =====
+    uint16_t pending() const;
+    String getStatusJSON() const;
+
+private:
+    struct PendingRow {
+        char payload[TELEMETRY_PAYLOAD_SIZE]; // Campos da leitura (sem device_id)
+        uint32_t epoch;
+        uint32_t captured_ms;
+    };
+
+    struct Batch {
+        PendingRow rows[SUPABASE_BATCH_MAX_ROWS];
+        uint8_t count;
+        unsigned long first_ms;     // millis() da linha mais antiga
+    };
+
+    Sender sender;
+    TelemetryQueue& queue;
+    Batch batches[TELEMETRY_TABLE_COUNT];
+    char body[SUPABASE_BATCH_MAX_ROWS * TELEMETRY_ROW_SIZE + 2]; // Array JSON do POST
+
+    uint8_t batch_size;
+    unsigned long flush_interval;
+
+    // Estatísticas
+    uint32_t requests;
+    uint32_t rows_sent;
+    uint32_t rows_queued;
+
+    void flushTable(TelemetryTable table, bool online);
+};
+
+#endif // SUPABASE_BATCH_UPLOADER_H
@@ -7,6 +7,11 @@
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include "Config.h"
+#include "CloudConnectionPool.h"
+
+// ===== BUFFERS FIXOS =====
+#define SUPABASE_PAYLOAD_BUFFER_SIZE 768      // Maior payload: status do dispositivo
+#define SUPABASE_URL_BUFFER_SIZE 256
 
 struct EnvironmentReading {
     float temperature;
@@ -45,15 +50,32 @@ struct DeviceStatusData {
 
 class SupabaseClient {
 private:
-    HTTPClient http;
     String baseUrl;
     String apiKey;
+    String restUrl;            // baseUrl + "/rest/v1/"
+    String authHeader;         // "Bearer <key>" montado uma vez no begin()
+    String deviceId;
     bool isConnected;
     unsigned long lastCommandCheck;
     
+    // Buffers reutilizados em toda requisição (sem String por envio)
+    char payloadBuffer[SUPABASE_PAYLOAD_BUFFER_SIZE];
+    char urlBuffer[SUPABASE_URL_BUFFER_SIZE];
+    
+    // Blocos de cabeçalhos pré-montados
+    CloudHeader insertHeaders[4];   // Authorization, apikey, Content-Type, Prefer padrão
+    CloudHeader upsertHeaders[4];   // ... Prefer: resolution=merge-duplicates
+    CloudHeader readHeaders[3];     // Authorization, apikey, Accept
+    CloudHeader patchHeaders[3];    // Authorization, apikey, Content-Type
+    
     String buildAuthHeader();
-    bool makeRequest(const String& method, const String& endpoint, const String& payload = "");
-    String buildRelayStatePayload(bool* relayStates, int numRelays);
+    void buildHeaderBlocks();
+    const char* currentDeviceId();
+    bool makeRequest(const char* method, const char* endpoint, const char* payload, size_t length);
+    int sendRequest(const char* method, const char* endpoint, const char* body, size_t length,
+                    const CloudHeader* headers, uint8_t count, String* response = nullptr);
+    bool patchCommand(int commandId, const char* payload, size_t length);
+    static size_t serializePayload(const JsonDocument& doc, char* out, size_t size);
 
 public:
     SupabaseClient();
@@ -67,14 +89,22 @@ public:
     bool sendHydroData(const HydroReading& reading);
     bool updateDeviceStatus(const DeviceStatusData& status);
     
-    // Método genérico para inserir dados
+    // Método genérico para inserir dados (array JSON = bulk insert)
     bool insert(const String& table, const String& jsonData);
+    bool insert(const char* table, const char* rows, size_t length);
+    
+    // Payloads das leituras escritos em out (sem device_id para a fila de telemetria)
+    // Retornam o tamanho escrito, ou 0 se não couber
+    size_t buildEnvironmentPayload(const EnvironmentReading& reading, char* out, size_t size, bool withDeviceId = true);
+    size_t buildHydroPayload(const HydroReading& reading, char* out, size_t size, bool withDeviceId = true);
     
     // Receber comandos de Supabase
     bool checkForCommands(RelayCommand* commands, int maxCommands, int& commandCount);
     bool markCommandSent(int commandId);
     bool markCommandCompleted(int commandId);
     bool markCommandFailed(int commandId, const String& errorMessage);
+    // Mesma transição para vários comandos num único PATCH (id=in.(...))
+    bool markCommands(const int* commandIds, uint8_t count, const char* status, const char* errorMessage = nullptr);
     
     // Utilitários
     bool testConnection();
@@ -83,9 +113,7 @@ public:
 private:
     String lastError;
     void setError(const String& error);
-    String buildEnvironmentPayload(const EnvironmentReading& reading);
-    String buildHydroPayload(const HydroReading& reading);
-    String buildDeviceStatusPayload(const DeviceStatusData& status);
+    size_t buildDeviceStatusPayload(const DeviceStatusData& status, char* out, size_t size);
     
 public:
     // ===== AUTO-REGISTRO =====
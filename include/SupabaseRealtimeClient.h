@@ -16,8 +16,8 @@ enum SupabaseWebSocketState {
     SUPABASE_WS_ERROR
 };
 
-// Callback para comandos recebidos
-typedef std::function<void(int relayNumber, String action, int duration)> CommandCallback;
+// Callback para comandos recebidos (commandId = id em relay_commands, 0 se ausente)
+typedef std::function<void(int commandId, int relayNumber, String action, int duration)> CommandCallback;
 typedef std::function<void(String message)> ErrorCallback;
 
 class SupabaseRealtimeClient {
@@ -76,6 +76,7 @@ public:
     // Comunicação
     bool sendDeviceStatus(const String& status);
     bool sendHeartbeatPing();
+    bool sendCommandAck(int commandId, const char* status);
     
     // Diagnóstico
     void printConnectionInfo() const;
@@ -7,7 +7,8 @@ class TDSReaderSerial {
 public:
     TDSReaderSerial(uint8_t pin, float vref, float calibrationFactor); //construtor
     void begin();
-    void readTDS();
+    bool readTDS(); // true quando um novo valor foi calculado
+    bool readTDSFromRaw(float raw); // Contagens já filtradas (ADC DMA)
     void updateTemperature(float temp); // Atualiza a temperatura lida externamente
     float getTDSValue(); //obter o valor do TDS
     float getECValue(); //obter o valor do EC
@@ -25,6 +26,7 @@ private:
     int _analogBufferIndex; //índice do buffer
 
     float calculateMedian(int *bArray, int iFilterLen); //calcular a mediana
+    void computeTDS(); //calcular TDS a partir de _averageVoltage
 };
 
 #endif  
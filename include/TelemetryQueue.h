@@ -0,0 +1,157 @@
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <functional>
+#include "Config.h"
+#include "SegmentRing.h"
+
+// ===== CONFIGURAÇÕES DA FILA DE TELEMETRIA =====
+#define TELEMETRY_RECORD_SIZE 128             // Registro fixo na flash
+#define TELEMETRY_PAYLOAD_SIZE (TELEMETRY_RECORD_SIZE - 20)
+#define TELEMETRY_ROW_SIZE 192                // Payload + device_id + created_at
+#define TELEMETRY_BODY_SIZE (TELEMETRY_DRAIN_BATCH * TELEMETRY_ROW_SIZE + 2)
+#define TELEMETRY_QUEUE_SEGMENTS 32           // Arquivos de segmento do anel
+#define TELEMETRY_QUEUE_SEGMENT_RECORDS 64    // 8KB por segmento
+#define TELEMETRY_QUEUE_CAPACITY (TELEMETRY_QUEUE_SEGMENTS * TELEMETRY_QUEUE_SEGMENT_RECORDS) // 256KB: ~8h a cada 30s
+#define TELEMETRY_DRAIN_BATCH 30              // Registros por rodada (um POST em lote por tabela)
+#define TELEMETRY_DRAIN_INTERVAL_MS 2000      // Intervalo entre rodadas com a nuvem OK
+#define TELEMETRY_BACKOFF_MAX_MS 300000       // Backoff máximo após falhas (5 min)
+#define TELEMETRY_QUEUE_DIRECTORY "/tq"
+#define TELEMETRY_QUEUE_LEGACY_PATH "/tq/queue.bin"   // Anel antigo, regravado no lugar
+
+/**
+ * @brief Tabelas de destino dos registros
+ */
+enum TelemetryTable : uint8_t {
+    TELEMETRY_ENVIRONMENT = 0,
+    TELEMETRY_HYDRO,
+    TELEMETRY_TABLE_COUNT
+};
+
+/**
+ * @brief Fila persistente de telemetria (store-and-forward)
+ *
+ * Leituras que não puderam ir para o Supabase (WiFi caído, nuvem fora,
+ * heap insuficiente para TLS) ficam num anel de registros fixos em
+ * LittleFS e são reenviadas em lotes quando a conexão volta, na ordem
+ * em que foram capturadas. Cada rodada agrupa os registros por tabela e
+ * envia um único POST com um array por tabela.
+ *
+ * - O anel é um SegmentRing: cada enqueue só anexa 128 bytes ao segmento
+ *   corrente, sem regravar o resto da fila na flash
+ * - Cheia, a fila descarta o segmento mais antigo (os recentes valem mais)
+ * - O ponto de confirmação fica na NVS: entrega ao menos uma vez
+ * - Após falha o envio recua exponencialmente até TELEMETRY_BACKOFF_MAX_MS
+ * - Cada registro guarda a hora da captura; com o relógio NTP sincronizado
+ *   o envio inclui created_at, então o histórico no banco não fica com a
+ *   hora da reconexão
+ * - O anel fica na partição "history" (HistoryFS); sem ela begin() falha,
+ *   enqueue() recusa e conta as leituras perdidas em "rejected"
+ */
+class TelemetryQueue {
+public:
+    /**
+     * @brief Envia um array JSON de linhas para uma tabela (bulk insert)
+     */
+    typedef std::function<bool(const char* table, const char* rows, size_t length)> Sender;
+
+    TelemetryQueue();
+
+    // ===== CONTROLE =====
+    bool begin(fs::FS& filesystem = LittleFS);
+
+    /**
+     * @brief Esvazia a fila em lotes (chamar do loop principal)
+     * @param online Nuvem alcançável e heap suficiente para HTTPS
+     */
+    void loop(bool online);
+    void setSender(Sender callback) { sender = callback; }
+
+    // ===== ENFILEIRAMENTO =====
+    /**
+     * @brief Guarda um objeto JSON para envio posterior
+     *
+     * O payload não deve conter device_id nem created_at (adicionados no envio).
+     * @return false se não couber no registro ou a fila não estiver pronta
+     */
+    bool enqueue(TelemetryTable table, const char* payload);
+    bool enqueue(TelemetryTable table, const char* payload, uint32_t epoch, uint32_t captured_ms);
+
+    // ===== STATUS =====
+    bool isReady() const { return ready; }
+    bool isEmpty() const { return next_sequence == acked_sequence; }
+    uint32_t size() const { return next_sequence - acked_sequence; }
+    uint32_t getDropped() const { return dropped; }
+    uint32_t getRejected() const { return rejected; }
+    String getStatusJSON() const;
+    void printStatus() const;
+
+    static const char* tableName(TelemetryTable table);
+
+    /**
+     * @brief Hora UTC em segundos (0 se o NTP ainda não sincronizou)
+     */
+    static uint32_t epochNow();
+
+    /**
+     * @brief Hora UTC de uma captura deste boot (0 se ainda desconhecida)
+     */
+    static uint32_t captureEpoch(uint32_t epoch, uint32_t captured_ms);
+
+    /**
+     * @brief Linha final: device_id + created_at (se conhecido) + campos do payload
+     * @return Bytes escritos em out (0 se não couber)
+     */
+    static size_t formatRow(char* out, size_t size, const char* payload, uint32_t epoch);
+
+private:
+    struct Record {
+        uint16_t magic;
+        uint8_t table;
+        uint8_t length;
+        uint32_t sequence;
+        uint32_t epoch;             // Hora UTC da captura (0 = desconhecida)
+        uint32_t captured_ms;       // millis() da captura
+        uint16_t boot;              // Boot em que foi capturado
+        uint16_t checksum;
+        char payload[TELEMETRY_PAYLOAD_SIZE];
+    } __attribute__((packed));
+
+    static const uint16_t RECORD_MAGIC = 0x5451;
+
+    fs::FS* fs;
+    SegmentRing ring;               // Índice = sequência - 1
+    Preferences prefs;
+    static const char* NVS_NAMESPACE;
+
+    Sender sender;
+    bool ready;
+
+    uint32_t next_sequence;         // Próximo registro a gravar
+    uint32_t acked_sequence;        // Primeiro registro ainda não entregue
+    uint16_t boot_id;
+
+    unsigned long last_drain;
+    unsigned long drain_delay;
+
+    // Estatísticas
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t failures;
+    uint32_t corrupted;
+    uint32_t rejected;              // Enfileiramentos com a fila indisponível
+
+    Record record;                  // Buffer de leitura/escrita
+    char body[TELEMETRY_BODY_SIZE]; // Array JSON do lote (reutilizado a cada rodada)
+
+    void recover();
+    bool readRecord(uint32_t sequence);
+    void saveAck();
+    static uint16_t checksum(const Record& rec);
+};
+
+#endif // TELEMETRY_QUEUE_H
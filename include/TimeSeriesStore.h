@@ -0,0 +1,266 @@
+#ifndef TIME_SERIES_STORE_H
+#define TIME_SERIES_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Config.h"
+#include "SegmentRing.h"
+#include "SensorBus.h"
+
+// ===== CONFIGURAÇÕES DO HISTÓRICO =====
+#define TS_PAGE_SIZE 512                      // Página fixa (unidade de escrita na flash)
+#define TS_MAX_COLUMNS 12                     // 4 canais x (média, mín, máx)
+#define TS_RAW_INTERVAL_MS 10000              // Uma linha bruta a cada 10s
+#define TS_RAW_PAGES 64                       // ~32KB: ~2 dias de dados brutos
+#define TS_MINUTE_PAGES 128                   // ~64KB: ~1 semana de agregados de 1 min
+#define TS_QUARTER_PAGES 64                   // ~32KB: ~2 meses de agregados de 15 min
+#define TS_SEGMENT_PAGES 8                    // 4KB (um bloco) por arquivo de segmento
+#define TS_CHECKPOINT_INTERVAL_MS 600000      // Página parcial gravada a cada 10 min
+#define TS_DIRECTORY "/ts"
+
+// Valor ausente (sensor inválido/sem dados) dentro das páginas
+#define TS_MISSING_VALUE INT32_MIN
+
+/**
+ * @brief Página de série temporal com compressão por bits
+ *
+ * Linhas (tempo + N colunas inteiras escaladas) codificadas como no
+ * Gorilla: tempo por delta-do-delta e cada coluna pelo delta em relação
+ * à linha anterior, com prefixos de tamanho variável ('0' = repetido).
+ * Leituras de sensores quantizadas na resolução do canal mudam pouco
+ * entre amostras, então a maioria das colunas custa 1 a 6 bits.
+ *
+ * Cada página é independente (começa com valores absolutos), o que
+ * permite descartar páginas antigas e ler qualquer uma isoladamente.
+ */
+class TimeSeriesPage {
+public:
+    struct Header {
+        uint16_t magic;
+        uint8_t tier;
+        uint8_t columns;
+        uint32_t sequence;          // Ordem de escrita (monotônica)
+        uint32_t first_time;        // Segundos do relógio do dispositivo
+        uint32_t last_time;
+        uint16_t count;             // Linhas na página
+        uint16_t bit_length;        // Bits usados após o cabeçalho
+        uint16_t checksum;          // Fletcher-16 do conteúdo
+        uint16_t reserved;
+    } __attribute__((packed));
+
+    typedef std::function<bool(uint32_t time, const int32_t* values)> RowVisitor;
+
+    static const uint16_t MAGIC = 0x5354;
+    static const uint16_t CAPACITY_BITS = (TS_PAGE_SIZE - sizeof(Header)) * 8;
+
+    TimeSeriesPage();
+
+    void reset(uint8_t tier, uint8_t columns, uint32_t sequence);
+
+    /**
+     * @brief Acrescenta uma linha
+     * @return false se não couber (página inalterada)
+     */
+    bool append(uint32_t time, const int32_t* values);
+
+    /**
+     * @brief Carrega uma página lida da flash (valida cabeçalho e checksum)
+     */
+    bool load(const uint8_t* data, uint8_t expected_tier);
+
+    /**
+     * @brief Percorre as linhas em ordem; o visitante retorna false para parar
+     */
+    bool decode(RowVisitor visitor) const;
+
+    const uint8_t* data() { sealHeader(); return buffer; }
+    const Header& header() const { return *reinterpret_cast<const Header*>(buffer); }
+    uint16_t getCount() const { return header().count; }
+    bool isEmpty() const { return header().count == 0; }
+
+private:
+    uint8_t buffer[TS_PAGE_SIZE];
+
+    // Estado do codificador (última linha)
+    uint32_t last_time;
+    int32_t last_delta;
+    int32_t last_values[TS_MAX_COLUMNS];
+
+    Header& mutableHeader() { return *reinterpret_cast<Header*>(buffer); }
+    void sealHeader();
+    uint16_t computeChecksum() const;
+
+    // Campos de bits após o cabeçalho
+    bool writeBits(uint32_t& pos, uint32_t value, uint8_t bits);
+    static uint32_t readBits(const uint8_t* payload, uint32_t& pos, uint8_t bits);
+    bool writeTimestamp(uint32_t& pos, int32_t delta_of_delta);
+    bool writeValue(uint32_t& pos, int32_t previous, int32_t value);
+    static int32_t readTimestamp(const uint8_t* payload, uint32_t& pos);
+    static int32_t readValue(const uint8_t* payload, uint32_t& pos, int32_t previous);
+};
+
+/**
+ * @brief Linha devolvida pelas consultas (valores já em unidade do sensor)
+ *
+ * No nível bruto values[i] é o canal i; nos agregados são três valores
+ * por canal: média, mínimo e máximo (values[3*i], [3*i+1], [3*i+2]).
+ * Valores ausentes são NAN.
+ */
+struct TimeSeriesRow {
+    uint32_t time;
+    uint8_t tier;
+    uint8_t columns;
+    float values[TS_MAX_COLUMNS];
+};
+
+/**
+ * @brief Estatística de um canal num intervalo
+ */
+struct TimeSeriesSummary {
+    float min;
+    float max;
+    float mean;
+    uint32_t count;
+    uint32_t first_time;
+    uint32_t last_time;
+};
+
+/**
+ * @brief Histórico local de sensores em LittleFS (partição "history")
+ *
+ * Três níveis, cada um um anel de páginas fixas (SegmentRing em
+ * TS_DIRECTORY/<nível>/): bruto (10s), 1 min e 15 min. Os agregados
+ * (média/mín/máx) são produzidos em fluxo a partir do nível anterior,
+ * então a compactação não precisa reler a flash.
+ *
+ * Nenhuma página é regravada no meio de um arquivo (no LittleFS isso
+ * copia o resto do arquivo): página cheia é anexada ao segmento
+ * corrente e, quando o anel dá a volta, o segmento mais antigo
+ * (TS_SEGMENT_PAGES páginas) é descartado inteiro. A página corrente
+ * fica na RAM e a cada TS_CHECKPOINT_INTERVAL_MS vai sozinha para
+ * head.bin (512 bytes regravados). A distribuição do desgaste fica com
+ * o wear leveling do LittleFS.
+ *
+ * Sem RTC, o tempo é um relógio do dispositivo em segundos que continua
+ * do último registro gravado a cada boot (o tempo desligado não conta).
+ *
+ * O sistema de arquivos é injetado (fs::FS): com o LittleFS padrão a
+ * partição é montada por HistoryFS; nos testes do host
+ * (test/test_time_series) roda sobre um FS em memória.
+ */
+class TimeSeriesStore {
+public:
+    enum Tier : uint8_t {
+        TIER_RAW = 0,
+        TIER_MINUTE,
+        TIER_QUARTER,
+        TIER_COUNT
+    };
+
+    typedef std::function<bool(const TimeSeriesRow& row)> RowCallback;
+
+    TimeSeriesStore();
+    ~TimeSeriesStore();
+
+    // ===== CONTROLE =====
+    bool begin(SensorBus* bus, fs::FS& filesystem = LittleFS);
+    void loop();
+    void end();
+    void flush();
+    bool isReady() const { return ready; }
+
+    // ===== TEMPO =====
+    uint32_t now() const;
+
+    // ===== CONSULTA =====
+    /**
+     * @brief Linhas de um nível com tempo em [from, to]
+     * @return Número de linhas entregues
+     */
+    size_t query(Tier tier, uint32_t from, uint32_t to, RowCallback callback);
+
+    /**
+     * @brief Nível mais fino que cobre o intervalo com até max_points linhas
+     */
+    Tier selectTier(uint32_t from, uint32_t to, size_t max_points) const;
+
+    bool summarize(uint8_t channel, uint32_t from, uint32_t to, TimeSeriesSummary& out);
+
+    // ===== CANAIS =====
+    uint8_t getChannelCount() const { return channel_count; }
+    int findChannel(const String& key) const;
+    const char* getChannelKey(uint8_t channel) const;
+
+    // ===== STATUS =====
+    String getStatusJSON() const;
+    void printStatus() const;
+
+private:
+    struct TierState {
+        const char* directory;
+        const char* head_path;          // Checkpoint da página corrente
+        const char* legacy_path;        // Anel antigo num arquivo só
+        SegmentRing* ring;              // Páginas fechadas (índice = sequência - 1)
+        uint16_t page_count;
+        uint32_t period_s;              // 0 = bruto
+        TimeSeriesPage page;            // Página corrente (RAM)
+        uint16_t head_slot;             // Posição da página corrente no anel
+        uint16_t slots_used;            // Páginas fechadas guardadas no anel
+        uint32_t next_sequence;
+        uint32_t* slot_first;           // Índice em RAM (0 = vazio)
+        uint32_t* slot_last;
+        bool dirty;
+        unsigned long last_checkpoint;
+        uint32_t rows_written;
+        uint32_t page_writes;           // Gravações na flash (desgaste)
+    };
+
+    // Agregação em fluxo para o nível seguinte
+    struct Aggregator {
+        bool active;
+        uint32_t bucket;                // Início do intervalo
+        uint16_t count[TS_MAX_COLUMNS / 3];
+        double sum[TS_MAX_COLUMNS / 3];
+        int32_t min[TS_MAX_COLUMNS / 3];
+        int32_t max[TS_MAX_COLUMNS / 3];
+    };
+
+    fs::FS* fs;
+    SensorBus* bus;
+    SemaphoreHandle_t mutex;
+    bool ready;
+
+    TierState tiers[TIER_COUNT];
+    Aggregator aggregators[TIER_COUNT];   // aggregators[t] alimenta o nível t
+    TimeSeriesPage scratch;               // Leitura de páginas nas consultas
+    uint8_t io_buffer[TS_PAGE_SIZE];
+
+    SensorChannel channels[TS_MAX_COLUMNS / 3];
+    float scales[TS_MAX_COLUMNS / 3];
+    uint8_t channel_count;
+
+    uint32_t clock_base;
+    unsigned long clock_origin;
+    unsigned long last_sample;
+
+    void sample(unsigned long now_ms);
+    void advanceClock(unsigned long now_ms);
+    uint32_t oldestTime(Tier tier) const;
+    uint32_t firstClosed(const TierState& state) const;
+    void recoverTier(Tier tier);
+    void appendRow(Tier tier, uint32_t time, const int32_t* values);
+    void feedAggregator(Tier tier, uint32_t time, const int32_t* avg, const int32_t* min, const int32_t* max);
+    void emitAggregate(Tier tier);
+    void closePage(Tier tier);
+    void checkpoint(Tier tier);
+    void rowFromValues(Tier tier, uint32_t time, const int32_t* values, TimeSeriesRow& row) const;
+    uint8_t columnsFor(Tier tier) const { return tier == TIER_RAW ? channel_count : channel_count * 3; }
+    void lock() const;
+    void unlock() const;
+};
+
+#endif // TIME_SERIES_STORE_H
@@ -0,0 +1,99 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ===== CONFIGURAÇÕES DO TRACE =====
+#define TRACE_ENABLED 1                       // 0 = PROFILE_SCOPE só alimenta o LoopProfiler
+#define TRACE_ENABLED_AT_BOOT true            // Gravador de voo: sempre guarda os últimos eventos
+#define TRACE_RING_EVENTS 1024                // 12KB de RAM
+#define TRACE_MAX_TRACKS 16                   // Tasks distintas no timeline
+#define TRACE_TRACK_NAME_SIZE 16
+#define TRACE_LINE_SIZE 192                   // Maior trecho de JSON montado de uma vez
+#define TRACE_BINARY_MAGIC "HWTR"
+#define TRACE_BINARY_VERSION 1
+
+/**
+ * @brief Evento completo (início + duração) de uma seção PROFILE_SCOPE
+ */
+struct TraceEvent {
+    uint32_t start_us;               // micros() no início
+    uint32_t duration_us;
+    uint8_t section;                 // Índice no LoopProfiler
+    uint8_t track;                   // Task que executou
+    uint8_t core;
+    uint8_t reserved;
+} __attribute__((packed));
+
+/**
+ * @brief Timeline das seções PROFILE_SCOPE no formato Chrome Trace
+ *
+ * Cada escopo medido vira um registro binário de 12 bytes num anel
+ * (início, duração, seção, task, núcleo); os TRACE_RING_EVENTS mais
+ * recentes ficam sempre disponíveis. A gravação é um spinlock curto,
+ * sem alocação.
+ *
+ * GET /api/trace (ou /trace no DiagWebServer)
+ *   JSON Trace Event ("ph":"X", ts/dur em us, uma linha por task),
+ *   aberto direto em chrome://tracing ou ui.perfetto.dev.
+ * GET /api/trace?format=bin
+ *   Cabeçalho + tabelas de nomes + registros crus (~10x menor);
+ *   scripts/trace_to_chrome.py converte para o mesmo JSON no host.
+ * ?enable=0|1 pausa/retoma a gravação.
+ *
+ * Durante o envio a gravação fica suspensa (eventos contados em
+ * "dropped") para o anel não ser sobrescrito no meio da leitura.
+ */
+class TraceRecorder {
+public:
+    static TraceRecorder& shared();
+
+    // ===== GRAVAÇÃO =====
+    void record(int8_t section, uint32_t start_us, uint32_t duration_us);
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+
+    // ===== CONSULTA =====
+    void attach(AsyncWebServer* server, const char* uri);
+
+    /**
+     * @brief Suspende a gravação para leitura; false se já há um envio
+     */
+    bool beginExport();
+    void endExport();
+
+    uint32_t getFirstSequence() const;
+    uint32_t getEndSequence() const { return head; }
+    bool readEvent(uint32_t sequence, TraceEvent& out) const;
+    uint8_t getTrackCount() const { return track_count; }
+    const char* getTrackName(uint8_t track) const;
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    struct Track {
+        TaskHandle_t handle;
+        char name[TRACE_TRACK_NAME_SIZE];
+    };
+
+    TraceRecorder();
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    portMUX_TYPE spinlock;
+    volatile bool enabled;
+    volatile bool exporting;
+
+    TraceEvent events[TRACE_RING_EVENTS];
+    uint32_t head;                   // Próxima sequência a gravar
+    uint32_t dropped;                // Perdidos durante envios ou sem track livre
+
+    Track tracks[TRACE_MAX_TRACKS];
+    uint8_t track_count;
+
+    int8_t trackFor(TaskHandle_t handle);
+};
+
+#endif // TRACE_RECORDER_H
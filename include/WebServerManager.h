@@ -9,6 +9,10 @@
 #include "DataTypes.h"
 #include "WiFiManager.h"
 #include "HydroControl.h"
+#include "SnapshotCache.h"
+#include "StaticAssets.h"
+#include "EventStream.h"
+#include "HistoryAPI.h"
 #include <functional>
 
 class WebServerManager {
@@ -25,6 +29,19 @@ private:
     float* phRef;
     float* tdsRef;
     std::function<void(int, int)> onRelayToggle;
+    
+    // Snapshots da API: serializados uma vez por geração, compartilhados entre requisições
+    SnapshotCache snapshots;
+    
+    // Arquivos do SPIFFS com gzip + ETag (manifesto gerado no build)
+    StaticAssets assets;
+    
+    // SSE para displays somente leitura (sensores, relés, regras)
+    EventStream events;
+    
+    // Histórico local (opcional; definido antes de beginAdminServer)
+    TimeSeriesStore* timeSeries;
+    HistoryAPI history;
 
     void setupUnifiedRoutes();
     void initSPIFFS();
@@ -40,6 +57,8 @@ public:
     void begin();
     void update();
     bool isActive() { return isRunning; }
+    SnapshotCache& getSnapshotCache() { return snapshots; }
+    EventStream& getEventStream() { return events; }
     
     // Configuração opcional (para uso futuro)
     void setupServer(SystemStatus& status, SensorData& sensors, bool* relayStates);
@@ -49,6 +68,7 @@ public:
     void setSystemStatus(SystemStatus* status) { systemStatus = status; }
     void setSensorData(SensorData* sensors) { sensorData = sensors; }
     void setRelayStates(bool* states) { relayStates = states; }
+    void setTimeSeries(TimeSeriesStore* store) { timeSeries = store; }
 };
 
 #endif // WEB_SERVER_MANAGER_H
\ No newline at end of file
@@ -7,10 +7,12 @@
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
+#include "StaticAssets.h"
 
 class WiFiConfigServer {
 private:
     AsyncWebServer* server;
+    StaticAssets assets;
     bool serverActive;
     unsigned long startTime;
     unsigned int activeConnections;
@@ -9,6 +9,7 @@
 #include <Preferences.h>
 #include <functional>
 #include "DeviceID.h"
+#include "StaticAssets.h"
 
 // ===== CONFIGURAÇÕES OTIMIZADAS =====
 #ifndef AP_SSID
@@ -176,7 +177,10 @@ private:
         }
         
         // ✅ SERVIDOR ESTÁTICO PRINCIPAL
-        server->serveStatic("/", SPIFFS, "/").setDefaultFile("wifi-config.html");
+        server->serveStatic("/", SPIFFS, "/").setDefaultFile("wifi-config.html")
+            .setFilter([](AsyncWebServerRequest* request) {
+                return request->url() != ASSET_MANIFEST_PATH;   // Manifesto do build não é público
+            });
         
         // ✅ FALLBACK SIMPLES PARA PÁGINA PRINCIPAL
         server->on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
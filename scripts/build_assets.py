@@ -0,0 +1,75 @@
+# Gera a imagem do SPIFFS a partir de data/ com variantes gzip e manifesto.
+#
+# Executado pelo PlatformIO (extra_scripts = pre:scripts/build_assets.py)
+# antes de qualquer alvo; buildfs/uploadfs leem o diretório gerado
+# (data_dir em platformio.ini), nunca data/ diretamente.
+#
+# Para cada arquivo de texto:
+#   <arquivo>     original (clientes sem gzip)
+#   <arquivo>.gz  gzip -9, só se reduzir o tamanho
+# e /assets.idx com "<caminho> <sha256[:16]>" por arquivo, usado pelo
+# firmware (StaticAssets) como ETag forte.
+
+Import("env")
+
+import gzip
+import hashlib
+import os
+import shutil
+
+SOURCE_DIR = os.path.join(env.subst("$PROJECT_DIR"), "data")
+OUTPUT_DIR = env.subst("$PROJECT_DATA_DIR")
+MANIFEST_NAME = "assets.idx"
+COMPRESSIBLE = (".html", ".css", ".js", ".json", ".svg", ".txt")
+SPIFFS_NAME_LIMIT = 31  # SPIFFS_OBJ_NAME_LEN (32) menos o '\0'
+
+
+def build_assets():
+    if os.path.abspath(SOURCE_DIR) == os.path.abspath(OUTPUT_DIR):
+        print("build_assets: data_dir aponta para data/, nada a gerar")
+        return
+
+    shutil.rmtree(OUTPUT_DIR, ignore_errors=True)
+    os.makedirs(OUTPUT_DIR)
+
+    manifest = []
+    raw_total = 0
+    sent_total = 0
+
+    for name in sorted(os.listdir(SOURCE_DIR)):
+        source = os.path.join(SOURCE_DIR, name)
+        if not os.path.isfile(source):
+            continue
+
+        with open(source, "rb") as f:
+            content = f.read()
+        shutil.copyfile(source, os.path.join(OUTPUT_DIR, name))
+
+        path = "/" + name
+        raw_total += len(content)
+        sent = len(content)
+
+        if name.endswith(COMPRESSIBLE):
+            # mtime=0: mesma entrada gera o mesmo .gz (imagem reproduzível)
+            packed = gzip.compress(content, compresslevel=9, mtime=0)
+            if len(path) + 3 > SPIFFS_NAME_LIMIT:
+                print("build_assets: %s.gz excede o limite de nome do SPIFFS, mantendo só o original" % path)
+            elif len(packed) < len(content):
+                with open(os.path.join(OUTPUT_DIR, name + ".gz"), "wb") as f:
+                    f.write(packed)
+                sent = len(packed)
+
+            manifest.append("%s %s" % (path, hashlib.sha256(content).hexdigest()[:16]))
+
+        sent_total += sent
+        print("build_assets: %-24s %7d -> %7d bytes" % (path, len(content), sent))
+
+    with open(os.path.join(OUTPUT_DIR, MANIFEST_NAME), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+
+    if raw_total:
+        print("build_assets: %d arquivos, %d -> %d bytes (%.1fx)" %
+              (len(manifest), raw_total, sent_total, float(raw_total) / max(sent_total, 1)))
+
+
+build_assets()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# Converte o trace binário do firmware (GET /api/trace?format=bin) para o
+# formato Chrome Trace Event, aberto em chrome://tracing ou ui.perfetto.dev.
+#
+# Uso:
+#   python3 scripts/trace_to_chrome.py trace.bin -o trace.json
+#   python3 scripts/trace_to_chrome.py http://192.168.4.1/api/trace?format=bin -o trace.json
+#
+# Formato (little-endian, ver TraceRecorder.h):
+#   cabeçalho  "HWTR", u16 versão, u16 tamanho do registro, u32 eventos,
+#              u32 perdidos, u32 base_us, u8 seções, u8 tracks, u16 reservado
+#   nomes      seções e depois tracks, cada um terminado em '\0'
+#   registros  u32 início_us, u32 duração_us, u8 seção, u8 track, u8 núcleo, u8 reservado
+#
+# A saída é a mesma do GET /api/trace (JSON gerado no dispositivo), só que
+# o binário é ~10x menor para baixar por WiFi fraco.
+
+import argparse
+import json
+import struct
+import sys
+import urllib.request
+
+MAGIC = b"HWTR"
+SUPPORTED_VERSION = 1
+HEADER = struct.Struct("<4sHHIIIBBH")
+RECORD = struct.Struct("<IIBBBB")
+
+
+def load(source):
+    if source.startswith("http://") or source.startswith("https://"):
+        with urllib.request.urlopen(source, timeout=30) as response:
+            return response.read()
+    with open(source, "rb") as handle:
+        return handle.read()
+
+
+def read_names(data, offset, count):
+    names = []
+    for _ in range(count):
+        end = data.index(b"\0", offset)
+        names.append(data[offset:end].decode("utf-8", "replace"))
+        offset = end + 1
+    return names, offset
+
+
+def convert(data):
+    if len(data) < HEADER.size:
+        raise ValueError("arquivo menor que o cabeçalho")
+
+    magic, version, record_size, count, dropped, base_us, sections, tracks, _ = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("não é um trace do firmware (magic %r)" % magic)
+    if version != SUPPORTED_VERSION:
+        raise ValueError("versão %d não suportada" % version)
+    if record_size < RECORD.size:
+        raise ValueError("registro de %d bytes menor que o esperado" % record_size)
+
+    section_names, offset = read_names(data, HEADER.size, sections)
+    track_names, offset = read_names(data, offset, tracks)
+
+    events = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "ESP32 HydroWave"}}]
+    for tid, name in enumerate(track_names):
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    available = (len(data) - offset) // record_size
+    if available < count:
+        print("aviso: %d de %d eventos (arquivo truncado)" % (available, count), file=sys.stderr)
+        count = available
+
+    for index in range(count):
+        start, duration, section, track, core, _ = RECORD.unpack_from(data, offset + index * record_size)
+        name = section_names[section] if section < len(section_names) else "section_%d" % section
+        events.append({
+            "name": name,
+            "ph": "X",
+            "ts": (start - base_us) & 0xFFFFFFFF,  # micros() dá a volta a cada ~71 min
+            "dur": duration,
+            "pid": 1,
+            "tid": track,
+            "args": {"core": core},
+        })
+
+    return {
+        "displayTimeUnit": "ms",
+        "otherData": {"base_us": base_us, "dropped": dropped},
+        "traceEvents": events,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Trace binário do firmware -> Chrome Trace JSON")
+    parser.add_argument("source", help="arquivo .bin ou URL de /api/trace?format=bin")
+    parser.add_argument("-o", "--output", help="arquivo de saída (padrão: stdout)")
+    args = parser.parse_args()
+
+    try:
+        trace = convert(load(args.source))
+    except (OSError, ValueError) as error:
+        print("erro: %s" % error, file=sys.stderr)
+        return 1
+
+    text = json.dumps(trace, separators=(",", ":"))
+    if args.output:
+        with open(args.output, "w") as handle:
+            handle.write(text)
+        print("%d eventos -> %s" % (len(trace["traceEvents"]), args.output), file=sys.stderr)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,6 +4,12 @@
 #include <SPIFFS.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
+#include "CloudConnectionPool.h"
+
+// Cabeçalho comum das rotas /api (JSON sem autenticação)
+static const CloudHeader JSON_HEADERS[] = {
+    {"Content-Type", "application/json"},
+};
 
 APIClient::APIClient() {
     supabaseUrl = "";
@@ -97,20 +103,22 @@ void APIClient::update() {
 bool APIClient::makeSupabaseRequest(const String& endpoint, const String& payload, String& response) {
     if (!isConnected() || supabaseUrl.length() == 0) return false;
 
-    http.begin(supabaseUrl + endpoint);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("apikey", supabaseKey);
-    http.addHeader("Authorization", "Bearer " + supabaseKey);
-    http.setTimeout(5000);
+    String authHeader = "Bearer " + supabaseKey;
+    const CloudHeader headers[] = {
+        {"Content-Type", "application/json"},
+        {"apikey", supabaseKey.c_str()},
+        {"Authorization", authHeader.c_str()},
+    };
 
-    int httpCode = http.POST(payload);
+    String body;
+    int httpCode = CloudConnectionPool::shared().request("POST", supabaseUrl + endpoint, payload,
+                                                         headers, 3, &body, 5000);
     bool success = (httpCode == 200);
     
     if (success) {
-        response = http.getString();
+        response = body;
     }
     
-    http.end();
     return success;
 }
 
@@ -134,23 +142,18 @@ bool APIClient::checkRelayCommands(const String& deviceId) {
         return false;
     }
 
-    HTTPClient http;
     String url = supabaseUrl + "/api/relay-commands?device_id=" + deviceId + "&status=pending";
     
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    
-    int httpCode = http.GET();
+    String payload;
+    int httpCode = CloudConnectionPool::shared().request("GET", url, "", JSON_HEADERS, 1, &payload);
     
     if (httpCode == 200) {
-        String payload = http.getString();
         
         DynamicJsonDocument doc(2048);
         DeserializationError error = deserializeJson(doc, payload);
         
         if (error) {
             Serial.println("❌ Erro ao parsear JSON dos comandos: " + String(error.c_str()));
-            http.end();
             return false;
         }
         
@@ -164,14 +167,12 @@ bool APIClient::checkRelayCommands(const String& deviceId) {
                 processRelayCommand(cmd);
             }
             
-            http.end();
             return true;
         }
     } else {
         Serial.println("❌ Erro HTTP ao verificar comandos: " + String(httpCode));
     }
     
-    http.end();
     return false;
 }
 
@@ -200,12 +201,8 @@ bool APIClient::confirmCommandExecution(const String& commandId, const String& s
         return false;
     }
 
-    HTTPClient http;
     String url = supabaseUrl + "/api/relay-commands";
     
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    
     DynamicJsonDocument doc(512);
     doc["command_id"] = commandId.toInt();
     doc["status"] = status;
@@ -216,17 +213,15 @@ bool APIClient::confirmCommandExecution(const String& commandId, const String& s
     String jsonString;
     serializeJson(doc, jsonString);
     
-    int httpCode = http.PUT(jsonString);
+    int httpCode = CloudConnectionPool::shared().request("PUT", url, jsonString, JSON_HEADERS, 1);
     
     if (httpCode == 200) {
         Serial.println("✅ Comando " + commandId + " confirmado como " + status);
-        http.end();
         return true;
     } else {
         Serial.println("❌ Erro ao confirmar comando: " + String(httpCode));
     }
 
-    http.end();
     return false;
 }
 
@@ -236,12 +231,8 @@ bool APIClient::sendDeviceStatus(const String& deviceId, const DeviceStatusData&
         return false;
     }
 
-    HTTPClient http;
     String url = supabaseUrl + "/api/device-status-unified";
     
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    
     DynamicJsonDocument doc(2048);
     doc["device_id"] = deviceId;
     doc["wifi_rssi"] = WiFi.RSSI();
@@ -259,17 +250,15 @@ bool APIClient::sendDeviceStatus(const String& deviceId, const DeviceStatusData&
     String jsonString;
     serializeJson(doc, jsonString);
     
-    int httpCode = http.POST(jsonString);
+    int httpCode = CloudConnectionPool::shared().request("POST", url, jsonString, JSON_HEADERS, 1);
     
     if (httpCode == 200) {
         Serial.println("✅ Status do dispositivo enviado com sucesso");
-        http.end();
         return true;
     } else {
         Serial.println("❌ Erro ao enviar status: " + String(httpCode));
     }
     
-    http.end();
     return false;
 }
 
@@ -279,12 +268,8 @@ bool APIClient::sendSensorData(const String& deviceId, const SensorData& data) {
         return false;
     }
 
-    HTTPClient http;
     String url = supabaseUrl + "/api/sensor-data-unified";
     
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    
     DynamicJsonDocument doc(1024);
     doc["device_id"] = deviceId;
     
@@ -311,17 +296,15 @@ bool APIClient::sendSensorData(const String& deviceId, const SensorData& data) {
     String jsonString;
     serializeJson(doc, jsonString);
     
-    int httpCode = http.POST(jsonString);
+    int httpCode = CloudConnectionPool::shared().request("POST", url, jsonString, JSON_HEADERS, 1);
     
     if (httpCode == 200) {
         Serial.println("✅ Dados dos sensores enviados com sucesso");
-        http.end();
     return true;
     } else {
         Serial.println("❌ Erro ao enviar dados dos sensores: " + String(httpCode));
     }
     
-    http.end();
     return false;
 }
 
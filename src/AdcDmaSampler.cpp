@@ -0,0 +1,134 @@
+#include "AdcDmaSampler.h"
+#include <driver/adc.h>
+
+// ===== AMOSTRADOR DMA =====
+AdcDmaSampler::AdcDmaSampler() :
+    running(false),
+    overflow_count(0) {
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        sample_counts[i] = 0;
+    }
+    adc_channels[CHANNEL_PH] = digitalPinToAnalogChannel(PH_PIN);    // GPIO35 -> ADC1_CH7
+    adc_channels[CHANNEL_TDS] = digitalPinToAnalogChannel(TDS_PIN);  // GPIO34 -> ADC1_CH6
+}
+
+AdcDmaSampler::~AdcDmaSampler() {
+    end();
+}
+
+bool AdcDmaSampler::begin() {
+    if (running) return true;
+
+    int8_t ph_channel = adc_channels[CHANNEL_PH];
+    int8_t tds_channel = adc_channels[CHANNEL_TDS];
+    if (ph_channel < 0 || ph_channel > 7 || tds_channel < 0 || tds_channel > 7) {
+        Serial.println("❌ ADC DMA: pinos de pH/TDS precisam estar no ADC1");
+        return false;
+    }
+
+    adc_digi_init_config_t init_config = {};
+    init_config.max_store_buf_size = ADC_DMA_STORE_BYTES;
+    init_config.conv_num_each_intr = ADC_DMA_FRAME_BYTES;
+    init_config.adc1_chan_mask = BIT(ph_channel) | BIT(tds_channel);
+    init_config.adc2_chan_mask = 0;
+
+    if (adc_digi_initialize(&init_config) != ESP_OK) {
+        Serial.println("❌ ADC DMA: falha ao inicializar controlador digital");
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern[2] = {};
+    uint8_t channels[2] = {(uint8_t)ph_channel, (uint8_t)tds_channel};
+    for (int i = 0; i < 2; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_11;           // Faixa completa (~0-3.3V), como analogRead
+        pattern[i].channel = channels[i];
+        pattern[i].unit = 0;                          // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_configuration_t digi_config = {};
+    digi_config.conv_limit_en = 1;                    // Obrigatório no ESP32
+    digi_config.conv_limit_num = 250;
+    digi_config.pattern_num = 2;
+    digi_config.adc_pattern = pattern;
+    digi_config.sample_freq_hz = ADC_DMA_SAMPLE_FREQ_HZ;
+    digi_config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digi_config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+    if (adc_digi_controller_configure(&digi_config) != ESP_OK || adc_digi_start() != ESP_OK) {
+        Serial.println("❌ ADC DMA: falha ao configurar/iniciar conversões");
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    running = true;
+    Serial.printf("✅ ADC DMA ativo: %d Hz (pH CH%d, TDS CH%d), decimação %d\n",
+                 ADC_DMA_SAMPLE_FREQ_HZ, ph_channel, tds_channel, ADC_DMA_DECIMATION);
+    return true;
+}
+
+void AdcDmaSampler::end() {
+    if (!running) return;
+
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    running = false;
+}
+
+void AdcDmaSampler::poll() {
+    if (!running) return;
+
+    // Esvaziar tudo o que já está pronto, sem esperar (timeout 0)
+    while (true) {
+        uint32_t length = 0;
+        esp_err_t result = adc_digi_read_bytes(read_buffer, sizeof(read_buffer), &length, 0);
+
+        if (result == ESP_ERR_INVALID_STATE) {
+            // Buffer do driver transbordou: dados antigos descartados, seguir lendo
+            overflow_count++;
+        } else if (result != ESP_OK) {
+            break;
+        }
+
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            adc_digi_output_data_t* data = (adc_digi_output_data_t*)&read_buffer[i];
+            int channel = channelFor(data->type1.channel);
+            if (channel < 0) continue;
+
+            filters[channel].push(data->type1.data);
+            sample_counts[channel]++;
+        }
+
+        if (length < sizeof(read_buffer)) break;
+    }
+}
+
+// ===== DADOS =====
+bool AdcDmaSampler::hasValue(Channel channel) const {
+    return channel < CHANNEL_COUNT && filters[channel].hasOutput();
+}
+
+float AdcDmaSampler::getRaw(Channel channel) const {
+    if (channel >= CHANNEL_COUNT) return 0.0;
+    return filters[channel].getOutput();
+}
+
+uint32_t AdcDmaSampler::getSampleCount(Channel channel) const {
+    if (channel >= CHANNEL_COUNT) return 0;
+    return sample_counts[channel];
+}
+
+void AdcDmaSampler::printStatus() {
+    Serial.println("\n📈 === ADC DMA ===");
+    Serial.printf("Ativo: %s | Overflows: %lu\n", running ? "SIM" : "NÃO", (unsigned long)overflow_count);
+    Serial.printf("pH:  %.1f cont. | %lu amostras\n", getRaw(CHANNEL_PH), (unsigned long)sample_counts[CHANNEL_PH]);
+    Serial.printf("TDS: %.1f cont. | %lu amostras\n", getRaw(CHANNEL_TDS), (unsigned long)sample_counts[CHANNEL_TDS]);
+    Serial.println("=================\n");
+}
+
+int AdcDmaSampler::channelFor(uint8_t adc_channel) const {
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        if (adc_channels[i] == adc_channel) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,125 @@
+#include "AdminFrameEncoder.h"
+
+// Bandas mortas: abaixo disso o campo não entra no delta
+static const uint32_t HEAP_DEADBAND = 512;
+static const uint32_t UPTIME_DEADBAND = 5;
+static const int8_t RSSI_DEADBAND = 3;
+static const int16_t SENSOR_DEADBAND[ADMIN_SENSOR_COUNT] = {2, 5, 10, 10, 50};
+
+// ===== ESCRITA LITTLE ENDIAN =====
+static inline void putU8(uint8_t* out, size_t& pos, uint8_t value) {
+    out[pos++] = value;
+}
+
+static inline void putU16(uint8_t* out, size_t& pos, uint16_t value) {
+    out[pos++] = value & 0xFF;
+    out[pos++] = value >> 8;
+}
+
+static inline void putU32(uint8_t* out, size_t& pos, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        out[pos++] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static inline uint32_t distance(uint32_t a, uint32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+// ===== CODIFICADOR =====
+AdminFrameEncoder::AdminFrameEncoder() : sequence(0) {
+    reset();
+}
+
+void AdminFrameEncoder::reset() {
+    memset(&baseline, 0, sizeof(baseline));
+}
+
+size_t AdminFrameEncoder::encode(const AdminTelemetry& current, bool full, uint8_t* out, size_t size) {
+    // Pior caso: cabeçalho + todos os campos + todos os peers
+    if (size < ADMIN_FRAME_SIZE) return 0;
+    
+    size_t pos = 0;
+    putU8(out, pos, full ? ADMIN_FRAME_SNAPSHOT : ADMIN_FRAME_DELTA);
+    putU8(out, pos, sequence);
+    
+    // ===== MEMÓRIA E SISTEMA =====
+    if (full || distance(current.heapFree, baseline.heapFree) >= HEAP_DEADBAND) {
+        putU8(out, pos, FIELD_HEAP_FREE);
+        putU32(out, pos, current.heapFree);
+        baseline.heapFree = current.heapFree;
+    }
+    if (full || distance(current.maxBlock, baseline.maxBlock) >= HEAP_DEADBAND) {
+        putU8(out, pos, FIELD_MAX_BLOCK);
+        putU32(out, pos, current.maxBlock);
+        baseline.maxBlock = current.maxBlock;
+    }
+    if (full || current.heapTotal != baseline.heapTotal) {
+        putU8(out, pos, FIELD_HEAP_TOTAL);
+        putU32(out, pos, current.heapTotal);
+        baseline.heapTotal = current.heapTotal;
+    }
+    if (full || distance(current.uptime, baseline.uptime) >= UPTIME_DEADBAND) {
+        putU8(out, pos, FIELD_UPTIME);
+        putU32(out, pos, current.uptime);
+        baseline.uptime = current.uptime;
+    }
+    if (full || abs(current.rssi - baseline.rssi) >= RSSI_DEADBAND) {
+        putU8(out, pos, FIELD_RSSI);
+        putU8(out, pos, (uint8_t)current.rssi);
+        baseline.rssi = current.rssi;
+    }
+    if (full || current.wsClients != baseline.wsClients) {
+        putU8(out, pos, FIELD_WS_CLIENTS);
+        putU8(out, pos, current.wsClients);
+        baseline.wsClients = current.wsClients;
+    }
+    
+    // ===== RELÉS E SENSORES =====
+    if (current.hasRelays && (full || !baseline.hasRelays || current.relayMask != baseline.relayMask)) {
+        putU8(out, pos, FIELD_RELAY_MASK);
+        putU16(out, pos, current.relayMask);
+        baseline.relayMask = current.relayMask;
+    }
+    baseline.hasRelays = current.hasRelays;
+    
+    for (uint8_t i = 0; i < ADMIN_SENSOR_COUNT; i++) {
+        int16_t value = current.sensors[i];
+        int16_t sent = baseline.sensors[i];
+        bool presence = (value == ADMIN_SENSOR_NONE) != (sent == ADMIN_SENSOR_NONE);
+        if (full || presence ||
+            (value != ADMIN_SENSOR_NONE && abs((int32_t)value - sent) >= SENSOR_DEADBAND[i])) {
+            putU8(out, pos, FIELD_SENSOR_BASE + i);
+            putU16(out, pos, (uint16_t)value);
+            baseline.sensors[i] = value;
+        }
+    }
+    
+    // ===== PEERS ESP-NOW =====
+    if (full || current.peerCount != baseline.peerCount) {
+        putU8(out, pos, FIELD_PEER_COUNT);
+        putU8(out, pos, current.peerCount);
+    }
+    for (uint8_t i = 0; i < current.peerCount; i++) {
+        bool changed = full || i >= baseline.peerCount ||
+                       memcmp(current.peers[i].mac, baseline.peers[i].mac, 6) != 0 ||
+                       current.peers[i].online != baseline.peers[i].online ||
+                       abs(current.peers[i].rssi - baseline.peers[i].rssi) >= RSSI_DEADBAND;
+        if (!changed) continue;
+        
+        putU8(out, pos, FIELD_PEER);
+        putU8(out, pos, i);
+        memcpy(out + pos, current.peers[i].mac, 6);
+        pos += 6;
+        putU8(out, pos, current.peers[i].online ? 1 : 0);
+        putU8(out, pos, (uint8_t)current.peers[i].rssi);
+        baseline.peers[i] = current.peers[i];
+    }
+    baseline.peerCount = current.peerCount;
+    
+    // Só cabeçalho: nada mudou
+    if (pos == 2) return 0;
+    
+    sequence++;
+    return pos;
+}
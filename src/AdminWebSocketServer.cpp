@@ -9,7 +9,15 @@ AdminWebSocketServer::AdminWebSocketServer() :
     lastHeapSent(0),
     lastUptimeSent(0),
     lastFragmentationSent(0),
-    lastDataSent(0) {
+    lastDataSent(0),
+    keyframePending(true),
+    lastStreamSent(0),
+    lastKeyframe(0),
+    lastSourceSample(0),
+    framesSent(0),
+    bytesSent(0),
+    framesSkipped(0) {
+    memset(&sourceCache, 0, sizeof(sourceCache));
 }
 
 AdminWebSocketServer::~AdminWebSocketServer() {
@@ -42,6 +50,12 @@ bool AdminWebSocketServer::begin() {
     // ===== CONFIGURAR ROTAS ESTÁTICAS =====
     setupStaticRoutes();
     
+    // ===== HISTÓRICO (gráficos do painel) =====
+    // Sem loop(): nada é amostrado aqui, só lido da flash
+    if (history.begin(&historyBus)) {
+        historyApi.begin(httpServer, history);
+    }
+    
     // ===== INICIAR SERVIDORES =====
     httpServer->begin();
     serverActive = true;
@@ -72,6 +86,7 @@ void AdminWebSocketServer::end() {
         httpServer = nullptr;
     }
     
+    history.end();
     serverActive = false;
     
     Serial.println("✅ AdminWebSocketServer parado");
@@ -87,8 +102,8 @@ void AdminWebSocketServer::loop() {
         return;
     }
     
-    // ===== PUSH INTELIGENTE DE DADOS =====
-    pushMemoryUpdate();
+    // ===== STREAM BINÁRIO (snapshot + deltas) =====
+    pushTelemetry();
     
     // ===== CLEANUP DE CLIENTES DESCONECTADOS =====
     if (webSocket) {
@@ -128,6 +143,35 @@ void AdminWebSocketServer::pushSystemStatus() {
     Serial.println("📊 System status pushed via WebSocket");
 }
 
+void AdminWebSocketServer::pushTelemetry() {
+    if (!webSocket || getConnectedClients() == 0) return;
+    
+    unsigned long now = millis();
+    if (now - lastStreamSent < ADMIN_STREAM_INTERVAL_MS) return;
+    lastStreamSent = now;
+    
+    // Cliente lento: pula o tick; o próximo delta leva os valores atuais
+    if (!webSocket->availableForWriteAll()) {
+        framesSkipped++;
+        return;
+    }
+    
+    AdminTelemetry current;
+    sampleTelemetry(current);
+    
+    bool keyframe = keyframePending || now - lastKeyframe >= ADMIN_KEYFRAME_INTERVAL_MS;
+    size_t length = encoder.encode(current, keyframe, frameBuffer, sizeof(frameBuffer));
+    if (keyframe) {
+        keyframePending = false;
+        lastKeyframe = now;
+    }
+    if (length == 0) return;
+    
+    webSocket->binaryAll(frameBuffer, length);
+    framesSent++;
+    bytesSent += length * getConnectedClients();
+}
+
 void AdminWebSocketServer::pushMessage(const String& message) {
     if (!webSocket || getConnectedClients() == 0) return;
     
@@ -153,14 +197,13 @@ void AdminWebSocketServer::onWebSocketEvent(AsyncWebSocket *server, AsyncWebSock
             
             // Verificar limite de clientes
             if (getConnectedClients() > MAX_WS_CLIENTS) {
-                Serial.println("⚠️ Limite de clientes WebSocket excedido - Desconectando cliente mais antigo");
-                // Encontrar e desconectar cliente mais antigo seria complexo, 
-                // por simplicidade vamos apenas logar
+                Serial.println("⚠️ Limite de clientes WebSocket excedido - recusando novo cliente");
+                client->close();
+                break;
             }
             
-            // Enviar dados iniciais para o novo cliente
-            pushMemoryUpdate();
-            pushSystemStatus();
+            // Snapshot no próximo tick do loop (fora da task do AsyncTCP)
+            keyframePending = true;
             break;
             
         case WS_EVT_DISCONNECT:
@@ -188,6 +231,8 @@ void AdminWebSocketServer::onWebSocketEvent(AsyncWebSocket *server, AsyncWebSock
                     } else if (action == "get_initial_data") {
                         pushMemoryUpdate();
                         pushSystemStatus();
+                    } else if (action == "get_snapshot") {
+                        keyframePending = true;
                     } else {
                         pushMessage("Ação não reconhecida: " + action);
                     }
@@ -207,17 +252,17 @@ void AdminWebSocketServer::onWebSocketEvent(AsyncWebSocket *server, AsyncWebSock
 
 // ===== CONFIGURAR ROTAS ESTÁTICAS =====
 void AdminWebSocketServer::setupStaticRoutes() {
+    assets.begin();
+    
     // ===== PÁGINA PRINCIPAL (ADMIN-PANEL.HTML) =====
-    httpServer->on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
+    assets.attach(httpServer, "/", [this](AsyncWebServerRequest *request) {
         if (!canAcceptNewClient()) {
             request->send(503, "text/plain", "Servidor sobrecarregado");
             return;
         }
         
-        // Servir admin-panel.html do SPIFFS
-        if (SPIFFS.exists("/admin-panel.html")) {
-            request->send(SPIFFS, "/admin-panel.html", "text/html");
-        } else {
+        // Servir admin-panel.html do SPIFFS (gzip + ETag quando há manifesto)
+        if (!assets.serve(request, "/admin-panel.html")) {
             // Fallback simples
             String fallbackHtml = "<!DOCTYPE html><html><head><title>Admin Panel</title></head><body>";
             fallbackHtml += "<h1>ESP32 Admin Panel</h1>";
@@ -347,12 +392,15 @@ String AdminWebSocketServer::buildMemoryJSON() {
 }
 
 String AdminWebSocketServer::buildSystemStatusJSON() {
-    StaticJsonDocument<200> doc;
+    StaticJsonDocument<256> doc;
     doc["type"] = "system_status";
     doc["wifi_connected"] = WiFi.isConnected();
     doc["wifi_rssi"] = WiFi.RSSI();
     doc["supabase_connected"] = random(0, 10) > 2; // Simulado
     doc["system_uptime"] = millis() / 1000;
+    doc["stream_frames"] = framesSent;
+    doc["stream_bytes"] = bytesSent;
+    doc["stream_skipped"] = framesSkipped;
     doc["timestamp"] = millis();
     
     String jsonString;
@@ -360,6 +408,34 @@ String AdminWebSocketServer::buildSystemStatusJSON() {
     return jsonString;
 }
 
+void AdminWebSocketServer::sampleTelemetry(AdminTelemetry& frame) {
+    // Sensores, relés e peers mudam devagar: provedor consultado a cada ADMIN_SOURCE_INTERVAL_MS
+    unsigned long now = millis();
+    if (lastSourceSample == 0 || now - lastSourceSample >= ADMIN_SOURCE_INTERVAL_MS) {
+        lastSourceSample = now;
+        sourceCache.hasRelays = false;
+        sourceCache.relayMask = 0;
+        sourceCache.peerCount = 0;
+        for (uint8_t i = 0; i < ADMIN_SENSOR_COUNT; i++) {
+            sourceCache.sensors[i] = ADMIN_SENSOR_NONE;
+        }
+        if (telemetryProvider) {
+            telemetryProvider(sourceCache);
+        }
+        if (sourceCache.peerCount > ADMIN_MAX_PEERS) {
+            sourceCache.peerCount = ADMIN_MAX_PEERS;
+        }
+    }
+    
+    frame = sourceCache;
+    frame.heapFree = ESP.getFreeHeap();
+    frame.maxBlock = ESP.getMaxAllocHeap();
+    frame.heapTotal = ESP.getHeapSize();
+    frame.uptime = now / 1000;
+    frame.rssi = WiFi.isConnected() ? (int8_t)WiFi.RSSI() : 0;
+    frame.wsClients = getConnectedClients();
+}
+
 bool AdminWebSocketServer::shouldPushMemoryUpdate() {
     uint32_t currentHeap = ESP.getFreeHeap();
     uint32_t currentUptime = millis() / 1000;
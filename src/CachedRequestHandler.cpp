@@ -0,0 +1,32 @@
+#include "CachedRequestHandler.h"
+
+CachedRequestHandler::CachedRequestHandler(const char* uri, ArRequestHandlerFunction handler) :
+    uri(uri),
+    handler(handler),
+    header_count(0) {
+}
+
+CachedRequestHandler& CachedRequestHandler::keepHeader(const char* name) {
+    if (header_count < CACHED_HANDLER_MAX_HEADERS) {
+        headers[header_count++] = name;
+    }
+    return *this;
+}
+
+bool CachedRequestHandler::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET || request->url() != uri) return false;
+
+    // Antes do parsing dos cabeçalhos: sem isso eles não chegam ao handler
+    for (uint8_t i = 0; i < header_count; i++) {
+        request->addInterestingHeader(headers[i]);
+    }
+    return true;
+}
+
+void CachedRequestHandler::handleRequest(AsyncWebServerRequest* request) {
+    if (handler) {
+        handler(request);
+    } else {
+        request->send(500);
+    }
+}
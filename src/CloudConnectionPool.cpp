@@ -0,0 +1,219 @@
+#include "CloudConnectionPool.h"
+#include <ArduinoJson.h>
+#include "LoopProfiler.h"
+#include "HeapMonitor.h"
+
+// ===== INSTÂNCIA =====
+CloudConnectionPool& CloudConnectionPool::shared() {
+    static CloudConnectionPool pool;
+    return pool;
+}
+
+CloudConnectionPool::CloudConnectionPool() :
+    mutex(xSemaphoreCreateMutex()),
+    failures(0),
+    evictions(0),
+    idle_closes(0),
+    min_free_heap(UINT32_MAX) {
+    memset(&handshake, 0, sizeof(handshake));
+    memset(&reused, 0, sizeof(reused));
+
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE; i++) {
+        slots[i].client.setInsecure(); // Mesma política dos clientes atuais (sem CA fixada)
+        slots[i].http.setReuse(true);
+        slots[i].http.setUserAgent("ESP32-Hydro/2.1.0");
+        slots[i].host[0] = '\0';
+        slots[i].last_used = 0;
+        slots[i].requests = 0;
+    }
+}
+
+// ===== REQUISIÇÃO =====
+int CloudConnectionPool::request(const char* method, const String& url, const String& payload,
+                                 const CloudHeader* headers, uint8_t header_count,
+                                 String* response, uint16_t timeout_ms) {
+    return request(method, url.c_str(), payload.c_str(), payload.length(),
+                   headers, header_count, response, timeout_ms);
+}
+
+int CloudConnectionPool::request(const char* method, const char* url, const char* body, size_t length,
+                                 const CloudHeader* headers, uint8_t header_count,
+                                 String* response, uint16_t timeout_ms) {
+    PROFILE_SCOPE("https.request");
+    HEAP_TAG("cloud.https");
+    lock();
+
+    Slot& slot = acquire(url);
+    bool had_session = slot.client.connected();
+    uint32_t heap_before = ESP.getFreeHeap();
+    unsigned long start = millis();
+
+    int code = HTTPC_ERROR_CONNECTION_REFUSED;
+    if (slot.http.begin(slot.client, url)) {
+        slot.http.setReuse(true);
+        slot.http.setConnectTimeout(CLOUD_CONNECT_TIMEOUT_MS);
+        slot.http.setTimeout(timeout_ms);
+        for (uint8_t i = 0; i < header_count; i++) {
+            slot.http.addHeader(headers[i].name, headers[i].value);
+        }
+
+        if (strcmp(method, "GET") == 0) {
+            code = slot.http.GET();
+        } else {
+            code = slot.http.sendRequest(method, (uint8_t*)body, length);
+        }
+
+        // Corpo precisa ser consumido para a sessão continuar reutilizável
+        if (code > 0 && response) {
+            *response = slot.http.getString();
+        }
+        slot.http.end();
+    }
+
+    uint32_t elapsed = millis() - start;
+    uint32_t heap_after = ESP.getFreeHeap();
+    if (heap_after < min_free_heap) min_free_heap = heap_after;
+
+    if (code < 0) {
+        // Sessão quebrada: descarta para o próximo uso abrir outra
+        failures++;
+        slot.client.stop();
+    } else {
+        record(had_session ? reused : handshake, elapsed, (int32_t)heap_before - (int32_t)heap_after);
+    }
+    slot.last_used = millis();
+    slot.requests++;
+
+    unlock();
+    return code;
+}
+
+void CloudConnectionPool::loop() {
+    unsigned long now = millis();
+    bool low_heap = ESP.getFreeHeap() < CLOUD_MIN_HEAP_IDLE;
+
+    lock();
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE; i++) {
+        Slot& slot = slots[i];
+        if (!slot.client.connected()) continue;
+
+        if (low_heap || now - slot.last_used >= CLOUD_IDLE_TIMEOUT_MS) {
+            slot.client.stop();
+            idle_closes++;
+        }
+    }
+    unlock();
+}
+
+void CloudConnectionPool::closeAll() {
+    lock();
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE; i++) {
+        slots[i].client.stop();
+    }
+    unlock();
+}
+
+// ===== STATUS =====
+uint8_t CloudConnectionPool::getOpenConnections() const {
+    uint8_t open = 0;
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE; i++) {
+        if (const_cast<WiFiClientSecure&>(slots[i].client).connected()) open++;
+    }
+    return open;
+}
+
+String CloudConnectionPool::getStatusJSON() const {
+    DynamicJsonDocument doc(512);
+    doc["open"] = getOpenConnections();
+    doc["size"] = CLOUD_POOL_SIZE;
+    doc["failures"] = failures;
+    doc["evictions"] = evictions;
+    doc["idle_closes"] = idle_closes;
+    doc["min_free_heap"] = min_free_heap == UINT32_MAX ? 0 : min_free_heap;
+
+    const Timing* timings[] = {&handshake, &reused};
+    const char* names[] = {"handshake", "reused"};
+    for (uint8_t i = 0; i < 2; i++) {
+        JsonObject entry = doc.createNestedObject(names[i]);
+        entry["requests"] = timings[i]->count;
+        entry["avg_ms"] = timings[i]->count ? timings[i]->total_ms / timings[i]->count : 0;
+        entry["max_ms"] = timings[i]->max_ms;
+        entry["avg_heap_retained"] = timings[i]->count ? timings[i]->heap_total / (int32_t)timings[i]->count : 0;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void CloudConnectionPool::printStatus() const {
+    Serial.println("\n🔐 === CONEXÕES HTTPS ===");
+    Serial.printf("Abertas: %u/%d | Falhas: %lu | Despejos: %lu | Fechadas por ociosidade: %lu\n",
+                 getOpenConnections(), CLOUD_POOL_SIZE, (unsigned long)failures,
+                 (unsigned long)evictions, (unsigned long)idle_closes);
+    Serial.printf("Com handshake: %lu req | média %lums | máx %lums | heap retido %ld bytes\n",
+                 (unsigned long)handshake.count,
+                 (unsigned long)(handshake.count ? handshake.total_ms / handshake.count : 0),
+                 (unsigned long)handshake.max_ms,
+                 (long)(handshake.count ? handshake.heap_total / (int32_t)handshake.count : 0));
+    Serial.printf("Reusadas:      %lu req | média %lums | máx %lums | heap retido %ld bytes\n",
+                 (unsigned long)reused.count,
+                 (unsigned long)(reused.count ? reused.total_ms / reused.count : 0),
+                 (unsigned long)reused.max_ms,
+                 (long)(reused.count ? reused.heap_total / (int32_t)reused.count : 0));
+    Serial.printf("Menor heap livre após requisição: %lu bytes\n",
+                 (unsigned long)(min_free_heap == UINT32_MAX ? 0 : min_free_heap));
+    Serial.println("========================\n");
+}
+
+// ===== MÉTODOS INTERNOS =====
+CloudConnectionPool::Slot& CloudConnectionPool::acquire(const char* url) {
+    const char* host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    const char* end = strchr(host, '/');
+    size_t host_length = end ? (size_t)(end - host) : strlen(host);
+    if (host_length >= sizeof(slots[0].host)) host_length = sizeof(slots[0].host) - 1;
+
+    // 1) Sessão aberta para o mesmo host
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE; i++) {
+        if (strncmp(slots[i].host, host, host_length) == 0 && slots[i].host[host_length] == '\0' &&
+            slots[i].client.connected()) {
+            return slots[i];
+        }
+    }
+
+    // 2) Slot livre (sem sessão)
+    uint8_t chosen = CLOUD_POOL_SIZE;
+    for (uint8_t i = 0; i < CLOUD_POOL_SIZE && chosen == CLOUD_POOL_SIZE; i++) {
+        if (!slots[i].client.connected()) chosen = i;
+    }
+
+    // 3) Despeja a sessão usada há mais tempo
+    if (chosen == CLOUD_POOL_SIZE) {
+        chosen = 0;
+        for (uint8_t i = 1; i < CLOUD_POOL_SIZE; i++) {
+            if (slots[i].last_used < slots[chosen].last_used) chosen = i;
+        }
+        slots[chosen].client.stop();
+        evictions++;
+    }
+
+    memcpy(slots[chosen].host, host, host_length);
+    slots[chosen].host[host_length] = '\0';
+    return slots[chosen];
+}
+
+void CloudConnectionPool::record(Timing& timing, uint32_t elapsed_ms, int32_t heap_delta) {
+    timing.count++;
+    timing.total_ms += elapsed_ms;
+    if (elapsed_ms > timing.max_ms) timing.max_ms = elapsed_ms;
+    timing.heap_total += heap_delta;
+}
+
+void CloudConnectionPool::lock() {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void CloudConnectionPool::unlock() {
+    if (mutex) xSemaphoreGive(mutex);
+}
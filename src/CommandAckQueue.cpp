@@ -0,0 +1,168 @@
+#include "CommandAckQueue.h"
+#include <ArduinoJson.h>
+
+CommandAckQueue::CommandAckQueue(BatchSender sender) :
+    batch_sender(sender),
+    count(0),
+    window_start(0),
+    retry_at(0),
+    acks_added(0),
+    coalesced(0),
+    requests(0),
+    push_acks(0),
+    failures(0),
+    refused(0) {
+}
+
+// ===== CONTROLE =====
+bool CommandAckQueue::add(int commandId, CommandAckStatus status, const char* errorMessage) {
+    if (commandId <= 0) return true;
+    acks_added++;
+
+    // Conclusão vai já pelo socket; o PATCH em lote registra no banco depois
+    if (status != COMMAND_ACK_SENT && push_sender && push_sender(commandId, statusName(status))) {
+        push_acks++;
+    }
+
+    int slot = find(commandId);
+    if (slot >= 0) {
+        // Estado mais avançado substitui o pendente (sent -> completed/failed)
+        PendingAck& entry = entries[slot];
+        if (status >= entry.status) {
+            entry.status = status;
+            strncpy(entry.error, errorMessage ? errorMessage : "", sizeof(entry.error) - 1);
+            entry.error[sizeof(entry.error) - 1] = '\0';
+        }
+        coalesced++;
+        return true;
+    }
+
+    if (count == COMMAND_ACK_CAPACITY) {
+        // Sem espaço: envia já em vez de descartar uma conclusão pendente
+        // (com o estado "sent" no banco, o polling não a recuperaria)
+        if (!retry_at || (long)(millis() - retry_at) >= 0) {
+            flush();
+        }
+        if (count == COMMAND_ACK_CAPACITY) {
+            if (refused++ == 0) {
+                Serial.println("⚠️ Fila de confirmações cheia - novas recusadas até o PATCH passar");
+            }
+            return false;
+        }
+    }
+
+    if (count == 0) {
+        window_start = millis();
+    }
+
+    PendingAck& entry = entries[count++];
+    entry.id = commandId;
+    entry.status = status;
+    strncpy(entry.error, errorMessage ? errorMessage : "", sizeof(entry.error) - 1);
+    entry.error[sizeof(entry.error) - 1] = '\0';
+    return true;
+}
+
+void CommandAckQueue::loop() {
+    if (count == 0) return;
+
+    unsigned long now = millis();
+    if (retry_at && (long)(now - retry_at) < 0) return;
+
+    // Janela esgotada ou lote cheio: agrupa e envia
+    if (count >= COMMAND_ACK_BATCH_MAX || now - window_start >= COMMAND_ACK_FLUSH_WINDOW_MS) {
+        flush();
+    }
+}
+
+bool CommandAckQueue::flush() {
+    if (count == 0) return true;
+
+    if (!batch_sender) {
+        retry_at = millis() + COMMAND_ACK_RETRY_MS;
+        return false;
+    }
+
+    while (count > 0) {
+        // Grupo = estado + mensagem da confirmação mais antiga
+        CommandAckStatus status = entries[0].status;
+        char error[COMMAND_ACK_ERROR_SIZE];
+        memcpy(error, entries[0].error, sizeof(error));
+
+        int ids[COMMAND_ACK_BATCH_MAX];
+        bool selected[COMMAND_ACK_CAPACITY] = {false};
+        uint8_t group = 0;
+        for (uint8_t i = 0; i < count && group < COMMAND_ACK_BATCH_MAX; i++) {
+            if (entries[i].status == status && strcmp(entries[i].error, error) == 0) {
+                ids[group++] = entries[i].id;
+                selected[i] = true;
+            }
+        }
+
+        requests++;
+        if (!batch_sender(ids, group, statusName(status), error[0] ? error : nullptr)) {
+            failures++;
+            retry_at = millis() + COMMAND_ACK_RETRY_MS;
+            Serial.printf("⚠️ Confirmação de %u comandos falhou - nova tentativa em %lus\n",
+                         group, (unsigned long)(COMMAND_ACK_RETRY_MS / 1000));
+            return false;
+        }
+
+        remove(selected);
+    }
+
+    retry_at = 0;
+    return true;
+}
+
+// ===== STATUS =====
+const char* CommandAckQueue::statusName(CommandAckStatus status) {
+    switch (status) {
+        case COMMAND_ACK_SENT: return "sent";
+        case COMMAND_ACK_COMPLETED: return "completed";
+        case COMMAND_ACK_FAILED: return "failed";
+        default: return "failed";
+    }
+}
+
+String CommandAckQueue::getStatusJSON() const {
+    DynamicJsonDocument doc(256);
+    doc["pending"] = count;
+    doc["acks"] = acks_added;
+    doc["coalesced"] = coalesced;
+    doc["requests"] = requests;
+    doc["push_acks"] = push_acks;
+    doc["failures"] = failures;
+    doc["refused"] = refused;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void CommandAckQueue::printStatus() const {
+    Serial.printf("📨 Confirmações: %lu registradas | %lu PATCH | %lu fundidas | %lu via socket\n",
+                 (unsigned long)acks_added, (unsigned long)requests,
+                 (unsigned long)coalesced, (unsigned long)push_acks);
+    Serial.printf("📨 Pendentes: %u | Falhas: %lu | Recusadas (cheia): %lu\n",
+                 count, (unsigned long)failures, (unsigned long)refused);
+}
+
+// ===== MÉTODOS INTERNOS =====
+int CommandAckQueue::find(int commandId) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].id == commandId) return i;
+    }
+    return -1;
+}
+
+void CommandAckQueue::remove(const bool* sent) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (sent[i]) continue;
+        if (kept != i) entries[kept] = entries[i];
+        kept++;
+    }
+    count = kept;
+    window_start = millis();
+}
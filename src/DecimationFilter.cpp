@@ -0,0 +1,60 @@
+#include "DecimationFilter.h"
+
+// ===== FILTRO DE DECIMAÇÃO =====
+DecimationFilter::DecimationFilter(uint16_t factor, float alpha) :
+    factor(factor > 0 ? factor : 1),
+    alpha(alpha) {
+    reset();
+}
+
+void DecimationFilter::reset() {
+    accumulator = 0;
+    count = 0;
+    history_size = 0;
+    history_index = 0;
+    output = 0.0;
+    primed = false;
+    output_count = 0;
+    for (int i = 0; i < 3; i++) {
+        history[i] = 0.0;
+    }
+}
+
+bool DecimationFilter::push(uint16_t raw) {
+    accumulator += raw;
+    if (++count < factor) {
+        return false;
+    }
+
+    // Estágio 1: média do bloco
+    float block = (float)accumulator / factor;
+    accumulator = 0;
+    count = 0;
+
+    // Estágio 2: mediana dos 3 últimos blocos
+    history[history_index] = block;
+    history_index = (history_index + 1) % 3;
+    if (history_size < 3) history_size++;
+    float median = medianOfHistory();
+
+    // Estágio 3: passa-baixa IIR
+    if (!primed) {
+        output = median;
+        primed = true;
+    } else {
+        output += alpha * (median - output);
+    }
+    output_count++;
+    return true;
+}
+
+float DecimationFilter::medianOfHistory() const {
+    if (history_size < 3) {
+        return history[(history_index + 2) % 3];  // Bloco mais recente
+    }
+
+    float a = history[0], b = history[1], c = history[2];
+    if (a > b) { float t = a; a = b; b = t; }
+    if (b > c) { b = c; }
+    return (a > b) ? a : b;
+}
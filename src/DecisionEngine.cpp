@@ -1,5 +1,7 @@
 #include "DecisionEngine.h"
 #include <LittleFS.h>
+#include "HistoryFS.h"
+#include "LoopProfiler.h"
 
 // ===== CONSTRUTOR E DESTRUTOR =====
 DecisionEngine::DecisionEngine() : 
@@ -8,7 +10,8 @@ DecisionEngine::DecisionEngine() :
     dry_run_mode(false),
     total_evaluations(0),
     total_actions_executed(0),
-    total_safety_blocks(0) {
+    total_safety_blocks(0),
+    total_health_blocks(0) {
 }
 
 DecisionEngine::~DecisionEngine() {
@@ -19,9 +22,8 @@ DecisionEngine::~DecisionEngine() {
 bool DecisionEngine::begin() {
     Serial.println("🧠 Inicializando Decision Engine...");
     
-    // Inicializar LittleFS se não estiver inicializado
-    if (!LittleFS.begin()) {
-        Serial.println("❌ Erro ao inicializar LittleFS");
+    // Regras ficam no LittleFS da partição de histórico (montagem compartilhada)
+    if (!HistoryFS::mount("DecisionEngine")) {
         return false;
     }
     
@@ -45,6 +47,7 @@ void DecisionEngine::loop() {
     
     // Verificar se é hora de avaliar regras
     if (now - last_evaluation >= evaluation_interval) {
+        PROFILE_SCOPE("rules.evaluate");
         evaluateAllRules();
         last_evaluation = now;
         total_evaluations++;
@@ -213,10 +216,19 @@ void DecisionEngine::evaluateAllRules() {
         // Avaliar condição principal
         if (!evaluateCondition(rule.condition, current_state)) continue;
         
+        // Não agir sobre dados de um sensor degradado
+        String unhealthy_sensor;
+        if (findUnhealthySensor(rule.condition, unhealthy_sensor)) {
+            total_health_blocks++;
+            Serial.printf("🩺 Regra %s bloqueada - sensor %s degradado\n", rule.name.c_str(), unhealthy_sensor.c_str());
+            logRuleExecution(rule.id, EVENT_RULE_BLOCKED_HEALTH);
+            continue;
+        }
+        
         // Verificar interlocks de segurança
         if (!checkSafetyConstraints(rule, current_state)) {
             total_safety_blocks++;
-            logRuleExecution(rule.id, "BLOCKED_BY_SAFETY", false);
+            logRuleExecution(rule.id, EVENT_RULE_BLOCKED_SAFETY);
             continue;
         }
         
@@ -233,7 +245,7 @@ void DecisionEngine::evaluateAllRules() {
             total_actions_executed++;
         }
         
-        logRuleExecution(rule.id, "EXECUTED", true);
+        logRuleExecution(rule.id, EVENT_RULE_EXECUTED);
         
         // Se trigger é on_change, marcar como executado
         if (rule.trigger_type == "on_change") {
@@ -345,6 +357,9 @@ void DecisionEngine::executeActions(const std::vector<RuleAction>& actions, cons
                 
             case SUPABASE_UPDATE:
                 // Implementar atualização Supabase
+                if (rule_event_callback) {
+                    rule_event_callback(EVENT_RULE_SUPABASE, rule_id);
+                }
                 if (log_callback) {
                     log_callback("SUPABASE_UPDATE", "Rule: " + rule_id + " - " + action.message);
                 }
@@ -364,9 +379,29 @@ float DecisionEngine::getSensorValue(const String& sensor_name, const SystemStat
     if (sensor_name == "uptime") return state.uptime / 1000.0; // em segundos
     if (sensor_name == "free_heap") return state.free_heap;
     
+    // Canais registrados no barramento de sensores (ORP, OD, vazão...)
+    float value;
+    if (sensor_value_callback && sensor_value_callback(sensor_name, value)) {
+        return value;
+    }
+    
     return 0.0;
 }
 
+bool DecisionEngine::findUnhealthySensor(const RuleCondition& condition, String& sensor_name) {
+    if (!sensor_health_callback) return false;
+    
+    if (condition.type == SENSOR_COMPARE && !sensor_health_callback(condition.sensor_name)) {
+        sensor_name = condition.sensor_name;
+        return true;
+    }
+    
+    for (const auto& sub_cond : condition.sub_conditions) {
+        if (findUnhealthySensor(sub_cond, sensor_name)) return true;
+    }
+    return false;
+}
+
 bool DecisionEngine::compareValues(float sensor_value, CompareOperator op, float target_min, float target_max) {
     switch (op) {
         case OP_LESS_THAN: return sensor_value < target_min;
@@ -382,6 +417,17 @@ bool DecisionEngine::compareValues(float sensor_value, CompareOperator op, float
 }
 
 void DecisionEngine::executeRelayAction(const RuleAction& action, const String& rule_id) {
+    if (action.type == RELAY_PWM) {
+        // PWM lento: value = duty (%), repeat_interval_ms = janela, duration_ms = tempo total
+        if (pwm_control_callback) {
+            pwm_control_callback(action.target_relay, action.value, action.repeat_interval_ms, action.duration_ms);
+            
+            Serial.printf("⚡ Executando PWM relé %d: %.1f%% por %lu ms (regra: %s)\n",
+                         action.target_relay, action.value, action.duration_ms, rule_id.c_str());
+        }
+        return;
+    }
+    
     if (relay_control_callback) {
         bool state = (action.type == RELAY_ON || action.type == RELAY_PULSE);
         relay_control_callback(action.target_relay, state, action.duration_ms);
@@ -399,6 +445,9 @@ void DecisionEngine::executeSystemAlert(const RuleAction& action, const String&
 }
 
 void DecisionEngine::executeLogEvent(const RuleAction& action, const String& rule_id) {
+    if (rule_event_callback) {
+        rule_event_callback(EVENT_RULE_LOG, rule_id);
+    }
     if (log_callback) {
         log_callback("RULE_EVENT", "Rule: " + rule_id + " - " + action.message);
     }
@@ -428,9 +477,15 @@ void DecisionEngine::updateExecutionCounts(DecisionRule& rule) {
     rule.execution_count_hour++;
 }
 
-void DecisionEngine::logRuleExecution(const String& rule_id, const String& action, bool success) {
+void DecisionEngine::logRuleExecution(const String& rule_id, EventCode code) {
+    // Caminho estruturado: nenhum texto montado por disparo
+    if (rule_event_callback) {
+        rule_event_callback(code, rule_id);
+        return;
+    }
     if (log_callback) {
-        String log_data = "Rule: " + rule_id + ", Action: " + action + ", Success: " + (success ? "true" : "false");
+        String log_data = "Rule: " + rule_id + ", Action: " + EventLog::codeName(code) +
+                          ", Success: " + (code == EVENT_RULE_EXECUTED ? "true" : "false");
         log_callback("RULE_EXECUTION", log_data);
     }
 }
@@ -471,6 +526,11 @@ bool DecisionEngine::validateRule(const DecisionRule& rule, String& error_messag
             error_message = "Ação PULSE deve ter duração > 0";
             return false;
         }
+        
+        if (action.type == RELAY_PWM && (action.value < 0.0 || action.value > 100.0)) {
+            error_message = "Ação PWM deve ter duty entre 0 e 100%";
+            return false;
+        }
     }
     
     return true;
@@ -482,6 +542,7 @@ void DecisionEngine::printStatistics() {
     Serial.printf("🔄 Total de avaliações: %lu\n", total_evaluations);
     Serial.printf("⚡ Total de ações executadas: %lu\n", total_actions_executed);
     Serial.printf("🛡️ Total bloqueios de segurança: %lu\n", total_safety_blocks);
+    Serial.printf("🩺 Total bloqueios por sensor degradado: %lu\n", total_health_blocks);
     Serial.printf("📋 Regras carregadas: %d\n", rules.size());
     Serial.printf("🧪 Modo dry-run: %s\n", dry_run_mode ? "ATIVADO" : "DESATIVADO");
     Serial.printf("⏱️ Intervalo de avaliação: %lu ms\n", evaluation_interval);
@@ -9,15 +9,12 @@ DecisionEngineIntegration::DecisionEngineIntegration(DecisionEngine* engine, Hyd
     supabase(supa),
     emergency_mode(false),
     manual_override_active(false),
+    sensor_subscription(-1),
     total_relay_commands(0),
     total_alerts_sent(0),
-    total_supabase_updates(0),
-    log_index(0) {
+    total_supabase_updates(0) {
     
-    // Limpar buffer de logs
-    for (size_t i = 0; i < LOG_BUFFER_SIZE; i++) {
-        execution_log[i] = "";
-    }
+    memset(sensor_timestamps, 0, sizeof(sensor_timestamps));
 }
 
 DecisionEngineIntegration::~DecisionEngineIntegration() {
@@ -38,6 +35,17 @@ bool DecisionEngineIntegration::begin() {
         this->handleRelayControl(relay, state, duration);
     });
     
+    engine->setPWMControlCallback([this](int relay, float duty_percent, unsigned long period_ms, unsigned long duration_ms) {
+        this->handleRelayPWM(relay, duty_percent, period_ms, duration_ms);
+    });
+    
+    // Saída do PWM: apenas transições do registrador sombra chegam ao hardware
+    pwm_scheduler.setRelayWriteCallback([this](int relay, bool state) {
+        this->hydroControl->setRelay(relay, state);
+    });
+    
+    dosing_limiter.begin();
+    
     engine->setAlertCallback([this](const String& message, bool is_critical) {
         this->handleAlert(message, is_critical);
     });
@@ -46,6 +54,36 @@ bool DecisionEngineIntegration::begin() {
         this->handleLogEvent(event, data);
     });
     
+    // Disparos de regras entram no log de eventos como registros binários
+    event_log.begin();
+    engine->setRuleEventCallback([this](EventCode code, const String& rule_id) {
+        this->handleRuleEvent(code, rule_id);
+    });
+    
+    // Regras que leem sensores degradados ficam bloqueadas
+    engine->setSensorHealthCallback([this](const String& sensor_name) {
+        return this->isSensorUsable(sensor_name);
+    });
+    
+    // Sensores registrados depois (ORP, OD...) ficam disponíveis nas regras pela chave
+    engine->setSensorValueCallback([this](const String& sensor_name, float& value) {
+        return this->readRegisteredSensor(sensor_name, value);
+    });
+    
+    // Leituras chegam pelo barramento (no loop principal), sem cópias por polling
+    sensor_subscription = hydroControl->getSensorBus().subscribe(
+        SensorBus::maskOf(SENSOR_PH) | SensorBus::maskOf(SENSOR_TDS) | SensorBus::maskOf(SENSOR_EC) |
+        SensorBus::maskOf(SENSOR_WATER_TEMP) | SensorBus::maskOf(SENSOR_WATER_LEVEL),
+        [this](const SensorReading& reading) { this->handleSensorReading(reading); });
+    
+    hydroControl->getSensorHealth().setHealthChangeCallback(
+        [this](SensorChannel channel, SensorHealthLevel level, const String& reason) {
+            if (level >= SENSOR_HEALTH_DEGRADED) {
+                this->handleAlert(String("Sensor ") + SensorHealthMonitor::channelName(channel) + " " +
+                                  SensorHealthMonitor::levelToString(level) + ": " + reason, false);
+            }
+        });
+    
     Serial.println("✅ DecisionEngine Integration inicializada");
     Serial.printf("🔧 Callbacks configurados\n");
     Serial.printf("🛡️ Modo emergência: %s\n", emergency_mode ? "ATIVO" : "INATIVO");
@@ -54,6 +92,15 @@ bool DecisionEngineIntegration::begin() {
 }
 
 void DecisionEngineIntegration::loop() {
+    // Avançar canais PWM (antes de tudo, para manter a temporização)
+    pwm_scheduler.update();
+    
+    // Persistência espaçada dos contadores de dosagem
+    dosing_limiter.loop();
+    
+    // Despejo dos eventos pendentes na flash (em lotes)
+    event_log.loop();
+    
     // Atualizar estado do sistema com dados dos sensores
     updateSystemStateFromSensors();
     
@@ -70,6 +117,13 @@ void DecisionEngineIntegration::loop() {
 
 void DecisionEngineIntegration::end() {
     Serial.println("🔗 Finalizando DecisionEngine Integration...");
+    pwm_scheduler.stopAll();
+    dosing_limiter.end();
+    event_log.flush();
+    if (hydroControl && sensor_subscription >= 0) {
+        hydroControl->getSensorBus().unsubscribe(sensor_subscription);
+        sensor_subscription = -1;
+    }
     locked_relays.clear();
 }
 
@@ -84,7 +138,7 @@ void DecisionEngineIntegration::setEmergencyMode(bool enabled) {
             emergencyShutdown("Modo emergência ativado manualmente");
         }
         
-        addToExecutionLog("Emergency mode " + String(enabled ? "ENABLED" : "DISABLED"));
+        event_log.record(EVENT_EMERGENCY_MODE, EVENT_LOG_NO_RELAY, enabled ? 1.0 : 0.0);
     }
 }
 
@@ -101,7 +155,7 @@ void DecisionEngineIntegration::setManualOverride(bool enabled) {
             Serial.println("✅ DecisionEngine retomou operação normal");
         }
         
-        addToExecutionLog("Manual override " + String(enabled ? "ENABLED" : "DISABLED"));
+        event_log.record(EVENT_MANUAL_OVERRIDE, EVENT_LOG_NO_RELAY, enabled ? 1.0 : 0.0);
     }
 }
 
@@ -112,8 +166,9 @@ void DecisionEngineIntegration::lockRelay(int relay_id) {
             if (locked == relay_id) return; // Já está travado
         }
         locked_relays.push_back(relay_id);
+        pwm_scheduler.stop(relay_id);
         Serial.printf("🔒 Relé %d travado\n", relay_id);
-        addToExecutionLog("Relay " + String(relay_id) + " LOCKED");
+        event_log.record(EVENT_RELAY_LOCKED, relay_id);
     }
 }
 
@@ -122,7 +177,7 @@ void DecisionEngineIntegration::unlockRelay(int relay_id) {
         if (*it == relay_id) {
             locked_relays.erase(it);
             Serial.printf("🔓 Relé %d destravado\n", relay_id);
-            addToExecutionLog("Relay " + String(relay_id) + " UNLOCKED");
+            event_log.record(EVENT_RELAY_UNLOCKED, relay_id);
             break;
         }
     }
@@ -132,7 +187,7 @@ void DecisionEngineIntegration::unlockAllRelays() {
     int count = locked_relays.size();
     locked_relays.clear();
     Serial.printf("🔓 Todos os relés destravados (%d relés)\n", count);
-    addToExecutionLog("All relays UNLOCKED (" + String(count) + " relays)");
+    event_log.record(EVENT_RELAYS_UNLOCKED_ALL, EVENT_LOG_NO_RELAY, count);
 }
 
 bool DecisionEngineIntegration::isRelayLocked(int relay_id) {
@@ -148,13 +203,13 @@ void DecisionEngineIntegration::updateSystemStateFromSensors() {
     
     SystemState state;
     
-    // Dados dos sensores
-    state.ph = hydroControl->getpH();
-    state.tds = hydroControl->getTDS();
-    state.ec = hydroControl->getEC();
-    state.temp_water = hydroControl->getWaterTemp();
+    // Dados dos sensores: últimos valores entregues pelo barramento
+    state.ph = sensor_state.ph;
+    state.tds = sensor_state.tds;
+    state.ec = sensor_state.ec;
+    state.temp_water = sensor_state.temp_water;
     state.temp_environment = hydroControl->getTemperature();
-    state.water_level_ok = hydroControl->isWaterLevelOk();
+    state.water_level_ok = sensor_state.water_level_ok;
     
     // Estados dos relés
     bool* relay_states = hydroControl->getRelayStates();
@@ -167,7 +222,16 @@ void DecisionEngineIntegration::updateSystemStateFromSensors() {
     state.supabase_connected = (supabase && supabase->isReady());
     state.uptime = millis();
     state.free_heap = ESP.getFreeHeap();
+    
+    // Timestamp da amostra mais antiga entre as usadas nas regras
     state.last_update = millis();
+    const SensorChannel rule_channels[] = {SENSOR_PH, SENSOR_TDS, SENSOR_WATER_TEMP};
+    for (SensorChannel channel : rule_channels) {
+        uint32_t timestamp = sensor_timestamps[channel];
+        if (timestamp != 0 && (long)(timestamp - state.last_update) < 0) {
+            state.last_update = timestamp;
+        }
+    }
     
     // Atualizar o DecisionEngine
     engine->updateSystemState(state);
@@ -180,39 +244,84 @@ SystemState DecisionEngineIntegration::getCurrentSystemState() {
 }
 
 // ===== CALLBACKS =====
+void DecisionEngineIntegration::handleSensorReading(const SensorReading& reading) {
+    if (reading.channel == SENSOR_WATER_LEVEL) {
+        sensor_state.water_level_ok = reading.isGood() && reading.value > 0.5;
+        return;
+    }
+    
+    // Leitura inválida mantém o último valor válido (regras bloqueadas pela saúde)
+    if (reading.quality & (SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_NO_DATA)) return;
+    
+    switch (reading.channel) {
+        case SENSOR_PH: sensor_state.ph = reading.value; break;
+        case SENSOR_TDS: sensor_state.tds = reading.value; break;
+        case SENSOR_EC: sensor_state.ec = reading.value; break;
+        case SENSOR_WATER_TEMP: sensor_state.temp_water = reading.value; break;
+        default: return;
+    }
+    sensor_timestamps[reading.channel] = reading.timestamp;
+}
+
+bool DecisionEngineIntegration::isSensorUsable(const String& sensor_name) {
+    SensorBus& bus = hydroControl->getSensorBus();
+    SensorChannel channel = bus.findChannel(sensor_name);
+    if (channel == SENSOR_CHANNEL_INVALID) {
+        return hydroControl->getSensorHealth().isUsable(sensor_name);
+    }
+    
+    SensorReading reading;
+    if (!bus.read(channel, reading, millis())) return false;
+    return !(reading.quality & (SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_STALE |
+                                SAMPLE_QUALITY_DEGRADED | SAMPLE_QUALITY_NO_DATA));
+}
+
+bool DecisionEngineIntegration::readRegisteredSensor(const String& sensor_name, float& value) {
+    SensorBus& bus = hydroControl->getSensorBus();
+    SensorChannel channel = bus.findChannel(sensor_name);
+    SensorReading reading;
+    if (channel == SENSOR_CHANNEL_INVALID || !bus.read(channel, reading, millis())) return false;
+    
+    value = reading.value;
+    return true;
+}
+
 void DecisionEngineIntegration::handleRelayControl(int relay, bool state, unsigned long duration) {
     total_relay_commands++;
     
     // Verificar se está em modo emergência
     if (emergency_mode) {
         Serial.printf("🚨 Comando de relé bloqueado - modo emergência ativo (relé %d)\n", relay);
-        addToExecutionLog("Relay command BLOCKED - emergency mode (relay " + String(relay) + ")");
+        event_log.record(EVENT_RELAY_BLOCKED_EMERGENCY, relay);
         return;
     }
     
     // Verificar se o relé está travado
     if (isRelayLocked(relay)) {
         Serial.printf("🔒 Comando de relé bloqueado - relé travado (relé %d)\n", relay);
-        addToExecutionLog("Relay command BLOCKED - relay locked (relay " + String(relay) + ")");
+        event_log.record(EVENT_RELAY_BLOCKED_LOCK, relay);
         return;
     }
     
     // Validar comando
     if (!validateRelayCommand(relay, state, duration)) {
         Serial.printf("❌ Comando de relé inválido (relé %d, estado %d, duração %lu)\n", relay, state, duration);
-        addToExecutionLog("Relay command INVALID (relay " + String(relay) + ")");
+        event_log.record(EVENT_RELAY_INVALID, relay, duration);
         return;
     }
     
+    // Comando direto tem prioridade sobre PWM em andamento
+    pwm_scheduler.stop(relay);
+    
     // Executar comando
     if (duration > 0) {
         hydroControl->toggleRelay(relay, duration / 1000); // HydroControl usa segundos
         Serial.printf("⚡ Relé %d acionado por %lu ms\n", relay, duration);
-        addToExecutionLog("Relay " + String(relay) + " pulsed for " + String(duration) + "ms");
+        event_log.record(EVENT_RELAY_PULSE, relay, duration);
     } else {
         hydroControl->toggleRelay(relay, 0); // Toggle permanente
         Serial.printf("⚡ Relé %d %s\n", relay, state ? "ligado" : "desligado");
-        addToExecutionLog("Relay " + String(relay) + " " + (state ? "ON" : "OFF"));
+        event_log.record(state ? EVENT_RELAY_ON : EVENT_RELAY_OFF, relay);
     }
     
     // Atualizar Supabase se disponível
@@ -221,12 +330,41 @@ void DecisionEngineIntegration::handleRelayControl(int relay, bool state, unsign
     }
 }
 
+void DecisionEngineIntegration::handleRelayPWM(int relay, float duty_percent, unsigned long period_ms, unsigned long duration_ms) {
+    total_relay_commands++;
+    
+    if (emergency_mode) {
+        Serial.printf("🚨 PWM bloqueado - modo emergência ativo (relé %d)\n", relay);
+        event_log.record(EVENT_PWM_BLOCKED_EMERGENCY, relay, duty_percent);
+        return;
+    }
+    
+    if (isRelayLocked(relay)) {
+        Serial.printf("🔒 PWM bloqueado - relé travado (relé %d)\n", relay);
+        event_log.record(EVENT_PWM_BLOCKED_LOCK, relay, duty_percent);
+        return;
+    }
+    
+    // Para o limitador de dosagem vale o tempo efetivamente ligado; a
+    // mistura só começa quando o ciclo inteiro (duration_ms) termina
+    unsigned long dose_ms = (unsigned long)(duration_ms * (duty_percent / 100.0));
+    if (!validateRelayCommand(relay, duty_percent > 0.0, dose_ms, duration_ms)) {
+        Serial.printf("❌ Comando PWM inválido (relé %d, duty %.1f%%)\n", relay, duty_percent);
+        event_log.record(EVENT_PWM_INVALID, relay, duty_percent);
+        return;
+    }
+    
+    if (pwm_scheduler.start(relay, duty_percent, period_ms, duration_ms)) {
+        event_log.record(EVENT_RELAY_PWM, relay, duty_percent);
+    }
+}
+
 void DecisionEngineIntegration::handleAlert(const String& message, bool is_critical) {
     total_alerts_sent++;
     
     if (is_critical) {
         Serial.println("🚨 ALERTA CRÍTICO: " + message);
-        addToExecutionLog("CRITICAL ALERT: " + message);
+        event_log.record(EVENT_ALERT_CRITICAL);
         
         // Para alertas críticos, considerar modo emergência
         if (!emergency_mode) {
@@ -235,7 +373,7 @@ void DecisionEngineIntegration::handleAlert(const String& message, bool is_criti
         }
     } else {
         Serial.println("🔔 Alerta: " + message);
-        addToExecutionLog("ALERT: " + message);
+        event_log.record(EVENT_ALERT);
     }
     
     // Enviar para Supabase se disponível
@@ -258,7 +396,10 @@ void DecisionEngineIntegration::handleAlert(const String& message, bool is_criti
 void DecisionEngineIntegration::handleLogEvent(const String& event, const String& data) {
     String log_entry = "[" + event + "] " + data;
     Serial.println("📝 " + log_entry);
-    addToExecutionLog(log_entry);
+    
+    if (rule_event_listener) {
+        rule_event_listener(event, data);
+    }
     
     // Log detalhado pode ir para Supabase também
     if (supabase && supabase->isReady() && event != "RULE_EXECUTION") {
@@ -267,8 +408,17 @@ void DecisionEngineIntegration::handleLogEvent(const String& event, const String
     }
 }
 
+void DecisionEngineIntegration::handleRuleEvent(EventCode code, const String& rule_id) {
+    event_log.record(code, EVENT_LOG_NO_RELAY, 0.0, EventLog::ruleKey(rule_id));
+    
+    // RULE_LOG e RULE_SUPABASE chegam ao SSE com a mensagem, via handleLogEvent
+    if (rule_event_listener && code != EVENT_RULE_LOG && code != EVENT_RULE_SUPABASE) {
+        rule_event_listener(EventLog::codeName(code), rule_id);
+    }
+}
+
 // ===== VALIDAÇÃO E SEGURANÇA =====
-bool DecisionEngineIntegration::validateRelayCommand(int relay_id, bool state, unsigned long duration) {
+bool DecisionEngineIntegration::validateRelayCommand(int relay_id, bool state, unsigned long duration, unsigned long run_ms) {
     // Verificar ID do relé
     if (relay_id < 0 || relay_id >= MAX_RELAYS) {
         Serial.printf("❌ ID de relé inválido: %d\n", relay_id);
@@ -300,6 +450,20 @@ bool DecisionEngineIntegration::validateRelayCommand(int relay_id, bool state, u
         return false;
     }
     
+    // Bombas dosadoras: volume, limites por hora/dia e tempo de mistura
+    // (último passo, pois debita a dose quando autorizada)
+    if (state) {
+        String reason;
+        if (!dosing_limiter.tryDose(relay_id, duration, run_ms ? run_ms : duration, millis(), &reason)) {
+            Serial.printf("❌ Dosagem bloqueada para relé %d: %s\n", relay_id, reason.c_str());
+            event_log.record(EVENT_DOSING_BLOCKED, relay_id, duration);
+            return false;
+        }
+        
+        // Dose autorizada: o sensor correspondente precisa reagir dentro do prazo
+        hydroControl->getSensorHealth().notifyDosing(relay_id, millis());
+    }
+    
     return true;
 }
 
@@ -343,16 +507,19 @@ void DecisionEngineIntegration::performSafetyChecks() {
 void DecisionEngineIntegration::emergencyShutdown(const String& reason) {
     Serial.println("🚨 PARADA DE EMERGÊNCIA: " + reason);
     
+    // Encerrar todo PWM antes de desligar os relés
+    pwm_scheduler.stopAll();
+    
     // Desligar relés críticos
     int critical_relays[] = {0, 1, 2, 5}; // Bombas principais e aquecedor
     for (int relay : critical_relays) {
         if (hydroControl) {
-            hydroControl->toggleRelay(relay, 0); // Desligar
+            hydroControl->setRelay(relay, false); // Desligar
         }
     }
     
     setEmergencyMode(true);
-    addToExecutionLog("EMERGENCY SHUTDOWN: " + reason);
+    event_log.record(EVENT_EMERGENCY_SHUTDOWN);
     
     // Notificar via Supabase
     if (supabase && supabase->isReady()) {
@@ -436,10 +603,12 @@ void DecisionEngineIntegration::sendTelemetryToSupabase() {
 }
 
 // ===== MÉTODOS AUXILIARES =====
-void DecisionEngineIntegration::addToExecutionLog(const String& log_entry) {
-    String timestamp = String(millis() / 1000) + "s: ";
-    execution_log[log_index] = timestamp + log_entry;
-    log_index = (log_index + 1) % LOG_BUFFER_SIZE;
+String DecisionEngineIntegration::resolveRuleKey(uint16_t rule_key) {
+    // Chave de 16 bits de volta ao id, procurando nas regras carregadas
+    for (const auto& rule : engine->getAllRules()) {
+        if (EventLog::ruleKey(rule.id) == rule_key) return rule.id;
+    }
+    return "#" + String((unsigned int)rule_key, HEX);
 }
 
 bool DecisionEngineIntegration::isSystemHealthy() {
@@ -470,25 +639,34 @@ String DecisionEngineIntegration::getExecutionLogJSON() {
     DynamicJsonDocument doc(2048);
     JsonArray logs = doc.createNestedArray("execution_log");
     
-    // Adicionar logs em ordem cronológica
-    for (size_t i = 0; i < LOG_BUFFER_SIZE; i++) {
-        size_t index = (log_index + i) % LOG_BUFFER_SIZE;
-        if (!execution_log[index].isEmpty()) {
-            logs.add(execution_log[index]);
-        }
-    }
+    // Últimos eventos em ordem cronológica, texto montado só aqui
+    uint32_t next = event_log.getNextSequence();
+    char text[EVENT_LOG_TEXT_SIZE];
+    event_log.forEach(next > RECENT_LOG_SIZE ? next - RECENT_LOG_SIZE : 0, RECENT_LOG_SIZE,
+        [&](const EventRecord& record) {
+            String rule_id = record.rule != EVENT_LOG_NO_RULE ? resolveRuleKey(record.rule) : String();
+            EventLog::describe(record, text, sizeof(text), rule_id.c_str());
+            logs.add(String(record.timestamp / 1000) + "s: " + text);
+            return true;
+        });
     
     doc["emergency_mode"] = emergency_mode;
     doc["manual_override"] = manual_override_active;
     doc["total_commands"] = total_relay_commands;
     doc["total_alerts"] = total_alerts_sent;
     doc["locked_relays"] = locked_relays.size();
+    doc["pwm_active"] = pwm_scheduler.getActiveCount();
+    doc["events_logged"] = event_log.getNextSequence();
     
     String result;
     serializeJson(doc, result);
     return result;
 }
 
+String DecisionEngineIntegration::getEventLogJSON(size_t limit) {
+    return event_log.getJSON(limit, [this](uint16_t rule_key) { return resolveRuleKey(rule_key); });
+}
+
 void DecisionEngineIntegration::printIntegrationStatistics() {
     Serial.println("\n🔗 === ESTATÍSTICAS DE INTEGRAÇÃO ===");
     Serial.printf("⚡ Comandos de relé executados: %lu\n", total_relay_commands);
@@ -497,6 +675,8 @@ void DecisionEngineIntegration::printIntegrationStatistics() {
     Serial.printf("🚨 Modo emergência: %s\n", emergency_mode ? "ATIVO" : "INATIVO");
     Serial.printf("🔧 Override manual: %s\n", manual_override_active ? "ATIVO" : "INATIVO");
     Serial.printf("🔒 Relés travados: %d\n", locked_relays.size());
+    Serial.printf("〰️ Canais PWM ativos: %d\n", pwm_scheduler.getActiveCount());
+    dosing_limiter.printStatus();
     Serial.printf("🛡️ Sistema saudável: %s\n", isSystemHealthy() ? "SIM" : "NÃO");
     Serial.println("=====================================\n");
 }
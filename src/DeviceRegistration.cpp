@@ -1,4 +1,5 @@
 #include "DeviceRegistration.h"
+#include "CloudConnectionPool.h"
 
 DeviceRegistration::DeviceRegistration() : 
     isRegistered(false),
@@ -94,30 +95,30 @@ bool DeviceRegistration::makeSupabaseRequest(const String& endpoint, const Strin
         return false;
     }
     
-    http.begin(supabaseUrl + endpoint);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("apikey", supabaseKey);
-    http.addHeader("Authorization", "Bearer " + supabaseKey);
-    http.setTimeout(10000);
+    String authHeader = "Bearer " + supabaseKey;
+    const CloudHeader headers[] = {
+        {"Content-Type", "application/json"},
+        {"apikey", supabaseKey.c_str()},
+        {"Authorization", authHeader.c_str()},
+    };
     
     Serial.println("🌐 Fazendo requisição para: " + supabaseUrl + endpoint);
     
-    int httpCode = http.POST(payload);
+    String body;
+    int httpCode = CloudConnectionPool::shared().request("POST", supabaseUrl + endpoint, payload,
+                                                         headers, 3, &body, 10000);
     
     if (httpCode == 200) {
-        response = http.getString();
-        http.end();
+        response = body;
         return true;
     } else {
         lastError = "HTTP Error: " + String(httpCode);
         if (httpCode > 0) {
-            String errorResponse = http.getString();
-            Serial.println("❌ Erro HTTP " + String(httpCode) + ": " + errorResponse);
-            lastError += " - " + errorResponse;
+            Serial.println("❌ Erro HTTP " + String(httpCode) + ": " + body);
+            lastError += " - " + body;
         } else {
             Serial.println("❌ Erro de conexão: " + String(httpCode));
         }
-        http.end();
         return false;
     }
 }
@@ -1,4 +1,7 @@
 #include "DiagWebServer.h"
+#include "LoopProfiler.h"
+#include "TraceRecorder.h"
+#include "HeapMonitor.h"
 
 DiagWebServer::DiagWebServer() {
     server = new AsyncWebServer(80);
@@ -6,6 +9,9 @@ DiagWebServer::DiagWebServer() {
     systemStatus = nullptr;
     sensorData = nullptr;
     relayStates = nullptr;
+    statusTopic = SNAPSHOT_INVALID_TOPIC;
+    sensorsTopic = SNAPSHOT_INVALID_TOPIC;
+    relaysTopic = SNAPSHOT_INVALID_TOPIC;
 }
 
 DiagWebServer::~DiagWebServer() {
@@ -22,6 +28,7 @@ void DiagWebServer::begin() {
     }
     
     // Configurar endpoints
+    setupSnapshots();
     setupStaticFiles();
     setupAPIEndpoints();
     setupConfigEndpoints();
@@ -35,20 +42,19 @@ void DiagWebServer::update() {
 }
 
 void DiagWebServer::setupStaticFiles() {
-    server->serveStatic("/", SPIFFS, "/");
+    assets.begin();
     
-    server->on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        request->send(SPIFFS, "/index.html", "text/html");
-    });
+    // Páginas principais com gzip + ETag; o restante segue pelo serveStatic (sem o manifesto)
+    assets.attach(server, "/", "/index.html");
+    assets.attach(server, "/style.css", "/style.css");
+    assets.attach(server, "/script.js", "/script.js");
+    
+    assets.attachFallback(server);
 }
 
-void DiagWebServer::setupAPIEndpoints() {
-    server->on("/status", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        if (!systemStatus) {
-            request->send(503, "application/json", "{\"error\":\"Status não disponível\"}");
-            return;
-        }
-        
+void DiagWebServer::setupSnapshots() {
+    // Status tem uptime e heap: vale por 1s
+    statusTopic = snapshots.registerTopic("status", [this](String& out) {
         StaticJsonDocument<512> doc;
         
         doc["wifi"]["connected"] = systemStatus->wifiConnected;
@@ -58,17 +64,11 @@ void DiagWebServer::setupAPIEndpoints() {
         doc["system"]["freeHeap"] = systemStatus->freeHeap;
         doc["system"]["lastError"] = systemStatus->lastError;
         
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
-    });
+        serializeJson(doc, out);
+    }, nullptr, 1000);
     
-    server->on("/sensors", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        if (!sensorData) {
-            request->send(503, "application/json", "{\"error\":\"Dados dos sensores não disponíveis\"}");
-            return;
-        }
-        
+    // Nova leitura = novo timestamp
+    sensorsTopic = snapshots.registerTopic("sensors", [this](String& out) {
         StaticJsonDocument<512> doc;
         
         doc["environment"]["temperature"] = sensorData->environmentTemp;
@@ -80,17 +80,11 @@ void DiagWebServer::setupAPIEndpoints() {
         doc["timestamp"] = sensorData->timestamp;
         doc["valid"] = sensorData->valid;
         
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
-    });
+        serializeJson(doc, out);
+    }, [this]() { return sensorData ? (uint32_t)sensorData->timestamp : 0; });
     
-    server->on("/relays", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        if (!relayStates) {
-            request->send(503, "application/json", "{\"error\":\"Estado dos relés não disponível\"}");
-            return;
-        }
-        
+    // Máscara dos 8 relés como versão: só reserializa quando algum muda
+    relaysTopic = snapshots.registerTopic("relays", [this](String& out) {
         StaticJsonDocument<1024> doc;
         JsonArray relays = doc.createNestedArray("relays");
         
@@ -104,10 +98,57 @@ void DiagWebServer::setupAPIEndpoints() {
             relay["config"]["safety_lock"] = RELAY_CONFIGS[i].safetyLock;
         }
         
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        serializeJson(doc, out);
+    }, [this]() {
+        uint32_t mask = 0;
+        for (int i = 0; relayStates && i < 8; i++) {
+            if (relayStates[i]) mask |= 1u << i;
+        }
+        return mask;
+    });
+}
+
+void DiagWebServer::setupAPIEndpoints() {
+    snapshots.attach(server, "/status", [this](AsyncWebServerRequest *request) {
+        handleStatus(request);
+    });
+    
+    snapshots.attach(server, "/sensors", [this](AsyncWebServerRequest *request) {
+        handleSensors(request);
+    });
+    
+    snapshots.attach(server, "/relays", [this](AsyncWebServerRequest *request) {
+        handleRelays(request);
     });
+    
+    // Tempos do loop, por subsistema e por task (?reset=1 zera)
+    LoopProfiler::shared().attach(server, "/perf");
+    TraceRecorder::shared().attach(server, "/trace");
+    HeapMonitor::shared().attach(server, "/heap");
+}
+
+void DiagWebServer::handleStatus(AsyncWebServerRequest *request) {
+    if (!systemStatus) {
+        request->send(503, "application/json", "{\"error\":\"Status não disponível\"}");
+        return;
+    }
+    snapshots.send(request, statusTopic);
+}
+
+void DiagWebServer::handleSensors(AsyncWebServerRequest *request) {
+    if (!sensorData) {
+        request->send(503, "application/json", "{\"error\":\"Dados dos sensores não disponíveis\"}");
+        return;
+    }
+    snapshots.send(request, sensorsTopic);
+}
+
+void DiagWebServer::handleRelays(AsyncWebServerRequest *request) {
+    if (!relayStates) {
+        request->send(503, "application/json", "{\"error\":\"Estado dos relés não disponível\"}");
+        return;
+    }
+    snapshots.send(request, relaysTopic);
 }
 
 void DiagWebServer::setupConfigEndpoints() {
@@ -0,0 +1,539 @@
+#include "DosingLimiter.h"
+#include <ArduinoJson.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <stddef.h>
+#include <time.h>
+
+const char* DosingLimiter::NVS_NAMESPACE = "dosing";
+
+// Contadores persistidos por relé
+struct DosingCounters {
+    float total_ml;
+    uint32_t total_doses;
+    uint32_t total_blocked;
+} __attribute__((packed));
+
+// Janela de uma bomba, com os tempos relativos ao momento da cópia
+struct DosingWindow {
+    float tokens_ml;
+    float day_slots_ml[DosingLimiter::DAY_SLOTS];
+    uint8_t slot_index;
+    uint32_t slot_age_ms;           // Decorrido da hora em andamento
+    uint32_t mix_left_ms;           // Mistura restante da última dose
+} __attribute__((packed));
+
+// Janela gravada na NVS (chave "w<relé>")
+struct DosingWindowRecord {
+    uint32_t epoch;                 // Hora de parede da gravação (0 = sem NTP)
+    DosingWindow window;
+} __attribute__((packed));
+
+namespace {
+
+const uint32_t WINDOW_MAGIC = 0x444F5345;    // "DOSE"
+const time_t EPOCH_VALID_AFTER = 1600000000;
+
+struct WindowSnapshot {
+    uint32_t magic;
+    uint32_t epoch;
+    DosingWindow pumps[MAX_RELAYS];
+    uint32_t checksum;
+};
+
+// Não é zerada no boot: sobrevive ao ESP.restart() (some ao desligar)
+RTC_NOINIT_ATTR WindowSnapshot rtc_windows;
+
+uint32_t snapshotChecksum(const WindowSnapshot& snapshot) {
+    // FNV-1a: a RTC volta com lixo depois de desligar
+    const uint8_t* bytes = (const uint8_t*)&snapshot;
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(WindowSnapshot, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+// ===== CONSTRUTOR =====
+DosingLimiter::DosingLimiter() :
+    initialized(false),
+    counters_dirty(false),
+    last_save(0),
+    last_snapshot(0),
+    boot_ms(0),
+    saved_epoch(0) {
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        resetState(i);
+        states[i].total_ml = 0;
+        states[i].total_doses = 0;
+        states[i].total_blocked = 0;
+    }
+}
+
+// ===== CONTROLE =====
+bool DosingLimiter::begin() {
+    Serial.println("💧 Inicializando limitador de dosagem...");
+
+    // Modelo padrão para as bombas dosadoras conhecidas
+    const int default_pumps[] = DOSING_PUMP_RELAYS;
+    for (int relay : default_pumps) {
+        if (!isValidRelay(relay)) continue;
+        models[relay].enabled = true;
+        models[relay].ml_per_second = DOSING_DEFAULT_ML_PER_SEC;
+        models[relay].max_ml_per_hour = DOSING_MAX_ML_PER_HOUR;
+        models[relay].max_ml_per_day = DOSING_MAX_ML_PER_DAY;
+        models[relay].min_mix_delay_ms = DOSING_MIN_MIX_DELAY_MS;
+    }
+
+    // Calibração e contadores gravados sobrescrevem os padrões
+    loadFromNVS();
+
+    // Janela do boot anterior: um reboot não pode liberar dose
+    restoreWindows();
+
+    initialized = true;
+    last_save = millis();
+    snapshotWindows(last_save);
+
+    int pumps = 0;
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (models[i].enabled) pumps++;
+    }
+    Serial.printf("✅ Limitador de dosagem ativo (%d bombas)\n", pumps);
+    return true;
+}
+
+void DosingLimiter::loop() {
+    if (!initialized) return;
+
+    unsigned long now = millis();
+    if (saved_epoch != 0) creditDowntime(now);
+    if (now - last_snapshot >= SNAPSHOT_INTERVAL_MS) snapshotWindows(now);
+
+    // Gravação espaçada para poupar a flash (doses gravam na hora)
+    if (counters_dirty && now - last_save >= SAVE_INTERVAL_MS) {
+        saveCounters();
+    }
+}
+
+void DosingLimiter::end() {
+    if (initialized && counters_dirty) {
+        saveCounters();
+    }
+    initialized = false;
+}
+
+// ===== CONFIGURAÇÃO =====
+bool DosingLimiter::configurePump(int relay, const PumpModel& model) {
+    if (!isValidRelay(relay)) return false;
+
+    if (model.enabled && model.ml_per_second <= 0.0) {
+        Serial.printf("❌ Dosagem: vazão inválida para relé %d\n", relay);
+        return false;
+    }
+
+    models[relay] = model;
+    resetState(relay);
+    savePumpModel(relay);
+
+    Serial.printf("💧 Bomba relé %d: %.2f ml/s | %.1f ml/h | %.1f ml/dia | mistura %lus\n",
+                 relay, model.ml_per_second, model.max_ml_per_hour,
+                 model.max_ml_per_day, model.min_mix_delay_ms / 1000);
+    return true;
+}
+
+const PumpModel& DosingLimiter::getPumpModel(int relay) const {
+    static const PumpModel empty_model;
+    if (!isValidRelay(relay)) return empty_model;
+    return models[relay];
+}
+
+bool DosingLimiter::isDosingPump(int relay) const {
+    return isValidRelay(relay) && models[relay].enabled;
+}
+
+// ===== LIMITAÇÃO =====
+bool DosingLimiter::tryDose(int relay, unsigned long dose_ms, unsigned long run_ms, unsigned long now, String* reason) {
+    if (!isValidRelay(relay)) {
+        if (reason) *reason = "relé inválido";
+        return false;
+    }
+
+    // Relés que não são bombas dosadoras não são limitados
+    if (!models[relay].enabled) return true;
+
+    const PumpModel& model = models[relay];
+    PumpState& state = states[relay];
+    String why;
+
+    refill(relay, now);
+    rotateDaySlots(relay, now);
+
+    float volume = estimateVolumeMl(relay, dose_ms);
+
+    if (dose_ms == 0) {
+        why = "dosagem sem duração definida";
+    } else if (state.has_dosed && (long)(now - state.last_dose_end) < (long)model.min_mix_delay_ms) {
+        why = "aguardando mistura da dose anterior";
+    } else if (model.max_ml_per_hour > 0 && volume > state.tokens_ml) {
+        why = "limite horário (" + String(state.tokens_ml, 1) + " ml disponíveis, " +
+              String(volume, 1) + " ml pedidos)";
+    } else if (model.max_ml_per_day > 0 && getDailyMl(relay, now) + volume > model.max_ml_per_day) {
+        why = "limite diário de " + String(model.max_ml_per_day, 1) + " ml";
+    }
+
+    if (why.length() > 0) {
+        state.total_blocked++;
+        counters_dirty = true;
+        Serial.printf("🚱 Dose negada relé %d: %s\n", relay, why.c_str());
+        if (reason) *reason = why;
+        return false;
+    }
+
+    // Debitar a dose
+    if (model.max_ml_per_hour > 0) {
+        state.tokens_ml -= volume;
+    }
+    state.day_slots_ml[state.slot_index] += volume;
+    state.last_dose_end = now + max(run_ms, dose_ms);
+    state.has_dosed = true;
+    state.total_ml += volume;
+    state.total_doses++;
+    counters_dirty = true;
+
+    // Antes do relé ligar: um reset durante a dose já a encontra debitada
+    if (initialized) {
+        snapshotWindows(now);
+        saveCounters();
+    }
+
+    Serial.printf("💧 Dose relé %d: %.2f ml (%lu ms) | total %.1f ml\n",
+                 relay, volume, dose_ms, state.total_ml);
+    return true;
+}
+
+float DosingLimiter::estimateVolumeMl(int relay, unsigned long duration_ms) const {
+    if (!isValidRelay(relay)) return 0.0;
+    return models[relay].ml_per_second * (duration_ms / 1000.0);
+}
+
+float DosingLimiter::getAvailableMl(int relay, unsigned long now) {
+    if (!isValidRelay(relay)) return 0.0;
+    refill(relay, now);
+    return states[relay].tokens_ml;
+}
+
+float DosingLimiter::getDailyMl(int relay, unsigned long now) {
+    if (!isValidRelay(relay)) return 0.0;
+    rotateDaySlots(relay, now);
+
+    float total = 0.0;
+    for (uint8_t i = 0; i < DAY_SLOTS; i++) {
+        total += states[relay].day_slots_ml[i];
+    }
+    return total;
+}
+
+// ===== ESTATÍSTICAS =====
+float DosingLimiter::getTotalMl(int relay) const {
+    return isValidRelay(relay) ? states[relay].total_ml : 0.0;
+}
+
+uint32_t DosingLimiter::getTotalDoses(int relay) const {
+    return isValidRelay(relay) ? states[relay].total_doses : 0;
+}
+
+uint32_t DosingLimiter::getTotalBlocked(int relay) const {
+    return isValidRelay(relay) ? states[relay].total_blocked : 0;
+}
+
+void DosingLimiter::resetCounters() {
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        states[i].total_ml = 0;
+        states[i].total_doses = 0;
+        states[i].total_blocked = 0;
+    }
+    counters_dirty = true;
+    saveCounters();
+    Serial.println("🔄 Contadores de dosagem zerados");
+}
+
+void DosingLimiter::saveCounters() {
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        Serial.println("❌ Dosagem: não foi possível abrir NVS");
+        return;
+    }
+
+    unsigned long now = millis();
+    uint32_t epoch = epochNow();
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (models[i].enabled && initialized) {
+            DosingWindowRecord record;
+            record.epoch = epoch;
+            captureWindow(i, now, record.window);
+
+            char key[8];
+            snprintf(key, sizeof(key), "w%d", i);
+            prefs.putBytes(key, &record, sizeof(record));
+        }
+
+        if (!models[i].enabled && states[i].total_doses == 0) continue;
+
+        DosingCounters counters;
+        counters.total_ml = states[i].total_ml;
+        counters.total_doses = states[i].total_doses;
+        counters.total_blocked = states[i].total_blocked;
+
+        char key[8];
+        snprintf(key, sizeof(key), "c%d", i);
+        prefs.putBytes(key, &counters, sizeof(counters));
+    }
+
+    prefs.end();
+    counters_dirty = false;
+    last_save = millis();
+}
+
+String DosingLimiter::getStatusJSON() {
+    DynamicJsonDocument doc(2048);
+    JsonArray pumps = doc.createNestedArray("pumps");
+    unsigned long now = millis();
+
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (!models[i].enabled) continue;
+
+        JsonObject pump = pumps.createNestedObject();
+        pump["relay"] = i;
+        pump["ml_per_second"] = models[i].ml_per_second;
+        pump["max_ml_per_hour"] = models[i].max_ml_per_hour;
+        pump["max_ml_per_day"] = models[i].max_ml_per_day;
+        pump["min_mix_delay_ms"] = models[i].min_mix_delay_ms;
+        pump["available_ml"] = getAvailableMl(i, now);
+        pump["daily_ml"] = getDailyMl(i, now);
+        pump["total_ml"] = states[i].total_ml;
+        pump["total_doses"] = states[i].total_doses;
+        pump["total_blocked"] = states[i].total_blocked;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void DosingLimiter::printStatus() {
+    unsigned long now = millis();
+    Serial.println("\n💧 === DOSAGEM ===");
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (!models[i].enabled) continue;
+        Serial.printf("   Relé %d: %.1f ml disp. | %.1f/%.1f ml hoje | total %.1f ml em %lu doses | %lu negadas\n",
+                     i, getAvailableMl(i, now), getDailyMl(i, now), models[i].max_ml_per_day,
+                     states[i].total_ml, (unsigned long)states[i].total_doses,
+                     (unsigned long)states[i].total_blocked);
+    }
+    Serial.println("=================\n");
+}
+
+// ===== MÉTODOS INTERNOS =====
+void DosingLimiter::refill(int relay, unsigned long now) {
+    const PumpModel& model = models[relay];
+    PumpState& state = states[relay];
+
+    if (model.max_ml_per_hour > 0) {
+        unsigned long elapsed = now - state.last_refill;
+        state.tokens_ml += model.max_ml_per_hour * ((float)elapsed / HOUR_MS);
+        if (state.tokens_ml > model.max_ml_per_hour) {
+            state.tokens_ml = model.max_ml_per_hour;
+        }
+    }
+    state.last_refill = now;
+}
+
+void DosingLimiter::rotateDaySlots(int relay, unsigned long now) {
+    PumpState& state = states[relay];
+
+    // Horas contadas pela diferença: o overflow do millis() (49 dias)
+    // não zera a janela
+    unsigned long elapsed_hours = (now - state.slot_start) / HOUR_MS;
+    if (elapsed_hours == 0) return;
+
+    // Zerar as horas que saíram da janela de 24h
+    if (elapsed_hours >= DAY_SLOTS) {
+        for (uint8_t i = 0; i < DAY_SLOTS; i++) {
+            state.day_slots_ml[i] = 0;
+        }
+    } else {
+        for (unsigned long h = 1; h <= elapsed_hours; h++) {
+            state.day_slots_ml[(state.slot_index + h) % DAY_SLOTS] = 0;
+        }
+    }
+    state.slot_index = (state.slot_index + elapsed_hours) % DAY_SLOTS;
+    state.slot_start += elapsed_hours * HOUR_MS;
+}
+
+void DosingLimiter::resetState(int relay) {
+    // Bucket cheio e janela vazia: bomba nova ou recalibrada. No boot a
+    // janela anterior é restaurada em seguida (restoreWindows)
+    PumpState& state = states[relay];
+    state.tokens_ml = models[relay].max_ml_per_hour;
+    state.last_refill = millis();
+    state.last_dose_end = 0;
+    state.has_dosed = false;
+    for (uint8_t i = 0; i < DAY_SLOTS; i++) {
+        state.day_slots_ml[i] = 0;
+    }
+    state.slot_index = 0;
+    state.slot_start = millis();
+}
+
+void DosingLimiter::captureWindow(int relay, unsigned long now, DosingWindow& window) {
+    PumpState& state = states[relay];
+    refill(relay, now);
+    rotateDaySlots(relay, now);
+
+    window.tokens_ml = state.tokens_ml;
+    memcpy(window.day_slots_ml, state.day_slots_ml, sizeof(window.day_slots_ml));
+    window.slot_index = state.slot_index;
+    window.slot_age_ms = now - state.slot_start;
+
+    // Negativo enquanto o PWM ainda cicla: resta mais que a mistura
+    long since_dose = (long)(now - state.last_dose_end);
+    long mix_ms = (long)models[relay].min_mix_delay_ms;
+    window.mix_left_ms = state.has_dosed && since_dose < mix_ms ? mix_ms - since_dose : 0;
+}
+
+void DosingLimiter::applyWindow(int relay, const DosingWindow& window, unsigned long now) {
+    PumpState& state = states[relay];
+    state.tokens_ml = constrain(window.tokens_ml, 0.0f, models[relay].max_ml_per_hour);
+    state.last_refill = now;
+    memcpy(state.day_slots_ml, window.day_slots_ml, sizeof(state.day_slots_ml));
+    state.slot_index = window.slot_index % DAY_SLOTS;
+    state.slot_start = now - window.slot_age_ms;
+    state.has_dosed = window.mix_left_ms > 0;
+    state.last_dose_end = now + window.mix_left_ms - models[relay].min_mix_delay_ms;
+}
+
+void DosingLimiter::restoreWindows() {
+    unsigned long now = millis();
+    boot_ms = now;
+
+    // Ligar (ou brownout) deixa lixo na RTC: vale só a cópia da NVS
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool rtc_valid = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT &&
+                     rtc_windows.magic == WINDOW_MAGIC &&
+                     rtc_windows.checksum == snapshotChecksum(rtc_windows);
+    bool nvs_open = !rtc_valid && prefs.begin(NVS_NAMESPACE, true);
+
+    saved_epoch = rtc_valid ? rtc_windows.epoch : 0;
+    int missing = 0;
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        resetState(i);
+        if (!models[i].enabled) continue;
+
+        DosingWindowRecord record;
+        char key[8];
+        snprintf(key, sizeof(key), "w%d", i);
+        if (rtc_valid) {
+            record.window = rtc_windows.pumps[i];
+        } else if (nvs_open && prefs.getBytesLength(key) == sizeof(record)) {
+            prefs.getBytes(key, &record, sizeof(record));
+            saved_epoch = record.epoch;
+        } else {
+            // Sem estado: como se tivesse acabado de dosar o limite
+            memset(&record, 0, sizeof(record));
+            record.window.mix_left_ms = models[i].min_mix_delay_ms;
+            missing++;
+        }
+        applyWindow(i, record.window, now);
+    }
+    if (nvs_open) prefs.end();
+
+    if (missing > 0) {
+        Serial.printf("⚠️ Dosagem: %d bomba(s) sem janela anterior - bucket vazio e mistura em curso\n", missing);
+    } else {
+        Serial.printf("💧 Janela de dosagem restaurada da %s\n", rtc_valid ? "RTC" : "NVS");
+    }
+    creditDowntime(now);
+}
+
+void DosingLimiter::snapshotWindows(unsigned long now) {
+    rtc_windows.magic = WINDOW_MAGIC;
+    rtc_windows.epoch = epochNow();
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (models[i].enabled) {
+            captureWindow(i, now, rtc_windows.pumps[i]);
+        } else {
+            memset(&rtc_windows.pumps[i], 0, sizeof(DosingWindow));
+        }
+    }
+    rtc_windows.checksum = snapshotChecksum(rtc_windows);
+    last_snapshot = now;
+}
+
+void DosingLimiter::creditDowntime(unsigned long now) {
+    if (saved_epoch == 0) return;
+
+    // Sem NTP o tempo parado não conta (conservador); credita quando sincronizar
+    uint32_t now_epoch = epochNow();
+    if (now_epoch == 0) return;
+
+    uint32_t boot_epoch = now_epoch - (now - boot_ms) / 1000;
+    if (boot_epoch > saved_epoch) {
+        // Um dia parado já esvazia tudo: limita antes de converter para ms
+        uint32_t downtime_s = min(boot_epoch - saved_epoch, (uint32_t)(DAY_SLOTS * (HOUR_MS / 1000)));
+        unsigned long downtime_ms = downtime_s * 1000UL;
+        for (int i = 0; i < MAX_RELAYS; i++) {
+            if (!models[i].enabled) continue;
+            states[i].last_refill -= downtime_ms;
+            states[i].slot_start -= downtime_ms;
+            states[i].last_dose_end -= downtime_ms;
+        }
+        Serial.printf("💧 Dosagem: %lus desligado creditados na janela\n", (unsigned long)downtime_s);
+    }
+    saved_epoch = 0;
+}
+
+uint32_t DosingLimiter::epochNow() {
+    time_t now = time(nullptr);
+    return now > EPOCH_VALID_AFTER ? (uint32_t)now : 0;
+}
+
+void DosingLimiter::loadFromNVS() {
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        // Namespace ainda não existe: primeira execução
+        return;
+    }
+
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        char key[8];
+
+        snprintf(key, sizeof(key), "m%d", i);
+        if (prefs.getBytesLength(key) == sizeof(PumpModel)) {
+            prefs.getBytes(key, &models[i], sizeof(PumpModel));
+        }
+
+        snprintf(key, sizeof(key), "c%d", i);
+        if (prefs.getBytesLength(key) == sizeof(DosingCounters)) {
+            DosingCounters counters;
+            prefs.getBytes(key, &counters, sizeof(counters));
+            states[i].total_ml = counters.total_ml;
+            states[i].total_doses = counters.total_doses;
+            states[i].total_blocked = counters.total_blocked;
+        }
+    }
+
+    prefs.end();
+}
+
+void DosingLimiter::savePumpModel(int relay) {
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        Serial.println("❌ Dosagem: não foi possível abrir NVS");
+        return;
+    }
+
+    char key[8];
+    snprintf(key, sizeof(key), "m%d", relay);
+    prefs.putBytes(key, &models[relay], sizeof(PumpModel));
+    prefs.end();
+}
@@ -1,4 +1,6 @@
 #include "ESPNowTask.h"
+#include "Logger.h"
+#include "LoopProfiler.h"
 #include <ArduinoJson.h>
 #include <WiFi.h>
 
@@ -93,6 +95,7 @@ bool ESPNowTask::begin() {
     }
     
     initialized = true;
+    LoopProfiler::shared().registerTask(taskHandle);
     Serial.println("✅ ESP-NOW Task criada com sucesso!");
     Serial.println("   Core: " + String(ESPNOW_TASK_CORE));
     Serial.println("   Canal: " + String(ESPNOW_FIXED_CHANNEL));
@@ -661,8 +664,10 @@ bool ESPNowTask::validateMessage(const TaskESPNowMessage& message) {
 }
 
 void ESPNowTask::processReceivedMessage(const TaskESPNowMessage& message) {
+    PROFILE_SCOPE("espnow.rx");
+    
     if (!validateMessage(message)) {
-        Serial.println("❌ Mensagem inválida (checksum incorreto)");
+        LOGW(ESPNOW, "❌ Mensagem inválida (checksum incorreto) de " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
         return;
     }
     
@@ -672,15 +677,15 @@ void ESPNowTask::processReceivedMessage(const TaskESPNowMessage& message) {
     // Processar por tipo
     switch (message.type) {
         case TASK_MSG_WIFI_CREDENTIALS:
-            Serial.println("📶 Credenciais WiFi recebidas de: " + macToString(message.senderMac));
+            LOGI(ESPNOW, "📶 Credenciais WiFi recebidas de: " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
             break;
             
         case TASK_MSG_RELAY_COMMAND:
-            Serial.println("🔌 Comando de relé recebido de: " + macToString(message.senderMac));
+            LOGD(ESPNOW, "🔌 Comando de relé recebido de: " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
             break;
             
         case TASK_MSG_PING: {
-            Serial.println("🏓 Ping recebido de: " + macToString(message.senderMac));
+            LOGD(ESPNOW, "🏓 Ping recebido de: " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
             // Enviar PONG
             TaskESPNowMessage pong = message;
             pong.type = TASK_MSG_PONG;
@@ -703,17 +708,16 @@ void ESPNowTask::processReceivedMessage(const TaskESPNowMessage& message) {
                 slave->pingTimestamp = 0; // Reset
                 
                 // Log com medição de latência
-                Serial.println("🏓 Pong ← " + String(slave->name) + 
-                               " | RTT: " + String(slave->latency) + "ms" +
-                               " | RSSI: " + String(slave->rssi) + "dBm");
+                LOGD(ESPNOW, "🏓 Pong ← %s | RTT: %lums | RSSI: %ddBm",
+                     slave->name, (unsigned long)slave->latency, (int)slave->rssi);
             } else {
-                Serial.println("🏓 Pong recebido de: " + macToString(message.senderMac));
+                LOGD(ESPNOW, "🏓 Pong recebido de: " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
             }
             break;
         }
             
         case TASK_MSG_DISCOVERY:
-            Serial.println("🔍 Discovery recebido de: " + macToString(message.senderMac));
+            LOGI(ESPNOW, "🔍 Discovery recebido de: " LOG_MAC_FMT, LOG_MAC_ARGS(message.senderMac));
             break;
             
         case TASK_MSG_HEARTBEAT:
@@ -721,7 +725,7 @@ void ESPNowTask::processReceivedMessage(const TaskESPNowMessage& message) {
             break;
             
         default:
-            Serial.println("❓ Tipo de mensagem desconhecido: " + String(message.type));
+            LOGW(ESPNOW, "❓ Tipo de mensagem desconhecido: %d", (int)message.type);
             break;
     }
     
@@ -742,7 +746,7 @@ void ESPNowTask::updateSlaveStatus(const uint8_t* mac, bool online, int rssi) {
             if (rssi != -50) slave.rssi = rssi;
             
             if (!wasOnline && online) {
-                Serial.println("✅ Slave online: " + String(slave.name));
+                LOGI(ESPNOW, "✅ Slave online: %s", slave.name);
                 if (statusCallback) {
                     statusCallback(slave.mac, true);
                 }
@@ -770,7 +774,7 @@ void ESPNowTask::onDataSent(const uint8_t* mac, esp_now_send_status_t status) {
     if (status == ESP_NOW_SEND_SUCCESS) {
         // Sucesso silencioso
     } else {
-        Serial.println("❌ Falha ao enviar para: " + instance->macToString(mac));
+        LOGW(ESPNOW, "❌ Falha ao enviar para: " LOG_MAC_FMT, LOG_MAC_ARGS(mac));
     }
 }
 
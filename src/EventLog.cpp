@@ -0,0 +1,385 @@
+#include "EventLog.h"
+#include "HistoryFS.h"
+#include <ArduinoJson.h>
+
+namespace {
+
+const char* const CODE_NAMES[EVENT_CODE_COUNT] = {
+    "NONE",
+    "RULE_EXECUTED",
+    "RULE_BLOCKED_HEALTH",
+    "RULE_BLOCKED_SAFETY",
+    "RULE_LOG",
+    "RULE_SUPABASE",
+    "RELAY_ON",
+    "RELAY_OFF",
+    "RELAY_PULSE",
+    "RELAY_PWM",
+    "RELAY_BLOCKED_EMERGENCY",
+    "RELAY_BLOCKED_LOCK",
+    "RELAY_INVALID",
+    "PWM_BLOCKED_EMERGENCY",
+    "PWM_BLOCKED_LOCK",
+    "PWM_INVALID",
+    "DOSING_BLOCKED",
+    "RELAY_LOCKED",
+    "RELAY_UNLOCKED",
+    "RELAYS_UNLOCKED_ALL",
+    "EMERGENCY_MODE",
+    "MANUAL_OVERRIDE",
+    "EMERGENCY_SHUTDOWN",
+    "ALERT",
+    "ALERT_CRITICAL"
+};
+
+const size_t RECORD_SIZE = sizeof(EventRecord);
+
+}  // namespace
+
+// ===== CONSTRUTOR =====
+EventLog::EventLog() :
+    next_sequence(0),
+    spilled_sequence(0),
+    ram_first(0),
+    dropped(0),
+    spill_writes(0),
+    last_spill(0),
+    fs(nullptr),
+    flash(EVENT_LOG_DIRECTORY, RECORD_SIZE, EVENT_LOG_SEGMENT_RECORDS, EVENT_LOG_SEGMENTS),
+    mutex(nullptr) {
+    memset(ring, 0, sizeof(ring));
+}
+
+EventLog::~EventLog() {
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+    }
+}
+
+// ===== CONTROLE =====
+bool EventLog::begin(fs::FS* filesystem) {
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutex();
+    }
+
+    // Mesma montagem (partição "history") do TimeSeriesStore e da TelemetryQueue
+    if (filesystem == &LittleFS && !HistoryFS::mount("EventLog")) {
+        Serial.println("⚠️ EventLog: sem partição de histórico, usando só a RAM");
+        filesystem = nullptr;
+    }
+    if (filesystem && !flash.begin(filesystem)) {
+        filesystem = nullptr;
+    }
+
+    // Anel antigo num arquivo só (regravado no lugar): não é migrado
+    if (filesystem && filesystem->exists(EVENT_LOG_LEGACY_PATH)) {
+        filesystem->remove(EVENT_LOG_LEGACY_PATH);
+        Serial.println("⚠️ EventLog: " EVENT_LOG_LEGACY_PATH " no formato antigo descartado");
+    }
+
+    lock();
+    fs = filesystem;
+    if (fs) recover();
+    ram_first = next_sequence;
+    spilled_sequence = next_sequence;
+    last_spill = millis();
+    unlock();
+
+    Serial.printf("✅ EventLog: %u eventos na RAM, %s (próxima sequência %lu)\n",
+                  EVENT_LOG_RAM_RECORDS, fs ? "despejo na flash" : "sem flash",
+                  (unsigned long)next_sequence);
+    return true;
+}
+
+void EventLog::loop() {
+    uint32_t pending = next_sequence - spilled_sequence;
+    if (!fs || pending == 0) return;
+
+    if (pending >= EVENT_LOG_SPILL_BATCH || millis() - last_spill >= EVENT_LOG_SPILL_INTERVAL_MS) {
+        lock();
+        spill();
+        unlock();
+    }
+}
+
+void EventLog::flush() {
+    if (!fs) return;
+    lock();
+    spill();
+    unlock();
+}
+
+// ===== REGISTRO =====
+void EventLog::record(EventCode code, int relay, float value, uint16_t rule) {
+    lock();
+    EventRecord& entry = ring[next_sequence % EVENT_LOG_RAM_RECORDS];
+    entry.sequence = next_sequence;
+    entry.timestamp = millis();
+    entry.rule = rule;
+    entry.code = code;
+    entry.relay = (relay >= INT8_MIN && relay <= INT8_MAX) ? relay : EVENT_LOG_NO_RELAY;
+    entry.value = value;
+    next_sequence++;
+
+    // Anel cheio sem despejo: o mais antigo pendente se perde
+    if (next_sequence - spilled_sequence > EVENT_LOG_RAM_RECORDS) {
+        spilled_sequence = next_sequence - EVENT_LOG_RAM_RECORDS;
+        dropped++;
+    }
+    unlock();
+}
+
+// ===== CONSULTA =====
+size_t EventLog::forEach(uint32_t from_sequence, size_t max_events, Visitor visitor) {
+    lock();
+    uint32_t sequence = max(from_sequence, getOldestSequence());
+    uint32_t ram_oldest = ramOldest();
+    size_t delivered = 0;
+
+    // Parte mais antiga na flash, o resto na RAM
+    while (sequence < next_sequence && delivered < max_events) {
+        EventRecord entry;
+        bool found;
+        if (sequence >= ram_oldest) {
+            entry = ring[sequence % EVENT_LOG_RAM_RECORDS];
+            found = true;
+        } else {
+            found = fs && readFlash(sequence, entry);
+        }
+        sequence++;
+
+        if (!found) continue;
+        delivered++;
+        if (!visitor(entry)) break;
+    }
+
+    if (fs) flash.endRead();
+    unlock();
+    return delivered;
+}
+
+String EventLog::getJSON(size_t limit, RuleResolver resolver) {
+    limit = min(limit, (size_t)EVENT_LOG_QUERY_LIMIT);
+    uint32_t next = next_sequence;
+    uint32_t from = next > limit ? next - limit : 0;
+
+    DynamicJsonDocument doc(256 + limit * 192);
+    doc["next_sequence"] = next;
+    doc["oldest_sequence"] = getOldestSequence();
+    doc["dropped"] = dropped;
+    JsonArray list = doc.createNestedArray("events");
+
+    char text[EVENT_LOG_TEXT_SIZE];
+    forEach(from, limit, [&](const EventRecord& entry) {
+        String rule_id = (entry.rule != EVENT_LOG_NO_RULE && resolver) ? resolver(entry.rule) : String();
+        describe(entry, text, sizeof(text), rule_id.c_str());
+
+        JsonObject item = list.createNestedObject();
+        item["seq"] = entry.sequence;
+        item["t"] = entry.timestamp;
+        item["code"] = codeName(entry.code);
+        if (entry.relay != EVENT_LOG_NO_RELAY) item["relay"] = entry.relay;
+        if (entry.value != 0.0) item["value"] = entry.value;
+        if (rule_id.length() > 0) item["rule"] = rule_id;
+        item["text"] = text;
+        return true;
+    });
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+size_t EventLog::describe(const EventRecord& entry, char* out, size_t size, const char* rule_id) {
+    int relay = entry.relay;
+    bool enabled = entry.value != 0.0;
+    const char* rule = (rule_id && rule_id[0]) ? rule_id : "?";
+    int length = 0;
+
+    switch (entry.code) {
+        case EVENT_RULE_EXECUTED:
+            length = snprintf(out, size, "Rule %s EXECUTED", rule);
+            break;
+        case EVENT_RULE_BLOCKED_HEALTH:
+            length = snprintf(out, size, "Rule %s BLOCKED - sensor health", rule);
+            break;
+        case EVENT_RULE_BLOCKED_SAFETY:
+            length = snprintf(out, size, "Rule %s BLOCKED - safety", rule);
+            break;
+        case EVENT_RULE_LOG:
+            length = snprintf(out, size, "Rule %s logged an event", rule);
+            break;
+        case EVENT_RULE_SUPABASE:
+            length = snprintf(out, size, "Rule %s requested Supabase update", rule);
+            break;
+        case EVENT_RELAY_ON:
+            length = snprintf(out, size, "Relay %d ON", relay);
+            break;
+        case EVENT_RELAY_OFF:
+            length = snprintf(out, size, "Relay %d OFF", relay);
+            break;
+        case EVENT_RELAY_PULSE:
+            length = snprintf(out, size, "Relay %d pulsed for %lums", relay, (unsigned long)entry.value);
+            break;
+        case EVENT_RELAY_PWM:
+            length = snprintf(out, size, "Relay %d PWM %.1f%%", relay, entry.value);
+            break;
+        case EVENT_RELAY_BLOCKED_EMERGENCY:
+            length = snprintf(out, size, "Relay command BLOCKED - emergency mode (relay %d)", relay);
+            break;
+        case EVENT_RELAY_BLOCKED_LOCK:
+            length = snprintf(out, size, "Relay command BLOCKED - relay locked (relay %d)", relay);
+            break;
+        case EVENT_RELAY_INVALID:
+            length = snprintf(out, size, "Relay command INVALID (relay %d)", relay);
+            break;
+        case EVENT_PWM_BLOCKED_EMERGENCY:
+            length = snprintf(out, size, "PWM command BLOCKED - emergency mode (relay %d)", relay);
+            break;
+        case EVENT_PWM_BLOCKED_LOCK:
+            length = snprintf(out, size, "PWM command BLOCKED - relay locked (relay %d)", relay);
+            break;
+        case EVENT_PWM_INVALID:
+            length = snprintf(out, size, "PWM command INVALID (relay %d)", relay);
+            break;
+        case EVENT_DOSING_BLOCKED:
+            length = snprintf(out, size, "Dosing BLOCKED (relay %d, %lums)", relay, (unsigned long)entry.value);
+            break;
+        case EVENT_RELAY_LOCKED:
+            length = snprintf(out, size, "Relay %d LOCKED", relay);
+            break;
+        case EVENT_RELAY_UNLOCKED:
+            length = snprintf(out, size, "Relay %d UNLOCKED", relay);
+            break;
+        case EVENT_RELAYS_UNLOCKED_ALL:
+            length = snprintf(out, size, "All relays UNLOCKED (%d relays)", (int)entry.value);
+            break;
+        case EVENT_EMERGENCY_MODE:
+            length = snprintf(out, size, "Emergency mode %s", enabled ? "ENABLED" : "DISABLED");
+            break;
+        case EVENT_MANUAL_OVERRIDE:
+            length = snprintf(out, size, "Manual override %s", enabled ? "ENABLED" : "DISABLED");
+            break;
+        case EVENT_EMERGENCY_SHUTDOWN:
+            length = snprintf(out, size, "EMERGENCY SHUTDOWN");
+            break;
+        case EVENT_ALERT:
+            length = snprintf(out, size, "ALERT");
+            break;
+        case EVENT_ALERT_CRITICAL:
+            length = snprintf(out, size, "CRITICAL ALERT");
+            break;
+        default:
+            length = snprintf(out, size, "Event %u", entry.code);
+            break;
+    }
+
+    if (length < 0) return 0;
+    return min((size_t)length, size - 1);
+}
+
+const char* EventLog::codeName(uint8_t code) {
+    return code < EVENT_CODE_COUNT ? CODE_NAMES[code] : "UNKNOWN";
+}
+
+uint16_t EventLog::ruleKey(const String& rule_id) {
+    // FNV-1a de 32 bits dobrado em 16; 0 fica reservado para "sem regra"
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < rule_id.length(); i++) {
+        hash ^= (uint8_t)rule_id[i];
+        hash *= 16777619UL;
+    }
+    uint16_t key = (uint16_t)(hash ^ (hash >> 16));
+    return key == EVENT_LOG_NO_RULE ? 1 : key;
+}
+
+// ===== STATUS =====
+uint32_t EventLog::getOldestSequence() const {
+    if (!fs) return ramOldest();
+
+    // Na flash ficam as sequências já despejadas que o anel ainda guarda
+    uint32_t flash_oldest = spilled_sequence > 0 ? flash.oldestKept(spilled_sequence - 1) : 0;
+    return min(flash_oldest, ramOldest());
+}
+
+String EventLog::getStatusJSON() const {
+    StaticJsonDocument<256> doc;
+    doc["flash"] = fs != nullptr;
+    doc["next_sequence"] = next_sequence;
+    doc["oldest_sequence"] = getOldestSequence();
+    doc["pending"] = next_sequence - spilled_sequence;
+    doc["dropped"] = dropped;
+    doc["spill_writes"] = spill_writes;
+    doc["ram_records"] = EVENT_LOG_RAM_RECORDS;
+    doc["flash_records"] = EVENT_LOG_FLASH_RECORDS;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+uint32_t EventLog::ramOldest() const {
+    uint32_t oldest = next_sequence > EVENT_LOG_RAM_RECORDS ? next_sequence - EVENT_LOG_RAM_RECORDS : 0;
+    return max(oldest, ram_first);
+}
+
+bool EventLog::readFlash(uint32_t sequence, EventRecord& out) {
+    if (!flash.read(sequence, (uint8_t*)&out)) {
+        return false;
+    }
+    // Slot já sobrescrito ou nunca gravado
+    return out.sequence == sequence && out.code != EVENT_NONE;
+}
+
+void EventLog::spill() {
+    if (spilled_sequence == next_sequence) return;
+
+    // Trechos contíguos no anel da RAM, anexados aos segmentos da flash
+    uint32_t sequence = spilled_sequence;
+    bool ok = true;
+    while (ok && sequence < next_sequence) {
+        uint32_t ram_slot = sequence % EVENT_LOG_RAM_RECORDS;
+        uint32_t count = next_sequence - sequence;
+        count = min(count, (uint32_t)(EVENT_LOG_RAM_RECORDS - ram_slot));
+
+        ok = flash.append(sequence, (const uint8_t*)&ring[ram_slot], count);
+        if (ok) sequence += count;
+    }
+
+    if (!ok) {
+        Serial.println("❌ EventLog: erro ao gravar na flash");
+    }
+    spilled_sequence = sequence;
+    spill_writes++;
+    last_spill = millis();
+}
+
+void EventLog::recover() {
+    // A maior sequência gravada continua a numeração
+    EventRecord entry;
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t slot = 0; slot < flash.capacity(); slot++) {
+        if (!flash.readSlot(slot, (uint8_t*)&entry)) continue;
+        if (entry.code == EVENT_NONE || entry.code >= EVENT_CODE_COUNT) continue;
+        if (entry.sequence % flash.capacity() != slot) continue;
+        if (!found || entry.sequence > newest) {
+            newest = entry.sequence;
+            found = true;
+        }
+    }
+    flash.endRead();
+
+    if (found) {
+        next_sequence = newest + 1;
+    }
+}
+
+void EventLog::lock() const {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void EventLog::unlock() const {
+    if (mutex) xSemaphoreGive(mutex);
+}
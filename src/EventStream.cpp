@@ -0,0 +1,268 @@
+#include "EventStream.h"
+#include "HydroControl.h"
+#include <ArduinoJson.h>
+
+// Anel inteiro com os dois textos copiados, mais "dropped"
+#define EVENT_STREAM_RULES_DOC_SIZE (JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(EVENT_STREAM_RULE_QUEUE) + \
+    EVENT_STREAM_RULE_QUEUE * (JSON_OBJECT_SIZE(4) + 2 * EVENT_STREAM_RULE_TEXT_SIZE))
+
+EventStream::EventStream() :
+    hydro(nullptr),
+    sensor_subscription(-1),
+    rule_sequence(0),
+    event_id(0) {
+    memset(endpoints, 0, sizeof(endpoints));
+    memset(rules, 0, sizeof(rules));
+    buffer[0] = '\0';
+}
+
+EventStream::~EventStream() {
+    if (hydro && sensor_subscription >= 0) {
+        hydro->getSensorBus().unsubscribe(sensor_subscription);
+    }
+}
+
+void EventStream::begin(AsyncWebServer* server, HydroControl& hydroControl) {
+    hydro = &hydroControl;
+
+    setupEndpoint(endpoints[0], server, EVENT_STREAM_LIVE_PATH, EVENT_STREAM_LIVE_INTERVAL_MS);
+    setupEndpoint(endpoints[1], server, EVENT_STREAM_KIOSK_PATH, EVENT_STREAM_KIOSK_INTERVAL_MS);
+
+    // Todos os canais, inclusive os registrados depois (ORP, OD...)
+    sensor_subscription = hydro->getSensorBus().subscribe(~(SensorBus::ChannelMask)0,
+        [this](const SensorReading& reading) { onSensorReading(reading); });
+
+    Serial.printf("✅ SSE: %s (%dms) e %s (%dms)\n",
+                  EVENT_STREAM_LIVE_PATH, EVENT_STREAM_LIVE_INTERVAL_MS,
+                  EVENT_STREAM_KIOSK_PATH, EVENT_STREAM_KIOSK_INTERVAL_MS);
+}
+
+void EventStream::loop() {
+    if (!hydro) return;
+
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < 2; i++) {
+        Endpoint& endpoint = endpoints[i];
+        if (endpoint.source && now - endpoint.last_flush >= endpoint.interval_ms) {
+            flush(endpoint, now);
+        }
+    }
+}
+
+void EventStream::publishRule(const String& event, const String& detail) {
+    // Mesmo disparo que nenhum endpoint enviou ainda: só conta a repetição
+    if (rule_sequence > 0) {
+        RuleEvent& last = rules[(rule_sequence - 1) % EVENT_STREAM_RULE_QUEUE];
+        bool unsent = endpoints[0].rule_cursor < rule_sequence && endpoints[1].rule_cursor < rule_sequence;
+        if (unsent && last.count < UINT16_MAX &&
+            strncmp(event.c_str(), last.event, sizeof(last.event) - 1) == 0 &&
+            strncmp(detail.c_str(), last.detail, sizeof(last.detail) - 1) == 0) {
+            last.count++;
+            last.timestamp = millis();
+            return;
+        }
+    }
+
+    RuleEvent& entry = rules[rule_sequence % EVENT_STREAM_RULE_QUEUE];
+    snprintf(entry.event, sizeof(entry.event), "%s", event.c_str());
+    snprintf(entry.detail, sizeof(entry.detail), "%s", detail.c_str());
+    entry.timestamp = millis();
+    entry.count = 1;
+    rule_sequence++;
+}
+
+// ===== STATUS =====
+size_t EventStream::getClientCount() const {
+    size_t total = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        if (endpoints[i].source) total += endpoints[i].source->count();
+    }
+    return total;
+}
+
+String EventStream::getStatusJSON() const {
+    DynamicJsonDocument doc(768);
+    doc["rules_published"] = rule_sequence;
+    doc["last_event_id"] = event_id;
+
+    JsonArray list = doc.createNestedArray("endpoints");
+    for (uint8_t i = 0; i < 2; i++) {
+        const Endpoint& endpoint = endpoints[i];
+        if (!endpoint.source) continue;
+
+        JsonObject item = list.createNestedObject();
+        item["path"] = endpoint.path;
+        item["interval_ms"] = endpoint.interval_ms;
+        item["clients"] = endpoint.source->count();
+        item["events_sent"] = endpoint.events_sent;
+        item["flushes_deferred"] = endpoint.flushes_deferred;
+        item["clients_rejected"] = endpoint.clients_rejected;
+        item["rules_deferred"] = endpoint.rules_deferred;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void EventStream::setupEndpoint(Endpoint& endpoint, AsyncWebServer* server, const char* path, uint32_t interval_ms) {
+    endpoint.path = path;
+    endpoint.interval_ms = interval_ms;
+    endpoint.source = new AsyncEventSource(path);
+
+    Endpoint* target = &endpoint;
+    endpoint.source->onConnect([this, target](AsyncEventSourceClient* client) {
+        if (target->source->count() > EVENT_STREAM_MAX_CLIENTS) {
+            target->clients_rejected++;
+            client->close();
+            return;
+        }
+
+        // Estado completo sai no próximo flush (no loop principal)
+        client->send("connected", "hello", event_id, EVENT_STREAM_RETRY_MS);
+        target->snapshot_pending = true;
+    });
+
+    server->addHandler(endpoint.source);
+}
+
+void EventStream::onSensorReading(const SensorReading& reading) {
+    if (reading.channel < 0 || reading.channel >= SENSOR_MAX_CHANNELS) return;
+
+    // Último valor vence: rajadas entre dois flushes viram uma única mudança
+    latest[reading.channel] = reading;
+    for (uint8_t i = 0; i < 2; i++) {
+        endpoints[i].dirty_sensors |= SensorBus::maskOf(reading.channel);
+    }
+}
+
+void EventStream::flush(Endpoint& endpoint, unsigned long now) {
+    endpoint.last_flush = now;
+    uint32_t relay_generation = hydro->getRelayGeneration();
+
+    // Ninguém ouvindo: descarta as mudanças acumuladas
+    if (endpoint.source->count() == 0) {
+        endpoint.dirty_sensors = 0;
+        endpoint.sent_relay_generation = relay_generation;
+        endpoint.rule_cursor = rule_sequence;
+        endpoint.snapshot_pending = false;
+        return;
+    }
+
+    // Cliente lento: segura o flush e continua coalescendo
+    if (endpoint.source->avgPacketsWaiting() > EVENT_STREAM_MAX_BACKLOG) {
+        endpoint.flushes_deferred++;
+        return;
+    }
+
+    bool force_relays = false;
+    if (endpoint.snapshot_pending) {
+        endpoint.snapshot_pending = false;
+        for (uint8_t i = 0; i < SENSOR_MAX_CHANNELS; i++) {
+            if (latest[i].channel != SENSOR_CHANNEL_INVALID) {
+                endpoint.dirty_sensors |= SensorBus::maskOf((SensorChannel)i);
+            }
+        }
+        force_relays = true;
+    }
+
+    if (endpoint.dirty_sensors) {
+        if (buildSensors(endpoint.dirty_sensors)) send(endpoint, "sensors");
+        endpoint.dirty_sensors = 0;
+    }
+
+    if (force_relays || relay_generation != endpoint.sent_relay_generation) {
+        if (buildRelays()) send(endpoint, "relays");
+        endpoint.sent_relay_generation = relay_generation;
+    }
+
+    // buildRules() avança o cursor até onde coube no buffer
+    if (endpoint.rule_cursor != rule_sequence) {
+        if (buildRules(endpoint)) send(endpoint, "rules");
+    }
+}
+
+void EventStream::send(Endpoint& endpoint, const char* event) {
+    endpoint.source->send(buffer, event, ++event_id);
+    endpoint.events_sent++;
+}
+
+size_t EventStream::buildSensors(SensorBus::ChannelMask channels) {
+    StaticJsonDocument<EVENT_STREAM_BUFFER_SIZE> doc;
+    doc["t"] = millis();
+    JsonObject values = doc.createNestedObject("values");
+    JsonObject quality;
+
+    for (uint8_t i = 0; i < SENSOR_MAX_CHANNELS; i++) {
+        if (!(channels & SensorBus::maskOf((SensorChannel)i))) continue;
+
+        const SensorReading& reading = latest[i];
+        if (!reading.descriptor) continue;
+
+        values[reading.descriptor->key] = reading.value;
+        // Qualidade só quando não é boa (mantém a mensagem curta)
+        if (!reading.isGood()) {
+            if (quality.isNull()) quality = doc.createNestedObject("quality");
+            quality[reading.descriptor->key] = reading.quality;
+        }
+    }
+
+    if (values.size() == 0) return 0;
+    return serializeJson(doc, buffer, sizeof(buffer));
+}
+
+size_t EventStream::buildRelays() {
+    StaticJsonDocument<384> doc;
+    doc["generation"] = hydro->getRelayGeneration();
+
+    JsonArray states = doc.createNestedArray("states");
+    bool* relayStates = hydro->getRelayStates();
+    for (int i = 0; i < HydroControl::NUM_RELAYS; i++) {
+        states.add(relayStates[i] ? 1 : 0);
+    }
+
+    return serializeJson(doc, buffer, sizeof(buffer));
+}
+
+size_t EventStream::buildRules(Endpoint& endpoint) {
+    // Disparos que já saíram do anel são só contados
+    uint32_t first = endpoint.rule_cursor;
+    uint32_t dropped = 0;
+    if (rule_sequence - first > EVENT_STREAM_RULE_QUEUE) {
+        dropped = rule_sequence - first - EVENT_STREAM_RULE_QUEUE;
+        first = rule_sequence - EVENT_STREAM_RULE_QUEUE;
+    }
+
+    // Documento comporta o anel inteiro; o limite real é o buffer do
+    // evento. O que não couber fica para o próximo flush (o cursor para
+    // no último disparo incluído).
+    StaticJsonDocument<EVENT_STREAM_RULES_DOC_SIZE> doc;
+    if (dropped) doc["dropped"] = dropped;
+    JsonArray list = doc.createNestedArray("rules");
+
+    uint32_t seq = first;
+    for (; seq < rule_sequence; seq++) {
+        const RuleEvent& entry = rules[seq % EVENT_STREAM_RULE_QUEUE];
+        JsonObject item = list.createNestedObject();
+        item["event"] = entry.event;
+        item["detail"] = entry.detail;
+        item["t"] = entry.timestamp;
+        if (entry.count > 1) item["count"] = entry.count;
+
+        if (doc.overflowed() || measureJson(doc) >= sizeof(buffer)) {
+            list.remove(list.size() - 1);
+            break;
+        }
+    }
+
+    if (list.size() == 0) {
+        // Nem um disparo coube: pula para não travar o cursor
+        endpoint.rule_cursor = first + 1;
+        return 0;
+    }
+
+    endpoint.rule_cursor = seq;
+    if (seq != rule_sequence) endpoint.rules_deferred++;
+    return serializeJson(doc, buffer, sizeof(buffer));
+}
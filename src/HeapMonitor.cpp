@@ -0,0 +1,470 @@
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+
+namespace {
+
+// Mesmas regiões de ESP.getFreeHeap()/getMaxAllocHeap(): os limites do
+// HydroSystemCore continuam comparáveis
+const uint32_t HEAP_CAPS = MALLOC_CAP_INTERNAL;
+const uint32_t SAMPLES_PER_HOUR = 3600000UL / HEAP_SAMPLE_INTERVAL_MS;
+const uint32_t REPORT_MAGIC = 0x48454150;    // "HEAP"
+
+/**
+ * @brief Relatório do último reinício por memória
+ */
+struct RestartReport {
+    uint32_t magic;
+    uint32_t uptime_s;
+    uint32_t free_bytes;
+    uint32_t largest_block;
+    char reason[24];
+    uint8_t tag_count;
+    struct {
+        char name[HEAP_TAG_NAME_SIZE];
+        int32_t retained;
+        uint32_t block_loss;
+    } tags[HEAP_REPORT_TAGS];
+};
+
+// Não é zerada no boot: sobrevive ao ESP.restart() (some ao desligar)
+RTC_NOINIT_ATTR RestartReport rtc_report;
+RestartReport previous_report;
+bool has_previous = false;
+
+}  // namespace
+
+// ===== INSTÂNCIA =====
+HeapMonitor& HeapMonitor::shared() {
+    static HeapMonitor monitor;
+    return monitor;
+}
+
+HeapMonitor::HeapMonitor() :
+    recent_count(0),
+    hourly_count(0),
+    hour_samples(0),
+    last_sample(0),
+    last_free(0),
+    last_block(0),
+    free_blocks(0),
+    min_free(HEAP_DEFAULT_MIN_FREE),
+    min_block(HEAP_DEFAULT_MIN_BLOCK),
+    free_slope(0),
+    block_slope(0),
+    alert(HEAP_ALERT_OK),
+    tag_count(0) {
+    spinlock = portMUX_INITIALIZER_UNLOCKED;
+    memset(recent, 0, sizeof(recent));
+    memset(hourly, 0, sizeof(hourly));
+    memset(&hour_min, 0, sizeof(hour_min));
+    memset(tags, 0, sizeof(tags));
+}
+
+void HeapMonitor::begin() {
+    if (rtc_report.magic == REPORT_MAGIC) {
+        previous_report = rtc_report;
+        previous_report.reason[sizeof(previous_report.reason) - 1] = '\0';
+        has_previous = true;
+        LOGW(SYSTEM, "🧩 Boot anterior reiniciado por %s (livre %lu, maior bloco %lu, uptime %lus)",
+             previous_report.reason, (unsigned long)previous_report.free_bytes,
+             (unsigned long)previous_report.largest_block, (unsigned long)previous_report.uptime_s);
+    }
+    rtc_report.magic = 0;
+
+    sample();
+}
+
+// ===== AMOSTRAGEM =====
+void HeapMonitor::loop() {
+    if (last_sample != 0 && millis() - last_sample < HEAP_SAMPLE_INTERVAL_MS) return;
+    sample();
+}
+
+void HeapMonitor::sample() {
+    last_sample = millis();
+
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, HEAP_CAPS);
+
+    Sample current;
+    current.free_bytes = info.total_free_bytes;
+    current.largest_block = info.largest_free_block;
+
+    last_free = current.free_bytes;
+    last_block = current.largest_block;
+    free_blocks = info.free_blocks;
+
+    recent[recent_count % HEAP_RECENT_SAMPLES] = current;
+    recent_count++;
+
+    // Mínimo da hora: o que importa é o fundo do poço, não a média
+    if (hour_samples == 0) {
+        hour_min = current;
+    } else {
+        hour_min.free_bytes = min(hour_min.free_bytes, current.free_bytes);
+        hour_min.largest_block = min(hour_min.largest_block, current.largest_block);
+    }
+    if (++hour_samples >= SAMPLES_PER_HOUR) {
+        hourly[hourly_count % HEAP_HOURLY_SAMPLES] = hour_min;
+        hourly_count++;
+        hour_samples = 0;
+        updateTrend();
+    }
+
+    updateAlert();
+}
+
+void HeapMonitor::setThresholds(uint32_t min_free, uint32_t min_block) {
+    this->min_free = min_free;
+    this->min_block = min_block;
+}
+
+uint8_t HeapMonitor::getFragmentation() const {
+    return last_free > 0 ? (uint8_t)(100 - (uint64_t)last_block * 100 / last_free) : 100;
+}
+
+const char* HeapMonitor::getTopTag() const {
+    uint8_t top = 0;
+    return topTags(&top, 1) ? tags[top].name : nullptr;
+}
+
+// ===== TENDÊNCIA =====
+void HeapMonitor::updateTrend() {
+    free_slope = slopePerHour(false);
+    block_slope = slopePerHour(true);
+}
+
+float HeapMonitor::slopePerHour(bool largest) const {
+    // Mínimos quadrados sobre as horas fechadas, a mais antiga em x = 0
+    uint32_t count = min(hourly_count, (uint32_t)HEAP_HOURLY_SAMPLES);
+    if (count < 2) return 0;
+
+    uint32_t first = hourly_count - count;
+    double sum_x = 0, sum_y = 0, sum_xy = 0, sum_xx = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const Sample& entry = hourly[(first + i) % HEAP_HOURLY_SAMPLES];
+        double y = largest ? entry.largest_block : entry.free_bytes;
+        sum_x += i;
+        sum_y += y;
+        sum_xy += i * y;
+        sum_xx += (double)i * i;
+    }
+    double denominator = count * sum_xx - sum_x * sum_x;
+    return denominator != 0 ? (float)((count * sum_xy - sum_x * sum_y) / denominator) : 0;
+}
+
+float HeapMonitor::hoursUntil(uint32_t current, uint32_t limit, float slope) {
+    if (current <= limit) return 0;
+    if (slope >= 0) return -1;               // Estável ou subindo: sem previsão
+    return (current - limit) / -slope;
+}
+
+void HeapMonitor::updateAlert() {
+    HeapAlert next = HEAP_ALERT_OK;
+    float free_eta = -1;
+    float block_eta = -1;
+
+    // Histerese de 10% para sair de "low": sem alerta a cada amostra no limite
+    bool below = last_free < min_free || last_block < min_block;
+    bool recovered = last_free >= min_free + min_free / 10 && last_block >= min_block + min_block / 10;
+    if (below || (alert == HEAP_ALERT_LOW && !recovered)) {
+        next = HEAP_ALERT_LOW;
+    } else if (hourly_count >= HEAP_TREND_MIN_HOURS) {
+        free_eta = hoursUntil(last_free, min_free, free_slope);
+        block_eta = hoursUntil(last_block, min_block, block_slope);
+        if ((free_eta >= 0 && free_eta < HEAP_TREND_HORIZON_HOURS) ||
+            (block_eta >= 0 && block_eta < HEAP_TREND_HORIZON_HOURS)) {
+            next = HEAP_ALERT_TREND;
+        }
+    }
+
+    if (next == alert) return;
+
+    const char* culprit = getTopTag();
+    if (!culprit) culprit = "?";
+    if (next == HEAP_ALERT_LOW) {
+        LOGE(SYSTEM, "🚨 Heap abaixo do limite: livre %lu/%lu, maior bloco %lu/%lu (maior retenção: %s)",
+             (unsigned long)last_free, (unsigned long)min_free,
+             (unsigned long)last_block, (unsigned long)min_block, culprit);
+    } else if (next == HEAP_ALERT_TREND) {
+        LOGW(SYSTEM, "📉 Heap em queda: livre %+.0f B/h (%.1fh), maior bloco %+.0f B/h (%.1fh) até o limite (maior retenção: %s)",
+             free_slope, free_eta, block_slope, block_eta, culprit);
+    } else {
+        LOGI(SYSTEM, "✅ Heap estável: livre %lu, maior bloco %lu",
+             (unsigned long)last_free, (unsigned long)last_block);
+    }
+    alert = next;
+}
+
+// ===== TAGS =====
+int8_t HeapMonitor::tag(const char* name) {
+    portENTER_CRITICAL(&spinlock);
+    int8_t id = -1;
+    for (uint8_t i = 0; i < tag_count; i++) {
+        if (strcmp(tags[i].name, name) == 0) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0 && tag_count < HEAP_MAX_TAGS) {
+        id = tag_count++;
+        tags[id].name = name;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return id;
+}
+
+void HeapMonitor::recordScope(int8_t id, uint32_t free_before, uint32_t block_before) {
+    if (id < 0) return;
+
+    int32_t retained = (int32_t)(free_before - heap_caps_get_free_size(HEAP_CAPS));
+    uint32_t block_after = heap_caps_get_largest_free_block(HEAP_CAPS);
+
+    portENTER_CRITICAL(&spinlock);
+    TagStats& entry = tags[id];
+    entry.calls++;
+    entry.retained += retained;
+    if (retained > entry.max_retained) entry.max_retained = retained;
+    if (block_after < block_before) entry.block_loss += block_before - block_after;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+void HeapMonitor::recordJsonAlloc(int8_t id, size_t bytes, bool ok) {
+    if (id < 0) return;
+
+    portENTER_CRITICAL(&spinlock);
+    TagStats& entry = tags[id];
+    if (ok) {
+        entry.json_live += bytes;
+        if (entry.json_live > entry.json_peak) entry.json_peak = entry.json_live;
+    } else {
+        entry.json_failed++;
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+void HeapMonitor::recordJsonFree(int8_t id, size_t bytes) {
+    if (id < 0) return;
+
+    portENTER_CRITICAL(&spinlock);
+    TagStats& entry = tags[id];
+    entry.json_live = entry.json_live > bytes ? entry.json_live - bytes : 0;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+// ===== REINÍCIO =====
+void HeapMonitor::recordRestart(const char* reason) {
+    sample();
+    printReport();
+
+    uint8_t order[HEAP_REPORT_TAGS];
+    uint8_t count = topTags(order, HEAP_REPORT_TAGS);
+
+    rtc_report.uptime_s = millis() / 1000;
+    rtc_report.free_bytes = last_free;
+    rtc_report.largest_block = last_block;
+    snprintf(rtc_report.reason, sizeof(rtc_report.reason), "%s", reason);
+    rtc_report.tag_count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        const TagStats& entry = tags[order[i]];
+        snprintf(rtc_report.tags[i].name, HEAP_TAG_NAME_SIZE, "%s", entry.name);
+        rtc_report.tags[i].retained = (int32_t)constrain(entry.retained, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+        rtc_report.tags[i].block_loss = (uint32_t)min(entry.block_loss, (uint64_t)UINT32_MAX);
+    }
+    rtc_report.magic = REPORT_MAGIC;
+}
+
+void HeapMonitor::printReport() {
+    // Direto na Serial: costuma vir logo antes de ESP.restart()
+    Serial.printf("🧩 Heap: livre %lu | maior bloco %lu | fragmentação %u%% | %lu blocos livres\n",
+                  (unsigned long)last_free, (unsigned long)last_block, getFragmentation(),
+                  (unsigned long)free_blocks);
+
+    uint8_t order[HEAP_MAX_TAGS];
+    uint8_t count = topTags(order, HEAP_MAX_TAGS);
+    for (uint8_t i = 0; i < count; i++) {
+        const TagStats& entry = tags[order[i]];
+        Serial.printf("   %-16s retido %7ld B | bloco -%lu B | %lu chamadas | JSON pico %lu B, %lu falhas\n",
+                      entry.name, (long)entry.retained, (unsigned long)min(entry.block_loss, (uint64_t)UINT32_MAX),
+                      (unsigned long)entry.calls, (unsigned long)entry.json_peak, (unsigned long)entry.json_failed);
+    }
+}
+
+// ===== CONSULTA =====
+void HeapMonitor::attach(AsyncWebServer* server, const char* uri) {
+    server->on(uri, HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (request->hasParam("reset")) {
+            reset();
+        }
+        AsyncWebServerResponse* response = request->beginResponse(200, "application/json",
+                                                                  getJSON(request->hasParam("history")));
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    });
+}
+
+String HeapMonitor::getJSON(bool history) {
+    // Cópia das tags sob o spinlock; o JSON é montado fora dele
+    TagStats tag_copy[HEAP_MAX_TAGS];
+    portENTER_CRITICAL(&spinlock);
+    uint8_t tags_used = tag_count;
+    memcpy(tag_copy, tags, sizeof(TagStats) * tags_used);
+    portEXIT_CRITICAL(&spinlock);
+
+    // Os anéis só quando pedidos: ~8KB a mais de documento
+    DynamicJsonDocument doc(4096 + (history ? (HEAP_RECENT_SAMPLES + HEAP_HOURLY_SAMPLES) * 32 : 0));
+    doc["uptime_ms"] = millis();
+    doc["free"] = last_free;
+    doc["largest_block"] = last_block;
+    doc["fragmentation"] = getFragmentation();
+    doc["free_blocks"] = free_blocks;
+    doc["min_free_ever"] = heap_caps_get_minimum_free_size(HEAP_CAPS);
+    doc["min_free"] = min_free;
+    doc["min_block"] = min_block;
+
+    static const char* const ALERT_NAMES[] = {"ok", "trend", "low"};
+    doc["alert"] = ALERT_NAMES[alert];
+
+    JsonObject trend = doc.createNestedObject("trend");
+    trend["hours"] = min(hourly_count, (uint32_t)HEAP_HOURLY_SAMPLES);
+    trend["free_per_hour"] = free_slope;
+    trend["block_per_hour"] = block_slope;
+    if (hourly_count >= HEAP_TREND_MIN_HOURS) {
+        float free_eta = hoursUntil(last_free, min_free, free_slope);
+        float block_eta = hoursUntil(last_block, min_block, block_slope);
+        if (free_eta >= 0) trend["free_eta_hours"] = free_eta;
+        if (block_eta >= 0) trend["block_eta_hours"] = block_eta;
+    }
+
+    JsonArray tag_list = doc.createNestedArray("tags");
+    for (uint8_t i = 0; i < tags_used; i++) {
+        const TagStats& entry = tag_copy[i];
+        JsonObject item = tag_list.createNestedObject();
+        item["name"] = entry.name;
+        item["calls"] = entry.calls;
+        item["retained"] = entry.retained;
+        item["max_retained"] = entry.max_retained;
+        item["block_loss"] = entry.block_loss;
+        item["json_live"] = entry.json_live;
+        item["json_peak"] = entry.json_peak;
+        item["json_failed"] = entry.json_failed;
+    }
+
+    if (has_previous) {
+        JsonObject previous = doc.createNestedObject("previous_boot");
+        previous["reason"] = (const char*)previous_report.reason;
+        previous["uptime_s"] = previous_report.uptime_s;
+        previous["free"] = previous_report.free_bytes;
+        previous["largest_block"] = previous_report.largest_block;
+        JsonArray culprits = previous.createNestedArray("tags");
+        for (uint8_t i = 0; i < previous_report.tag_count && i < HEAP_REPORT_TAGS; i++) {
+            JsonObject item = culprits.createNestedObject();
+            item["name"] = (const char*)previous_report.tags[i].name;
+            item["retained"] = previous_report.tags[i].retained;
+            item["block_loss"] = previous_report.tags[i].block_loss;
+        }
+    }
+
+    if (history) {
+        // Mais antiga primeiro
+        JsonObject recent_json = doc.createNestedObject("recent");
+        recent_json["interval_s"] = HEAP_SAMPLE_INTERVAL_MS / 1000;
+        JsonArray recent_free = recent_json.createNestedArray("free");
+        JsonArray recent_block = recent_json.createNestedArray("block");
+        uint32_t available = min(recent_count, (uint32_t)HEAP_RECENT_SAMPLES);
+        for (uint32_t i = recent_count - available; i < recent_count; i++) {
+            recent_free.add(recent[i % HEAP_RECENT_SAMPLES].free_bytes);
+            recent_block.add(recent[i % HEAP_RECENT_SAMPLES].largest_block);
+        }
+
+        JsonObject hourly_json = doc.createNestedObject("hourly");
+        JsonArray hourly_free = hourly_json.createNestedArray("min_free");
+        JsonArray hourly_block = hourly_json.createNestedArray("min_block");
+        available = min(hourly_count, (uint32_t)HEAP_HOURLY_SAMPLES);
+        for (uint32_t i = hourly_count - available; i < hourly_count; i++) {
+            hourly_free.add(hourly[i % HEAP_HOURLY_SAMPLES].free_bytes);
+            hourly_block.add(hourly[i % HEAP_HOURLY_SAMPLES].largest_block);
+        }
+    }
+
+    // Tamanho exato antes: a String não cresce em degraus no heap que medimos
+    String result;
+    result.reserve(measureJson(doc) + 1);
+    serializeJson(doc, result);
+    return result;
+}
+
+void HeapMonitor::reset() {
+    portENTER_CRITICAL(&spinlock);
+    for (uint8_t i = 0; i < tag_count; i++) {
+        // json_live continua: os documentos ainda vivos serão liberados depois
+        tags[i].calls = 0;
+        tags[i].retained = 0;
+        tags[i].max_retained = 0;
+        tags[i].block_loss = 0;
+        tags[i].json_peak = tags[i].json_live;
+        tags[i].json_failed = 0;
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+// ===== MÉTODOS INTERNOS =====
+uint8_t HeapMonitor::topTags(uint8_t* order, uint8_t max) const {
+    // Ordena por retenção acumulada (inserção: no máximo HEAP_MAX_TAGS)
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < tag_count; i++) {
+        if (tags[i].calls == 0 && tags[i].json_peak == 0) continue;
+
+        uint8_t position = count;
+        while (position > 0 && tags[order[position - 1]].retained < tags[i].retained) {
+            position--;
+        }
+        if (position >= max) continue;
+
+        // Abre espaço; com a lista cheia o último sai
+        for (uint8_t j = count < max ? count : max - 1; j > position; j--) {
+            order[j] = order[j - 1];
+        }
+        order[position] = i;
+        if (count < max) count++;
+    }
+    return count;
+}
+
+// ===== ESCOPO E ALOCADOR =====
+ScopedHeapTag::ScopedHeapTag(int8_t id) : id(id), free_before(0), block_before(0) {
+    if (id < 0) return;
+    free_before = heap_caps_get_free_size(HEAP_CAPS);
+    block_before = heap_caps_get_largest_free_block(HEAP_CAPS);
+}
+
+ScopedHeapTag::~ScopedHeapTag() {
+    HeapMonitor::shared().recordScope(id, free_before, block_before);
+}
+
+void* HeapTagAllocator::allocate(size_t bytes) {
+    void* pointer = malloc(bytes);
+    HeapMonitor::shared().recordJsonAlloc(id, bytes, pointer != nullptr);
+    if (pointer) size = bytes;
+    return pointer;
+}
+
+void HeapTagAllocator::deallocate(void* pointer) {
+    // Documento movido fica sem pool: nada a descontar
+    if (!pointer) return;
+    free(pointer);
+    HeapMonitor::shared().recordJsonFree(id, size);
+    size = 0;
+}
+
+void* HeapTagAllocator::reallocate(void* pointer, size_t bytes) {
+    void* resized = realloc(pointer, bytes);
+    if (resized) {
+        HeapMonitor::shared().recordJsonFree(id, size);
+        HeapMonitor::shared().recordJsonAlloc(id, bytes, true);
+        size = bytes;
+    }
+    return resized;
+}
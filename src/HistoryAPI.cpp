@@ -0,0 +1,378 @@
+#include "HistoryAPI.h"
+#include <ArduinoJson.h>
+#include <memory>
+#include <stdarg.h>
+
+namespace {
+
+const char* const TIER_NAMES[] = {"raw", "minute", "quarter"};
+const uint32_t RAW_STEP_S = TS_RAW_INTERVAL_MS / 1000;
+const uint8_t MAX_CHANNELS = TS_MAX_COLUMNS / 3;
+
+/**
+ * @brief Estado de uma resposta em andamento (vive enquanto o TCP envia)
+ *
+ * Cada chamada do filler continua a consulta a partir de cursor, em lotes
+ * de HISTORY_CHUNK_ROWS linhas. Um ponto que não coube no buffer do TCP
+ * fica em pending e sai na chamada seguinte.
+ */
+struct HistoryCursor {
+    TimeSeriesStore* store;
+    volatile uint8_t* active_streams;
+    TimeSeriesStore::Tier tier;
+    uint32_t to;
+    uint32_t from;
+    uint32_t step;                  // 0 = linhas sem redução (paginadas)
+    uint32_t cursor;                // Próximo tempo a consultar
+    uint8_t channels[MAX_CHANNELS];
+    uint8_t channel_count;
+    bool minmax;
+    uint16_t limit;
+    uint16_t emitted;
+    uint32_t next;                  // Início da próxima página (0 = não há)
+    bool query_done;
+    bool finished;
+
+    // Ponto sendo agregado
+    bool bucket_active;
+    uint32_t bucket;
+    uint16_t count[MAX_CHANNELS];
+    float sum[MAX_CHANNELS];
+    float low[MAX_CHANNELS];
+    float high[MAX_CHANNELS];
+
+    char pending[HISTORY_LINE_SIZE];
+    size_t pending_len;
+    size_t pending_pos;
+
+    // Lote copiado do store, consumido fora do mutex
+    TimeSeriesRow batch[HISTORY_CHUNK_ROWS];
+    uint8_t batch_count;
+    uint8_t batch_pos;
+
+    ~HistoryCursor() {
+        if (active_streams && *active_streams > 0) (*active_streams)--;
+    }
+
+    void stage(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(pending + pending_len, sizeof(pending) - pending_len, format, args);
+        va_end(args);
+        if (length > 0) {
+            pending_len += min((size_t)length, sizeof(pending) - pending_len - 1);
+        }
+    }
+
+    void stageValue(float value) {
+        if (isnan(value)) {
+            stage(",null");
+        } else {
+            stage(",%.5g", value);
+        }
+    }
+
+    size_t drain(uint8_t* out, size_t max_len, size_t written) {
+        size_t length = min(pending_len - pending_pos, max_len - written);
+        memcpy(out + written, pending + pending_pos, length);
+        pending_pos += length;
+        if (pending_pos == pending_len) {
+            pending_len = 0;
+            pending_pos = 0;
+        }
+        return written + length;
+    }
+
+    bool hasPending() const { return pending_len > 0; }
+
+    void stagePoint() {
+        stage(emitted == 0 ? "[%lu" : ",[%lu", (unsigned long)bucket);
+        for (uint8_t i = 0; i < channel_count; i++) {
+            stageValue(count[i] ? sum[i] / count[i] : NAN);
+            if (minmax) {
+                stageValue(count[i] ? low[i] : NAN);
+                stageValue(count[i] ? high[i] : NAN);
+            }
+        }
+        stage("]");
+        emitted++;
+        bucket_active = false;
+    }
+
+    void openBucket(uint32_t time) {
+        bucket_active = true;
+        bucket = step ? from + ((time - from) / step) * step : time;
+        for (uint8_t i = 0; i < channel_count; i++) {
+            count[i] = 0;
+            sum[i] = 0.0;
+            low[i] = NAN;
+            high[i] = NAN;
+        }
+    }
+
+    void accumulate(const TimeSeriesRow& row) {
+        for (uint8_t i = 0; i < channel_count; i++) {
+            uint8_t column = tier == TimeSeriesStore::TIER_RAW ? channels[i] : channels[i] * 3;
+            float avg = row.values[column];
+            if (isnan(avg)) continue;
+
+            float row_low = tier == TimeSeriesStore::TIER_RAW ? avg : row.values[column + 1];
+            float row_high = tier == TimeSeriesStore::TIER_RAW ? avg : row.values[column + 2];
+            if (count[i] == 0 || row_low < low[i]) low[i] = row_low;
+            if (count[i] == 0 || row_high > high[i]) high[i] = row_high;
+            sum[i] += avg;
+            count[i]++;
+        }
+    }
+
+    /**
+     * @brief Linha da consulta: fecha o ponto anterior ou acumula
+     */
+    void consume(const TimeSeriesRow& row) {
+        // Sem redução: página cheia, a próxima começa nesta linha
+        if (!step && emitted >= limit) {
+            next = row.time;
+            query_done = true;
+            batch_count = 0;
+            return;
+        }
+
+        uint32_t row_bucket = step ? from + ((row.time - from) / step) * step : row.time;
+        if (bucket_active && row_bucket != bucket) {
+            stagePoint();
+        }
+        if (!bucket_active) openBucket(row.time);
+        accumulate(row);
+
+        // Sem redução cada linha é um ponto
+        if (!step) stagePoint();
+    }
+
+    /**
+     * @brief Copia o próximo lote de linhas (o mutex do store só fica
+     *        tomado durante a cópia, não enquanto o JSON é montado)
+     */
+    void loadBatch() {
+        batch_count = 0;
+        batch_pos = 0;
+        store->query(tier, cursor, to, [this](const TimeSeriesRow& row) {
+            batch[batch_count++] = row;
+            cursor = row.time + 1;
+            return batch_count < HISTORY_CHUNK_ROWS;
+        });
+        if (batch_count < HISTORY_CHUNK_ROWS) query_done = true;
+    }
+
+    /**
+     * @brief Preenche até max_len bytes; 0 = resposta completa
+     */
+    size_t fill(uint8_t* out, size_t max_len) {
+        size_t written = drain(out, max_len, 0);
+
+        // Só segue com o staging vazio: o que não coube volta na chamada seguinte
+        while (written < max_len && !finished) {
+            if (batch_pos < batch_count) {
+                consume(batch[batch_pos++]);
+                written = drain(out, max_len, written);
+            } else if (!query_done) {
+                loadBatch();
+            } else {
+                if (bucket_active) stagePoint();
+                if (next) {
+                    stage("],\"next\":%lu}", (unsigned long)next);
+                } else {
+                    stage("]}");
+                }
+                finished = true;
+                written = drain(out, max_len, written);
+            }
+        }
+        return written;
+    }
+};
+
+}  // namespace
+
+HistoryAPI::HistoryAPI() :
+    store(nullptr),
+    active_streams(0) {
+}
+
+void HistoryAPI::begin(AsyncWebServer* server, TimeSeriesStore& timeSeries) {
+    store = &timeSeries;
+
+    // Rotas mais específicas primeiro: "/api/history" também casa com "/api/history/..."
+    server->on("/api/history/summary", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        handleSummary(request);
+    });
+
+    server->on("/api/history/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", store->getStatusJSON());
+    });
+
+    server->on("/api/history", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        handleSeries(request);
+    });
+}
+
+// ===== ENDPOINTS =====
+void HistoryAPI::handleSeries(AsyncWebServerRequest* request) {
+    if (!store->isReady()) {
+        sendError(request, 503, "Histórico não disponível");
+        return;
+    }
+    if (active_streams >= HISTORY_MAX_STREAMS) {
+        sendError(request, 503, "Muitas consultas simultâneas");
+        return;
+    }
+
+    uint32_t from, to;
+    if (!parseRange(request, from, to)) {
+        sendError(request, 400, "Intervalo inválido");
+        return;
+    }
+
+    // make_shared inicializa por valor: todos os campos zerados
+    std::shared_ptr<HistoryCursor> state = std::make_shared<HistoryCursor>();
+    HistoryCursor& cursor = *state;
+    cursor.store = store;
+    cursor.from = from;
+    cursor.to = to;
+    cursor.cursor = from;
+    cursor.minmax = paramU32(request, "minmax", 0) != 0;
+
+    // Canais: "ph,ec" ou todos
+    if (request->hasParam("channels")) {
+        String list = request->getParam("channels")->value();
+        int start = 0;
+        while (start <= (int)list.length() && cursor.channel_count < MAX_CHANNELS) {
+            int comma = list.indexOf(',', start);
+            if (comma < 0) comma = list.length();
+            String key = list.substring(start, comma);
+            key.trim();
+            if (key.length() > 0) {
+                int channel = store->findChannel(key);
+                if (channel < 0) {
+                    sendError(request, 400, "Canal desconhecido");
+                    return;
+                }
+                cursor.channels[cursor.channel_count++] = channel;
+            }
+            start = comma + 1;
+        }
+    } else {
+        for (uint8_t i = 0; i < store->getChannelCount() && i < MAX_CHANNELS; i++) {
+            cursor.channels[cursor.channel_count++] = i;
+        }
+    }
+    if (cursor.channel_count == 0) {
+        sendError(request, 400, "Nenhum canal");
+        return;
+    }
+
+    // Nível e passo
+    uint32_t points = min(paramU32(request, "points", HISTORY_DEFAULT_POINTS), (uint32_t)HISTORY_MAX_POINTS);
+    // limit=0 devolveria "next" sem avançar: o cliente paginaria para sempre
+    cursor.limit = constrain(paramU32(request, "limit", HISTORY_PAGE_LIMIT), (uint32_t)1, (uint32_t)HISTORY_PAGE_LIMIT);
+    cursor.tier = store->selectTier(from, to, points ? points : HISTORY_PAGE_LIMIT);
+
+    if (request->hasParam("tier")) {
+        String name = request->getParam("tier")->value();
+        for (uint8_t t = 0; t < TimeSeriesStore::TIER_COUNT; t++) {
+            if (name == TIER_NAMES[t]) cursor.tier = (TimeSeriesStore::Tier)t;
+        }
+    }
+
+    if (points) {
+        uint32_t tier_step = cursor.tier == TimeSeriesStore::TIER_RAW ? RAW_STEP_S :
+                             cursor.tier == TimeSeriesStore::TIER_MINUTE ? 60 : 900;
+        uint32_t span_step = (to - from + points - 1) / points;
+        cursor.step = max(tier_step, span_step);
+    }
+
+    // Cabeçalho do JSON; os pontos seguem pelo filler
+    cursor.stage("{\"tier\":\"%s\",\"from\":%lu,\"to\":%lu,\"now\":%lu,\"step\":%lu,\"minmax\":%s,\"channels\":[",
+                 TIER_NAMES[cursor.tier], (unsigned long)from, (unsigned long)to,
+                 (unsigned long)store->now(), (unsigned long)cursor.step, cursor.minmax ? "true" : "false");
+    for (uint8_t i = 0; i < cursor.channel_count; i++) {
+        cursor.stage(i == 0 ? "\"%s\"" : ",\"%s\"", store->getChannelKey(cursor.channels[i]));
+    }
+    cursor.stage("],\"points\":[");
+
+    // Contado a partir daqui; o destrutor do cursor libera a vaga
+    active_streams++;
+    cursor.active_streams = &active_streams;
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+        [state](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+            return state->fill(buffer, max_len);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+void HistoryAPI::handleSummary(AsyncWebServerRequest* request) {
+    if (!store->isReady()) {
+        sendError(request, 503, "Histórico não disponível");
+        return;
+    }
+
+    uint32_t from, to;
+    if (!parseRange(request, from, to)) {
+        sendError(request, 400, "Intervalo inválido");
+        return;
+    }
+
+    String key = request->hasParam("channel") ? request->getParam("channel")->value() : "";
+    int channel = store->findChannel(key);
+    if (channel < 0) {
+        sendError(request, 400, "Canal desconhecido");
+        return;
+    }
+
+    TimeSeriesSummary summary;
+    bool found = store->summarize(channel, from, to, summary);
+
+    StaticJsonDocument<384> doc;
+    doc["channel"] = store->getChannelKey(channel);
+    doc["from"] = from;
+    doc["to"] = to;
+    doc["count"] = summary.count;
+    if (found) {
+        doc["min"] = summary.min;
+        doc["max"] = summary.max;
+        doc["mean"] = summary.mean;
+        doc["first_time"] = summary.first_time;
+        doc["last_time"] = summary.last_time;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+// ===== MÉTODOS INTERNOS =====
+bool HistoryAPI::parseRange(AsyncWebServerRequest* request, uint32_t& from, uint32_t& to) {
+    uint32_t now = store->now();
+    to = min(paramU32(request, "to", now), now);
+
+    if (request->hasParam("from")) {
+        from = paramU32(request, "from", 0);
+    } else {
+        uint32_t range = paramU32(request, "range", HISTORY_DEFAULT_RANGE_S);
+        from = range < to ? to - range : 0;
+    }
+    return from <= to;
+}
+
+uint32_t HistoryAPI::paramU32(AsyncWebServerRequest* request, const char* name, uint32_t fallback) {
+    if (!request->hasParam(name)) return fallback;
+    return strtoul(request->getParam(name)->value().c_str(), nullptr, 10);
+}
+
+void HistoryAPI::sendError(AsyncWebServerRequest* request, int code, const char* message) {
+    StaticJsonDocument<128> doc;
+    doc["error"] = message;
+    String response;
+    serializeJson(doc, response);
+    request->send(code, "application/json", response);
+}
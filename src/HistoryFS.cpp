@@ -0,0 +1,23 @@
+#include "HistoryFS.h"
+
+static bool mounted = false;
+
+bool HistoryFS::mount(const char* owner) {
+    if (mounted) return true;
+
+    // formatOnFail: partição nova (ou vinda do SPIFFS) é formatada uma vez
+    if (!LittleFS.begin(true, HISTORY_FS_BASE_PATH, HISTORY_FS_MAX_FILES, HISTORY_FS_PARTITION)) {
+        Serial.printf("❌ %s: partição '%s' não montada - gravar a tabela partitions_hydro.csv\n",
+                     owner, HISTORY_FS_PARTITION);
+        return false;
+    }
+
+    mounted = true;
+    Serial.printf("✅ LittleFS montado na partição '%s' (%u/%u KB usados)\n", HISTORY_FS_PARTITION,
+                 (unsigned)(LittleFS.usedBytes() / 1024), (unsigned)(LittleFS.totalBytes() / 1024));
+    return true;
+}
+
+bool HistoryFS::isMounted() {
+    return mounted;
+}
@@ -1,4 +1,6 @@
 #include "HydroControl.h"
+#include "Logger.h"
+#include "LoopProfiler.h"
 
 HydroControl::HydroControl()
     : lcd(0x27, 16, 2)
@@ -6,8 +8,11 @@ HydroControl::HydroControl()
     , sensors(&oneWire)
     , pcf1(0x20)  // Primeiro PCF8574
     , pcf2(0x24)  // Segundo PCF8574
+    , sensorTask(sensorBus.getStore())
     , pcf1_ok(false)
     , pcf2_ok(false)
+    , relayGeneration(0)
+    , sensorGeneration(0)
 {
     // Inicializa os estados dos relés
     for(int i = 0; i < NUM_RELAYS; i++) {
@@ -42,7 +47,16 @@ bool HydroControl::begin() {
     
     // Inicializar sensor de pH
     pHSensor = new phSensor();
-    pHSensor->calibrate(2.56, 3.3, 2.05, false);
+    phCalibration.begin();   // Curva salva na NVS (padrão: PH_CAL_7 / PH_CAL_4)
+    pHSensor->setCalibration(&phCalibration);
+    sensorHealth.setCalibration(&phCalibration);
+    sensorBus.setHealthMonitor(&sensorHealth);
+    
+    // Valores exibidos no LCD e retornados pelos getters chegam pelo barramento
+    sensorBus.subscribe(SensorBus::maskOf(SENSOR_WATER_TEMP) | SensorBus::maskOf(SENSOR_PH) |
+                        SensorBus::maskOf(SENSOR_TDS) | SensorBus::maskOf(SENSOR_EC) |
+                        SensorBus::maskOf(SENSOR_WATER_LEVEL),
+                        [this](const SensorReading& reading) { this->onSensorReading(reading); });
 
     // Inicializar sensor TDS
     tdsSensor = new TDSReaderSerial(TDS_PIN, 3.3, 1.0);
@@ -52,6 +66,14 @@ bool HydroControl::begin() {
     tankSensor = new LevelSensor(TANK_LOW_PIN, TANK_HIGH_PIN);
     tankSensor->begin();
 
+    // pH e TDS por ADC contínuo (DMA); sem ele, volta ao analogRead
+    if (!adcSampler.begin()) {
+        Serial.println("⚠️ ADC DMA indisponível - pH/TDS via analogRead");
+    }
+
+    // Aquisição assíncrona: o loop principal só lê os últimos valores
+    sensorTask.begin(&sensors, pHSensor, tdsSensor, tankSensor, &adcSampler);
+
     // Pequena pausa para estabilizar o barramento I2C
     delay(100);
 
@@ -105,98 +127,99 @@ void HydroControl::update() {
     updateSensors();
     updateDisplay();
     checkRelayTimers();
+    phCalibration.loop();
     
-    // Debug status
-    static unsigned long lastDebug = 0;
-    if (millis() - lastDebug > 5000) {  // A cada 5 segundos
-        lastDebug = millis();
-        Serial.println("\n=== Status do Sistema ===");
-        Serial.printf("Temperatura: %.1f°C\n", temperature);
-        Serial.printf("pH: %.2f\n", pH);
-        Serial.printf("TDS: %.0f ppm\n", tds);
-        Serial.printf("EC: %.0f uS/cm\n", ec);
-        Serial.println("Estado dos Relés:");
-        for (int i = 0; i < NUM_RELAYS; i++) {
-            Serial.printf("Relé %d: %s\n", i+1, relayStates[i] ? "ON" : "OFF");
-        }
-        Serial.println("=====================\n");
+    // Debug status (compilado só com LOG_LEVEL_HYDRO >= DEBUG)
+#if LOG_LEVEL_HYDRO >= LOG_LEVEL_DEBUG
+    uint16_t relayMask = 0;
+    for (int i = 0; i < NUM_RELAYS; i++) {
+        if (relayStates[i]) relayMask |= (1 << i);
     }
+    LOG_EVERY_MS(HYDRO, LOG_LEVEL_DEBUG, 5000, "Status: %.1f°C pH %.2f TDS %.0fppm EC %.0fuS/cm relés 0x%04X",
+                 temperature, pH, tds, ec, relayMask);
+#endif
 }
 
 void HydroControl::updateSensors() {
     static unsigned long lastErrorPrint = 0;  // Controlar prints de erro
     bool shouldPrintError = (millis() - lastErrorPrint > 5000);  // A cada 5 segundos
     
-    // Temperatura
-    sensors.requestTemperatures();
-    float tempReading = sensors.getTempCByIndex(0);
-    if (tempReading != -127.0 && tempReading >= MIN_TEMP && tempReading <= MAX_TEMP) {
-        temperature = tempReading;
-        sensorsOk = true;
-    } else {
-        if (shouldPrintError) {
-            Serial.println("⚠️ Erro na leitura da temperatura");
-        }
-        sensorsOk = false;
+    // Sem task dedicada: avançar as máquinas de estado aqui (não bloqueante)
+    if (!sensorTask.isRunning()) {
+        sensorTask.step(millis());
     }
     
-    // pH
-    float phReading = pHSensor->readPH(PH_PIN);
-    if (phReading >= MIN_PH && phReading <= MAX_PH) {
-        pH = phReading;
-        sensorsOk &= true;
-    } else {
-        if (shouldPrintError) {
-            Serial.println("⚠️ Erro na leitura do pH");
-        }
-        sensorsOk = false;
-    }
+    // Estatísticas por sensor antes da entrega (qualidade DEGRADED já atualizada)
+    unsigned long now = millis();
+    sensorHealth.update(sensorBus.getStore(), now);
     
-    // TDS e EC
-    tdsSensor->updateTemperature(temperature);
-    tdsSensor->readTDS();
-    float tdsReading = tdsSensor->getTDSValue();
-    if (tdsReading >= MIN_TDS && tdsReading <= MAX_TDS) {
-        tds = tdsReading;
-        ec = tdsSensor->getECValue();
-        sensorsOk &= true;
-    } else {
-        Serial.println("⚠️ Valor TDS fora do intervalo válido");
-        sensorsOk = false;
-    }
-
-    // Nível do reservatório
-    String tankStatus = tankSensor->getStatus();
-    tankLevelOk = tankSensor->checkWaterLevel();
+    // Entrega as amostras novas aos assinantes (inclusive onSensorReading)
+    sensorBus.dispatch(now);
     
-    // Log detalhado (solo si debe imprimir o si todo está OK)
-    if (sensorsOk) {
-        if (shouldPrintError) {  // Imprimir OK también cada 5 segundos
-            Serial.println("\n✅ Leitura dos sensores OK:");
-            Serial.printf("  Temperatura: %.1f°C\n", temperature);
-            Serial.printf("  pH: %.2f\n", pH);
-            Serial.printf("  TDS: %.0f ppm\n", tds);
-            Serial.printf("  EC: %.0f µS/cm\n", ec);
-            Serial.println("  Nível: " + tankStatus);
-            lastErrorPrint = millis();  // Actualizar timestamp
+    // Amostras ainda não publicadas (boot) não contam como erro;
+    // falha do monitor (parado, sem dados) conta
+    auto channelOk = [this, now](SensorChannel channel) {
+        SensorReading reading;
+        if (!sensorBus.read(channel, reading, now)) return false;
+        if (reading.quality & SAMPLE_QUALITY_NO_DATA) return true;
+        return !(reading.quality & SAMPLE_QUALITY_INVALID) &&
+               sensorHealth.getStatus(channel).level != SENSOR_HEALTH_FAILED;
+    };
+    bool tempOk = channelOk(SENSOR_WATER_TEMP);
+    bool phOk = channelOk(SENSOR_PH);
+    bool tdsOk = channelOk(SENSOR_TDS);
+    sensorsOk = tempOk && phOk && tdsOk;
+    
+    // Log resumido a cada 5 segundos (leitura OK só em DEBUG)
+    if (shouldPrintError) {
+        if (sensorsOk) {
+            LOGD(HYDRO, "✅ Sensores OK: %.1f°C pH %.2f TDS %.0fppm EC %.0fµS/cm nível %s",
+                 temperature, pH, tds, ec, tankLevelOk ? "OK" : "BAIXO");
+        } else {
+            LOGW(HYDRO, "⚠️ Sensores: %.1f°C %s pH %.2f %s TDS %.0fppm %s EC %.0fµS/cm nível %s",
+                 temperature, tempOk ? "✓" : "✗", pH, phOk ? "✓" : "✗", tds, tdsOk ? "✓" : "✗",
+                 ec, tankLevelOk ? "OK" : "BAIXO");
         }
-    } else {
-        if (shouldPrintError) {  // Solo imprimir errores cada 5 segundos
-            Serial.println("\n⚠️ Problemas na leitura dos sensores:");
-            Serial.printf("  Temperatura: %.1f°C %s\n", temperature, 
-                (tempReading >= MIN_TEMP && tempReading <= MAX_TEMP) ? "✓" : "✗");
-            Serial.printf("  pH: %.2f %s\n", pH,
-                (phReading >= MIN_PH && phReading <= MAX_PH) ? "✓" : "✗");
-            Serial.printf("  TDS: %.0f ppm %s\n", tds,
-                (tdsReading >= MIN_TDS && tdsReading <= MAX_TDS) ? "✓" : "✗");
-            Serial.printf("  EC: %.0f µS/cm\n", ec);
-            Serial.println("  Nível: " + tankStatus);
-            lastErrorPrint = millis();  // Actualizar timestamp
+        lastErrorPrint = millis();
+    }
+}
+
+void HydroControl::onSensorReading(const SensorReading& reading) {
+    // Nível: qualquer problema na leitura conta como nível baixo
+    if (reading.channel == SENSOR_WATER_LEVEL) {
+        bool usable = !(reading.quality & (SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_STALE | SAMPLE_QUALITY_NO_DATA));
+        bool levelOk = usable && reading.value > 0.5;
+        if (levelOk != tankLevelOk) {
+            tankLevelOk = levelOk;
+            sensorGeneration++;
         }
+        return;
+    }
+    
+    // Demais canais: manter o último valor válido
+    if (reading.quality & (SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_NO_DATA)) return;
+    
+    float* target = nullptr;
+    switch (reading.channel) {
+        case SENSOR_WATER_TEMP: target = &temperature; break;
+        case SENSOR_PH: target = &pH; break;
+        case SENSOR_TDS: target = &tds; break;
+        case SENSOR_EC: target = &ec; break;
+        default: break;
+    }
+    if (target && *target != reading.value) {
+        *target = reading.value;
+        sensorGeneration++;
     }
 }
 
 void HydroControl::updateDisplay() {
+    // LCD via I2C é lento: atualizar no máximo a cada 1 segundo
+    static unsigned long lastDisplayUpdate = 0;
+    if (millis() - lastDisplayUpdate < 1000) return;
+    lastDisplayUpdate = millis();
+    
+    PROFILE_SCOPE("i2c.lcd");
     lcd.clear();
     
     // Linha 1: Temperatura centralizada
@@ -241,6 +264,7 @@ void HydroControl::toggleRelay(int relay, int seconds) {
     
     bool success = false;
     // Tentar acionar o relé
+    PROFILE_SCOPE("i2c.relay");
     try {
         if (relay < 7) {  // Primeiro PCF8574 (P0-P6)
             pcf1.digitalWrite(relay, state);
@@ -263,6 +287,8 @@ void HydroControl::toggleRelay(int relay, int seconds) {
         return;
     }
     
+    relayGeneration++;
+    
     // Configurar timer se necessário
     if (seconds > 0 && relayStates[relay]) {
         startTimes[relay] = millis();
@@ -274,6 +300,19 @@ void HydroControl::toggleRelay(int relay, int seconds) {
     }
 }
 
+bool HydroControl::setRelay(int relay, bool state) {
+    if (relay < 0 || relay >= NUM_RELAYS) {
+        Serial.printf("❌ Relé %d inválido\n", relay + 1);
+        return false;
+    }
+
+    // Só aciona o hardware se o estado realmente mudar
+    if (relayStates[relay] != state) {
+        toggleRelay(relay, 0);
+    }
+    return relayStates[relay] == state;
+}
+
 void HydroControl::checkRelayTimers() {
     unsigned long currentMillis = millis();
     for(int i = 0; i < NUM_RELAYS; i++) {
@@ -294,6 +333,7 @@ void HydroControl::checkRelayTimers() {
                 
                 timerSeconds[i] = 0;
                 startTimes[i] = 0;
+                relayGeneration++;
             }
         }
     }
@@ -305,6 +345,7 @@ void HydroControl::updateSensorData(float temp, float humidity, float ph, float
     pH = ph;
     this->tds = tds;
     ec = tds * 2;  // EC = TDS * 2 (aproximação)
+    sensorGeneration++;
     
     // Atualizar display com os novos dados
     updateDisplay();
@@ -314,6 +355,11 @@ void HydroControl::updateRelayTimers() {
     checkRelayTimers();
 }
 
+float HydroControl::getWaterTemp() {
+    // DS18B20 no reservatório
+    return temperature;
+}
+
 String HydroControl::getTankStatus() {
     return tankSensor->getStatus();
 }
\ No newline at end of file
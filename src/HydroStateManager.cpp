@@ -260,6 +260,22 @@ void HydroStateManager::switchToAdminPanel() {
     // Criar e inicializar servidor WebSocket
     adminServer = new AdminWebSocketServer();
     
+#ifdef MASTER_MODE
+    // Tabela de peers ESP-NOW no stream binário do painel
+    adminServer->setTelemetryProvider([](AdminTelemetry& frame) {
+        extern ESPNowBridge* masterBridge;
+        if (!masterBridge) return;
+        
+        std::vector<RemoteDevice> devices = masterBridge->getRemoteDevices();
+        frame.peerCount = devices.size() > ADMIN_MAX_PEERS ? ADMIN_MAX_PEERS : devices.size();
+        for (uint8_t i = 0; i < frame.peerCount; i++) {
+            memcpy(frame.peers[i].mac, devices[i].mac, 6);
+            frame.peers[i].online = devices[i].online;
+            frame.peers[i].rssi = (int8_t)devices[i].rssi;
+        }
+    });
+#endif
+    
     if (adminServer->begin()) {
         Serial.println("✅ Admin Panel WebSocket ativo");
         Serial.println("🌐 Acesse: http://" + WiFi.localIP().toString());
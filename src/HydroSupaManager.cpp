@@ -1,16 +1,33 @@
 #include "HydroSupaManager.h"
 #include "DeviceID.h"
 
-HydroSupaManager::HydroSupaManager() :
-    httpClient(),
+const char* HydroSupaManager::NVS_NAMESPACE = "hydro_cmds";
+
+HydroSupaManager::HydroSupaManager(SupabaseClient& client) :
+    httpClient(client),
     realtimeClient(),
+    ackQueue([&client](const int* ids, uint8_t count, const char* status, const char* error) {
+        return client.isReady() && client.markCommands(ids, count, status, error);
+    }),
     isInitialized(false),
     useWebSocket(true),
-    lastHttpSend(0),
-    lastStatusUpdate(0),
+    wasSubscribed(false),
+    catchUpPending(true),
     lastCommandCheck(0),
-    httpFailures(0),
-    wsFailures(0) {
+    pollInterval(HTTP_POLL_MIN_INTERVAL),
+    lastWebSocketRetry(0),
+    recentCommandIndex(0),
+    unreportedCommands(false),
+    wsFailures(0),
+    realtimeCommands(0),
+    polledCommands(0),
+    duplicateCommands(0),
+    httpPolls(0) {
+    for (uint8_t i = 0; i < COMMAND_DEDUPE_SIZE; i++) {
+        recentCommandIds[i] = 0;
+        recentCommandOk[i] = 0;
+        recentCommandReported[i] = true;
+    }
 }
 
 HydroSupaManager::~HydroSupaManager() {
@@ -21,22 +38,32 @@ bool HydroSupaManager::begin(const String& url, const String& key) {
     baseUrl = url;
     apiKey = key;
     deviceId = getDeviceID();
-    
+
     Serial.println("🌊 Iniciando Hybrid Supabase Manager...");
-    
-    // Inicializar cliente HTTP
-    if (!httpClient.begin(url, key)) {
-        Serial.println("❌ Erro ao inicializar cliente HTTP");
-        return false;
+
+    // IDs já executados antes do reboot: a recuperação pode trazê-los de novo
+    loadRecentCommands();
+
+    // Cliente HTTP compartilhado: só inicializa se o dono ainda não o fez
+    if (!httpClient.isReady()) {
+        if (!httpClient.begin(url, key)) {
+            Serial.println("❌ Erro ao inicializar cliente HTTP");
+            return false;
+        }
+
+        // Auto-registrar dispositivo via HTTP
+        if (httpClient.autoRegisterDevice("ESP32 Hidropônico - Híbrido", "Sistema Principal")) {
+            Serial.println("✅ Dispositivo auto-registrado via HTTP");
+        }
     }
-    
+
     Serial.println("✅ Cliente HTTP inicializado");
-    
-    // Auto-registrar dispositivo via HTTP
-    if (httpClient.autoRegisterDevice("ESP32 Hidropônico - Híbrido", "Sistema Principal")) {
-        Serial.println("✅ Dispositivo auto-registrado via HTTP");
-    }
-    
+
+    // Conclusões seguem pelo socket quando inscrito; o banco recebe o PATCH em lote
+    ackQueue.setPushSender([this](int commandId, const char* status) {
+        return useWebSocket && realtimeClient.sendCommandAck(commandId, status);
+    });
+
     // Tentar inicializar WebSocket (não crítico)
     if (initializeWebSocket()) {
         Serial.println("✅ WebSocket Realtime inicializado");
@@ -45,12 +72,14 @@ bool HydroSupaManager::begin(const String& url, const String& key) {
         Serial.println("⚠️ WebSocket falhou - usando apenas HTTP");
         useWebSocket = false;
     }
-    
+
     isInitialized = true;
-    
-    Serial.printf("🌊 Hybrid Manager ativo | HTTP: ✅ | WebSocket: %s\n", 
+    catchUpPending = true;
+    lastWebSocketRetry = millis();
+
+    Serial.printf("🌊 Hybrid Manager ativo | HTTP: ✅ | WebSocket: %s\n",
                   useWebSocket ? "✅" : "❌");
-    
+
     return true;
 }
 
@@ -59,235 +88,314 @@ bool HydroSupaManager::initializeWebSocket() {
         Serial.println("⚠️ Heap insuficiente para WebSocket - usando apenas HTTP");
         return false;
     }
-    
+
     // Configurar callbacks
-    realtimeClient.setCommandCallback([this](int relay, String action, int duration) {
-        this->handleWebSocketCommand(relay, action, duration);
+    realtimeClient.setCommandCallback([this](int commandId, int relay, String action, int duration) {
+        this->handleWebSocketCommand(commandId, relay, action, duration);
     });
-    
+
     realtimeClient.setErrorCallback([this](String error) {
         this->handleWebSocketError(error);
     });
-    
+
     return realtimeClient.begin(baseUrl, apiKey, deviceId);
 }
 
 void HydroSupaManager::loop() {
     if (!isInitialized) return;
-    
+
     unsigned long now = millis();
-    
+
     // ===== WEBSOCKET LOOP (se ativo) =====
     if (useWebSocket) {
         realtimeClient.loop();
-        
-        // Verificar se WebSocket está falhando muito
-        if (!realtimeClient.isConnected() && wsFailures > MAX_WS_FAILURES) {
-            Serial.println("⚠️ WebSocket falhando muito - desabilitando temporariamente");
+
+        // Cliente desistiu de reconectar: volta ao polling até a próxima tentativa
+        if (realtimeClient.getState() == SUPABASE_WS_DISCONNECTED) {
+            Serial.println("⚠️ WebSocket sem conexão - usando polling HTTP");
             useWebSocket = false;
-            wsFailures = 0;
-            realtimeClient.end();
+            lastWebSocketRetry = now;
         }
     }
-    
-    // ===== HTTP HEARTBEAT + DADOS (30s) =====
-    if (now - lastHttpSend >= HTTP_SEND_INTERVAL) {
-        sendHttpData();
-        lastHttpSend = now;
+
+    // ===== RECUPERAÇÃO A CADA (RE)INSCRIÇÃO =====
+    bool subscribed = useWebSocket && realtimeClient.isSubscribed();
+    if (subscribed && !wasSubscribed) {
+        Serial.println("⚡ Realtime inscrito - comandos por push");
+        wsFailures = 0;
+        catchUpPending = true;
+    } else if (!subscribed && wasSubscribed) {
+        Serial.println("⚠️ Realtime fora - polling HTTP adaptativo ativo");
+        pollInterval = HTTP_POLL_MIN_INTERVAL;
+        lastCommandCheck = 0;
     }
-    
-    // ===== STATUS UPDATE (60s) =====
-    if (now - lastStatusUpdate >= STATUS_UPDATE_INTERVAL) {
-        updateDeviceStatus();
-        lastStatusUpdate = now;
+    wasSubscribed = subscribed;
+
+    if (catchUpPending) {
+        checkHttpCommands("recuperação");
     }
-    
-    // ===== HTTP POLLING (apenas se WebSocket não estiver ativo) =====
-    if (!useWebSocket && now - lastCommandCheck >= HTTP_POLL_INTERVAL) {
-        checkHttpCommands();
-        lastCommandCheck = now;
+
+    // ===== HTTP POLLING (apenas sem Realtime) =====
+    if (!subscribed && now - lastCommandCheck >= pollInterval) {
+        checkHttpCommands("fallback");
     }
-    
+
     // ===== TENTAR REATIVAR WEBSOCKET (se desabilitado) =====
     if (!useWebSocket && now - lastWebSocketRetry >= WS_RETRY_INTERVAL) {
         if (ESP.getFreeHeap() > 50000) {
             Serial.println("🔄 Tentando reativar WebSocket...");
             if (initializeWebSocket()) {
                 useWebSocket = true;
-                wsFailures = 0;
                 Serial.println("✅ WebSocket reativado");
             }
         }
         lastWebSocketRetry = now;
     }
+
+    // ===== CONFIRMAÇÕES EM LOTE =====
+    ackQueue.loop();
+    if (unreportedCommands && !ackQueue.isFull()) {
+        retryUnreported();
+    }
 }
 
 void HydroSupaManager::end() {
     if (isInitialized) {
+        ackQueue.flush();
         realtimeClient.end();
         isInitialized = false;
+        wasSubscribed = false;
         Serial.println("🌊 Hybrid Supabase Manager parado");
     }
 }
 
-void HydroSupaManager::sendHttpData() {
-    if (!httpClient.isReady()) return;
-    
-    // Simular dados dos sensores (substituir pela leitura real)
-    EnvironmentReading envData = {
-        .temperature = 23.5,
-        .humidity = 65.0,
-        .timestamp = millis()
-    };
-    
-    HydroReading hydroData = {
-        .temperature = 22.8,
-        .ph = 6.5,
-        .tds = 850.0,
-        .waterLevelOk = true,
-        .timestamp = millis()
-    };
-    
-    // Enviar dados
-    bool envSuccess = httpClient.sendEnvironmentData(envData);
-    bool hydroSuccess = httpClient.sendHydroData(hydroData);
-    
-    if (envSuccess && hydroSuccess) {
-        Serial.println("📤 Dados HTTP enviados com sucesso");
-        httpFailures = 0;
-    } else {
-        httpFailures++;
-        Serial.printf("❌ Falha HTTP (%d/%d)\n", httpFailures, MAX_HTTP_FAILURES);
-    }
+void HydroSupaManager::forceWebSocketReconnect() {
+    realtimeClient.end();
+    useWebSocket = initializeWebSocket();
+    lastWebSocketRetry = millis();
 }
 
-void HydroSupaManager::updateDeviceStatus() {
+void HydroSupaManager::checkHttpCommands(const char* reason) {
     if (!httpClient.isReady()) return;
-    
-    DeviceStatusData status = {
-        .deviceId = deviceId,
-        .wifiRssi = WiFi.RSSI(),
-        .freeHeap = ESP.getFreeHeap(),
-        .uptimeSeconds = millis() / 1000,
-        .relayStates = {false}, // Substituir pelos estados reais
-        .isOnline = true,
-        .firmwareVersion = FIRMWARE_VERSION,
-        .ipAddress = WiFi.localIP().toString(),
-        .timestamp = millis()
-    };
-    
-    if (httpClient.updateDeviceStatus(status)) {
-        Serial.println("📤 Status do dispositivo atualizado");
-        
-        // Se WebSocket ativo, enviar ping também
-        if (useWebSocket && realtimeClient.isConnected()) {
-            realtimeClient.sendHeartbeatPing();
-        }
-    }
-}
 
-void HydroSupaManager::checkHttpCommands() {
-    if (!httpClient.isReady()) return;
-    
     RelayCommand commands[5];
     int commandCount = 0;
-    
-    if (httpClient.checkForCommands(commands, 5, commandCount)) {
-        Serial.printf("📥 HTTP: %d comandos recebidos\n", commandCount);
-        
-        for (int i = 0; i < commandCount; i++) {
-            processCommand(commands[i], "HTTP");
-        }
+
+    // checkForCommands tem intervalo mínimo próprio: false = tentar depois
+    if (!httpClient.checkForCommands(commands, 5, commandCount)) return;
+
+    lastCommandCheck = millis();
+    catchUpPending = false;
+    httpPolls++;
+
+    if (commandCount > 0) {
+        Serial.printf("📥 HTTP (%s): %d comandos recebidos\n", reason, commandCount);
+    }
+
+    for (int i = 0; i < commandCount; i++) {
+        processCommand(commands[i], "HTTP");
+    }
+
+    // Com atividade volta ao intervalo curto; sem comandos recua até o máximo
+    if (commandCount > 0) {
+        pollInterval = HTTP_POLL_MIN_INTERVAL;
+    } else {
+        pollInterval = pollInterval * 2 > HTTP_POLL_MAX_INTERVAL ? HTTP_POLL_MAX_INTERVAL : pollInterval * 2;
     }
 }
 
-void HydroSupaManager::handleWebSocketCommand(int relay, String action, int duration) {
+void HydroSupaManager::handleWebSocketCommand(int commandId, int relay, String action, int duration) {
     Serial.printf("⚡ WebSocket: Relé %d -> %s", relay, action.c_str());
     if (duration > 0) {
         Serial.printf(" por %ds", duration);
     }
     Serial.println();
-    
+
     // Criar comando para processamento unificado
     RelayCommand cmd = {
-        .id = 0, // WebSocket não tem ID específico
+        .id = commandId,
         .relayNumber = relay,
         .action = action,
         .durationSeconds = duration,
         .status = "received",
         .timestamp = millis()
     };
-    
+
     processCommand(cmd, "WebSocket");
 }
 
 void HydroSupaManager::handleWebSocketError(String error) {
     Serial.println("❌ WebSocket Error: " + error);
     wsFailures++;
-    
+
     if (wsFailures >= MAX_WS_FAILURES) {
         Serial.println("⚠️ Muitos erros WebSocket - desabilitando temporariamente");
         useWebSocket = false;
+        wsFailures = 0;
+        lastWebSocketRetry = millis();
         realtimeClient.end();
     }
 }
 
 void HydroSupaManager::processCommand(const RelayCommand& cmd, const String& source) {
-    Serial.printf("🎛️ [%s] Processando: Relé %d -> %s\n", 
+    // Execução única: o mesmo ID pode chegar por push e por polling
+    if (cmd.id > 0) {
+        int slot = findProcessed(cmd.id);
+        if (slot >= 0) {
+            duplicateCommands++;
+            Serial.printf("🔁 [%s] Comando %d já executado - ignorado\n", source.c_str(), cmd.id);
+
+            // Ainda pendente no banco: a confirmação anterior se perdeu
+            if (source == "HTTP") {
+                recentCommandReported[slot] = reportResult(cmd.id, recentCommandOk[slot]);
+                unreportedCommands |= !recentCommandReported[slot];
+            }
+            return;
+        }
+    }
+
+    if (source == "WebSocket") {
+        realtimeCommands++;
+    } else {
+        polledCommands++;
+    }
+
+    Serial.printf("🎛️ [%s] Processando: Relé %d -> %s\n",
                   source.c_str(), cmd.relayNumber, cmd.action.c_str());
-    
+
     // Validar comando
     if (cmd.relayNumber < 0 || cmd.relayNumber >= 16) {
         Serial.printf("❌ Relé %d inválido\n", cmd.relayNumber);
         if (cmd.id > 0) {
-            httpClient.markCommandFailed(cmd.id, "Relé inválido");
+            int slot = rememberCommand(cmd.id, false);
+            recentCommandReported[slot] = ackQueue.add(cmd.id, COMMAND_ACK_FAILED, "Relé inválido");
+            unreportedCommands |= !recentCommandReported[slot];
         }
         return;
     }
-    
-    // Executar comando (substituir pela implementação real)
-    bool success = executeRelayCommand(cmd.relayNumber, cmd.action, cmd.durationSeconds);
-    
+
+    // Gravado antes de acionar: um reboot durante a dose não a repete
+    int slot = cmd.id > 0 ? rememberCommand(cmd.id, false) : -1;
+
+    // Relé primeiro, confirmação depois: o HTTP não entra na latência
+    bool success = commandHandler ? commandHandler(cmd)
+                                  : executeRelayCommand(cmd.relayNumber, cmd.action, cmd.durationSeconds);
+
     // Reportar resultado
+    Serial.println(success ? "✅ Comando executado com sucesso" : "❌ Falha na execução do comando");
+    if (slot >= 0) {
+        setCommandResult(slot, success);
+        recentCommandReported[slot] = reportResult(cmd.id, success);
+        unreportedCommands |= !recentCommandReported[slot];
+    }
+}
+
+bool HydroSupaManager::reportResult(int commandId, bool success) {
+    // Entra na janela de coalescência; o PATCH sai agrupado no loop()
     if (success) {
-        Serial.println("✅ Comando executado com sucesso");
-        if (cmd.id > 0) {
-            httpClient.markCommandCompleted(cmd.id);
-        }
-    } else {
-        Serial.println("❌ Falha na execução do comando");
-        if (cmd.id > 0) {
-            httpClient.markCommandFailed(cmd.id, "Falha na execução");
+        return ackQueue.add(commandId, COMMAND_ACK_COMPLETED);
+    }
+    return ackQueue.add(commandId, COMMAND_ACK_FAILED, "Falha na execução");
+}
+
+void HydroSupaManager::retryUnreported() {
+    // Recusadas com a fila cheia: o resultado ficou no anel de execução
+    unreportedCommands = false;
+    for (uint8_t i = 0; i < COMMAND_DEDUPE_SIZE; i++) {
+        if (recentCommandReported[i] || recentCommandIds[i] == 0) continue;
+        if (ackQueue.isFull()) {
+            unreportedCommands = true;
+            return;
         }
+        recentCommandReported[i] = reportResult(recentCommandIds[i], recentCommandOk[i]);
+        unreportedCommands |= !recentCommandReported[i];
     }
 }
 
 bool HydroSupaManager::executeRelayCommand(int relay, const String& action, int duration) {
-    // IMPLEMENTAR: Lógica real de controle dos relés
-    // Por enquanto, apenas simula sucesso
-    
+    // Sem handler registrado: apenas simula (modo de teste)
     Serial.printf("🔧 Executando: Relé %d -> %s", relay, action.c_str());
     if (duration > 0) {
         Serial.printf(" por %ds", duration);
     }
     Serial.println();
-    
-    // Simular sucesso (substituir pela implementação real)
+
     return true;
 }
 
+int HydroSupaManager::findProcessed(int commandId) const {
+    for (uint8_t i = 0; i < COMMAND_DEDUPE_SIZE; i++) {
+        if (recentCommandIds[i] == commandId) return i;
+    }
+    return -1;
+}
+
+int HydroSupaManager::rememberCommand(int commandId, bool success) {
+    int slot = recentCommandIndex;
+    recentCommandIds[slot] = commandId;
+    recentCommandOk[slot] = success;
+    recentCommandReported[slot] = true;
+    recentCommandIndex = (recentCommandIndex + 1) % COMMAND_DEDUPE_SIZE;
+    saveRecentCommands();
+    return slot;
+}
+
+void HydroSupaManager::setCommandResult(int slot, bool success) {
+    if (recentCommandOk[slot] == success) return;
+    recentCommandOk[slot] = success;
+    saveRecentCommands();
+}
+
+void HydroSupaManager::loadRecentCommands() {
+    if (!prefs.begin(NVS_NAMESPACE, true)) return;
+
+    // Anel gravado por inteiro: tamanhos diferentes = versão antiga, ignora
+    if (prefs.getBytesLength("ids") == sizeof(recentCommandIds) &&
+        prefs.getBytesLength("ok") == sizeof(recentCommandOk)) {
+        prefs.getBytes("ids", recentCommandIds, sizeof(recentCommandIds));
+        prefs.getBytes("ok", recentCommandOk, sizeof(recentCommandOk));
+        recentCommandIndex = prefs.getUInt("index", 0) % COMMAND_DEDUPE_SIZE;
+    }
+    prefs.end();
+
+    uint8_t known = 0;
+    for (uint8_t i = 0; i < COMMAND_DEDUPE_SIZE; i++) {
+        if (recentCommandIds[i] != 0) known++;
+    }
+    if (known > 0) {
+        Serial.printf("🔁 %u comandos já executados restaurados da NVS\n", known);
+    }
+}
+
+void HydroSupaManager::saveRecentCommands() {
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        Serial.println("⚠️ NVS indisponível - deduplicação de comandos só em RAM");
+        return;
+    }
+    prefs.putBytes("ids", recentCommandIds, sizeof(recentCommandIds));
+    prefs.putBytes("ok", recentCommandOk, sizeof(recentCommandOk));
+    prefs.putUInt("index", recentCommandIndex);
+    prefs.end();
+}
+
 void HydroSupaManager::printStatus() {
     Serial.println("\n🌊 === HYBRID SUPABASE MANAGER ===");
     Serial.println("🆔 Device ID: " + deviceId);
     Serial.println("📡 HTTP Client: " + String(httpClient.isReady() ? "✅ Ativo" : "❌ Inativo"));
     Serial.println("⚡ WebSocket: " + String(useWebSocket ? "✅ Ativo" : "❌ Inativo"));
-    
+
     if (useWebSocket) {
         Serial.println("📺 WS Estado: " + realtimeClient.getStateString());
         Serial.println("⏰ WS Uptime: " + String(realtimeClient.getUptime() / 1000) + "s");
+    } else {
+        Serial.println("⏱️ Polling a cada: " + String(pollInterval / 1000) + "s");
     }
-    
-    Serial.println("❌ HTTP Failures: " + String(httpFailures) + "/" + String(MAX_HTTP_FAILURES));
+
+    Serial.printf("🎛️ Comandos: %lu push | %lu polling | %lu duplicados ignorados\n",
+                 (unsigned long)realtimeCommands, (unsigned long)polledCommands,
+                 (unsigned long)duplicateCommands);
+    Serial.println("🔍 Consultas HTTP: " + String(httpPolls));
+    ackQueue.printStatus();
     Serial.println("❌ WS Failures: " + String(wsFailures) + "/" + String(MAX_WS_FAILURES));
     Serial.println("💾 Heap Livre: " + String(ESP.getFreeHeap()) + " bytes");
     Serial.println("=====================================\n");
@@ -8,17 +8,21 @@
 #include "DeviceID.h"
 #include <esp_task_wdt.h>
 #include <esp_err.h>
+#include "CloudConnectionPool.h"
+#include "LoopProfiler.h"
+#include "HeapMonitor.h"
 #include "HybridStateManager.h"  
 
 // ===== CONSTRUTOR E DESTRUTOR =====
 HydroSystemCore::HydroSystemCore() : 
+    hybridSupabase(supabase),
+    batchUploader(telemetryQueue),
     systemReady(false),
     supabaseConnected(false),
     startTime(0),
     lastSensorSend(0),
     lastStatusSend(0),
     lastStatusPrint(0),
-    lastSupabaseCheck(0),
     lastMemoryProtection(0) {
 }
 
@@ -37,6 +41,9 @@ bool HydroSystemCore::begin() {
     
     startTime = millis();
     
+    // Alerta de tendência antes de o HTTPS ser desligado
+    HeapMonitor::shared().setThresholds(MIN_HEAP_FOR_HTTPS, HEAP_DEFAULT_MIN_BLOCK);
+    
     // ===== INICIALIZAR SISTEMA HIDROPÔNICO =====
     Serial.println("🔧 Inicializando controle hidropônico...");
     if (!hydroControl.begin()) {
@@ -45,6 +52,24 @@ bool HydroSystemCore::begin() {
     }
     Serial.println("✅ HydroControl inicializado");
     
+    // ===== HISTÓRICO LOCAL (LittleFS) =====
+    if (!timeSeries.begin(&hydroControl.getSensorBus())) {
+        Serial.println("⚠️ Histórico local indisponível - continuando sem ele");
+    }
+    
+    // ===== FILA DE TELEMETRIA (store-and-forward) =====
+    configTime(0, 0, NTP_PRIMARY_SERVER, NTP_SECONDARY_SERVER);
+    // Mesmo bulk insert para os lotes e para o reenvio da fila
+    TelemetryQueue::Sender sender = [this](const char* table, const char* rows, size_t length) {
+        return supabase.insert(table, rows, length);
+    };
+    batchUploader.setSender(sender);
+    if (telemetryQueue.begin()) {
+        telemetryQueue.setSender(sender);
+    } else {
+        Serial.println("⚠️ Fila de telemetria indisponível - leituras offline serão perdidas");
+    }
+    
     // ===== CONECTAR SUPABASE =====
     Serial.println("☁️ Conectando ao Supabase...");
     if (supabase.begin(SUPABASE_URL, SUPABASE_ANON_KEY)) {
@@ -61,6 +86,12 @@ bool HydroSystemCore::begin() {
         } else {
             Serial.println("⚠️ Auto-registro falhou, mas continuando...");
         }
+        
+        // ===== COMANDOS DE RELÉ (Realtime + polling de reserva) =====
+        hybridSupabase.setCommandHandler([this](const RelayCommand& cmd) {
+            return executeRelayCommand(cmd);
+        });
+        hybridSupabase.begin(SUPABASE_URL, SUPABASE_ANON_KEY);
     } else {
         Serial.println("❌ Erro ao conectar Supabase - Sistema continuará sem cloud");
         supabaseConnected = false;
@@ -69,11 +100,11 @@ bool HydroSystemCore::begin() {
     // ===== INICIALIZAR SERVIDOR WEB ADMIN =====
     Serial.println("🌐 Iniciando painel admin web...");
     
-    // Criar instâncias temporárias para compatibilidade
+    // WiFiManager temporário para compatibilidade; o servidor vive com o core
     static WiFiManager wifiManager;
-    static WebServerManager webServerManager;
     
-    webServerManager.beginAdminServer(wifiManager, hydroControl);
+    webServer.setTimeSeries(&timeSeries);
+    webServer.beginAdminServer(wifiManager, hydroControl);
     
     Serial.println("✅ Painel admin disponível em: http://" + WiFi.localIP().toString());
     
@@ -102,12 +133,31 @@ void HydroSystemCore::loop() {
     
     // ===== SENSORES → SUPABASE (30s) =====
     if (now - lastSensorSend >= SENSOR_SEND_INTERVAL) {
+        PROFILE_SCOPE("supabase.sensors");
         sendSensorDataToSupabase();
         lastSensorSend = now;
     }
     
+    // ===== LOTES → SUPABASE E REENVIO DA FILA OFFLINE =====
+    {
+        PROFILE_SCOPE("supabase.batches");
+        bool cloudReachable = isCloudReachable();
+        batchUploader.loop(cloudReachable);
+        telemetryQueue.loop(cloudReachable);
+    }
+    
+    // ===== SESSÕES HTTPS OCIOSAS =====
+    CloudConnectionPool::shared().loop();
+    
+    // ===== SSE (coalescido por endpoint) =====
+    {
+        PROFILE_SCOPE("web.update");
+        webServer.update();
+    }
+    
     // ===== STATUS DEVICE → SUPABASE (60s) =====
     if (now - lastStatusSend >= STATUS_SEND_INTERVAL) {
+        PROFILE_SCOPE("supabase.status");
         sendDeviceStatusToSupabase();
         lastStatusSend = now;
     }
@@ -118,14 +168,23 @@ void HydroSystemCore::loop() {
         lastStatusPrint = now;
     }
     
-    // ===== VERIFICAR SUPABASE (30s) =====
-    if (now - lastSupabaseCheck >= SUPABASE_CHECK_INTERVAL) {
-        checkSupabaseCommands();
-        lastSupabaseCheck = now;
+    // ===== COMANDOS DE RELÉ (push Realtime; polling só sem socket) =====
+    if (supabaseConnected) {
+        PROFILE_SCOPE("supabase.commands");
+        hybridSupabase.loop();
     }
     
     // ===== LOOP DOS SENSORES/RELÉS =====
-    hydroControl.loop();
+    {
+        PROFILE_SCOPE("hydro.update");
+        hydroControl.loop();
+    }
+    
+    // ===== HISTÓRICO LOCAL (10s) =====
+    {
+        PROFILE_SCOPE("history.loop");
+        timeSeries.loop();
+    }
 }
 
 void HydroSystemCore::end() {
@@ -133,6 +192,11 @@ void HydroSystemCore::end() {
     
     Serial.println("🛑 Parando HydroSystemCore...");
     
+    batchUploader.flush(isCloudReachable());
+    hybridSupabase.end();
+    timeSeries.end();
+    CloudConnectionPool::shared().closeAll();
+    
     systemReady = false;
     supabaseConnected = false;
     
@@ -157,6 +221,9 @@ void HydroSystemCore::printSystemStatus() {
     Serial.println("\n📊 === LEITURAS DOS SENSORES ===");
     printSensorReadings();
     Serial.println("=====================================\n");
+    
+    hybridSupabase.printStatus();
+    CloudConnectionPool::shared().printStatus();
 }
 
 void HydroSystemCore::printSensorReadings() {
@@ -188,108 +255,70 @@ void HydroSystemCore::testSupabaseConnection() {
 }
 
 // ===== OPERAÇÕES PRINCIPAIS =====
-void HydroSystemCore::checkSupabaseCommands() {
-    if (!supabaseConnected || !hasEnoughMemoryForHTTPS()) {
-        return;
-    }
-    
-    if (!supabase.isReady()) return;
-    
-    RelayCommand commands[5];
-    int commandCount = 0;
-    
-    if (supabase.checkForCommands(commands, 5, commandCount)) {
-        Serial.printf("📥 Recebidos %d comandos do Supabase\n", commandCount);
-        
-        for (int i = 0; i < commandCount; i++) {
-            processRelayCommand(commands[i]);
-        }
-    }
-}
-
-void HydroSystemCore::processRelayCommand(const RelayCommand& cmd) {
+bool HydroSystemCore::executeRelayCommand(const RelayCommand& cmd) {
+    // Confirmação no Supabase (completed/failed) fica com o HydroSupaManager
     Serial.printf("🎛️ Comando: Relé %d -> %s", cmd.relayNumber, cmd.action.c_str());
     if (cmd.durationSeconds > 0) {
         Serial.printf(" por %d segundos", cmd.durationSeconds);
     }
     Serial.println();
     
-    // Marcar comando como recebido
-    if (supabaseConnected) {
-        supabase.markCommandSent(cmd.id);
-    }
-    
-    // Validar relé
-    if (cmd.relayNumber < 0 || cmd.relayNumber >= 16) {
-        Serial.printf("❌ Relé %d inválido\n", cmd.relayNumber);
-        if (supabaseConnected) {
-            supabase.markCommandFailed(cmd.id, "Relé inválido");
-        }
-        return;
-    }
-    
-    // Executar comando
-    bool success = false;
     bool* relayStates = hydroControl.getRelayStates();
     
     if (cmd.action == "on") {
         if (!relayStates[cmd.relayNumber]) {
             hydroControl.toggleRelay(cmd.relayNumber, cmd.durationSeconds);
-            success = true;
-        } else {
-            success = true; // Já estava ligado
         }
+        return true; // Ligado agora ou já estava ligado
     } else if (cmd.action == "off") {
         if (relayStates[cmd.relayNumber]) {
             hydroControl.toggleRelay(cmd.relayNumber, 0);
-            success = true;
-        } else {
-            success = true; // Já estava desligado
         }
+        return true; // Desligado agora ou já estava desligado
     }
     
-    // Reportar resultado
-    if (success) {
-        Serial.println("✅ Comando executado com sucesso");
-        if (supabaseConnected) {
-            supabase.markCommandCompleted(cmd.id);
-        }
-    } else {
-        Serial.println("❌ Falha na execução do comando");
-        if (supabaseConnected) {
-            supabase.markCommandFailed(cmd.id, "Falha na execução");
-        }
-    }
+    Serial.printf("❌ Ação desconhecida: %s\n", cmd.action.c_str());
+    return false;
 }
 
 void HydroSystemCore::sendSensorDataToSupabase() {
-    if (!supabaseConnected || !hasEnoughMemoryForHTTPS()) {
+    // Não enviar leituras antigas (task de sensores parada ou sensores falhando)
+    SensorBus& bus = hydroControl.getSensorBus();
+    uint32_t now = millis();
+    SensorReading temp, ph, tds, level;
+    bus.read(SENSOR_WATER_TEMP, temp, now);
+    bus.read(SENSOR_PH, ph, now);
+    bus.read(SENSOR_TDS, tds, now);
+    bus.read(SENSOR_WATER_LEVEL, level, now);
+    
+    const uint8_t unusable = SAMPLE_QUALITY_STALE | SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_NO_DATA;
+    if ((ph.quality & unusable) && (tds.quality & unusable)) {
+        Serial.println("⚠️ Amostras de sensores desatualizadas - envio adiado");
         return;
     }
     
-    if (!supabase.isReady()) return;
-    
     // Dados ambientais
     EnvironmentReading envData;
     envData.temperature = hydroControl.getTemperature();
     envData.humidity = 65.0; // Simulado
-    envData.timestamp = millis();
+    envData.timestamp = now;
     
-    // Dados hidropônicos
+    // Dados hidropônicos: direto das amostras do barramento
     HydroReading hydroData;
-    hydroData.temperature = hydroControl.getTemperature();
-    hydroData.ph = hydroControl.getpH();
-    hydroData.tds = hydroControl.getTDS();
-    hydroData.waterLevelOk = hydroControl.isWaterLevelOk();
-    hydroData.timestamp = millis();
-    
-    // Enviar dados
-    if (supabase.sendEnvironmentData(envData)) {
-        Serial.println("📤 Dados ambientais enviados ao Supabase");
+    hydroData.temperature = (temp.quality & unusable) ? hydroControl.getTemperature() : temp.value;
+    hydroData.ph = (ph.quality & unusable) ? hydroControl.getpH() : ph.value;
+    hydroData.tds = (tds.quality & unusable) ? hydroControl.getTDS() : tds.value;
+    hydroData.waterLevelOk = level.isGood() && level.value > 0.5;
+    hydroData.timestamp = now;
+    
+    // Acumuladas e enviadas em lote (falha/offline → fila persistente)
+    bool cloudReachable = isCloudReachable();
+    char payload[TELEMETRY_PAYLOAD_SIZE];
+    if (supabase.buildEnvironmentPayload(envData, payload, sizeof(payload), false)) {
+        batchUploader.add(TELEMETRY_ENVIRONMENT, payload, cloudReachable);
     }
-    
-    if (supabase.sendHydroData(hydroData)) {
-        Serial.println("📤 Dados hidropônicos enviados ao Supabase");
+    if (supabase.buildHydroPayload(hydroData, payload, sizeof(payload), false)) {
+        batchUploader.add(TELEMETRY_HYDRO, payload, cloudReachable);
     }
 }
 
@@ -331,8 +360,12 @@ void HydroSystemCore::performMemoryProtection() {
     if (freeHeap < 15000) {
         Serial.println("🚨 ALERTA: Heap crítico! " + String(freeHeap) + " bytes");
         
+        // Sessões TLS mantidas abertas são a maior reserva liberável
+        CloudConnectionPool::shared().closeAll();
+        
         if (freeHeap < 8000) {
             Serial.println("💀 RESET EMERGENCIAL por falta de memória!");
+            HeapMonitor::shared().recordRestart("heap_critical");
             delay(1000);
             ESP.restart();
         }
@@ -341,9 +374,11 @@ void HydroSystemCore::performMemoryProtection() {
     // ===== PROTEÇÃO POR FRAGMENTAÇÃO =====
     if (fragmentationPercent > 70) {
         Serial.println("🧩 ALERTA: Fragmentação alta! " + String(fragmentationPercent) + "%");
+        HeapMonitor::shared().printReport();
         
         if (fragmentationPercent > 85 && freeHeap > 10000) {
             Serial.println("🔄 RESET por fragmentação extrema!");
+            HeapMonitor::shared().recordRestart("fragmentation");
             delay(1000);
             ESP.restart();
         }
@@ -364,6 +399,10 @@ bool HydroSystemCore::hasEnoughMemoryForHTTPS() {
     return ESP.getFreeHeap() >= MIN_HEAP_FOR_HTTPS;
 }
 
+bool HydroSystemCore::isCloudReachable() {
+    return supabaseConnected && supabase.isReady() && hasEnoughMemoryForHTTPS();
+}
+
 void HydroSystemCore::printPeriodicStatus() {
     Serial.printf("🔄 Sistema ativo há %ds | Heap: %d bytes | Supabase: %s | MASTER MODE\n", 
                   (int)(getUptime()/1000), 
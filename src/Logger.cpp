@@ -0,0 +1,179 @@
+#include "Logger.h"
+#include <ArduinoJson.h>
+#include <stdarg.h>
+
+namespace {
+
+const char LEVEL_LETTERS[] = "-EWIDV";
+
+}  // namespace
+
+// ===== INSTÂNCIA =====
+Logger& Logger::shared() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() :
+    mutex(xSemaphoreCreateMutex()),
+    stream(nullptr),
+    taskHandle(nullptr),
+    tokens(LOG_RATE_BURST),
+    last_refill(0),
+    pending_suppressed(0),
+    lines_written(0),
+    lines_dropped(0),
+    lines_suppressed(0),
+    min_free_space(LOGGER_QUEUE_BYTES) {
+    line[0] = '\0';
+}
+
+// ===== CONTROLE =====
+bool Logger::begin() {
+    if (taskHandle) return true;
+
+    stream = xStreamBufferCreate(LOGGER_QUEUE_BYTES, 1);
+    if (!stream) {
+        Serial.println("⚠️ Logger: sem memória para a fila - escrita direta na Serial");
+        return false;
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(
+        taskFunction,
+        "LogDrain",
+        LOG_TASK_STACK_SIZE,
+        this,
+        LOG_TASK_PRIORITY,
+        &taskHandle,
+        LOG_TASK_CORE
+    );
+
+    if (result != pdPASS) {
+        vStreamBufferDelete(stream);
+        stream = nullptr;
+        taskHandle = nullptr;
+        Serial.println("⚠️ Logger: erro ao criar task - escrita direta na Serial");
+        return false;
+    }
+
+    Serial.printf("✅ Logger: fila de %d bytes, nível global %d\n", LOGGER_QUEUE_BYTES, LOG_LEVEL);
+    return true;
+}
+
+void Logger::write(uint8_t level, const char* module, const char* format, ...) {
+    if (!mutex || xSemaphoreTake(mutex, pdMS_TO_TICKS(LOG_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        lines_dropped++;
+        return;
+    }
+
+    if (!takeToken(level)) {
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    // Linhas suprimidas pelo limite de taxa saem antes da próxima
+    if (pending_suppressed > 0) {
+        int length = snprintf(line, sizeof(line), "[%lu][W][LOG] %lu linhas suprimidas\n",
+                              millis(), (unsigned long)pending_suppressed);
+        pending_suppressed = 0;
+        emit(line, min((size_t)length, sizeof(line) - 1));
+    }
+
+    int prefix = snprintf(line, sizeof(line), "[%lu][%c][%s] ", millis(),
+                          LEVEL_LETTERS[level < sizeof(LEVEL_LETTERS) - 1 ? level : 0], module);
+    size_t length = min((size_t)prefix, sizeof(line) - 2);
+
+    va_list args;
+    va_start(args, format);
+    int body = vsnprintf(line + length, sizeof(line) - length - 1, format, args);
+    va_end(args);
+    if (body > 0) {
+        length += min((size_t)body, sizeof(line) - length - 2);
+    }
+
+    // Uma linha por chamada (mensagens antigas às vezes já terminam em \n)
+    if (length == 0 || line[length - 1] != '\n') {
+        line[length++] = '\n';
+    }
+    line[length] = '\0';
+
+    emit(line, length);
+    xSemaphoreGive(mutex);
+}
+
+void Logger::flush(uint32_t timeout_ms) {
+    if (!stream) return;
+
+    unsigned long start = millis();
+    while (!xStreamBufferIsEmpty(stream) && millis() - start < timeout_ms) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    Serial.flush();
+}
+
+// ===== STATUS =====
+String Logger::getStatusJSON() const {
+    StaticJsonDocument<256> doc;
+    doc["async"] = taskHandle != nullptr;
+    doc["level"] = LOG_LEVEL;
+    doc["lines_written"] = lines_written;
+    doc["lines_dropped"] = lines_dropped;
+    doc["lines_suppressed"] = lines_suppressed;
+    doc["buffer_size"] = LOGGER_QUEUE_BYTES;
+    doc["buffer_min_free"] = min_free_space;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+bool Logger::takeToken(uint8_t level) {
+    unsigned long now = millis();
+    tokens += (now - last_refill) * (LOG_RATE_LINES_PER_S / 1000.0);
+    if (tokens > LOG_RATE_BURST) tokens = LOG_RATE_BURST;
+    last_refill = now;
+
+    if (tokens >= 1.0) {
+        tokens -= 1.0;
+        return true;
+    }
+    if (level <= LOG_LEVEL_ERROR) {
+        return true;
+    }
+
+    pending_suppressed++;
+    lines_suppressed++;
+    return false;
+}
+
+void Logger::emit(const char* text, size_t length) {
+    if (!stream) {
+        Serial.write((const uint8_t*)text, length);
+        lines_written++;
+        return;
+    }
+
+    // Nunca espera: com a fila cheia a linha inteira é descartada
+    size_t space = xStreamBufferSpacesAvailable(stream);
+    if (space < min_free_space) min_free_space = space;
+    if (space < length) {
+        lines_dropped++;
+        return;
+    }
+
+    xStreamBufferSend(stream, text, length, 0);
+    lines_written++;
+}
+
+void Logger::taskFunction(void* parameter) {
+    Logger* logger = static_cast<Logger*>(parameter);
+    uint8_t chunk[LOG_DRAIN_CHUNK];
+
+    while (true) {
+        size_t received = xStreamBufferReceive(logger->stream, chunk, sizeof(chunk), portMAX_DELAY);
+        if (received > 0) {
+            Serial.write(chunk, received);
+        }
+    }
+}
@@ -0,0 +1,282 @@
+#include "LoopProfiler.h"
+#include "TraceRecorder.h"
+#include <ArduinoJson.h>
+
+// ===== INSTÂNCIA =====
+LoopProfiler& LoopProfiler::shared() {
+    static LoopProfiler profiler;
+    return profiler;
+}
+
+LoopProfiler::LoopProfiler() :
+    section_count(0),
+    loop_count(0),
+    loop_start_us(0),
+    loop_max_us(0),
+    loop_total_us(0),
+    task_count(0),
+    last_total_runtime(0),
+    last_task_sample(0) {
+    spinlock = portMUX_INITIALIZER_UNLOCKED;
+    memset(sections, 0, sizeof(sections));
+    memset(loop_history, 0, sizeof(loop_history));
+    memset(tasks, 0, sizeof(tasks));
+}
+
+// ===== LOOP PRINCIPAL =====
+void LoopProfiler::loopStart() {
+    loop_start_us = micros();
+
+    // A task do loop sempre aparece, mesmo sem run-time stats
+    if (loop_count == 0) {
+        registerTask(xTaskGetCurrentTaskHandle());
+    }
+}
+
+void LoopProfiler::loopEnd() {
+    uint32_t elapsed = micros() - loop_start_us;
+
+    portENTER_CRITICAL(&spinlock);
+    loop_history[loop_count % PROFILER_LOOP_HISTORY] = elapsed;
+    loop_count++;
+    loop_total_us += elapsed;
+    if (elapsed > loop_max_us) loop_max_us = elapsed;
+    portEXIT_CRITICAL(&spinlock);
+
+    if (millis() - last_task_sample >= PROFILER_TASK_SAMPLE_MS) {
+        sampleTasks();
+    }
+}
+
+// ===== SEÇÕES =====
+int8_t LoopProfiler::section(const char* name) {
+    portENTER_CRITICAL(&spinlock);
+    int8_t id = -1;
+    for (uint8_t i = 0; i < section_count; i++) {
+        if (strcmp(sections[i].name, name) == 0) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0 && section_count < PROFILER_MAX_SECTIONS) {
+        id = section_count++;
+        sections[id].name = name;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return id;
+}
+
+void LoopProfiler::record(int8_t id, uint32_t start_us, uint32_t elapsed_us) {
+    if (id < 0) return;
+
+#if TRACE_ENABLED
+    TraceRecorder::shared().record(id, start_us, elapsed_us);
+#endif
+
+    portENTER_CRITICAL(&spinlock);
+    Section& entry = sections[id];
+    entry.count++;
+    entry.total_us += elapsed_us;
+    entry.last_us = elapsed_us;
+    if (elapsed_us > entry.max_us) entry.max_us = elapsed_us;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+// ===== TASKS =====
+void LoopProfiler::registerTask(TaskHandle_t handle) {
+    if (!handle) return;
+
+    TaskSample task;
+    memset(&task, 0, sizeof(task));
+    task.handle = handle;
+    task.core = -1;
+    task.stack_free = UINT32_MAX;
+    snprintf(task.name, sizeof(task.name), "%s", pcTaskGetTaskName(handle));
+
+    portENTER_CRITICAL(&spinlock);
+    if (!findTask(handle, 0) && task_count < PROFILER_MAX_TASKS) {
+        tasks[task_count++] = task;
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+void LoopProfiler::sampleTasks() {
+    last_task_sample = millis();
+
+#if configUSE_TRACE_FACILITY
+    // Chamado só do loop principal: o buffer estático não é disputado
+    static TaskStatus_t status[PROFILER_MAX_TASKS];
+    uint32_t total_runtime = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, PROFILER_MAX_TASKS, &total_runtime);
+
+    if (count > 0) {
+        // getJSON() copia tasks[] da task do AsyncTCP: atualização e
+        // compactação ficam sob o spinlock (só cópias, sem chamadas ao kernel)
+        portENTER_CRITICAL(&spinlock);
+        uint32_t window = total_runtime - last_total_runtime;
+        for (uint8_t i = 0; i < task_count; i++) {
+            tasks[i].seen = false;
+        }
+
+        for (UBaseType_t i = 0; i < count; i++) {
+            const TaskStatus_t& info = status[i];
+            TaskSample* task = findTask(info.xHandle, info.xTaskNumber);
+            bool is_new = !task;
+            if (!task && task_count < PROFILER_MAX_TASKS) {
+                task = &tasks[task_count++];
+                memset(task, 0, sizeof(*task));
+                task->stack_free = UINT32_MAX;
+                strncpy(task->name, info.pcTaskName, sizeof(task->name) - 1);
+            }
+            if (!task) continue;
+
+            task->handle = info.xHandle;
+            task->number = info.xTaskNumber;
+            task->priority = info.uxCurrentPriority;
+            task->seen = true;
+#if configTASKLIST_INCLUDE_COREID
+            task->core = info.xCoreID < 2 ? info.xCoreID : -1;
+#else
+            task->core = -1;
+#endif
+            if (info.usStackHighWaterMark < task->stack_free) {
+                task->stack_free = info.usStackHighWaterMark;
+            }
+
+#if configGENERATE_RUN_TIME_STATS
+            // Em dois núcleos a soma chega a 200%: a base é um núcleo
+            uint32_t used = info.ulRunTimeCounter - task->last_runtime;
+            task->cpu_permille = (!is_new && window > 0) ? (uint16_t)min((uint64_t)used * 1000 / window, (uint64_t)2000) : 0;
+            task->last_runtime = info.ulRunTimeCounter;
+#else
+            (void)is_new;
+            (void)window;
+#endif
+        }
+        last_total_runtime = total_runtime;
+
+        // Tasks encerradas liberam a vaga
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < task_count; i++) {
+            if (tasks[i].seen) tasks[kept++] = tasks[i];
+        }
+        task_count = kept;
+        portEXIT_CRITICAL(&spinlock);
+        return;
+    }
+#endif
+
+    // Sem trace facility: só a folga de stack das tasks registradas
+    for (uint8_t i = 0; i < task_count; i++) {
+        uint32_t free_bytes = uxTaskGetStackHighWaterMark(tasks[i].handle);
+        portENTER_CRITICAL(&spinlock);
+        if (free_bytes < tasks[i].stack_free) tasks[i].stack_free = free_bytes;
+        portEXIT_CRITICAL(&spinlock);
+    }
+}
+
+// ===== CONSULTA =====
+void LoopProfiler::attach(AsyncWebServer* server, const char* uri) {
+    server->on(uri, HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (request->hasParam("reset")) {
+            reset();
+        }
+        AsyncWebServerResponse* response = request->beginResponse(200, "application/json", getJSON());
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    });
+}
+
+String LoopProfiler::getJSON() {
+    // Cópia sob o spinlock; o JSON é montado fora dele
+    Section section_copy[PROFILER_MAX_SECTIONS];
+    uint32_t history_copy[PROFILER_LOOP_HISTORY];
+    TaskSample task_copy[PROFILER_MAX_TASKS];
+    portENTER_CRITICAL(&spinlock);
+    uint8_t sections_used = section_count;
+    memcpy(section_copy, sections, sizeof(Section) * sections_used);
+    memcpy(history_copy, loop_history, sizeof(history_copy));
+    uint8_t tasks_used = task_count;
+    memcpy(task_copy, tasks, sizeof(TaskSample) * tasks_used);
+    uint32_t loops = loop_count;
+    uint32_t loop_max = loop_max_us;
+    uint64_t loop_total = loop_total_us;
+    portEXIT_CRITICAL(&spinlock);
+
+    DynamicJsonDocument doc(4096 + PROFILER_LOOP_HISTORY * 16);
+    doc["uptime_ms"] = millis();
+    doc["free_heap"] = ESP.getFreeHeap();
+
+    JsonObject loop = doc.createNestedObject("loop");
+    loop["count"] = loops;
+    loop["avg_us"] = loops ? (uint32_t)(loop_total / loops) : 0;
+    loop["max_us"] = loop_max;
+
+    // Mais antiga primeiro
+    JsonArray recent = loop.createNestedArray("recent_us");
+    uint32_t available = min(loops, (uint32_t)PROFILER_LOOP_HISTORY);
+    for (uint32_t i = loops - available; i < loops; i++) {
+        recent.add(history_copy[i % PROFILER_LOOP_HISTORY]);
+    }
+
+    JsonArray list = doc.createNestedArray("sections");
+    for (uint8_t i = 0; i < sections_used; i++) {
+        const Section& entry = section_copy[i];
+        JsonObject item = list.createNestedObject();
+        item["name"] = entry.name;
+        item["count"] = entry.count;
+        item["avg_us"] = entry.count ? (uint32_t)(entry.total_us / entry.count) : 0;
+        item["max_us"] = entry.max_us;
+        item["last_us"] = entry.last_us;
+    }
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    doc["run_time_stats"] = true;
+#else
+    doc["run_time_stats"] = false;
+#endif
+    doc["task_window_ms"] = PROFILER_TASK_SAMPLE_MS;
+
+    JsonArray task_list = doc.createNestedArray("tasks");
+    for (uint8_t i = 0; i < tasks_used; i++) {
+        const TaskSample& task = task_copy[i];
+        JsonObject item = task_list.createNestedObject();
+        item["name"] = task.name;
+        item["cpu"] = task.cpu_permille / 10.0;
+        if (task.stack_free != UINT32_MAX) item["stack_free"] = task.stack_free;
+        item["priority"] = task.priority;
+        if (task.core >= 0) item["core"] = task.core;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void LoopProfiler::reset() {
+    portENTER_CRITICAL(&spinlock);
+    for (uint8_t i = 0; i < section_count; i++) {
+        sections[i].count = 0;
+        sections[i].total_us = 0;
+        sections[i].max_us = 0;
+        sections[i].last_us = 0;
+    }
+    memset(loop_history, 0, sizeof(loop_history));
+    loop_count = 0;
+    loop_max_us = 0;
+    loop_total_us = 0;
+    for (uint8_t i = 0; i < task_count; i++) {
+        tasks[i].stack_free = UINT32_MAX;
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+// ===== MÉTODOS INTERNOS =====
+LoopProfiler::TaskSample* LoopProfiler::findTask(TaskHandle_t handle, uint32_t number) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (tasks[i].handle == handle && (number == 0 || tasks[i].number == 0 || tasks[i].number == number)) {
+            return &tasks[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,484 @@
+#include "PHCalibration.h"
+#include <ArduinoJson.h>
+#include <math.h>
+
+const char* PHCalibration::NVS_NAMESPACE = "ph_cal";
+
+// Kelvin para a relação de Nernst
+static const float KELVIN_OFFSET = 273.15;
+
+// ===== CONSTRUTOR E DESTRUTOR =====
+PHCalibration::PHCalibration() :
+    mutex(nullptr),
+    state_mutex(nullptr),
+    session_count(0),
+    reference_slope(0.0),
+    probe_hours(0.0),
+    last_hours_update(0),
+    history_count(0) {
+    loadDefaults();
+}
+
+PHCalibration::~PHCalibration() {
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+        mutex = nullptr;
+    }
+    if (state_mutex) {
+        vSemaphoreDelete(state_mutex);
+        state_mutex = nullptr;
+    }
+}
+
+// ===== CONTROLE =====
+bool PHCalibration::begin() {
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutex();
+        if (!mutex) {
+            Serial.println("❌ Calibração pH: erro ao criar mutex");
+            return false;
+        }
+    }
+    if (!state_mutex) {
+        state_mutex = xSemaphoreCreateRecursiveMutex();
+        if (!state_mutex) {
+            Serial.println("❌ Calibração pH: erro ao criar mutex");
+            return false;
+        }
+    }
+
+    lockState();
+    loadFromNVS();
+    last_hours_update = millis();
+    unlockState();
+
+    PHCalibrationRecord rec = getRecord();
+    Serial.printf("🧪 Calibração pH: %d pontos (%s) | inclinação %.1f%% | sonda %.0fh\n",
+                 rec.point_count, rec.mode == PH_FIT_PIECEWISE ? "segmentos" : "mínimos quadrados",
+                 rec.slope_percent, getProbeHours());
+    if (isProbeWorn()) {
+        Serial.println("⚠️ Sonda de pH com inclinação baixa - considerar substituição");
+    }
+    return true;
+}
+
+void PHCalibration::loop() {
+    // Horas de uso da sonda gravadas com pouca frequência (desgaste da flash)
+    lockState();
+    if (millis() - last_hours_update >= PH_CAL_HOURS_SAVE_INTERVAL_MS) {
+        saveProbeHours();
+    }
+    unlockState();
+}
+
+// ===== CONVERSÃO =====
+float PHCalibration::toPH(float voltage, float temperature) const {
+    lock();
+    float ph = rawPH(record, voltage);
+    float cal_temp = record.cal_temperature;
+    unlock();
+
+    // Nernst: inclinação proporcional a T absoluta, isopotencial em pH 7
+    if (!isnan(temperature) && temperature > MIN_TEMP && temperature < MAX_TEMP) {
+        ph = 7.0 + (ph - 7.0) * (cal_temp + KELVIN_OFFSET) / (temperature + KELVIN_OFFSET);
+    }
+    return ph;
+}
+
+// ===== SESSÃO DE CALIBRAÇÃO =====
+void PHCalibration::startSession() {
+    lockState();
+    session_count = 0;
+    unlockState();
+    Serial.println("🧪 Sessão de calibração de pH iniciada");
+}
+
+bool PHCalibration::addPoint(float buffer_ph, float voltage, float temperature, String& error) {
+    if (buffer_ph < 1.0 || buffer_ph > 13.0) {
+        error = "pH do tampão fora da faixa (1-13)";
+        return false;
+    }
+
+    lockState();
+    bool added = insertPoint(buffer_ph, voltage, temperature, error);
+    unlockState();
+    return added;
+}
+
+bool PHCalibration::insertPoint(float buffer_ph, float voltage, float temperature, String& error) {
+    // Mesmo tampão medido de novo: substitui a leitura anterior
+    for (uint8_t i = 0; i < session_count; i++) {
+        if (fabs(session_points[i].ph - buffer_ph) < 0.5) {
+            session_points[i].voltage = voltage;
+            session_points[i].temperature = temperature;
+            Serial.printf("🧪 Ponto pH %.2f atualizado: %.4f V @ %.1f°C\n", buffer_ph, voltage, temperature);
+            return true;
+        }
+    }
+
+    if (session_count >= PH_CAL_MAX_POINTS) {
+        error = "Máximo de " + String(PH_CAL_MAX_POINTS) + " pontos";
+        return false;
+    }
+
+    // Inserção ordenada por pH
+    uint8_t pos = session_count;
+    while (pos > 0 && session_points[pos - 1].ph > buffer_ph) {
+        session_points[pos] = session_points[pos - 1];
+        pos--;
+    }
+    session_points[pos].ph = buffer_ph;
+    session_points[pos].voltage = voltage;
+    session_points[pos].temperature = temperature;
+    session_count++;
+
+    Serial.printf("🧪 Ponto pH %.2f registrado: %.4f V @ %.1f°C (%d/%d)\n",
+                 buffer_ph, voltage, temperature, session_count, PH_CAL_MAX_POINTS);
+    return true;
+}
+
+bool PHCalibration::commit(PHFitMode mode, String& error) {
+    lockState();
+    bool committed = commitSession(mode, error);
+    unlockState();
+    return committed;
+}
+
+bool PHCalibration::commitSession(PHFitMode mode, String& error) {
+    if (session_count < 2) {
+        error = "São necessários pelo menos 2 pontos";
+        return false;
+    }
+
+    PHCalibrationRecord candidate = getRecord();
+    candidate.version = RECORD_VERSION;
+    candidate.mode = mode;
+    candidate.point_count = session_count;
+    for (uint8_t i = 0; i < session_count; i++) {
+        candidate.points[i] = session_points[i];
+    }
+
+    if (!fit(candidate, error)) {
+        return false;
+    }
+
+    // Primeira calibração da sonda vira a referência de inclinação
+    if (reference_slope == 0.0) {
+        reference_slope = candidate.slope;
+    }
+    if ((candidate.slope > 0) != (reference_slope > 0)) {
+        error = "Inclinação invertida em relação à sonda - verificar tampões";
+        return false;
+    }
+    candidate.slope_percent = fabs(candidate.slope / reference_slope) * 100.0;
+    if (candidate.slope_percent > PH_CAL_MAX_SLOPE_PERCENT) {
+        error = "Inclinação " + String(candidate.slope_percent, 1) + "% acima do esperado - verificar tampões";
+        return false;
+    }
+
+    candidate.probe_hours_at_cal = getProbeHours();
+    candidate.calibration_count++;
+
+    lock();
+    record = candidate;
+    unlock();
+
+    // Histórico para tendência de inclinação
+    if (history_count == PH_CAL_HISTORY_SIZE) {
+        memmove(&history[0], &history[1], sizeof(HistoryEntry) * (PH_CAL_HISTORY_SIZE - 1));
+        history_count--;
+    }
+    history[history_count].slope_percent = candidate.slope_percent;
+    history[history_count].probe_hours = candidate.probe_hours_at_cal;
+    history_count++;
+
+    saveToNVS();
+    session_count = 0;
+
+    Serial.printf("✅ Calibração pH salva: %d pontos | inclinação %.1f%% | %.1f°C\n",
+                 candidate.point_count, candidate.slope_percent, candidate.cal_temperature);
+    if (isProbeWorn()) {
+        Serial.println("⚠️ Inclinação abaixo de " + String(PH_CAL_MIN_SLOPE_PERCENT, 0) + "% - sonda desgastada");
+    }
+    return true;
+}
+
+void PHCalibration::cancelSession() {
+    lockState();
+    session_count = 0;
+    unlockState();
+    Serial.println("🧪 Sessão de calibração de pH cancelada");
+}
+
+// ===== SONDA =====
+void PHCalibration::markNewProbe() {
+    lockState();
+    saveProbeHours();
+
+    reference_slope = 0.0;
+    probe_hours = 0.0;
+    last_hours_update = millis();
+    history_count = 0;
+
+    lock();
+    record.slope_percent = 100.0;
+    record.probe_hours_at_cal = 0.0;
+    record.calibration_count = 0;
+    unlock();
+
+    saveToNVS();
+    unlockState();
+    Serial.println("🧪 Nova sonda de pH registrada - calibrar antes do uso");
+}
+
+float PHCalibration::getProbeHours() const {
+    lockState();
+    float hours = probe_hours + (millis() - last_hours_update) / 3600000.0;
+    unlockState();
+    return hours;
+}
+
+float PHCalibration::getSlopePercent() const {
+    lock();
+    float percent = record.slope_percent;
+    unlock();
+    return percent;
+}
+
+float PHCalibration::getHoursSinceCalibration() const {
+    lock();
+    float at_cal = record.probe_hours_at_cal;
+    unlock();
+    return getProbeHours() - at_cal;
+}
+
+bool PHCalibration::isProbeWorn() const {
+    return getSlopePercent() < PH_CAL_MIN_SLOPE_PERCENT;
+}
+
+// ===== STATUS =====
+PHCalibrationRecord PHCalibration::getRecord() const {
+    lock();
+    PHCalibrationRecord copy = record;
+    unlock();
+    return copy;
+}
+
+String PHCalibration::getStatusJSON() const {
+    PHCalibrationRecord rec = getRecord();
+    DynamicJsonDocument doc(1536);
+
+    doc["mode"] = rec.mode == PH_FIT_PIECEWISE ? "piecewise" : "least_squares";
+    doc["cal_temperature"] = rec.cal_temperature;
+    doc["slope"] = rec.slope;
+    doc["offset"] = rec.offset;
+    doc["slope_percent"] = rec.slope_percent;
+    doc["calibration_count"] = rec.calibration_count;
+    doc["probe_hours"] = getProbeHours();
+    doc["hours_since_calibration"] = getHoursSinceCalibration();
+    doc["probe_worn"] = isProbeWorn();
+
+    lockState();
+    doc["session_points"] = session_count;
+
+    JsonArray points = doc.createNestedArray("points");
+    for (uint8_t i = 0; i < rec.point_count; i++) {
+        JsonObject point = points.createNestedObject();
+        point["ph"] = rec.points[i].ph;
+        point["voltage"] = rec.points[i].voltage;
+        point["temperature"] = rec.points[i].temperature;
+    }
+
+    JsonArray slope_history = doc.createNestedArray("slope_history");
+    for (uint8_t i = 0; i < history_count; i++) {
+        JsonObject entry = slope_history.createNestedObject();
+        entry["slope_percent"] = history[i].slope_percent;
+        entry["probe_hours"] = history[i].probe_hours;
+    }
+    unlockState();
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void PHCalibration::printStatus() const {
+    PHCalibrationRecord rec = getRecord();
+    Serial.println("\n🧪 === CALIBRAÇÃO pH ===");
+    Serial.printf("Modo: %s | Pontos: %d | Temp. calibração: %.1f°C\n",
+                 rec.mode == PH_FIT_PIECEWISE ? "segmentos" : "mínimos quadrados",
+                 rec.point_count, rec.cal_temperature);
+    for (uint8_t i = 0; i < rec.point_count; i++) {
+        Serial.printf("   pH %.2f -> %.4f V @ %.1f°C\n",
+                     rec.points[i].ph, rec.points[i].voltage, rec.points[i].temperature);
+    }
+    Serial.printf("Inclinação: %.3f pH/V (%.1f%%) | Calibrações: %d\n",
+                 rec.slope, rec.slope_percent, rec.calibration_count);
+    Serial.printf("Sonda: %.0fh de uso | %.0fh desde a calibração%s\n",
+                 getProbeHours(), getHoursSinceCalibration(), isProbeWorn() ? " | ⚠️ DESGASTADA" : "");
+    Serial.println("=======================\n");
+}
+
+// ===== MÉTODOS INTERNOS =====
+void PHCalibration::loadDefaults() {
+    // Mesmos dois pontos usados antes pelo HydroControl (pH 7 e pH 4)
+    memset(&record, 0, sizeof(record));
+    record.version = RECORD_VERSION;
+    record.mode = PH_FIT_PIECEWISE;
+    record.point_count = 2;
+    record.points[0] = {4.0, PH_CAL_4, PH_CAL_REFERENCE_TEMP};
+    record.points[1] = {7.0, PH_CAL_7, PH_CAL_REFERENCE_TEMP};
+
+    String error;
+    fit(record, error);
+    record.slope_percent = 100.0;
+}
+
+void PHCalibration::loadFromNVS() {
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        // Primeira execução: manter padrões
+        return;
+    }
+
+    PHCalibrationRecord stored;
+    if (prefs.getBytesLength("record") == sizeof(stored)) {
+        prefs.getBytes("record", &stored, sizeof(stored));
+        if (stored.version == RECORD_VERSION && stored.point_count >= 2 &&
+            stored.point_count <= PH_CAL_MAX_POINTS) {
+            lock();
+            record = stored;
+            unlock();
+        }
+    }
+
+    reference_slope = prefs.getFloat("ref_slope", 0.0);
+    probe_hours = prefs.getFloat("probe_hours", 0.0);
+
+    history_count = 0;
+    size_t history_bytes = prefs.getBytesLength("history");
+    if (history_bytes > 0 && history_bytes <= sizeof(history) &&
+        history_bytes % sizeof(HistoryEntry) == 0) {
+        prefs.getBytes("history", history, history_bytes);
+        history_count = history_bytes / sizeof(HistoryEntry);
+    }
+
+    prefs.end();
+}
+
+void PHCalibration::saveToNVS() {
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        Serial.println("❌ Calibração pH: não foi possível abrir NVS");
+        return;
+    }
+
+    PHCalibrationRecord rec = getRecord();
+    prefs.putBytes("record", &rec, sizeof(rec));
+    prefs.putFloat("ref_slope", reference_slope);
+    prefs.putFloat("probe_hours", probe_hours);
+    if (history_count > 0) {
+        prefs.putBytes("history", history, sizeof(HistoryEntry) * history_count);
+    } else {
+        prefs.remove("history");
+    }
+
+    prefs.end();
+}
+
+void PHCalibration::saveProbeHours() {
+    unsigned long now = millis();
+    probe_hours += (now - last_hours_update) / 3600000.0;
+    last_hours_update = now;
+
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putFloat("probe_hours", probe_hours);
+        prefs.end();
+    }
+}
+
+bool PHCalibration::fit(PHCalibrationRecord& target, String& error) const {
+    uint8_t n = target.point_count;
+    if (n < 2 || n > PH_CAL_MAX_POINTS) {
+        error = "Número de pontos inválido";
+        return false;
+    }
+
+    // Pontos precisam ser distintos em pH e em tensão
+    for (uint8_t i = 1; i < n; i++) {
+        if (target.points[i].ph - target.points[i - 1].ph < 1.0) {
+            error = "Tampões precisam diferir em pelo menos 1 pH";
+            return false;
+        }
+        if (fabs(target.points[i].voltage - target.points[i - 1].voltage) < 0.01) {
+            error = "Tensões muito próximas - sonda sem resposta?";
+            return false;
+        }
+    }
+
+    // Segmentos precisam ter a mesma orientação (curva monotônica)
+    for (uint8_t i = 2; i < n; i++) {
+        float d1 = target.points[i - 1].voltage - target.points[i - 2].voltage;
+        float d2 = target.points[i].voltage - target.points[i - 1].voltage;
+        if ((d1 > 0) != (d2 > 0)) {
+            error = "Curva não monotônica - verificar tampões";
+            return false;
+        }
+    }
+
+    // Reta de mínimos quadrados (com 2 pontos é a reta exata)
+    float sum_v = 0, sum_ph = 0, sum_vv = 0, sum_vph = 0, sum_t = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        sum_v += target.points[i].voltage;
+        sum_ph += target.points[i].ph;
+        sum_vv += target.points[i].voltage * target.points[i].voltage;
+        sum_vph += target.points[i].voltage * target.points[i].ph;
+        sum_t += target.points[i].temperature;
+    }
+    float denominator = n * sum_vv - sum_v * sum_v;
+    if (fabs(denominator) < 1e-9) {
+        error = "Pontos degenerados";
+        return false;
+    }
+
+    target.slope = (n * sum_vph - sum_v * sum_ph) / denominator;
+    target.offset = (sum_ph - target.slope * sum_v) / n;
+    target.cal_temperature = sum_t / n;
+    return true;
+}
+
+float PHCalibration::rawPH(const PHCalibrationRecord& rec, float voltage) const {
+    if (rec.mode == PH_FIT_LEAST_SQUARES || rec.point_count < 3) {
+        if (rec.point_count == 2) {
+            // 2 pontos: reta pelos próprios pontos
+            const PHCalPoint& a = rec.points[0];
+            const PHCalPoint& b = rec.points[1];
+            return a.ph + (voltage - a.voltage) * (b.ph - a.ph) / (b.voltage - a.voltage);
+        }
+        return rec.slope * voltage + rec.offset;
+    }
+
+    // Segmentos: escolher o lado do ponto central em que a tensão está
+    const PHCalPoint& low = rec.points[0];
+    const PHCalPoint& mid = rec.points[1];
+    const PHCalPoint& high = rec.points[2];
+    bool low_side = ((voltage - mid.voltage) > 0) == ((low.voltage - mid.voltage) > 0);
+
+    const PHCalPoint& a = low_side ? low : mid;
+    const PHCalPoint& b = low_side ? mid : high;
+    return a.ph + (voltage - a.voltage) * (b.ph - a.ph) / (b.voltage - a.voltage);
+}
+
+void PHCalibration::lock() const {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void PHCalibration::unlock() const {
+    if (mutex) xSemaphoreGive(mutex);
+}
+
+void PHCalibration::lockState() const {
+    if (state_mutex) xSemaphoreTakeRecursive(state_mutex, portMAX_DELAY);
+}
+
+void PHCalibration::unlockState() const {
+    if (state_mutex) xSemaphoreGiveRecursive(state_mutex);
+}
@@ -1,4 +1,5 @@
 #include "PHSensor.h"
+#include "SignalFilters.h"
 
 // Construtor - inicializa todas as variáveis com valores padrão
 phSensor::phSensor() {
@@ -16,6 +17,10 @@ phSensor::phSensor() {
     for (int i = 0; i < 10; i++) {
         buf[i] = 0;
     }
+    sampleIndex = 0;
+    calibration = nullptr;
+    temperature = NAN;
+    lastVoltage = 0.0;
 }
 
 // Calibração do sensor com 2 ou 3 pontos
@@ -43,29 +48,42 @@ float phSensor::getAverage(uint8_t pin) {
         delay(10);
     }
 
-    // Ordenar as leituras
-    for (int i = 0; i < 9; i++) {
-        for (int j = i + 1; j < 10; j++) {
-            if (buf[i] > buf[j]) {
-                int temp = buf[i];
-                buf[i] = buf[j];
-                buf[j] = temp;
-            }
-        }
-    }
+    return averageBuffer();
+}
 
-    // Calcular o valor médio das leituras centrais
-    int valorMedio = 0;
-    for (int i = 2; i < 8; i++) {
-        valorMedio += buf[i];
+// Adiciona uma amostra ao buffer; retorna true quando o lote está completo
+bool phSensor::collectSample(uint8_t pin) {
+    if (sampleIndex < 10) {
+        buf[sampleIndex++] = analogRead(pin);
     }
+    return sampleIndex >= 10;
+}
+
+// Calcula o pH do lote coletado e libera o buffer para o próximo
+float phSensor::getBufferedPH() {
+    sampleIndex = 0;
+    return calculatePH(averageBuffer());
+}
+
+// Converte contagens filtradas externamente (0-4095) em pH
+float phSensor::readPHFromRaw(float raw) {
+    return calculatePH((raw * 3.3) / 4095.0);
+}
+
+// Média das leituras centrais do buffer (descarta as 2 maiores e as 2 menores)
+float phSensor::averageBuffer() {
+    float valorMedio = SignalFilters::trimmedMean(buf, 10, 2);
 
     // Converter o valor médio para voltagem
-    return (valorMedio * 3.3) / 4095.0 / 6;
+    return (valorMedio * 3.3) / 4095.0;
 }
 
 // Converte voltagem para valor de pH usando equação da reta
 float phSensor::calculatePH(float voltage) {
+    lastVoltage = voltage;
+    if (calibration) {
+        return calibration->toPH(voltage, temperature);
+    }
     return m * voltage + b;  // Calcular o pH
 }
 
@@ -2,11 +2,21 @@
 
 // Constructor
 RelayBridge::RelayBridge(SupabaseClient* supabase, ESPNowTask* espnowTask)
-    : supabase(supabase), espnowTask(espnowTask), enabled(false), 
+    : supabase(supabase), espnowTask(espnowTask),
+      acks(supabase ? new CommandAckQueue([supabase](const int* ids, uint8_t count, const char* status, const char* error) {
+          return supabase->isReady() && supabase->markCommands(ids, count, status, error);
+      }) : nullptr), enabled(false), 
       lastCheck(0), checkInterval(5000), // Check cada 5 segundos
       commandsProcessed(0), commandsSent(0), commandsFailed(0), commandsCompleted(0) {
 }
 
+RelayBridge::~RelayBridge() {
+    if (acks) {
+        acks->flush();
+        delete acks;
+    }
+}
+
 bool RelayBridge::begin() {
     Serial.println("\n🌉 === INICIANDO RELAY BRIDGE ===");
     
@@ -52,6 +62,11 @@ void RelayBridge::update() {
         processSupabaseCommands();
         lastCheck = now;
     }
+    
+    // Confirmaciones pendientes: un PATCH por estado al cerrar la ventana
+    if (acks) {
+        acks->loop();
+    }
 }
 
 void RelayBridge::processSupabaseCommands() {
@@ -176,17 +191,17 @@ bool RelayBridge::sendCommandToSlaveByName(const RelayCommand& supaCmd, const St
 }
 
 bool RelayBridge::updateCommandStatus(int commandId, const String& status) {
-    if (!enabled || !supabase) {
+    if (!enabled || !acks) {
         return false;
     }
     
-    // Actualizar en Supabase según el status
+    // Encolar según el status; sent + completed en la misma ventana = un solo PATCH
     if (status == "sent") {
-        return supabase->markCommandSent(commandId);
+        return acks->add(commandId, COMMAND_ACK_SENT);
     } else if (status == "completed") {
-        return supabase->markCommandCompleted(commandId);
+        return acks->add(commandId, COMMAND_ACK_COMPLETED);
     } else if (status == "failed") {
-        return supabase->markCommandFailed(commandId, "Error desconocido");
+        return acks->add(commandId, COMMAND_ACK_FAILED, "Error desconocido");
     }
     
     return false;
@@ -201,11 +216,11 @@ bool RelayBridge::markCommandCompleted(int commandId) {
 }
 
 bool RelayBridge::markCommandFailed(int commandId, const String& errorMessage) {
-    if (!enabled || !supabase) {
+    if (!enabled || !acks) {
         return false;
     }
     
-    return supabase->markCommandFailed(commandId, errorMessage);
+    return acks->add(commandId, COMMAND_ACK_FAILED, errorMessage.c_str());
 }
 
 void RelayBridge::setAutoProcessing(bool enabled) {
@@ -221,6 +236,9 @@ String RelayBridge::getStatsJSON() {
     json += "\"commandsFailed\":" + String(commandsFailed) + ",";
     json += "\"commandsCompleted\":" + String(commandsCompleted) + ",";
     json += "\"checkInterval\":" + String(checkInterval);
+    if (acks) {
+        json += ",\"acks\":" + acks->getStatusJSON();
+    }
     json += "}";
     return json;
 }
@@ -233,6 +251,9 @@ void RelayBridge::printStats() {
     Serial.println("Comandos completados: " + String(commandsCompleted));
     Serial.println("Comandos fallidos: " + String(commandsFailed));
     Serial.println("Intervalo de polling: " + String(checkInterval) + "ms");
+    if (acks) {
+        acks->printStatus();
+    }
     Serial.println("=============================\n");
 }
 
@@ -0,0 +1,167 @@
+#include "RelayPWMScheduler.h"
+
+// ===== CONSTRUTOR =====
+RelayPWMScheduler::RelayPWMScheduler() :
+    shadow_mask(0) {
+}
+
+// ===== CONTROLE =====
+bool RelayPWMScheduler::start(int relay, float duty_percent, unsigned long period_ms, unsigned long run_time_ms) {
+    if (!isValidRelay(relay)) {
+        Serial.printf("❌ PWM: relé inválido %d\n", relay);
+        return false;
+    }
+
+    if (duty_percent <= 0.0) {
+        stop(relay);
+        return true;
+    }
+
+    if (period_ms == 0) period_ms = DEFAULT_PERIOD_MS;
+    if (period_ms < MIN_PERIOD_MS) period_ms = MIN_PERIOD_MS;
+
+    PWMChannel& channel = channels[relay];
+    bool was_active = channel.active;
+
+    channel.duty = constrain(duty_percent, 0.0f, 100.0f) / 100.0;
+    channel.period_ms = period_ms;
+    channel.start_time = millis();
+    channel.run_time_ms = run_time_ms;
+
+    if (!was_active) {
+        // Primeira janela defasada pelo índice do relé: canais com o mesmo
+        // período nunca ligam no mesmo instante
+        channel.carry_ms = 0;
+        channel.window_start = channel.start_time + relay * PHASE_STAGGER_MS;
+        channel.active = true;
+        beginWindow(channel);
+    }
+    // Se já estava ativo, o novo duty vale a partir da próxima janela
+
+    Serial.printf("〰️ PWM relé %d: %.1f%% de %lus", relay, duty_percent, period_ms / 1000);
+    if (run_time_ms > 0) {
+        Serial.printf(" por %lus", run_time_ms / 1000);
+    }
+    Serial.println();
+
+    return true;
+}
+
+void RelayPWMScheduler::stop(int relay) {
+    if (!isValidRelay(relay)) return;
+
+    PWMChannel& channel = channels[relay];
+    if (!channel.active) return;
+
+    channel.active = false;
+    channel.duty = 0.0;
+    channel.carry_ms = 0;
+    applyState(relay, false);
+
+    Serial.printf("〰️ PWM relé %d parado\n", relay);
+}
+
+void RelayPWMScheduler::stopAll() {
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        stop(i);
+    }
+}
+
+void RelayPWMScheduler::update() {
+    update(millis());
+}
+
+void RelayPWMScheduler::update(unsigned long now) {
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        PWMChannel& channel = channels[i];
+        if (!channel.active) continue;
+
+        // Tempo total de execução esgotado
+        if (channel.run_time_ms > 0 && now - channel.start_time >= channel.run_time_ms) {
+            stop(i);
+            continue;
+        }
+
+        // Primeira janela ainda não começou (defasagem)
+        if ((long)(now - channel.window_start) < 0) {
+            applyState(i, false);
+            continue;
+        }
+
+        // Avançar janelas vencidas (inclui atrasos longos do loop)
+        while (now - channel.window_start >= channel.period_ms) {
+            channel.window_start += channel.period_ms;
+            beginWindow(channel);
+        }
+
+        applyState(i, (now - channel.window_start) < channel.on_time_ms);
+    }
+}
+
+// ===== STATUS =====
+bool RelayPWMScheduler::isActive(int relay) const {
+    return isValidRelay(relay) && channels[relay].active;
+}
+
+float RelayPWMScheduler::getDutyPercent(int relay) const {
+    if (!isActive(relay)) return 0.0;
+    return channels[relay].duty * 100.0;
+}
+
+uint8_t RelayPWMScheduler::getActiveCount() const {
+    uint8_t count = 0;
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        if (channels[i].active) count++;
+    }
+    return count;
+}
+
+void RelayPWMScheduler::printStatus() {
+    Serial.println("\n〰️ === PWM DE RELÉS ===");
+    Serial.printf("Canais ativos: %d | Registrador sombra: 0x%04X\n", getActiveCount(), shadow_mask);
+    for (int i = 0; i < MAX_RELAYS; i++) {
+        const PWMChannel& channel = channels[i];
+        if (!channel.active) continue;
+        Serial.printf("   Relé %d: %.1f%% | janela %lus | ligado %lums | %s\n",
+                     i, channel.duty * 100.0, channel.period_ms / 1000, channel.on_time_ms,
+                     (shadow_mask & (1 << i)) ? "ON" : "OFF");
+    }
+    Serial.println("======================\n");
+}
+
+// ===== MÉTODOS INTERNOS =====
+void RelayPWMScheduler::beginWindow(PWMChannel& channel) {
+    // Tempo ligado desejado + resto acumulado das janelas anteriores.
+    // Pulsos menores que MIN_SWITCH_MS não são emitidos: o tempo fica
+    // acumulado e sai numa janela seguinte, preservando a dose média.
+    long target = (long)(channel.duty * channel.period_ms) + channel.carry_ms;
+    long period = (long)channel.period_ms;
+    long actual;
+
+    if (target < (long)MIN_SWITCH_MS) {
+        actual = 0;
+    } else if (period - target < (long)MIN_SWITCH_MS) {
+        actual = period;
+    } else {
+        actual = target;
+    }
+
+    channel.carry_ms = constrain(target - actual, -period, period);
+    channel.on_time_ms = (unsigned long)actual;
+}
+
+void RelayPWMScheduler::applyState(int relay, bool state) {
+    uint16_t bit = (uint16_t)(1 << relay);
+    bool current = (shadow_mask & bit) != 0;
+    if (current == state) return;
+
+    if (state) {
+        shadow_mask |= bit;
+    } else {
+        shadow_mask &= ~bit;
+    }
+
+    if (write_callback) {
+        write_callback(relay, state);
+    }
+}
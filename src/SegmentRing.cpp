@@ -0,0 +1,151 @@
+#include "SegmentRing.h"
+
+// ===== CONSTRUTOR =====
+SegmentRing::SegmentRing(const char* directory, size_t record_size, uint16_t records_per_segment,
+                         uint16_t segment_count) :
+    directory(directory),
+    record_size(record_size),
+    per_segment(records_per_segment),
+    segments(segment_count),
+    fs(nullptr),
+    reader_segment(-1) {
+}
+
+bool SegmentRing::begin(fs::FS* filesystem) {
+    endRead();
+    fs = filesystem;
+    if (!fs) return false;
+
+    if (!fs->exists(directory) && !fs->mkdir(directory)) {
+        Serial.printf("❌ SegmentRing: erro ao criar %s\n", directory);
+        return false;
+    }
+    return true;
+}
+
+// ===== GRAVAÇÃO =====
+bool SegmentRing::append(uint32_t index, const uint8_t* data, size_t count) {
+    if (!fs) return false;
+    endRead();
+
+    // Trechos contíguos dentro de cada segmento
+    char path[SEGMENT_RING_PATH_SIZE];
+    bool ok = true;
+    while (ok && count > 0) {
+        uint32_t slot = index % capacity();
+        uint16_t position = slot % per_segment;
+        size_t chunk = min(count, (size_t)(per_segment - position));
+        size_t bytes = chunk * record_size;
+
+        segmentPath(slot / per_segment, path);
+        File file = openAt(path, position);
+        ok = file && file.write(data, bytes) == bytes;
+        if (file) file.close();
+
+        data += bytes;
+        index += chunk;
+        count -= chunk;
+    }
+    return ok;
+}
+
+void SegmentRing::clear() {
+    if (!fs) return;
+    endRead();
+
+    char path[SEGMENT_RING_PATH_SIZE];
+    for (uint16_t segment = 0; segment < segments; segment++) {
+        segmentPath(segment, path);
+        if (fs->exists(path)) fs->remove(path);
+    }
+}
+
+// ===== LEITURA =====
+bool SegmentRing::readSlot(uint32_t slot, uint8_t* out) {
+    if (!fs || slot >= capacity()) return false;
+
+    int segment = slot / per_segment;
+    if (!reader || reader_segment != segment) {
+        endRead();
+        char path[SEGMENT_RING_PATH_SIZE];
+        segmentPath(segment, path);
+        if (!fs->exists(path)) return false;
+
+        reader = fs->open(path, "r");
+        if (!reader) return false;
+        reader_segment = segment;
+    }
+
+    return reader.seek((slot % per_segment) * record_size) &&
+           reader.read(out, record_size) == record_size;
+}
+
+void SegmentRing::endRead() {
+    if (reader) reader.close();
+    reader_segment = -1;
+}
+
+uint32_t SegmentRing::oldestKept(uint32_t newest) const {
+    // Segmento corrente até newest + os outros segmentos inteiros
+    uint32_t start = newest - newest % per_segment;
+    uint32_t others = capacity() - per_segment;
+    return start > others ? start - others : 0;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void SegmentRing::segmentPath(uint16_t segment, char* out) const {
+    snprintf(out, SEGMENT_RING_PATH_SIZE, "%s/%u.seg", directory, segment);
+}
+
+File SegmentRing::openAt(const char* path, uint16_t position) {
+    // Início de segmento: recicla (trunca) o arquivo
+    if (position == 0) return fs->open(path, "w");
+
+    size_t expected = (size_t)position * record_size;
+    File file = fs->open(path, "a");
+    if (!file) return file;
+
+    if (file.size() > expected) {
+        file.close();
+        if (!truncate(path, expected)) return File();
+        file = fs->open(path, "a");
+        if (!file) return file;
+    }
+
+    // Índices pulados viram registros zerados (inválidos para os donos)
+    static const uint8_t zeros[32] = {0};
+    size_t size = file.size();
+    while (size < expected) {
+        size_t count = min(sizeof(zeros), expected - size);
+        if (file.write(zeros, count) != count) {
+            file.close();
+            return File();
+        }
+        size += count;
+    }
+    return file;
+}
+
+bool SegmentRing::truncate(const char* path, size_t length) {
+    // Sem ftruncate no VFS do Arduino: copia o começo para um temporário
+    char temp[SEGMENT_RING_PATH_SIZE];
+    snprintf(temp, sizeof(temp), "%s/tmp.seg", directory);
+
+    File source = fs->open(path, "r");
+    File target = fs->open(temp, "w");
+    uint8_t chunk[128];
+    bool ok = source && target;
+    while (ok && length > 0) {
+        size_t count = min(length, sizeof(chunk));
+        ok = source.read(chunk, count) == count && target.write(chunk, count) == count;
+        length -= count;
+    }
+    if (source) source.close();
+    if (target) target.close();
+
+    ok = ok && fs->remove(path) && fs->rename(temp, path);
+    if (!ok) {
+        Serial.printf("❌ SegmentRing: erro ao cortar %s\n", path);
+    }
+    return ok;
+}
@@ -0,0 +1,189 @@
+#include "SensorBus.h"
+#include <ArduinoJson.h>
+
+// ===== CONSTRUTOR =====
+SensorBus::SensorBus() :
+    channel_count(SENSOR_CHANNEL_COUNT),
+    health(nullptr),
+    subscribed_channels(0) {
+    memset(descriptors, 0, sizeof(descriptors));
+    memset(dispatched_sequence, 0, sizeof(dispatched_sequence));
+    memset(dispatched_quality, SAMPLE_QUALITY_NO_DATA, sizeof(dispatched_quality));
+
+    // Canais publicados pela SensorTask
+    registerBuiltin(SENSOR_WATER_TEMP, "temp_water", "Temperatura da água", "°C", MIN_TEMP, MAX_TEMP, 10000, 1);
+    registerBuiltin(SENSOR_PH, "ph", "pH", "pH", MIN_PH, MAX_PH, 10000, 2);
+    registerBuiltin(SENSOR_TDS, "tds", "TDS", "ppm", MIN_TDS, MAX_TDS, 10000, 0);
+    registerBuiltin(SENSOR_EC, "ec", "Condutividade", "µS/cm", 0.0, MAX_TDS * 2.0, 10000, 0);
+    registerBuiltin(SENSOR_WATER_LEVEL, "level", "Nível do reservatório", "", 0.0, 1.0, 5000, 0);
+    registerBuiltin(SENSOR_PH_VOLTAGE, "ph_voltage", "Tensão do eletrodo de pH", "V", 0.0, PH_VREF, 5000, 4);
+}
+
+// ===== REGISTRO =====
+SensorChannel SensorBus::registerChannel(const char* key, const char* label, const char* unit,
+                                         float min_value, float max_value, uint32_t max_age_ms,
+                                         uint8_t decimals) {
+    if (findChannel(key) != SENSOR_CHANNEL_INVALID) {
+        Serial.printf("⚠️ SensorBus: canal '%s' já registrado\n", key);
+        return SENSOR_CHANNEL_INVALID;
+    }
+    if (channel_count >= SENSOR_MAX_CHANNELS) {
+        Serial.printf("❌ SensorBus: sem espaço para o canal '%s'\n", key);
+        return SENSOR_CHANNEL_INVALID;
+    }
+
+    SensorChannel channel = (SensorChannel)channel_count++;
+    registerBuiltin(channel, key, label, unit, min_value, max_value, max_age_ms, decimals);
+    Serial.printf("✅ SensorBus: canal '%s' (%s) registrado como %d\n", key, unit, channel);
+    return channel;
+}
+
+const SensorDescriptor* SensorBus::describe(SensorChannel channel) const {
+    if (channel < 0 || channel >= SENSOR_MAX_CHANNELS || !descriptors[channel].registered) {
+        return nullptr;
+    }
+    return &descriptors[channel];
+}
+
+SensorChannel SensorBus::findChannel(const String& key) const {
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (descriptors[i].registered && key == descriptors[i].key) {
+            return (SensorChannel)i;
+        }
+    }
+    return SENSOR_CHANNEL_INVALID;
+}
+
+// ===== PUBLICAÇÃO =====
+void SensorBus::publish(SensorChannel channel, float value, uint32_t timestamp) {
+    const SensorDescriptor* descriptor = describe(channel);
+    if (!descriptor) return;
+
+    bool valid = !isnan(value) && value >= descriptor->min_value && value <= descriptor->max_value;
+    store.publish(channel, value, valid, timestamp);
+}
+
+// ===== ASSINATURA =====
+int SensorBus::subscribe(ChannelMask channels, Subscriber callback) {
+    for (int i = 0; i < SENSOR_BUS_MAX_SUBSCRIBERS; i++) {
+        if (!subscribers[i].active) {
+            subscribers[i].channels = channels;
+            subscribers[i].callback = callback;
+            subscribers[i].active = true;
+            subscribed_channels |= channels;
+            return i;
+        }
+    }
+
+    Serial.println("❌ SensorBus: limite de assinantes atingido");
+    return -1;
+}
+
+void SensorBus::unsubscribe(int subscription_id) {
+    if (subscription_id < 0 || subscription_id >= SENSOR_BUS_MAX_SUBSCRIBERS) return;
+
+    subscribers[subscription_id].active = false;
+    subscribers[subscription_id].callback = nullptr;
+
+    subscribed_channels = 0;
+    for (int i = 0; i < SENSOR_BUS_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].active) subscribed_channels |= subscribers[i].channels;
+    }
+}
+
+void SensorBus::dispatch(uint32_t now) {
+    for (uint8_t ch = 0; ch < channel_count; ch++) {
+        SensorChannel channel = (SensorChannel)ch;
+        if (!(subscribed_channels & maskOf(channel))) continue;
+
+        SensorReading reading;
+        if (!read(channel, reading, now)) continue;
+
+        // Só entrega amostra nova ou mudança de qualidade
+        if (reading.sequence == dispatched_sequence[ch] && reading.quality == dispatched_quality[ch]) {
+            continue;
+        }
+        dispatched_sequence[ch] = reading.sequence;
+        dispatched_quality[ch] = reading.quality;
+
+        for (int i = 0; i < SENSOR_BUS_MAX_SUBSCRIBERS; i++) {
+            if (subscribers[i].active && (subscribers[i].channels & maskOf(channel))) {
+                subscribers[i].callback(reading);
+            }
+        }
+    }
+}
+
+// ===== LEITURA DIRETA =====
+bool SensorBus::read(SensorChannel channel, SensorReading& out, uint32_t now) const {
+    const SensorDescriptor* descriptor = describe(channel);
+    if (!descriptor) return false;
+
+    SensorSample sample;
+    if (!store.read(channel, sample)) return false;
+
+    out.channel = channel;
+    out.descriptor = descriptor;
+    out.value = sample.value;
+    out.timestamp = sample.timestamp;
+    out.sequence = sample.sequence;
+    out.quality = evaluateQuality(channel, sample, now);
+    return true;
+}
+
+String SensorBus::getStatusJSON(uint32_t now) const {
+    DynamicJsonDocument doc(2048);
+    JsonArray channels = doc.createNestedArray("channels");
+
+    for (uint8_t ch = 0; ch < channel_count; ch++) {
+        SensorReading reading;
+        if (!read((SensorChannel)ch, reading, now)) continue;
+
+        JsonObject entry = channels.createNestedObject();
+        entry["id"] = ch;
+        entry["key"] = reading.descriptor->key;
+        entry["label"] = reading.descriptor->label;
+        entry["unit"] = reading.descriptor->unit;
+        entry["value"] = reading.value;
+        entry["decimals"] = reading.descriptor->decimals;
+        entry["age_ms"] = reading.sequence ? now - reading.timestamp : 0;
+        entry["quality"] = reading.quality;
+        entry["good"] = reading.isGood();
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void SensorBus::registerBuiltin(SensorChannel channel, const char* key, const char* label, const char* unit,
+                                float min_value, float max_value, uint32_t max_age_ms, uint8_t decimals) {
+    SensorDescriptor& descriptor = descriptors[channel];
+    descriptor.key = key;
+    descriptor.label = label;
+    descriptor.unit = unit;
+    descriptor.min_value = min_value;
+    descriptor.max_value = max_value;
+    descriptor.max_age_ms = max_age_ms;
+    descriptor.decimals = decimals;
+    descriptor.registered = true;
+}
+
+uint8_t SensorBus::evaluateQuality(SensorChannel channel, const SensorSample& sample, uint32_t now) const {
+    if (sample.sequence == 0) return SAMPLE_QUALITY_NO_DATA;
+
+    const SensorDescriptor& descriptor = descriptors[channel];
+    uint8_t quality = SAMPLE_QUALITY_GOOD;
+
+    if (!sample.valid || sample.value < descriptor.min_value || sample.value > descriptor.max_value) {
+        quality |= SAMPLE_QUALITY_INVALID;
+    }
+    if (now - sample.timestamp > descriptor.max_age_ms) {
+        quality |= SAMPLE_QUALITY_STALE;
+    }
+    if (health && !health->isUsable(channel)) {
+        quality |= SAMPLE_QUALITY_DEGRADED;
+    }
+    return quality;
+}
@@ -0,0 +1,314 @@
+#include "SensorHealth.h"
+#include <ArduinoJson.h>
+
+// Ruído volta a ser aceito só abaixo de 70% do limite (histerese)
+static const float NOISE_CLEAR_RATIO = 0.7;
+
+// ===== CONSTRUTOR =====
+SensorHealthMonitor::SensorHealthMonitor() :
+    ph_calibration(nullptr),
+    last_update(0) {
+    channels[0].id = SENSOR_PH;
+    channels[0].limits = {SENSOR_HEALTH_PH_NOISE_MAX, SENSOR_HEALTH_PH_STUCK_EPSILON, SENSOR_HEALTH_PH_MIN_RESPONSE};
+
+    channels[1].id = SENSOR_TDS;
+    channels[1].limits = {SENSOR_HEALTH_TDS_NOISE_MAX, SENSOR_HEALTH_TDS_STUCK_EPSILON, SENSOR_HEALTH_TDS_MIN_RESPONSE};
+
+    channels[2].id = SENSOR_WATER_TEMP;
+    channels[2].limits = {SENSOR_HEALTH_TEMP_NOISE_MAX, 0.0, 0.0};
+}
+
+// ===== CONTROLE =====
+void SensorHealthMonitor::update(const SensorSampleStore& store, unsigned long now) {
+    if (now - last_update < SENSOR_HEALTH_INTERVAL_MS) return;
+    last_update = now;
+
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        Channel& channel = channels[i];
+        SensorSample sample;
+        store.read(channel.id, sample);
+
+        // Nada publicado ainda (boot): sem julgamento
+        if (sample.sequence == 0) continue;
+
+        if (sample.sequence != channel.last_sequence) {
+            channel.last_sequence = sample.sequence;
+            if (sample.valid) {
+                addSample(channel, sample.value, now);
+            }
+        }
+
+        evaluate(channel, sample, now);
+    }
+}
+
+void SensorHealthMonitor::notifyDosing(int relay, unsigned long now) {
+    static const int ph_relays[] = SENSOR_HEALTH_PH_PUMP_RELAYS;
+    static const int nutrient_relays[] = SENSOR_HEALTH_NUTRIENT_PUMP_RELAYS;
+
+    SensorChannel target = SENSOR_CHANNEL_COUNT;
+    for (int r : ph_relays) {
+        if (r == relay) target = SENSOR_PH;
+    }
+    for (int r : nutrient_relays) {
+        if (r == relay) target = SENSOR_TDS;
+    }
+
+    Channel* channel = findChannel(target);
+    if (!channel || channel->limits.min_response <= 0.0 || channel->window.size() == 0) return;
+
+    // Doses seguidas dentro da mesma janela medem contra a linha de base original
+    if (channel->response_pending) return;
+
+    channel->response_pending = true;
+    channel->response_baseline = channel->window.get();
+    channel->dose_time = now;
+}
+
+void SensorHealthMonitor::acknowledgeResponse(SensorChannel channel) {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        if (channel == SENSOR_CHANNEL_COUNT || channels[i].id == channel) {
+            channels[i].acknowledge_requested = true;
+        }
+    }
+}
+
+// ===== CONSULTA =====
+const SensorHealthStatus& SensorHealthMonitor::getStatus(SensorChannel channel) const {
+    static const SensorHealthStatus unknown;
+    const Channel* found = findChannel(channel);
+    return found ? found->status : unknown;
+}
+
+bool SensorHealthMonitor::isUsable(SensorChannel channel) const {
+    // EC é derivada da mesma sonda do TDS
+    const Channel* found = findChannel(channel == SENSOR_EC ? SENSOR_TDS : channel);
+    return !found || found->status.level < SENSOR_HEALTH_DEGRADED;
+}
+
+bool SensorHealthMonitor::isUsable(const String& sensor_name) const {
+    // Mesmos nomes usados nas condições do DecisionEngine
+    if (sensor_name == "ph") return isUsable(SENSOR_PH);
+    if (sensor_name == "tds") return isUsable(SENSOR_TDS);
+    if (sensor_name == "ec") return isUsable(SENSOR_EC);
+    if (sensor_name == "temp_water") return isUsable(SENSOR_WATER_TEMP);
+    return true;
+}
+
+bool SensorHealthMonitor::hasFailure() const {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        if (channels[i].status.level == SENSOR_HEALTH_FAILED) return true;
+    }
+    return false;
+}
+
+// ===== STATUS =====
+String SensorHealthMonitor::getStatusJSON() const {
+    DynamicJsonDocument doc(1024);
+    JsonArray sensors = doc.createNestedArray("sensors");
+
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        const Channel& channel = channels[i];
+        JsonObject sensor = sensors.createNestedObject();
+        sensor["sensor"] = channelName(channel.id);
+        sensor["level"] = levelToString(channel.status.level);
+        sensor["flags"] = channel.status.flags;
+        sensor["reasons"] = describeFlags(channel.status.flags);
+        sensor["noise"] = channel.status.noise;
+        sensor["median"] = channel.status.median;
+        sensor["last_response_ms"] = channel.status.last_response_ms;
+        sensor["response_failures"] = channel.status.response_failures;
+        sensor["response_pending"] = channel.response_pending;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void SensorHealthMonitor::printStatus() const {
+    Serial.println("\n🩺 === SAÚDE DOS SENSORES ===");
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        const SensorHealthStatus& status = channels[i].status;
+        Serial.printf("%s: %s | ruído %.3f | mediana %.2f | resposta %lums | falhas %d %s\n",
+                     channelName(channels[i].id), levelToString(status.level), status.noise,
+                     status.median, status.last_response_ms, status.response_failures,
+                     describeFlags(status.flags).c_str());
+    }
+    Serial.println("=============================\n");
+}
+
+const char* SensorHealthMonitor::levelToString(SensorHealthLevel level) {
+    switch (level) {
+        case SENSOR_HEALTH_OK: return "ok";
+        case SENSOR_HEALTH_WARNING: return "warning";
+        case SENSOR_HEALTH_DEGRADED: return "degraded";
+        case SENSOR_HEALTH_FAILED: return "failed";
+        default: return "unknown";
+    }
+}
+
+// ===== MÉTODOS INTERNOS =====
+SensorHealthMonitor::Channel* SensorHealthMonitor::findChannel(SensorChannel id) {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        if (channels[i].id == id) return &channels[i];
+    }
+    return nullptr;
+}
+
+const SensorHealthMonitor::Channel* SensorHealthMonitor::findChannel(SensorChannel id) const {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        if (channels[i].id == id) return &channels[i];
+    }
+    return nullptr;
+}
+
+void SensorHealthMonitor::addSample(Channel& channel, float value, unsigned long now) {
+    // Ruído pelas diferenças sucessivas: var(x[n] - x[n-1]) = 2σ² para ruído branco
+    if (channel.window.size() > 0) {
+        float diff = value - channel.last_value;
+        channel.diff_sq[channel.diff_head] = diff * diff;
+        channel.diff_head = (channel.diff_head + 1) % SENSOR_HEALTH_WINDOW;
+        if (channel.diff_count < SENSOR_HEALTH_WINDOW) channel.diff_count++;
+
+        channel.diff_sum = 0.0;
+        for (uint8_t i = 0; i < channel.diff_count; i++) {
+            channel.diff_sum += channel.diff_sq[i];
+        }
+        channel.status.noise = sqrt(channel.diff_sum / channel.diff_count / 2.0);
+    }
+    channel.last_value = value;
+
+    channel.window.push(value);
+    channel.status.median = channel.window.get();
+
+    // Valor parado: janela cheia sem variação
+    if (channel.limits.stuck_epsilon > 0.0 && channel.window.isFull() &&
+        channel.window.getMax() - channel.window.getMin() <= channel.limits.stuck_epsilon) {
+        if (channel.stuck_since == 0) channel.stuck_since = now;
+    } else {
+        channel.stuck_since = 0;
+    }
+}
+
+void SensorHealthMonitor::evaluate(Channel& channel, const SensorSample& sample, unsigned long now) {
+    uint16_t flags = 0;
+
+    if (!sample.valid) {
+        flags |= SENSOR_FLAG_INVALID;
+    }
+    if ((uint32_t)now - sample.timestamp > SENSOR_HEALTH_STALE_MS) {
+        flags |= SENSOR_FLAG_STALE;
+    }
+    if (channel.stuck_since != 0 && now - channel.stuck_since >= SENSOR_HEALTH_STUCK_MS) {
+        flags |= SENSOR_FLAG_STUCK;
+    }
+
+    if (channel.diff_count >= SENSOR_HEALTH_WINDOW / 2) {
+        bool was_noisy = channel.status.flags & SENSOR_FLAG_NOISY;
+        float limit = channel.limits.noise_max * (was_noisy ? NOISE_CLEAR_RATIO : 1.0);
+        if (channel.status.noise > limit) {
+            flags |= SENSOR_FLAG_NOISY;
+        }
+    }
+
+    checkResponse(channel, now);
+    if (channel.status.response_failures >= SENSOR_HEALTH_RESPONSE_FAILURES) {
+        flags |= SENSOR_FLAG_NO_RESPONSE;
+    }
+
+    if (channel.id == SENSOR_PH && ph_calibration) {
+        if (ph_calibration->isProbeWorn()) {
+            flags |= SENSOR_FLAG_SLOPE_DRIFT;
+        }
+        if (ph_calibration->getHoursSinceCalibration() > SENSOR_HEALTH_CAL_MAX_HOURS) {
+            flags |= SENSOR_FLAG_CAL_OVERDUE;
+        }
+    }
+
+    // Valor parado sozinho não tira a sonda do controle: a dose é a prova
+    bool stuck_confirmed = (flags & SENSOR_FLAG_STUCK) && channel.status.response_failures > 0;
+
+    SensorHealthLevel level = SENSOR_HEALTH_OK;
+    if (flags & (SENSOR_FLAG_STALE | SENSOR_FLAG_INVALID)) {
+        level = SENSOR_HEALTH_FAILED;
+    } else if (stuck_confirmed || (flags & (SENSOR_FLAG_NOISY | SENSOR_FLAG_NO_RESPONSE | SENSOR_FLAG_SLOPE_DRIFT))) {
+        level = SENSOR_HEALTH_DEGRADED;
+    } else if (flags & (SENSOR_FLAG_STUCK | SENSOR_FLAG_CAL_OVERDUE)) {
+        level = SENSOR_HEALTH_WARNING;
+    }
+
+    bool level_changed = level != channel.status.level;
+    channel.status.flags = flags;
+    channel.status.level = level;
+
+    if (level_changed) {
+        String reason = describeFlags(flags);
+        Serial.printf("%s Sensor %s: %s %s\n", level >= SENSOR_HEALTH_DEGRADED ? "🩺⚠️" : "🩺",
+                     channelName(channel.id), levelToString(level), reason.c_str());
+        if (change_callback) {
+            change_callback(channel.id, level, reason);
+        }
+    }
+}
+
+void SensorHealthMonitor::checkResponse(Channel& channel, unsigned long now) {
+    if (channel.acknowledge_requested) {
+        channel.acknowledge_requested = false;
+        if (channel.status.response_failures > 0) {
+            Serial.printf("🩺 Sensor %s: falhas de resposta reconhecidas manualmente\n", channelName(channel.id));
+        }
+        channel.status.response_failures = 0;
+        channel.response_pending = false;
+        return;
+    }
+
+    // Degradado, o sensor bloqueia as doses que provariam a resposta:
+    // depois do prazo, uma falha é perdoada e a próxima dose é a prova
+    if (!channel.response_pending && channel.status.response_failures >= SENSOR_HEALTH_RESPONSE_FAILURES &&
+        now - channel.last_failure >= SENSOR_HEALTH_RESPONSE_RETRY_MS) {
+        channel.status.response_failures = SENSOR_HEALTH_RESPONSE_FAILURES - 1;
+        Serial.printf("🩺 Sensor %s: liberando uma dose de prova da resposta\n", channelName(channel.id));
+        return;
+    }
+
+    if (!channel.response_pending || channel.window.size() == 0) return;
+
+    float delta = fabs(channel.window.get() - channel.response_baseline);
+    if (delta >= channel.limits.min_response) {
+        channel.status.last_response_ms = now - channel.dose_time;
+        channel.status.response_failures = 0;
+        channel.response_pending = false;
+        return;
+    }
+
+    if (now - channel.dose_time >= SENSOR_HEALTH_RESPONSE_TIMEOUT_MS) {
+        if (channel.status.response_failures < 255) channel.status.response_failures++;
+        channel.response_pending = false;
+        channel.last_failure = now;
+        Serial.printf("🩺 Sensor %s não respondeu à dosagem (Δ %.3f em %lus)\n",
+                     channelName(channel.id), delta, (now - channel.dose_time) / 1000);
+    }
+}
+
+String SensorHealthMonitor::describeFlags(uint16_t flags) const {
+    String result = "";
+    if (flags & SENSOR_FLAG_STALE) result += "stale ";
+    if (flags & SENSOR_FLAG_INVALID) result += "invalid ";
+    if (flags & SENSOR_FLAG_STUCK) result += "stuck ";
+    if (flags & SENSOR_FLAG_NOISY) result += "noisy ";
+    if (flags & SENSOR_FLAG_NO_RESPONSE) result += "no_response ";
+    if (flags & SENSOR_FLAG_SLOPE_DRIFT) result += "slope_drift ";
+    if (flags & SENSOR_FLAG_CAL_OVERDUE) result += "cal_overdue ";
+    if (result.length() > 0) result = result.substring(0, result.length() - 1);
+    return result;
+}
+
+const char* SensorHealthMonitor::channelName(SensorChannel id) {
+    switch (id) {
+        case SENSOR_PH: return "ph";
+        case SENSOR_TDS: return "tds";
+        case SENSOR_WATER_TEMP: return "temp_water";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,64 @@
+#include "SensorSampleStore.h"
+
+// Tentativas de leitura antes de desistir (escritor nunca fica tanto tempo ativo)
+static const int MAX_READ_RETRIES = 8;
+
+SensorSampleStore::SensorSampleStore() {
+}
+
+// ===== ESCRITA =====
+void SensorSampleStore::publish(SensorChannel channel, float value, bool valid, uint32_t timestamp) {
+    if (channel < 0 || channel >= SENSOR_MAX_CHANNELS) return;
+
+    Slot& slot = slots[channel];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+
+    // Ímpar: escrita em andamento
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.sample.value = value;
+    slot.sample.valid = valid;
+    slot.sample.timestamp = timestamp;
+    slot.sample.sequence++;
+
+    // Par: escrita concluída
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+// ===== LEITURA =====
+bool SensorSampleStore::read(SensorChannel channel, SensorSample& out) const {
+    if (channel < 0 || channel >= SENSOR_MAX_CHANNELS) return false;
+
+    const Slot& slot = slots[channel];
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        SensorSample copy = slot.sample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        uint32_t after = slot.seq.load(std::memory_order_relaxed);
+        if (before == after) {
+            out = copy;
+            return true;
+        }
+    }
+    return false;
+}
+
+float SensorSampleStore::getValue(SensorChannel channel, float fallback) const {
+    SensorSample sample;
+    if (read(channel, sample) && sample.valid) {
+        return sample.value;
+    }
+    return fallback;
+}
+
+bool SensorSampleStore::isFresh(SensorChannel channel, uint32_t max_age_ms, uint32_t now) const {
+    SensorSample sample;
+    if (!read(channel, sample) || !sample.valid || sample.sequence == 0) {
+        return false;
+    }
+    return (now - sample.timestamp) <= max_age_ms;
+}
@@ -0,0 +1,197 @@
+#include "SensorTask.h"
+#include "LoopProfiler.h"
+
+SensorTask::SensorTask(SensorSampleStore& store) :
+    taskHandle(nullptr),
+    store(store),
+    tempSensor(nullptr),
+    pHSensor(nullptr),
+    tdsSensor(nullptr),
+    levelSensor(nullptr),
+    adcSampler(nullptr),
+    tempState(TEMP_IDLE),
+    tempRequestTime(0),
+    lastTempCycle(0),
+    lastWaterTemp(25.0),
+    phState(PH_IDLE),
+    lastPHSample(0),
+    lastPHCycle(0),
+    lastTDSCycle(0),
+    lastLevelCheck(0) {
+}
+
+SensorTask::~SensorTask() {
+    end();
+}
+
+// ===== INICIALIZAÇÃO =====
+bool SensorTask::begin(DallasTemperature* temp, phSensor* ph, TDSReaderSerial* tds, LevelSensor* level,
+                       AdcDmaSampler* adc) {
+    tempSensor = temp;
+    pHSensor = ph;
+    tdsSensor = tds;
+    levelSensor = level;
+    adcSampler = adc;
+
+    // Conversão DS18B20 assíncrona: requestTemperatures() retorna imediatamente
+    if (tempSensor) {
+        tempSensor->setWaitForConversion(false);
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(
+        taskFunction,             // Função da task
+        "SensorTask",             // Nome da task
+        SENSOR_TASK_STACK_SIZE,   // Stack size
+        this,                     // Parâmetro
+        SENSOR_TASK_PRIORITY,     // Prioridade
+        &taskHandle,              // Handle da task
+        SENSOR_TASK_CORE          // Core
+    );
+
+    if (result != pdPASS) {
+        taskHandle = nullptr;
+        Serial.println("⚠️ Erro ao criar task de sensores - leitura pelo loop principal");
+        return false;
+    }
+
+    LoopProfiler::shared().registerTask(taskHandle);
+    Serial.println("✅ Task de sensores criada no Core " + String(SENSOR_TASK_CORE));
+    return true;
+}
+
+void SensorTask::end() {
+    if (taskHandle) {
+        vTaskDelete(taskHandle);
+        taskHandle = nullptr;
+    }
+}
+
+void SensorTask::taskFunction(void* parameter) {
+    SensorTask* task = static_cast<SensorTask*>(parameter);
+
+    while (true) {
+        task->step(millis());
+        vTaskDelay(pdMS_TO_TICKS(SENSOR_TASK_TICK_MS));
+    }
+}
+
+// ===== MÁQUINAS DE ESTADO =====
+void SensorTask::step(unsigned long now) {
+    // Drenar o DMA antes de consumir os filtros
+    if (isUsingAdcDma()) {
+        adcSampler->poll();
+    }
+
+    stepTemperature(now);
+    stepPH(now);
+    stepTDS(now);
+    stepLevel(now);
+}
+
+void SensorTask::stepTemperature(unsigned long now) {
+    if (!tempSensor) return;
+
+    switch (tempState) {
+        case TEMP_IDLE:
+            if (now - lastTempCycle >= SENSOR_TEMP_INTERVAL_MS) {
+                lastTempCycle = now;
+                tempSensor->requestTemperatures();
+                tempRequestTime = now;
+                tempState = TEMP_CONVERTING;
+            }
+            break;
+
+        case TEMP_CONVERTING: {
+            bool timedOut = (now - tempRequestTime) >= SENSOR_TEMP_TIMEOUT_MS;
+            if (!tempSensor->isConversionComplete() && !timedOut) {
+                break;
+            }
+
+            float reading = tempSensor->getTempCByIndex(0);
+            bool valid = !timedOut && reading != DEVICE_DISCONNECTED_C &&
+                         reading >= MIN_TEMP && reading <= MAX_TEMP;
+            if (valid) {
+                lastWaterTemp = reading;
+            }
+            store.publish(SENSOR_WATER_TEMP, reading, valid, now);
+            tempState = TEMP_IDLE;
+            break;
+        }
+    }
+}
+
+void SensorTask::stepPH(unsigned long now) {
+    if (!pHSensor) return;
+
+    // ADC contínuo: o valor já chega filtrado, basta converter
+    if (isUsingAdcDma()) {
+        if (now - lastPHCycle >= SENSOR_PH_INTERVAL_MS && adcSampler->hasValue(AdcDmaSampler::CHANNEL_PH)) {
+            lastPHCycle = now;
+            pHSensor->setTemperature(lastWaterTemp);
+            float ph = pHSensor->readPHFromRaw(adcSampler->getRaw(AdcDmaSampler::CHANNEL_PH));
+            store.publish(SENSOR_PH, ph, ph >= MIN_PH && ph <= MAX_PH, now);
+            store.publish(SENSOR_PH_VOLTAGE, pHSensor->getLastVoltage(), true, now);
+        }
+        return;
+    }
+
+    switch (phState) {
+        case PH_IDLE:
+            if (now - lastPHCycle >= SENSOR_PH_INTERVAL_MS) {
+                lastPHCycle = now;
+                lastPHSample = 0;
+                phState = PH_SAMPLING;
+            }
+            break;
+
+        case PH_SAMPLING:
+            // Uma amostra por passo, espaçadas como no driver original
+            if (lastPHSample != 0 && now - lastPHSample < PH_SAMPLE_INTERVAL) {
+                break;
+            }
+            lastPHSample = now;
+
+            if (pHSensor->collectSample(PH_PIN)) {
+                pHSensor->setTemperature(lastWaterTemp);
+                float ph = pHSensor->getBufferedPH();
+                store.publish(SENSOR_PH, ph, ph >= MIN_PH && ph <= MAX_PH, now);
+                store.publish(SENSOR_PH_VOLTAGE, pHSensor->getLastVoltage(), true, now);
+                phState = PH_IDLE;
+            }
+            break;
+    }
+}
+
+void SensorTask::stepTDS(unsigned long now) {
+    if (!tdsSensor) return;
+
+    tdsSensor->updateTemperature(lastWaterTemp);
+
+    bool updated = false;
+    if (isUsingAdcDma()) {
+        if (now - lastTDSCycle >= SENSOR_TDS_INTERVAL_MS && adcSampler->hasValue(AdcDmaSampler::CHANNEL_TDS)) {
+            lastTDSCycle = now;
+            updated = tdsSensor->readTDSFromRaw(adcSampler->getRaw(AdcDmaSampler::CHANNEL_TDS));
+        }
+    } else {
+        // O driver TDS já é temporizado (amostra a cada 40ms, mediana a cada 800ms)
+        updated = tdsSensor->readTDS();
+    }
+
+    if (updated) {
+        float tds = tdsSensor->getTDSValue();
+        bool valid = tds >= MIN_TDS && tds <= MAX_TDS;
+        store.publish(SENSOR_TDS, tds, valid, now);
+        store.publish(SENSOR_EC, tdsSensor->getECValue(), valid, now);
+    }
+}
+
+void SensorTask::stepLevel(unsigned long now) {
+    if (!levelSensor) return;
+
+    if (now - lastLevelCheck >= SENSOR_LEVEL_INTERVAL_MS) {
+        lastLevelCheck = now;
+        bool ok = levelSensor->checkWaterLevel();
+        store.publish(SENSOR_WATER_LEVEL, ok ? 1.0 : 0.0, true, now);
+    }
+}
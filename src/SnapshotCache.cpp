@@ -0,0 +1,203 @@
+#include "SnapshotCache.h"
+#include "CachedRequestHandler.h"
+#include <ArduinoJson.h>
+#include "HeapMonitor.h"
+#include <esp_system.h>
+
+SnapshotCache::SnapshotCache() :
+    topic_count(0),
+    mutex(xSemaphoreCreateMutex()) {
+    // Prefixo por boot: ETag de antes de um reset nunca casa com a geração nova
+    boot_salt = (uint16_t)esp_random();
+}
+
+SnapshotCache::~SnapshotCache() {
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+        mutex = nullptr;
+    }
+}
+
+// ===== TÓPICOS =====
+int8_t SnapshotCache::registerTopic(const char* name, SnapshotBuilder builder,
+                                    SnapshotVersion version, uint32_t max_age_ms) {
+    lock();
+    if (topic_count >= SNAPSHOT_MAX_TOPICS) {
+        unlock();
+        Serial.printf("❌ SnapshotCache: sem espaço para o tópico %s\n", name);
+        return SNAPSHOT_INVALID_TOPIC;
+    }
+
+    Topic& entry = topics[topic_count];
+    entry.name = name;
+    entry.builder = builder;
+    entry.version = version;
+    entry.max_age_ms = max_age_ms;
+    entry.generation = 1;
+    entry.built_generation = 0;
+    entry.source_version = version ? version() : 0;
+    entry.built_at = 0;
+    entry.buffer.reset();
+    entry.hits = 0;
+    entry.builds = 0;
+    entry.not_modified = 0;
+
+    int8_t id = topic_count++;
+    unlock();
+    return id;
+}
+
+void SnapshotCache::invalidate(int8_t topic) {
+    if (!valid(topic)) return;
+    lock();
+    topics[topic].generation++;
+    unlock();
+}
+
+void SnapshotCache::invalidateAll() {
+    lock();
+    for (uint8_t i = 0; i < topic_count; i++) {
+        topics[i].generation++;
+    }
+    unlock();
+}
+
+// ===== LEITURA =====
+SnapshotBuffer SnapshotCache::get(int8_t topic) {
+    if (!valid(topic)) return SnapshotBuffer();
+
+    lock();
+    refresh(topics[topic]);
+    SnapshotBuffer buffer = topics[topic].buffer;
+    unlock();
+    return buffer;
+}
+
+uint32_t SnapshotCache::getGeneration(int8_t topic) {
+    if (!valid(topic)) return 0;
+
+    lock();
+    refresh(topics[topic]);
+    uint32_t generation = topics[topic].built_generation;
+    unlock();
+    return generation;
+}
+
+void SnapshotCache::send(AsyncWebServerRequest* request, int8_t topic, const char* content_type) {
+    if (!valid(topic)) {
+        request->send(500, "application/json", "{\"error\":\"Snapshot indisponível\"}");
+        return;
+    }
+
+    lock();
+    Topic& entry = topics[topic];
+    refresh(entry);
+    SnapshotBuffer buffer = entry.buffer;
+
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%04x-%lx\"", boot_salt, (unsigned long)entry.built_generation);
+
+    bool not_modified = request->hasHeader("If-None-Match") &&
+                        request->getHeader("If-None-Match")->value() == etag;
+    if (not_modified) {
+        entry.not_modified++;
+    }
+    unlock();
+
+    if (not_modified) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        request->send(response);
+        return;
+    }
+
+    // O filler segura o buffer (refcount) até a resposta terminar de sair
+    AsyncWebServerResponse* response = request->beginResponse(content_type, buffer->length(),
+        [buffer](uint8_t* out, size_t max_len, size_t index) -> size_t {
+            size_t remaining = buffer->length() - index;
+            size_t length = remaining < max_len ? remaining : max_len;
+            memcpy(out, buffer->c_str() + index, length);
+            return length;
+        });
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+void SnapshotCache::attach(AsyncWebServer* server, const char* uri, int8_t topic) {
+    attach(server, uri, [this, topic](AsyncWebServerRequest* request) {
+        send(request, topic);
+    });
+}
+
+void SnapshotCache::attach(AsyncWebServer* server, const char* uri, ArRequestHandlerFunction handler) {
+    CachedRequestHandler* route = new CachedRequestHandler(uri, handler);
+    route->keepHeader("If-None-Match");
+    server->addHandler(route);
+}
+
+// ===== STATUS =====
+String SnapshotCache::getStatusJSON() {
+    DynamicJsonDocument doc(1536);
+    JsonArray list = doc.createNestedArray("topics");
+
+    lock();
+    for (uint8_t i = 0; i < topic_count; i++) {
+        const Topic& entry = topics[i];
+        JsonObject item = list.createNestedObject();
+        item["name"] = entry.name;
+        item["generation"] = entry.built_generation;
+        item["builds"] = entry.builds;
+        item["hits"] = entry.hits;
+        item["not_modified"] = entry.not_modified;
+        item["bytes"] = entry.buffer ? entry.buffer->length() : 0;
+    }
+    unlock();
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void SnapshotCache::refresh(Topic& entry) {
+    unsigned long now = millis();
+
+    // Estado de origem mudou: nova geração
+    if (entry.version) {
+        uint32_t version = entry.version();
+        if (version != entry.source_version) {
+            entry.source_version = version;
+            entry.generation++;
+        }
+    }
+
+    // Campos que mudam sozinhos (uptime, heap): geração expira por idade
+    if (entry.max_age_ms && entry.buffer && now - entry.built_at >= entry.max_age_ms) {
+        entry.generation++;
+    }
+
+    if (entry.buffer && entry.built_generation == entry.generation) {
+        entry.hits++;
+        return;
+    }
+
+    // O buffer novo fica retido no cache: aparece como retenção da tag
+    HEAP_TAG("web.snapshot");
+    std::shared_ptr<String> fresh = std::make_shared<String>();
+    entry.builder(*fresh);
+
+    // Respostas em andamento continuam com o buffer anterior
+    entry.buffer = fresh;
+    entry.built_generation = entry.generation;
+    entry.built_at = now;
+    entry.builds++;
+}
+
+void SnapshotCache::lock() {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void SnapshotCache::unlock() {
+    if (mutex) xSemaphoreGive(mutex);
+}
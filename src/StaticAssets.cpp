@@ -0,0 +1,159 @@
+#include "StaticAssets.h"
+#include <ArduinoJson.h>
+
+StaticAssets::StaticAssets() :
+    entry_count(0),
+    served_gzip(0),
+    served_raw(0),
+    not_modified(0) {
+}
+
+bool StaticAssets::begin() {
+    entry_count = 0;
+
+    File manifest = SPIFFS.open(ASSET_MANIFEST_PATH, "r");
+    if (!manifest) {
+        Serial.println("⚠️ Assets: manifesto não encontrado - servindo arquivos sem gzip/ETag");
+        return false;
+    }
+
+    // Formato: "<path> <hash>\n" por arquivo
+    while (manifest.available() && entry_count < ASSET_MAX_ENTRIES) {
+        String line = manifest.readStringUntil('\n');
+        line.trim();
+        int space = line.indexOf(' ');
+        if (space <= 0) continue;
+
+        String path = line.substring(0, space);
+        String hash = line.substring(space + 1);
+        if (path.length() >= ASSET_PATH_SIZE || hash.length() >= ASSET_HASH_SIZE) continue;
+
+        Entry& entry = entries[entry_count++];
+        strncpy(entry.path, path.c_str(), sizeof(entry.path));
+        strncpy(entry.hash, hash.c_str(), sizeof(entry.hash));
+        entry.gzip = SPIFFS.exists(path + ".gz");
+    }
+    manifest.close();
+
+    Serial.printf("✅ Assets: %d arquivos no manifesto\n", entry_count);
+    return true;
+}
+
+bool StaticAssets::serve(AsyncWebServerRequest* request, const char* path, const char* content_type) {
+    if (!content_type) content_type = contentTypeFor(path);
+
+    const Entry* entry = find(path);
+    if (!entry) {
+        // Sem manifesto: comportamento antigo
+        if (!SPIFFS.exists(path)) return false;
+        served_raw++;
+        request->send(SPIFFS, path, content_type);
+        return true;
+    }
+
+    bool use_gzip = entry->gzip && acceptsGzip(request);
+
+    // Representações diferentes = ETags diferentes (ETag forte)
+    char etag[ASSET_HASH_SIZE + 8];
+    snprintf(etag, sizeof(etag), use_gzip ? "\"%s-gz\"" : "\"%s\"", entry->hash);
+
+    const char* cache_control = isHTML(path) ? "no-cache" : ASSET_CACHE_CONTROL;
+
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == etag) {
+        not_modified++;
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", cache_control);
+        response->addHeader("Vary", "Accept-Encoding");
+        request->send(response);
+        return true;
+    }
+
+    AsyncWebServerResponse* response;
+    if (use_gzip) {
+        served_gzip++;
+        response = request->beginResponse(SPIFFS, String(path) + ".gz", content_type);
+        response->addHeader("Content-Encoding", "gzip");
+    } else {
+        served_raw++;
+        response = request->beginResponse(SPIFFS, path, content_type);
+    }
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cache_control);
+    response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
+    return true;
+}
+
+void StaticAssets::attach(AsyncWebServer* server, const char* uri, const char* path) {
+    attach(server, uri, [this, path](AsyncWebServerRequest* request) {
+        if (!serve(request, path)) {
+            request->send(404, "text/plain", "Arquivo não encontrado");
+        }
+    });
+}
+
+void StaticAssets::attach(AsyncWebServer* server, const char* uri, ArRequestHandlerFunction handler) {
+    CachedRequestHandler* route = new CachedRequestHandler(uri, handler);
+    route->keepHeader("If-None-Match").keepHeader("Accept-Encoding");
+    server->addHandler(route);
+}
+
+void StaticAssets::attachFallback(AsyncWebServer* server) {
+    // O manifesto é detalhe do build: não vira URL pública
+    server->serveStatic("/", SPIFFS, "/").setFilter([](AsyncWebServerRequest* request) {
+        return request->url() != ASSET_MANIFEST_PATH;
+    });
+}
+
+// ===== STATUS =====
+String StaticAssets::getStatusJSON() const {
+    DynamicJsonDocument doc(1024);
+    doc["entries"] = entry_count;
+    doc["served_gzip"] = served_gzip;
+    doc["served_raw"] = served_raw;
+    doc["not_modified"] = not_modified;
+
+    JsonArray list = doc.createNestedArray("assets");
+    for (uint8_t i = 0; i < entry_count; i++) {
+        JsonObject item = list.createNestedObject();
+        item["path"] = entries[i].path;
+        item["hash"] = entries[i].hash;
+        item["gzip"] = entries[i].gzip;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+const StaticAssets::Entry* StaticAssets::find(const char* path) const {
+    for (uint8_t i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].path, path) == 0) return &entries[i];
+    }
+    return nullptr;
+}
+
+const char* StaticAssets::contentTypeFor(const char* path) {
+    const char* ext = strrchr(path, '.');
+    if (!ext) return "application/octet-stream";
+    if (strcmp(ext, ".html") == 0) return "text/html";
+    if (strcmp(ext, ".css") == 0) return "text/css";
+    if (strcmp(ext, ".js") == 0) return "application/javascript";
+    if (strcmp(ext, ".json") == 0) return "application/json";
+    if (strcmp(ext, ".svg") == 0) return "image/svg+xml";
+    if (strcmp(ext, ".ico") == 0) return "image/x-icon";
+    return "text/plain";
+}
+
+bool StaticAssets::isHTML(const char* path) {
+    const char* ext = strrchr(path, '.');
+    return ext && strcmp(ext, ".html") == 0;
+}
+
+bool StaticAssets::acceptsGzip(AsyncWebServerRequest* request) {
+    if (!request->hasHeader("Accept-Encoding")) return false;
+    return request->getHeader("Accept-Encoding")->value().indexOf("gzip") >= 0;
+}
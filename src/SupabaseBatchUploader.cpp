@@ -0,0 +1,145 @@
+#include "SupabaseBatchUploader.h"
+#include <ArduinoJson.h>
+
+// ===== CONSTRUTOR =====
+SupabaseBatchUploader::SupabaseBatchUploader(TelemetryQueue& queue) :
+    queue(queue),
+    batch_size(SUPABASE_BATCH_SIZE),
+    flush_interval(SUPABASE_BATCH_INTERVAL_MS),
+    requests(0),
+    rows_sent(0),
+    rows_queued(0) {
+    for (uint8_t t = 0; t < TELEMETRY_TABLE_COUNT; t++) {
+        batches[t].count = 0;
+        batches[t].first_ms = 0;
+    }
+}
+
+// ===== CONTROLE =====
+void SupabaseBatchUploader::add(TelemetryTable table, const char* payload, bool online) {
+    if (table >= TELEMETRY_TABLE_COUNT) return;
+
+    size_t length = strnlen(payload, TELEMETRY_PAYLOAD_SIZE);
+    if (length == 0 || length >= TELEMETRY_PAYLOAD_SIZE) {
+        Serial.printf("⚠️ Payload de %s descartado (%u bytes)\n", TelemetryQueue::tableName(table), (unsigned)length);
+        return;
+    }
+
+    Batch& batch = batches[table];
+    if (batch.count >= batch_size) {
+        flushTable(table, online);
+    }
+
+    PendingRow& row = batch.rows[batch.count];
+    memcpy(row.payload, payload, length + 1);
+    row.epoch = TelemetryQueue::epochNow();
+    row.captured_ms = millis();
+
+    if (batch.count == 0) {
+        batch.first_ms = row.captured_ms;
+    }
+    batch.count++;
+}
+
+void SupabaseBatchUploader::loop(bool online) {
+    unsigned long now = millis();
+
+    for (uint8_t t = 0; t < TELEMETRY_TABLE_COUNT; t++) {
+        Batch& batch = batches[t];
+        if (batch.count == 0) continue;
+
+        if (batch.count >= batch_size || now - batch.first_ms >= flush_interval) {
+            flushTable((TelemetryTable)t, online);
+        }
+    }
+}
+
+void SupabaseBatchUploader::flush(bool online) {
+    for (uint8_t t = 0; t < TELEMETRY_TABLE_COUNT; t++) {
+        flushTable((TelemetryTable)t, online);
+    }
+}
+
+// ===== CONFIGURAÇÃO =====
+void SupabaseBatchUploader::setBatchSize(uint8_t rows) {
+    if (rows < 1) rows = 1;
+    if (rows > SUPABASE_BATCH_MAX_ROWS) rows = SUPABASE_BATCH_MAX_ROWS;
+    batch_size = rows;
+}
+
+// ===== STATUS =====
+uint16_t SupabaseBatchUploader::pending() const {
+    uint16_t total = 0;
+    for (uint8_t t = 0; t < TELEMETRY_TABLE_COUNT; t++) {
+        total += batches[t].count;
+    }
+    return total;
+}
+
+String SupabaseBatchUploader::getStatusJSON() const {
+    DynamicJsonDocument doc(256);
+    doc["batch_size"] = batch_size;
+    doc["flush_interval_ms"] = flush_interval;
+    doc["pending"] = pending();
+    doc["requests"] = requests;
+    doc["rows_sent"] = rows_sent;
+    doc["rows_queued"] = rows_queued;
+    doc["rows_per_request"] = requests ? (float)rows_sent / requests : 0.0;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void SupabaseBatchUploader::flushTable(TelemetryTable table, bool online) {
+    Batch& batch = batches[table];
+    if (batch.count == 0) return;
+
+    // Fila com atraso: o lote vai para trás dela, senão chegaria ao banco
+    // antes das leituras mais antigas (a fila só esvazia com a nuvem OK)
+    bool backlog = !queue.isEmpty();
+
+    uint8_t sent = 0;
+    if (online && sender && !backlog) {
+        // Mesmo boot para todas as linhas: ou todas têm created_at ou nenhuma
+        size_t length = 0;
+        uint8_t rows = 0;
+        body[length++] = '[';
+        while (rows < batch.count) {
+            const PendingRow& row = batch.rows[rows];
+            if (rows > 0) body[length++] = ',';
+            size_t written = TelemetryQueue::formatRow(body + length, sizeof(body) - length - 2, row.payload,
+                                                       TelemetryQueue::captureEpoch(row.epoch, row.captured_ms));
+            if (written == 0) {
+                if (rows > 0) length--;
+                break;
+            }
+            length += written;
+            rows++;
+        }
+        body[length++] = ']';
+        body[length] = '\0';
+
+        requests++;
+        if (rows > 0 && sender(TelemetryQueue::tableName(table), body, length)) {
+            sent = rows;
+            rows_sent += rows;
+            Serial.printf("📤 %u linhas enviadas em lote para %s\n", rows, TelemetryQueue::tableName(table));
+        }
+    }
+
+    // Sem nuvem, falha ou linhas que não couberam: vão para a fila persistente
+    if (sent < batch.count) {
+        for (uint8_t i = sent; i < batch.count; i++) {
+            const PendingRow& row = batch.rows[i];
+            if (queue.enqueue(table, row.payload, row.epoch, row.captured_ms)) {
+                rows_queued++;
+            }
+        }
+        Serial.printf("📦 %u linhas de %s guardadas na fila offline (%lu pendentes)\n",
+                     batch.count - sent, TelemetryQueue::tableName(table), (unsigned long)queue.size());
+    }
+
+    batch.count = 0;
+}
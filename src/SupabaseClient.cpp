@@ -1,18 +1,27 @@
 #include "SupabaseClient.h"
+#include "CloudConnectionPool.h"
 #include "DeviceID.h"
+#include "Logger.h"
+#include "HeapMonitor.h"
 
 SupabaseClient::SupabaseClient() : 
     isConnected(false),
     lastCommandCheck(0) {
+    payloadBuffer[0] = '\0';
+    urlBuffer[0] = '\0';
+    buildHeaderBlocks();
 }
 
 SupabaseClient::~SupabaseClient() {
-    http.end();
 }
 
 bool SupabaseClient::begin(const String& url, const String& key) {
     baseUrl = url;
     apiKey = key;
+    restUrl = baseUrl + "/rest/v1/";
+    authHeader = buildAuthHeader();
+    deviceId = getDeviceID();
+    buildHeaderBlocks();
     
     if (WiFi.status() != WL_CONNECTED) {
         setError("WiFi não conectado");
@@ -20,15 +29,7 @@ bool SupabaseClient::begin(const String& url, const String& key) {
     }
     
     // ===== CONFIGURAÇÃO SSL PARA SUPABASE =====
-    // Configurar HTTPClient para HTTPS com certificados auto-assinados
-    WiFiClientSecure* secureClient = new WiFiClientSecure();
-    secureClient->setInsecure(); // Aceitar certificados auto-assinados para desenvolvimento
-    
-    http.begin(*secureClient, baseUrl + "/rest/v1/");
-    http.setUserAgent("ESP32-Hydro/2.1.0");
-    http.setConnectTimeout(15000); // 15 segundos timeout de conexão
-    http.setTimeout(20000); // 20 segundos timeout total
-    
+    // Sessões TLS keep-alive ficam no CloudConnectionPool (compartilhado)
     Serial.println("🔐 Configurando conexão SSL para Supabase...");
     Serial.println("🔓 Certificados auto-assinados: ACEITOS (desenvolvimento)");
     
@@ -50,121 +51,134 @@ String SupabaseClient::buildAuthHeader() {
     return "Bearer " + apiKey;
 }
 
-bool SupabaseClient::makeRequest(const String& method, const String& endpoint, const String& payload) {
+void SupabaseClient::buildHeaderBlocks() {
+    // Apontam para authHeader/apiKey, que só mudam no begin()
+    const CloudHeader authorization = {"Authorization", authHeader.c_str()};
+    const CloudHeader key = {"apikey", apiKey.c_str()};
+    const CloudHeader json = {"Content-Type", SUPABASE_CONTENT_TYPE};
+    
+    insertHeaders[0] = authorization;
+    insertHeaders[1] = key;
+    insertHeaders[2] = json;
+    insertHeaders[3] = {"Prefer", SUPABASE_PREFER};
+    
+    upsertHeaders[0] = authorization;
+    upsertHeaders[1] = key;
+    upsertHeaders[2] = json;
+    upsertHeaders[3] = {"Prefer", "resolution=merge-duplicates"};
+    
+    readHeaders[0] = authorization;
+    readHeaders[1] = key;
+    readHeaders[2] = {"Accept", "application/json"};
+    
+    patchHeaders[0] = authorization;
+    patchHeaders[1] = key;
+    patchHeaders[2] = json;
+}
+
+int SupabaseClient::sendRequest(const char* method, const char* endpoint, const char* body, size_t length,
+                                const CloudHeader* headers, uint8_t count, String* response) {
+    int written = snprintf(urlBuffer, sizeof(urlBuffer), "%s%s", restUrl.c_str(), endpoint);
+    if (written < 0 || (size_t)written >= sizeof(urlBuffer)) {
+        setError("URL muito longa");
+        return HTTPC_ERROR_TOO_LESS_RAM;
+    }
+    
+    return CloudConnectionPool::shared().request(method, urlBuffer, body, length, headers, count, response);
+}
+
+bool SupabaseClient::makeRequest(const char* method, const char* endpoint, const char* payload, size_t length) {
     if (!isReady()) {
         setError("Cliente não está pronto");
         return false;
     }
     
-    String url = baseUrl + "/rest/v1/" + endpoint;
-    
-    http.begin(url);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("Prefer", SUPABASE_PREFER);
-    http.addHeader("apikey", apiKey);
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
-    
-    int httpCode;
-    if (method == "POST") {
-        httpCode = http.POST(payload);
-    } else if (method == "GET") {
-        httpCode = http.GET();
-    } else if (method == "PATCH") {
-        httpCode = http.PATCH(payload);
-    } else {
-        setError("Método HTTP não suportado: " + method);
-        http.end();
-        return false;
-    }
+    String response;
+    int httpCode = sendRequest(method, endpoint, payload, length, insertHeaders, 4, &response);
     
     if (httpCode >= 200 && httpCode < 300) {
-        Serial.printf("✅ %s %s: %d\n", method.c_str(), endpoint.c_str(), httpCode);
-        http.end();
+        LOGD(SUPABASE, "✅ %s %s: %d", method, endpoint, httpCode);
         return true;
     } else {
-        String response = http.getString();
         setError("HTTP " + String(httpCode) + ": " + response);
-        Serial.printf("❌ %s %s: %d - %s\n", method.c_str(), endpoint.c_str(), httpCode, response.c_str());
-        http.end();
+        LOGE(SUPABASE, "❌ %s %s: %d - %.96s", method, endpoint, httpCode, response.c_str());
         return false;
     }
 }
 
 bool SupabaseClient::sendEnvironmentData(const EnvironmentReading& reading) {
-    String payload = buildEnvironmentPayload(reading);
-    return makeRequest("POST", SUPABASE_ENVIRONMENT_TABLE, payload);
+    size_t length = buildEnvironmentPayload(reading, payloadBuffer, sizeof(payloadBuffer));
+    return length > 0 && makeRequest("POST", SUPABASE_ENVIRONMENT_TABLE, payloadBuffer, length);
 }
 
 bool SupabaseClient::sendHydroData(const HydroReading& reading) {
-    String payload = buildHydroPayload(reading);
-    return makeRequest("POST", SUPABASE_HYDRO_TABLE, payload);
+    size_t length = buildHydroPayload(reading, payloadBuffer, sizeof(payloadBuffer));
+    return length > 0 && makeRequest("POST", SUPABASE_HYDRO_TABLE, payloadBuffer, length);
 }
 
 bool SupabaseClient::updateDeviceStatus(const DeviceStatusData& status) {
-    String payload = buildDeviceStatusPayload(status);
+    size_t length = buildDeviceStatusPayload(status, payloadBuffer, sizeof(payloadBuffer));
+    if (length == 0) {
+        setError("Payload de status não coube no buffer");
+        return false;
+    }
     
     // Usar UPSERT para atualizar ou inserir
-    String endpoint = String(SUPABASE_STATUS_TABLE) + "?device_id=eq." + status.deviceId;
+    char endpoint[96];
+    snprintf(endpoint, sizeof(endpoint), "%s?device_id=eq.%s", SUPABASE_STATUS_TABLE, status.deviceId.c_str());
     
     // Primeiro tentar UPDATE
-    http.begin(baseUrl + "/rest/v1/" + endpoint);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("Prefer", "resolution=merge-duplicates");
-    http.addHeader("apikey", apiKey);
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
-    
-    int httpCode = http.PATCH(payload);
+    int httpCode = sendRequest("PATCH", endpoint, payloadBuffer, length, upsertHeaders, 4);
     
     if (httpCode >= 200 && httpCode < 300) {
         Serial.printf("✅ Device status atualizado: %d\n", httpCode);
-        http.end();
         return true;
     } else {
         // Se falhou, tentar INSERT
-        http.end();
-        return makeRequest("POST", SUPABASE_STATUS_TABLE, payload);
+        return makeRequest("POST", SUPABASE_STATUS_TABLE, payloadBuffer, length);
     }
 }
 
-String SupabaseClient::buildEnvironmentPayload(const EnvironmentReading& reading) {
-    DynamicJsonDocument doc(256);
+// ===== PAYLOADS (buffer fixo, sem alocação) =====
+size_t SupabaseClient::buildEnvironmentPayload(const EnvironmentReading& reading, char* out, size_t size,
+                                               bool withDeviceId) {
+    StaticJsonDocument<128> doc;
     
-    doc["device_id"] = getDeviceID();
+    if (withDeviceId) {
+        doc["device_id"] = currentDeviceId();
+    }
     doc["temperature"] = reading.temperature;
     doc["humidity"] = reading.humidity;
     
-    String payload;
-    serializeJson(doc, payload);
-    return payload;
+    return serializePayload(doc, out, size);
 }
 
-String SupabaseClient::buildHydroPayload(const HydroReading& reading) {
-    DynamicJsonDocument doc(256);
+size_t SupabaseClient::buildHydroPayload(const HydroReading& reading, char* out, size_t size, bool withDeviceId) {
+    StaticJsonDocument<192> doc;
     
-    doc["device_id"] = getDeviceID();
+    if (withDeviceId) {
+        doc["device_id"] = currentDeviceId();
+    }
     doc["temperature"] = reading.temperature;
     doc["ph"] = reading.ph;
     doc["tds"] = reading.tds;
     doc["water_level_ok"] = reading.waterLevelOk;
     
-    String payload;
-    serializeJson(doc, payload);
-    return payload;
+    return serializePayload(doc, out, size);
 }
 
-String SupabaseClient::buildDeviceStatusPayload(const DeviceStatusData& status) {
-    DynamicJsonDocument doc(1024);
+size_t SupabaseClient::buildDeviceStatusPayload(const DeviceStatusData& status, char* out, size_t size) {
+    StaticJsonDocument<768> doc;
     
-    doc["device_id"] = status.deviceId;
+    // c_str(): o documento guarda o ponteiro em vez de copiar a String
+    doc["device_id"] = status.deviceId.c_str();
     doc["last_seen"] = "now()";
     doc["wifi_rssi"] = status.wifiRssi;
     doc["free_heap"] = status.freeHeap;
     doc["uptime_seconds"] = status.uptimeSeconds;
     doc["is_online"] = status.isOnline;
-    doc["firmware_version"] = status.firmwareVersion;
-    doc["ip_address"] = status.ipAddress;
+    doc["firmware_version"] = status.firmwareVersion.c_str();
+    doc["ip_address"] = status.ipAddress.c_str();
     doc["updated_at"] = "now()";
     
     // Array de estados dos relés
@@ -173,9 +187,29 @@ String SupabaseClient::buildDeviceStatusPayload(const DeviceStatusData& status)
         relayArray.add(status.relayStates[i]);
     }
     
-    String payload;
-    serializeJson(doc, payload);
-    return payload;
+    return serializePayload(doc, out, size);
+}
+
+size_t SupabaseClient::serializePayload(const JsonDocument& doc, char* out, size_t size) {
+    if (doc.overflowed()) {
+        Serial.println("⚠️ SupabaseClient: documento JSON estourou a capacidade");
+        return 0;
+    }
+    
+    size_t length = measureJson(doc);
+    if (length >= size) {
+        Serial.printf("⚠️ SupabaseClient: payload de %u bytes não cabe no buffer (%u)\n",
+                     (unsigned)length, (unsigned)size);
+        return 0;
+    }
+    return serializeJson(doc, out, size);
+}
+
+const char* SupabaseClient::currentDeviceId() {
+    if (deviceId.isEmpty()) {
+        deviceId = getDeviceID();
+    }
+    return deviceId.c_str();
 }
 
 bool SupabaseClient::checkForCommands(RelayCommand* commands, int maxCommands, int& commandCount) {
@@ -189,37 +223,24 @@ bool SupabaseClient::checkForCommands(RelayCommand* commands, int maxCommands, i
         return false;
     }
     lastCommandCheck = now;
+    HEAP_TAG("cloud.commands");
     
     // BUSCAR COMANDOS PENDENTES usando a mesma query do SQL
-    String endpoint = String(SUPABASE_RELAY_TABLE) + "?device_id=eq." + getDeviceID() + "&status=eq.pending&order=created_at.asc&limit=" + maxCommands;
-    String fullUrl = baseUrl + "/rest/v1/" + endpoint;
-    
-    Serial.printf("🔍 Verificando comandos: %s\n", fullUrl.c_str());
-    
-    // Configurar cliente HTTP com settings robustos
-    HTTPClient httpClient;
-    WiFiClientSecure* secureClient = new WiFiClientSecure();
-    secureClient->setInsecure(); // Para desenvolvimento - aceitar certificados auto-assinados
+    char endpoint[160];
+    snprintf(endpoint, sizeof(endpoint), "%s?device_id=eq.%s&status=eq.pending&order=created_at.asc&limit=%d",
+             SUPABASE_RELAY_TABLE, currentDeviceId(), maxCommands);
     
-    httpClient.begin(*secureClient, fullUrl);
-    httpClient.setConnectTimeout(10000); // 10s timeout conexão
-    httpClient.setTimeout(15000); // 15s timeout total
-    httpClient.setUserAgent("ESP32-Hydro/2.1.0");
-    
-    httpClient.addHeader("Authorization", buildAuthHeader());
-    httpClient.addHeader("apikey", apiKey);
-    httpClient.addHeader("Accept", "application/json");
+    Serial.printf("🔍 Verificando comandos: %s%s\n", restUrl.c_str(), endpoint);
     
+    // Sessão keep-alive do pool: sem handshake TLS a cada consulta
     Serial.println("📡 Enviando requisição GET para comandos...");
-    int httpCode = httpClient.GET();
+    String response;
+    int httpCode = sendRequest("GET", endpoint, nullptr, 0, readHeaders, 3, &response);
     
     if (httpCode == 200) {
-        String response = httpClient.getString();
-        httpClient.end();
-        
         Serial.printf("✅ Resposta recebida: %d bytes\n", response.length());
         
-        DynamicJsonDocument doc(2048);
+        TaggedJsonDocument doc("cloud.commands", 2048);
         DeserializationError error = deserializeJson(doc, response);
         
         if (error) {
@@ -247,10 +268,8 @@ bool SupabaseClient::checkForCommands(RelayCommand* commands, int maxCommands, i
         return true;
     } else if (httpCode > 0) {
         // Código HTTP válido mas com erro
-        String response = httpClient.getString();
         setError("Erro HTTP ao buscar comandos: " + String(httpCode) + " - " + response);
         Serial.printf("❌ HTTP Error %d: %s\n", httpCode, response.c_str());
-        httpClient.end();
         return false;
     } else {
         // Erro de conexão (códigos negativos)
@@ -297,62 +316,69 @@ bool SupabaseClient::checkForCommands(RelayCommand* commands, int maxCommands, i
             isConnected = false;
         }
         
-        httpClient.end();
         return false;
     }
 }
 
 bool SupabaseClient::markCommandSent(int commandId) {
-    String endpoint = String(SUPABASE_RELAY_TABLE) + "?id=eq." + commandId;
-    String payload = "{\"status\": \"sent\", \"sent_at\": \"now()\"}";
-    
-    http.begin(baseUrl + "/rest/v1/" + endpoint);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("apikey", apiKey);
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
-    
-    int httpCode = http.PATCH(payload);
-    http.end();
-    
-    return (httpCode >= 200 && httpCode < 300);
+    static const char payload[] = "{\"status\": \"sent\", \"sent_at\": \"now()\"}";
+    return patchCommand(commandId, payload, sizeof(payload) - 1);
 }
 
 bool SupabaseClient::markCommandCompleted(int commandId) {
-    String endpoint = String(SUPABASE_RELAY_TABLE) + "?id=eq." + commandId;
-    String payload = "{\"status\": \"completed\", \"completed_at\": \"now()\"}";
-    
-    http.begin(baseUrl + "/rest/v1/" + endpoint);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("apikey", apiKey);
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
-    
-    int httpCode = http.PATCH(payload);
-    http.end();
-    
-    return (httpCode >= 200 && httpCode < 300);
+    static const char payload[] = "{\"status\": \"completed\", \"completed_at\": \"now()\"}";
+    return patchCommand(commandId, payload, sizeof(payload) - 1);
 }
 
 bool SupabaseClient::markCommandFailed(int commandId, const String& errorMessage) {
-    String endpoint = String(SUPABASE_RELAY_TABLE) + "?id=eq." + commandId;
-    
-    DynamicJsonDocument doc(256);
+    StaticJsonDocument<256> doc;
     doc["status"] = "failed";
-    doc["error_message"] = errorMessage;
+    doc["error_message"] = errorMessage.c_str();
     doc["completed_at"] = "now()";
     
-    String payload;
-    serializeJson(doc, payload);
+    size_t length = serializePayload(doc, payloadBuffer, sizeof(payloadBuffer));
+    return length > 0 && patchCommand(commandId, payloadBuffer, length);
+}
+
+bool SupabaseClient::markCommands(const int* commandIds, uint8_t count, const char* status, const char* errorMessage) {
+    if (count == 0) return true;
+    
+    // Filtro id=in.(1,2,3) montado direto no buffer do endpoint
+    char endpoint[192];
+    int written = snprintf(endpoint, sizeof(endpoint), "%s?id=in.(", SUPABASE_RELAY_TABLE);
+    for (uint8_t i = 0; i < count && written > 0 && (size_t)written < sizeof(endpoint); i++) {
+        written += snprintf(endpoint + written, sizeof(endpoint) - written, i ? ",%d" : "%d", commandIds[i]);
+    }
+    if (written < 0 || (size_t)written + 2 > sizeof(endpoint)) {
+        setError("Lista de comandos muito longa");
+        return false;
+    }
+    endpoint[written++] = ')';
+    endpoint[written] = '\0';
+    
+    StaticJsonDocument<256> doc;
+    doc["status"] = status;
+    if (errorMessage) {
+        doc["error_message"] = errorMessage;
+    }
+    if (strcmp(status, "sent") == 0) {
+        doc["sent_at"] = "now()";
+    } else {
+        doc["completed_at"] = "now()";
+    }
+    
+    size_t length = serializePayload(doc, payloadBuffer, sizeof(payloadBuffer));
+    if (length == 0) return false;
     
-    http.begin(baseUrl + "/rest/v1/" + endpoint);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("apikey", apiKey);
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
+    int httpCode = sendRequest("PATCH", endpoint, payloadBuffer, length, patchHeaders, 3);
+    return (httpCode >= 200 && httpCode < 300);
+}
+
+bool SupabaseClient::patchCommand(int commandId, const char* payload, size_t length) {
+    char endpoint[64];
+    snprintf(endpoint, sizeof(endpoint), "%s?id=eq.%d", SUPABASE_RELAY_TABLE, commandId);
     
-    int httpCode = http.PATCH(payload);
-    http.end();
+    int httpCode = sendRequest("PATCH", endpoint, payload, length, patchHeaders, 3);
     
     return (httpCode >= 200 && httpCode < 300);
 }
@@ -368,33 +394,19 @@ bool SupabaseClient::testConnection() {
     
     Serial.printf("📡 WiFi OK - IP: %s\n", WiFi.localIP().toString().c_str());
     
-    // Configurar cliente HTTP para teste
-    HTTPClient testHttp;
-    WiFiClientSecure* secureClient = new WiFiClientSecure();
-    secureClient->setInsecure(); // Para desenvolvimento - aceitar certificados auto-assinados
-    
-    String testUrl = baseUrl + "/rest/v1/";
-    Serial.printf("🌐 Testando URL: %s\n", testUrl.c_str());
-    
-    testHttp.begin(*secureClient, testUrl);
-    testHttp.setConnectTimeout(15000); // 15s timeout conexão
-    testHttp.setTimeout(20000); // 20s timeout total
-    testHttp.setUserAgent("ESP32-Hydro/2.1.0");
+    Serial.printf("🌐 Testando URL: %s\n", restUrl.c_str());
     
-    testHttp.addHeader("apikey", apiKey);
-    testHttp.addHeader("Accept", "application/json");
-    
-    int httpCode = testHttp.GET();
+    // A sessão aberta aqui fica no pool para as próximas requisições
+    String response;
+    int httpCode = CloudConnectionPool::shared().request("GET", restUrl.c_str(), nullptr, 0,
+                                                         readHeaders, 3, &response, 20000);
     
     if (httpCode >= 200 && httpCode < 300) {
         Serial.printf("✅ Teste de conexão OK: HTTP %d\n", httpCode);
-        testHttp.end();
         return true;
     } else if (httpCode > 0) {
-        String response = testHttp.getString();
         Serial.printf("❌ Teste falhou: HTTP %d - %s\n", httpCode, response.c_str());
         setError("Teste de conexão falhou: HTTP " + String(httpCode));
-        testHttp.end();
         return false;
     } else {
         // Erro de conexão
@@ -415,7 +427,6 @@ bool SupabaseClient::testConnection() {
         }
         
         setError(errorMsg);
-        testHttp.end();
         return false;
     }
 }
@@ -435,7 +446,7 @@ bool SupabaseClient::autoRegisterDevice(const String& deviceName, const String&
     Serial.println("🆔 Iniciando auto-registro do dispositivo...");
     
     // Preparar dados do dispositivo
-    DynamicJsonDocument doc(512);
+    TaggedJsonDocument doc("cloud.supabase", 512);
     doc["device_id"] = getDeviceID();
     doc["mac_address"] = getFullMAC();
     doc["ip_address"] = WiFi.localIP().toString();
@@ -445,25 +456,18 @@ bool SupabaseClient::autoRegisterDevice(const String& deviceName, const String&
     doc["firmware_version"] = FIRMWARE_VERSION;
     doc["is_online"] = true;
     
-    String payload;
-    serializeJson(doc, payload);
+    size_t length = serializePayload(doc, payloadBuffer, sizeof(payloadBuffer));
+    if (length == 0) {
+        setError("Payload de auto-registro não coube no buffer");
+        return false;
+    }
     
-    Serial.printf("📤 Payload auto-registro: %s\n", payload.c_str());
+    Serial.printf("📤 Payload auto-registro: %s\n", payloadBuffer);
     
     // Usar UPSERT (INSERT com ON CONFLICT)
-    String endpoint = String(SUPABASE_STATUS_TABLE);
-    String fullUrl = baseUrl + "/rest/v1/" + endpoint;
-    
-    http.begin(fullUrl);
-    http.addHeader("Authorization", buildAuthHeader());
-    http.addHeader("Content-Type", SUPABASE_CONTENT_TYPE);
-    http.addHeader("apikey", apiKey);
-    http.addHeader("Prefer", "resolution=merge-duplicates"); // UPSERT mode
-    http.setTimeout(SUPABASE_TIMEOUT_MS);
-    
-    int httpCode = http.POST(payload);
-    String response = http.getString();
-    http.end();
+    String response;
+    int httpCode = sendRequest("POST", SUPABASE_STATUS_TABLE, payloadBuffer, length,
+                               upsertHeaders, 4, &response); // UPSERT mode
     
     if (httpCode >= 200 && httpCode < 300) {
         Serial.printf("✅ Dispositivo auto-registrado: %s\n", getDeviceID().c_str());
@@ -479,11 +483,14 @@ bool SupabaseClient::autoRegisterDevice(const String& deviceName, const String&
 
 // ===== MÉTODO GENÉRICO PARA INSERIR DADOS =====
 bool SupabaseClient::insert(const String& table, const String& jsonData) {
+    return insert(table.c_str(), jsonData.c_str(), jsonData.length());
+}
+
+bool SupabaseClient::insert(const char* table, const char* rows, size_t length) {
     if (!isReady()) {
         setError("Supabase não está pronto");
         return false;
     }
     
-    String endpoint = table;
-    return makeRequest("POST", endpoint, jsonData);
+    return makeRequest("POST", table, rows, length);
 } 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "SupabaseRealtimeClient.h"
 #include "DeviceID.h"
+#include "HeapMonitor.h"
 
 SupabaseRealtimeClient::SupabaseRealtimeClient() :
     currentState(SUPABASE_WS_DISCONNECTED),
@@ -98,6 +99,7 @@ void SupabaseRealtimeClient::end() {
 }
 
 void SupabaseRealtimeClient::handleWebSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
+    HEAP_TAG("cloud.realtime");
     switch (type) {
         case WStype_DISCONNECTED:
             Serial.println("❌ WebSocket desconectado");
@@ -133,7 +135,7 @@ void SupabaseRealtimeClient::joinChannel() {
     // Canal específico para comandos do dispositivo
     channelTopic = "realtime:public:relay_commands:device_id=eq." + deviceId;
     
-    DynamicJsonDocument doc(512);
+    TaggedJsonDocument doc("cloud.realtime", 512);
     doc["topic"] = channelTopic;
     doc["event"] = "phx_join";
     doc["payload"] = JsonObject();
@@ -147,7 +149,7 @@ void SupabaseRealtimeClient::joinChannel() {
 }
 
 void SupabaseRealtimeClient::sendHeartbeat() {
-    DynamicJsonDocument doc(256);
+    TaggedJsonDocument doc("cloud.realtime", 256);
     doc["topic"] = "phoenix";
     doc["event"] = "heartbeat";
     doc["payload"] = JsonObject();
@@ -160,7 +162,7 @@ void SupabaseRealtimeClient::sendHeartbeat() {
 }
 
 void SupabaseRealtimeClient::handleIncomingMessage(const String& message) {
-    DynamicJsonDocument doc(1024);
+    TaggedJsonDocument doc("cloud.realtime", 1024);
     DeserializationError error = deserializeJson(doc, message);
     
     if (error) {
@@ -182,13 +184,23 @@ void SupabaseRealtimeClient::handleIncomingMessage(const String& message) {
         }
     }
     else if (event == "postgres_changes" && channelJoined) {
-        String eventType = doc["payload"]["eventType"];
+        // Formato atual: payload.data.record; versões anteriores: payload.new
+        JsonObject change = doc["payload"]["data"].isNull() ? doc["payload"].as<JsonObject>()
+                                                             : doc["payload"]["data"].as<JsonObject>();
+        String eventType = change["eventType"] | "";
+        if (eventType.isEmpty()) eventType = change["type"] | "";
         if (eventType == "INSERT") {
             // Novo comando de relé
-            JsonObject newRecord = doc["payload"]["new"];
+            JsonObject newRecord = change["record"].isNull() ? change["new"].as<JsonObject>()
+                                                              : change["record"].as<JsonObject>();
             processRelayCommand(newRecord);
         }
     }
+    else if (event == "INSERT" && channelJoined) {
+        // Protocolo legado (tópico realtime:public:tabela:filtro)
+        JsonObject newRecord = doc["payload"]["record"];
+        processRelayCommand(newRecord);
+    }
     else if (event == "phx_error") {
         Serial.printf("❌ Erro Phoenix: %s\n", message.c_str());
         currentState = SUPABASE_WS_ERROR;
@@ -204,6 +216,11 @@ void SupabaseRealtimeClient::processRelayCommand(const JsonObject& payload) {
         return;
     }
     
+    // Só comandos ainda pendentes (o polling pode ter executado antes)
+    String status = payload["status"] | "pending";
+    if (status != "pending") return;
+    
+    int commandId = payload["id"] | 0;
     int relayNumber = payload["relay_number"];
     String action = payload["action"];
     int duration = payload["duration_seconds"] | 0;
@@ -215,13 +232,13 @@ void SupabaseRealtimeClient::processRelayCommand(const JsonObject& payload) {
     Serial.println();
     
     // Chamar callback
-    onCommandReceived(relayNumber, action, duration);
+    onCommandReceived(commandId, relayNumber, action, duration);
 }
 
 bool SupabaseRealtimeClient::sendDeviceStatus(const String& status) {
     if (!isConnected()) return false;
     
-    DynamicJsonDocument doc(512);
+    TaggedJsonDocument doc("cloud.realtime", 512);
     doc["topic"] = channelTopic;
     doc["event"] = "device_status_update";
     doc["payload"]["device_id"] = deviceId;
@@ -235,10 +252,32 @@ bool SupabaseRealtimeClient::sendDeviceStatus(const String& status) {
     return webSocket.sendTXT(message);
 }
 
+bool SupabaseRealtimeClient::sendCommandAck(int commandId, const char* status) {
+    if (!isSubscribed()) return false;
+    
+    // Broadcast no canal do dispositivo: o dashboard recebe sem esperar o PATCH
+    StaticJsonDocument<384> doc;
+    doc["topic"] = channelTopic;
+    doc["event"] = "broadcast";
+    JsonObject payload = doc.createNestedObject("payload");
+    payload["type"] = "broadcast";
+    payload["event"] = "command_ack";
+    payload["payload"]["id"] = commandId;
+    payload["payload"]["device_id"] = deviceId;
+    payload["payload"]["status"] = status;
+    doc["ref"] = String(refCounter++);
+    
+    char message[384];
+    size_t length = serializeJson(doc, message, sizeof(message));
+    if (length == 0 || length >= sizeof(message)) return false;
+    
+    return webSocket.sendTXT(message, length);
+}
+
 bool SupabaseRealtimeClient::sendHeartbeatPing() {
     if (!isConnected()) return false;
     
-    DynamicJsonDocument doc(256);
+    TaggedJsonDocument doc("cloud.realtime", 256);
     doc["topic"] = "realtime:device:" + deviceId;
     doc["event"] = "ping";
     doc["payload"]["device_id"] = deviceId;
@@ -1,5 +1,6 @@
 #include "Config.h"
 #include "TDSReaderSerial.h"
+#include "SignalFilters.h"
 
 TDSReaderSerial::TDSReaderSerial(uint8_t pin, float vref, float calibrationFactor)
     : _pin(pin)
@@ -23,7 +24,7 @@ void TDSReaderSerial::begin() {
     Serial.println("TDS/EC Serial Monitor");
 }
 
-void TDSReaderSerial::readTDS() {
+bool TDSReaderSerial::readTDS() {
     static unsigned long analogSampleTimepoint = millis();
 
     if (millis() - analogSampleTimepoint > 40U) {
@@ -45,29 +46,41 @@ void TDSReaderSerial::readTDS() {
 
         _averageVoltage = calculateMedian(_analogBufferTemp, _sampleCount) * (_vref / 4095.0);
 
-        float compensationCoefficient = 1.0 + 0.02 * (_temperature - 25.0);
-        float compensationVoltage = _averageVoltage / compensationCoefficient;
+        computeTDS();
+        return true;
+    }
+    return false;
+}
 
-        float rawTDS = (133.42 * compensationVoltage * compensationVoltage * compensationVoltage 
-                    - 255.86 * compensationVoltage * compensationVoltage 
-                    + 857.39 * compensationVoltage) * 0.5 * _calibrationFactor;
+bool TDSReaderSerial::readTDSFromRaw(float raw) {
+    _averageVoltage = raw * (_vref / 4095.0);
+    computeTDS();
+    return true;
+}
 
-        if (rawTDS < 0 || rawTDS > 1000) {
-            _tdsValue = 0;
-        } else {
-            _tdsValue = rawTDS;
-        }
+void TDSReaderSerial::computeTDS() {
+    float compensationCoefficient = 1.0 + 0.02 * (_temperature - 25.0);
+    float compensationVoltage = _averageVoltage / compensationCoefficient;
 
-        Serial.print("Voltage: ");
-        Serial.print(_averageVoltage, 3);
-        Serial.print("V | TDS Raw: ");
-        Serial.print(rawTDS);
-        Serial.print(" | TDS Final: ");
-        Serial.print(_tdsValue, 0);
-        Serial.print(" ppm | EC: ");
-        Serial.print(getECValue(), 0);
-        Serial.println(" uS/cm");
+    float rawTDS = (133.42 * compensationVoltage * compensationVoltage * compensationVoltage 
+                - 255.86 * compensationVoltage * compensationVoltage 
+                + 857.39 * compensationVoltage) * 0.5 * _calibrationFactor;
+
+    if (rawTDS < 0 || rawTDS > 1000) {
+        _tdsValue = 0;
+    } else {
+        _tdsValue = rawTDS;
     }
+
+    Serial.print("Voltage: ");
+    Serial.print(_averageVoltage, 3);
+    Serial.print("V | TDS Raw: ");
+    Serial.print(rawTDS);
+    Serial.print(" | TDS Final: ");
+    Serial.print(_tdsValue, 0);
+    Serial.print(" ppm | EC: ");
+    Serial.print(getECValue(), 0);
+    Serial.println(" uS/cm");
 }
 
 void TDSReaderSerial::updateTemperature(float temp) {
@@ -83,24 +96,6 @@ float TDSReaderSerial::getECValue() {
 }
 
 float TDSReaderSerial::calculateMedian(int *bArray, int iFilterLen) {
-    int bTab[iFilterLen];
-    for (int i = 0; i < iFilterLen; i++) {
-        bTab[i] = bArray[i];
-    }
-
-    for (int j = 0; j < iFilterLen - 1; j++) {
-        for (int i = 0; i < iFilterLen - j - 1; i++) {
-            if (bTab[i] > bTab[i + 1]) {
-                int bTemp = bTab[i];
-                bTab[i] = bTab[i + 1];
-                bTab[i + 1] = bTemp;
-            }
-        }
-    }
-
-    if ((iFilterLen & 1) > 0) {
-        return bTab[(iFilterLen - 1) / 2];
-    } else {
-        return (bTab[iFilterLen / 2] + bTab[iFilterLen / 2 - 1]) / 2.0;
-    }
+    // Quickselect O(n); reordena bArray (aqui sempre a cópia _analogBufferTemp)
+    return SignalFilters::median(bArray, iFilterLen);
 }
@@ -0,0 +1,365 @@
+#include "TelemetryQueue.h"
+#include "DeviceID.h"
+#include "HistoryFS.h"
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <time.h>
+
+const char* TelemetryQueue::NVS_NAMESPACE = "telemetry_q";
+
+// Antes disso o relógio ainda não foi sincronizado pelo NTP
+static const time_t EPOCH_VALID_AFTER = 1600000000;
+
+// ===== CONSTRUTOR =====
+TelemetryQueue::TelemetryQueue() :
+    fs(nullptr),
+    ring(TELEMETRY_QUEUE_DIRECTORY, TELEMETRY_RECORD_SIZE, TELEMETRY_QUEUE_SEGMENT_RECORDS, TELEMETRY_QUEUE_SEGMENTS),
+    ready(false),
+    next_sequence(1),
+    acked_sequence(1),
+    boot_id(0),
+    last_drain(0),
+    drain_delay(TELEMETRY_DRAIN_INTERVAL_MS),
+    sent(0),
+    dropped(0),
+    failures(0),
+    corrupted(0),
+    rejected(0) {
+    memset(&record, 0, sizeof(record));
+}
+
+// ===== CONTROLE =====
+bool TelemetryQueue::begin(fs::FS& filesystem) {
+    fs = &filesystem;
+
+    if (&filesystem == &LittleFS && !HistoryFS::mount("TelemetryQueue")) {
+        return false;
+    }
+    if (!ring.begin(fs)) {
+        return false;
+    }
+
+    // Anel antigo num arquivo só (regravado no lugar): não é migrado
+    if (fs->exists(TELEMETRY_QUEUE_LEGACY_PATH)) {
+        fs->remove(TELEMETRY_QUEUE_LEGACY_PATH);
+        Serial.println("⚠️ TelemetryQueue: fila no formato antigo descartada");
+    }
+
+    recover();
+    ready = true;
+
+    Serial.printf("✅ TelemetryQueue: %lu registros pendentes (capacidade %d, boot %u)\n",
+                 (unsigned long)size(), TELEMETRY_QUEUE_CAPACITY, boot_id);
+    return true;
+}
+
+void TelemetryQueue::loop(bool online) {
+    if (!ready || !online || !sender || isEmpty()) return;
+
+    unsigned long now = millis();
+    if (now - last_drain < drain_delay) return;
+    last_drain = now;
+
+    // Agrupa a janela mais antiga por tabela e por presença de created_at
+    // (PostgREST exige as mesmas chaves em todas as linhas do lote)
+    static const uint8_t MAX_GROUPS = TELEMETRY_TABLE_COUNT * 2;
+    static const uint8_t NO_GROUP = 0xFF;
+    uint8_t group_table[MAX_GROUPS];
+    bool group_timed[MAX_GROUPS];
+    uint8_t record_group[TELEMETRY_DRAIN_BATCH];
+    uint32_t record_epoch[TELEMETRY_DRAIN_BATCH];
+    uint8_t group_count = 0;
+    uint32_t window = 0;
+
+    while (window < TELEMETRY_DRAIN_BATCH && acked_sequence + window != next_sequence) {
+        if (!readRecord(acked_sequence + window)) {
+            record_group[window++] = NO_GROUP;
+            continue;
+        }
+
+        uint32_t epoch = record.boot == boot_id ? captureEpoch(record.epoch, record.captured_ms) : record.epoch;
+        bool timed = epoch != 0;
+
+        uint8_t group = 0;
+        while (group < group_count && (group_table[group] != record.table || group_timed[group] != timed)) {
+            group++;
+        }
+        if (group == group_count) {
+            group_table[group] = record.table;
+            group_timed[group] = timed;
+            group_count++;
+        }
+
+        record_epoch[window] = epoch;
+        record_group[window++] = group;
+    }
+
+    // Um POST por grupo, montado no buffer fixo (relendo os registros do
+    // grupo); depois de uma falha não insiste nos demais
+    bool group_ok[MAX_GROUPS] = {false};
+    bool ok = true;
+    uint32_t limit = window;
+    for (uint8_t group = 0; group < group_count && ok; group++) {
+        size_t length = 0;
+        uint8_t rows = 0;
+        body[length++] = '[';
+        for (uint32_t i = 0; i < window; i++) {
+            if (record_group[i] != group) continue;
+
+            size_t row = 0;
+            if (readRecord(acked_sequence + i)) {
+                if (length > 1) body[length++] = ',';
+                row = formatRow(body + length, sizeof(body) - length - 2, record.payload, record_epoch[i]);
+            }
+            if (row == 0) {
+                // Não coube: o restante da janela fica para a próxima rodada
+                if (length > 1 && body[length - 1] == ',') length--;
+                if (i < limit) limit = i;
+                break;
+            }
+            length += row;
+            rows++;
+        }
+        body[length++] = ']';
+        body[length] = '\0';
+
+        group_ok[group] = rows > 0 && sender(tableName((TelemetryTable)group_table[group]), body, length);
+        if (group_ok[group]) {
+            Serial.printf("📤 TelemetryQueue: %u linhas reenviadas para %s\n",
+                         rows, tableName((TelemetryTable)group_table[group]));
+        } else {
+            ok = false;
+        }
+    }
+    ring.endRead();
+
+    // Confirma até o primeiro registro cujo lote falhou
+    uint32_t delivered = 0;
+    uint32_t skipped = 0;
+    uint32_t advanced = 0;
+    while (advanced < limit) {
+        uint8_t group = record_group[advanced];
+        if (group != NO_GROUP && !group_ok[group]) break;
+        if (group == NO_GROUP) skipped++; else delivered++;
+        advanced++;
+    }
+    acked_sequence += advanced;
+    sent += delivered;
+
+    if (advanced > 0) {
+        saveAck();
+    }
+    if (skipped > 0) {
+        corrupted += skipped;
+        Serial.printf("⚠️ TelemetryQueue: %lu registros corrompidos descartados\n", (unsigned long)skipped);
+    }
+
+    if (ok) {
+        drain_delay = TELEMETRY_DRAIN_INTERVAL_MS;
+    } else {
+        failures++;
+        drain_delay = drain_delay * 2 > TELEMETRY_BACKOFF_MAX_MS ? TELEMETRY_BACKOFF_MAX_MS : drain_delay * 2;
+        Serial.printf("⚠️ TelemetryQueue: reenvio falhou, nova tentativa em %lus (%lu pendentes)\n",
+                     drain_delay / 1000, (unsigned long)size());
+    }
+}
+
+// ===== ENFILEIRAMENTO =====
+bool TelemetryQueue::enqueue(TelemetryTable table, const char* payload) {
+    return enqueue(table, payload, epochNow(), millis());
+}
+
+bool TelemetryQueue::enqueue(TelemetryTable table, const char* payload, uint32_t epoch, uint32_t captured_ms) {
+    if (!ready) {
+        // Sem fila, cada leitura offline se perde: erro explícito (uma vez) e contagem
+        if (rejected++ == 0) {
+            Serial.printf("❌ TelemetryQueue: fila indisponível (begin() falhou, partição '%s'?) - "
+                          "leituras de %s e seguintes serão perdidas\n",
+                         HISTORY_FS_PARTITION, tableName(table));
+        }
+        return false;
+    }
+    if (table >= TELEMETRY_TABLE_COUNT) return false;
+
+    size_t length = strnlen(payload, sizeof(record.payload));
+    if (length >= sizeof(record.payload) || payload[0] != '{') {
+        Serial.printf("⚠️ TelemetryQueue: payload inválido para %s (%u bytes)\n",
+                     tableName(table), (unsigned)length);
+        return false;
+    }
+
+    // Cheia: o segmento reciclado leva junto os registros mais antigos
+    uint32_t oldest = ring.oldestKept(next_sequence - 1) + 1;
+    if (acked_sequence < oldest) {
+        if (dropped == 0) {
+            Serial.println("⚠️ TelemetryQueue: fila cheia, descartando registros mais antigos");
+        }
+        dropped += oldest - acked_sequence;
+        acked_sequence = oldest;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.magic = RECORD_MAGIC;
+    record.table = table;
+    record.length = length;
+    record.sequence = next_sequence;
+    record.epoch = epoch;
+    record.captured_ms = captured_ms;
+    record.boot = boot_id;
+    memcpy(record.payload, payload, record.length);
+    record.checksum = checksum(record);
+
+    if (!ring.append(next_sequence - 1, (const uint8_t*)&record)) {
+        Serial.println("❌ TelemetryQueue: erro ao gravar registro");
+        return false;
+    }
+
+    next_sequence++;
+    return true;
+}
+
+// ===== STATUS =====
+String TelemetryQueue::getStatusJSON() const {
+    DynamicJsonDocument doc(384);
+    doc["ready"] = ready;
+    doc["pending"] = size();
+    doc["capacity"] = TELEMETRY_QUEUE_CAPACITY;
+    doc["sent"] = sent;
+    doc["dropped"] = dropped;
+    doc["failures"] = failures;
+    doc["corrupted"] = corrupted;
+    doc["rejected"] = rejected;
+    doc["retry_delay_ms"] = drain_delay;
+    doc["clock_synced"] = epochNow() != 0;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void TelemetryQueue::printStatus() const {
+    Serial.println("\n📦 === FILA DE TELEMETRIA ===");
+    if (!ready) {
+        Serial.printf("❌ Indisponível (partição '%s' não montada) | Perdidos: %lu\n",
+                     HISTORY_FS_PARTITION, (unsigned long)rejected);
+    }
+    Serial.printf("Pendentes: %lu/%d | Reenviados: %lu | Descartados: %lu\n",
+                 (unsigned long)size(), TELEMETRY_QUEUE_CAPACITY, (unsigned long)sent, (unsigned long)dropped);
+    Serial.printf("Falhas: %lu | Corrompidos: %lu | Próxima tentativa: %lus | NTP: %s\n",
+                 (unsigned long)failures, (unsigned long)corrupted, drain_delay / 1000,
+                 epochNow() ? "OK" : "não sincronizado");
+    Serial.println("============================\n");
+}
+
+const char* TelemetryQueue::tableName(TelemetryTable table) {
+    switch (table) {
+        case TELEMETRY_ENVIRONMENT: return SUPABASE_ENVIRONMENT_TABLE;
+        case TELEMETRY_HYDRO: return SUPABASE_HYDRO_TABLE;
+        default: return "";
+    }
+}
+
+uint32_t TelemetryQueue::epochNow() {
+    time_t now = time(nullptr);
+    return now > EPOCH_VALID_AFTER ? (uint32_t)now : 0;
+}
+
+uint32_t TelemetryQueue::captureEpoch(uint32_t epoch, uint32_t captured_ms) {
+    if (epoch != 0) return epoch;
+
+    // Capturado antes do NTP sincronizar: recupera a hora pelo millis()
+    uint32_t now_epoch = epochNow();
+    if (now_epoch == 0) return 0;
+    return now_epoch - (millis() - captured_ms) / 1000;
+}
+
+size_t TelemetryQueue::formatRow(char* out, size_t size, const char* payload, uint32_t epoch) {
+    // O ID não muda durante o boot: monta uma vez
+    static char device_id[32] = "";
+    if (device_id[0] == '\0') {
+        strncpy(device_id, getDeviceID().c_str(), sizeof(device_id) - 1);
+    }
+
+    char timestamp[24] = "";
+    if (epoch != 0) {
+        time_t t = epoch;
+        struct tm utc;
+        gmtime_r(&t, &utc);
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    }
+
+    const char* fields = payload[0] == '{' ? payload + 1 : payload;
+    int length = snprintf(out, size, "{\"device_id\":\"%s\"%s%s%s%s%s",
+                          device_id,
+                          epoch != 0 ? ",\"created_at\":\"" : "", timestamp, epoch != 0 ? "\"" : "",
+                          *fields != '}' ? "," : "", fields);
+    return (length > 0 && (size_t)length < size) ? (size_t)length : 0;
+}
+
+// ===== MÉTODOS INTERNOS =====
+void TelemetryQueue::recover() {
+    uint32_t stored_ack = 1;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        stored_ack = prefs.getUInt("acked", 1);
+        boot_id = prefs.getUShort("boots", 0) + 1;
+        prefs.putUShort("boots", boot_id);
+        prefs.end();
+    }
+
+    // Registro mais novo = maior sequência válida no anel
+    uint32_t newest = 0;
+    for (uint32_t slot = 0; slot < ring.capacity(); slot++) {
+        if (ring.readSlot(slot, (uint8_t*)&record) && record.magic == RECORD_MAGIC &&
+            record.sequence > newest && (record.sequence - 1) % ring.capacity() == slot &&
+            record.checksum == checksum(record)) {
+            newest = record.sequence;
+        }
+    }
+    ring.endRead();
+
+    if (newest == 0) {
+        // Arquivo vazio ou perdido: recomeça do início do anel
+        next_sequence = 1;
+        acked_sequence = 1;
+        if (stored_ack != 1) saveAck();
+        return;
+    }
+
+    next_sequence = newest + 1;
+    acked_sequence = stored_ack;
+    if (acked_sequence > next_sequence) {
+        acked_sequence = next_sequence;
+    }
+    uint32_t oldest = ring.oldestKept(newest - 1) + 1;
+    if (acked_sequence < oldest) {
+        acked_sequence = oldest;
+    }
+}
+
+bool TelemetryQueue::readRecord(uint32_t sequence) {
+    return ring.read(sequence - 1, (uint8_t*)&record) &&
+           record.magic == RECORD_MAGIC && record.sequence == sequence &&
+           record.table < TELEMETRY_TABLE_COUNT && record.checksum == checksum(record);
+}
+
+void TelemetryQueue::saveAck() {
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putUInt("acked", acked_sequence);
+        prefs.end();
+    }
+}
+
+uint16_t TelemetryQueue::checksum(const Record& rec) {
+    // Fletcher-16 sobre o cabeçalho (até o checksum) e o payload usado
+    uint16_t sum1 = 0, sum2 = 0;
+    const uint8_t* header = (const uint8_t*)&rec;
+    for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+        sum1 = (sum1 + header[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    for (uint8_t i = 0; i < rec.length && i < sizeof(rec.payload); i++) {
+        sum1 = (sum1 + (uint8_t)rec.payload[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
@@ -0,0 +1,752 @@
+#include "TimeSeriesStore.h"
+#include "HistoryFS.h"
+#include <ArduinoJson.h>
+
+static const char* const TIER_NAMES[] = {"raw", "1m", "15m"};
+
+// Estende o sinal de um campo de 'bits' bits
+static int32_t signExtend(uint32_t value, uint8_t bits) {
+    return (int32_t)(value << (32 - bits)) >> (32 - bits);
+}
+
+static bool fitsSigned(int64_t value, uint8_t bits) {
+    int64_t limit = 1LL << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+// ===== PÁGINA =====
+TimeSeriesPage::TimeSeriesPage() {
+    reset(0, 0, 0);
+}
+
+void TimeSeriesPage::reset(uint8_t tier, uint8_t columns, uint32_t sequence) {
+    memset(buffer, 0, sizeof(buffer));
+    Header& header = mutableHeader();
+    header.magic = MAGIC;
+    header.tier = tier;
+    header.columns = columns;
+    header.sequence = sequence;
+
+    last_time = 0;
+    last_delta = 0;
+    memset(last_values, 0, sizeof(last_values));
+}
+
+bool TimeSeriesPage::append(uint32_t time, const int32_t* values) {
+    Header& header = mutableHeader();
+    if (header.count == 0xFFFF) return false;
+
+    uint32_t pos = header.bit_length;
+    int32_t delta = 0;
+    bool ok;
+
+    // Primeira linha em valor absoluto: cada página se decodifica sozinha
+    if (header.count == 0) {
+        ok = writeBits(pos, time, 32);
+    } else {
+        delta = (int32_t)(time - last_time);
+        ok = writeTimestamp(pos, delta - last_delta);
+    }
+
+    for (uint8_t c = 0; ok && c < header.columns; c++) {
+        ok = writeValue(pos, last_values[c], values[c]);
+    }
+
+    // Não coube: bits além de bit_length são ignorados, página continua válida
+    if (!ok) return false;
+
+    if (header.count == 0) {
+        header.first_time = time;
+    } else {
+        last_delta = delta;
+    }
+    last_time = time;
+    memcpy(last_values, values, header.columns * sizeof(int32_t));
+
+    header.last_time = time;
+    header.count++;
+    header.bit_length = pos;
+    return true;
+}
+
+bool TimeSeriesPage::load(const uint8_t* data, uint8_t expected_tier) {
+    memcpy(buffer, data, sizeof(buffer));
+    const Header& loaded = header();
+
+    if (loaded.magic != MAGIC || loaded.tier != expected_tier ||
+        loaded.columns > TS_MAX_COLUMNS || loaded.bit_length > CAPACITY_BITS ||
+        loaded.checksum != computeChecksum()) {
+        reset(expected_tier, 0, 0);
+        return false;
+    }
+
+    // Restaura o estado do codificador para continuar a página
+    uint16_t row = 0;
+    last_time = 0;
+    last_delta = 0;
+    decode([this, &row](uint32_t time, const int32_t* values) {
+        if (row++ > 0) {
+            last_delta = (int32_t)(time - last_time);
+        }
+        last_time = time;
+        memcpy(last_values, values, header().columns * sizeof(int32_t));
+        return true;
+    });
+    return true;
+}
+
+bool TimeSeriesPage::decode(RowVisitor visitor) const {
+    const Header& h = header();
+    const uint8_t* payload = buffer + sizeof(Header);
+    uint32_t pos = 0;
+    uint32_t time = 0;
+    int32_t delta = 0;
+    int32_t values[TS_MAX_COLUMNS] = {0};
+
+    for (uint16_t row = 0; row < h.count; row++) {
+        if (row == 0) {
+            time = readBits(payload, pos, 32);
+        } else {
+            delta += readTimestamp(payload, pos);
+            time += delta;
+        }
+        for (uint8_t c = 0; c < h.columns; c++) {
+            values[c] = readValue(payload, pos, values[c]);
+        }
+        if (pos > h.bit_length) return false;
+        if (!visitor(time, values)) return false;
+    }
+    return true;
+}
+
+void TimeSeriesPage::sealHeader() {
+    mutableHeader().checksum = computeChecksum();
+}
+
+uint16_t TimeSeriesPage::computeChecksum() const {
+    // Fletcher-16 sobre os bytes usados
+    const uint8_t* payload = buffer + sizeof(Header);
+    uint16_t length = (header().bit_length + 7) / 8;
+    uint16_t sum1 = 0, sum2 = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        sum1 = (sum1 + payload[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
+
+bool TimeSeriesPage::writeBits(uint32_t& pos, uint32_t value, uint8_t bits) {
+    if (pos + bits > CAPACITY_BITS) return false;
+
+    uint8_t* payload = buffer + sizeof(Header);
+    for (int8_t i = bits - 1; i >= 0; i--) {
+        uint8_t mask = 0x80 >> (pos & 7);
+        if ((value >> i) & 1) {
+            payload[pos >> 3] |= mask;
+        } else {
+            payload[pos >> 3] &= ~mask;
+        }
+        pos++;
+    }
+    return true;
+}
+
+uint32_t TimeSeriesPage::readBits(const uint8_t* payload, uint32_t& pos, uint8_t bits) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        if (pos >= CAPACITY_BITS) return value;
+        value = (value << 1) | ((payload[pos >> 3] >> (7 - (pos & 7))) & 1);
+        pos++;
+    }
+    return value;
+}
+
+bool TimeSeriesPage::writeTimestamp(uint32_t& pos, int32_t delta_of_delta) {
+    // Intervalo regular: delta-do-delta zero custa 1 bit
+    if (delta_of_delta == 0) return writeBits(pos, 0x0, 1);
+    if (fitsSigned(delta_of_delta, 7)) return writeBits(pos, 0x2, 2) && writeBits(pos, delta_of_delta & 0x7F, 7);
+    if (fitsSigned(delta_of_delta, 9)) return writeBits(pos, 0x6, 3) && writeBits(pos, delta_of_delta & 0x1FF, 9);
+    if (fitsSigned(delta_of_delta, 12)) return writeBits(pos, 0xE, 4) && writeBits(pos, delta_of_delta & 0xFFF, 12);
+    return writeBits(pos, 0xF, 4) && writeBits(pos, (uint32_t)delta_of_delta, 32);
+}
+
+int32_t TimeSeriesPage::readTimestamp(const uint8_t* payload, uint32_t& pos) {
+    if (!readBits(payload, pos, 1)) return 0;
+    if (!readBits(payload, pos, 1)) return signExtend(readBits(payload, pos, 7), 7);
+    if (!readBits(payload, pos, 1)) return signExtend(readBits(payload, pos, 9), 9);
+    if (!readBits(payload, pos, 1)) return signExtend(readBits(payload, pos, 12), 12);
+    return (int32_t)readBits(payload, pos, 32);
+}
+
+bool TimeSeriesPage::writeValue(uint32_t& pos, int32_t previous, int32_t value) {
+    if (value == previous) return writeBits(pos, 0x0, 1);
+
+    // Entrada/saída de valor ausente vai sempre em absoluto
+    if (value != TS_MISSING_VALUE && previous != TS_MISSING_VALUE) {
+        int64_t delta = (int64_t)value - previous;
+        if (fitsSigned(delta, 4)) return writeBits(pos, 0x2, 2) && writeBits(pos, delta & 0xF, 4);
+        if (fitsSigned(delta, 8)) return writeBits(pos, 0x6, 3) && writeBits(pos, delta & 0xFF, 8);
+        if (fitsSigned(delta, 16)) return writeBits(pos, 0xE, 4) && writeBits(pos, delta & 0xFFFF, 16);
+    }
+    return writeBits(pos, 0xF, 4) && writeBits(pos, (uint32_t)value, 32);
+}
+
+int32_t TimeSeriesPage::readValue(const uint8_t* payload, uint32_t& pos, int32_t previous) {
+    if (!readBits(payload, pos, 1)) return previous;
+    if (!readBits(payload, pos, 1)) return previous + signExtend(readBits(payload, pos, 4), 4);
+    if (!readBits(payload, pos, 1)) return previous + signExtend(readBits(payload, pos, 8), 8);
+    if (!readBits(payload, pos, 1)) return previous + signExtend(readBits(payload, pos, 16), 16);
+    return (int32_t)readBits(payload, pos, 32);
+}
+
+// ===== CONSTRUTOR =====
+TimeSeriesStore::TimeSeriesStore() :
+    fs(nullptr),
+    bus(nullptr),
+    mutex(nullptr),
+    ready(false),
+    channel_count(0),
+    clock_base(0),
+    clock_origin(0),
+    last_sample(0) {
+    static const char* const directories[] = {TS_DIRECTORY "/raw", TS_DIRECTORY "/m1", TS_DIRECTORY "/m15"};
+    static const char* const head_paths[] = {TS_DIRECTORY "/raw/head.bin", TS_DIRECTORY "/m1/head.bin",
+                                             TS_DIRECTORY "/m15/head.bin"};
+    static const char* const legacy_paths[] = {TS_DIRECTORY "/raw.bin", TS_DIRECTORY "/m1.bin", TS_DIRECTORY "/m15.bin"};
+    static const uint16_t page_counts[] = {TS_RAW_PAGES, TS_MINUTE_PAGES, TS_QUARTER_PAGES};
+    static const uint32_t periods[] = {0, 60, 900};
+
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        TierState& tier = tiers[t];
+        tier.directory = directories[t];
+        tier.head_path = head_paths[t];
+        tier.legacy_path = legacy_paths[t];
+        tier.ring = new SegmentRing(directories[t], TS_PAGE_SIZE, TS_SEGMENT_PAGES,
+                                    page_counts[t] / TS_SEGMENT_PAGES);
+        tier.page_count = page_counts[t];
+        tier.period_s = periods[t];
+        tier.head_slot = 0;
+        tier.slots_used = 0;
+        tier.next_sequence = 1;
+        tier.slot_first = nullptr;
+        tier.slot_last = nullptr;
+        tier.dirty = false;
+        tier.last_checkpoint = 0;
+        tier.rows_written = 0;
+        tier.page_writes = 0;
+        aggregators[t].active = false;
+    }
+
+    // Canais do histórico (mesmas chaves das regras)
+    static const SensorChannel history_channels[] = {SENSOR_PH, SENSOR_TDS, SENSOR_EC, SENSOR_WATER_TEMP};
+    for (SensorChannel channel : history_channels) {
+        scales[channel_count] = 1.0;
+        channels[channel_count++] = channel;
+    }
+}
+
+TimeSeriesStore::~TimeSeriesStore() {
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        delete[] tiers[t].slot_first;
+        delete[] tiers[t].slot_last;
+        delete tiers[t].ring;
+    }
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+    }
+}
+
+// ===== CONTROLE =====
+bool TimeSeriesStore::begin(SensorBus* sensor_bus, fs::FS& filesystem) {
+    bus = sensor_bus;
+    fs = &filesystem;
+
+    if (&filesystem == &LittleFS && !HistoryFS::mount("TimeSeries")) {
+        return false;
+    }
+    if (!fs->exists(TS_DIRECTORY)) {
+        fs->mkdir(TS_DIRECTORY);
+    }
+
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutex();
+    }
+
+    // Valores gravados como inteiros na resolução de cada canal
+    for (uint8_t i = 0; i < channel_count; i++) {
+        const SensorDescriptor* descriptor = bus ? bus->describe(channels[i]) : nullptr;
+        scales[i] = powf(10.0, descriptor ? descriptor->decimals : 2);
+    }
+
+    clock_base = 0;
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        TierState& tier = tiers[t];
+        tier.ring->begin(fs);
+
+        // Anel antigo num arquivo só (regravado no lugar): não é migrado
+        if (fs->exists(tier.legacy_path)) {
+            fs->remove(tier.legacy_path);
+            Serial.printf("⚠️ TimeSeries: %s no formato antigo descartado\n", tier.legacy_path);
+        }
+
+        if (!tier.slot_first) {
+            tier.slot_first = new uint32_t[tier.page_count]();
+            tier.slot_last = new uint32_t[tier.page_count]();
+        }
+        recoverTier((Tier)t);
+    }
+
+    // Relógio continua depois do último registro (sem RTC)
+    if (clock_base > 0) clock_base++;
+    clock_origin = millis();
+    last_sample = clock_origin;
+    ready = true;
+
+    Serial.printf("✅ TimeSeries: histórico pronto (t=%lus | bruto %u/%u, 1min %u/%u, 15min %u/%u páginas)\n",
+                 (unsigned long)clock_base,
+                 tiers[TIER_RAW].slots_used, tiers[TIER_RAW].page_count,
+                 tiers[TIER_MINUTE].slots_used, tiers[TIER_MINUTE].page_count,
+                 tiers[TIER_QUARTER].slots_used, tiers[TIER_QUARTER].page_count);
+    return true;
+}
+
+void TimeSeriesStore::loop() {
+    if (!ready) return;
+
+    unsigned long now_ms = millis();
+    advanceClock(now_ms);
+
+    if (now_ms - last_sample >= TS_RAW_INTERVAL_MS) {
+        last_sample = now_ms;
+        sample(now_ms);
+    }
+
+    // Página parcial vai para a flash só periodicamente (desgaste)
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        if (tiers[t].dirty && now_ms - tiers[t].last_checkpoint >= TS_CHECKPOINT_INTERVAL_MS) {
+            lock();
+            checkpoint((Tier)t);
+            unlock();
+        }
+    }
+}
+
+void TimeSeriesStore::end() {
+    flush();
+    ready = false;
+}
+
+void TimeSeriesStore::flush() {
+    if (!ready) return;
+
+    lock();
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        checkpoint((Tier)t);
+    }
+    unlock();
+}
+
+// ===== TEMPO =====
+uint32_t TimeSeriesStore::now() const {
+    return clock_base + (millis() - clock_origin) / 1000;
+}
+
+// ===== CONSULTA =====
+size_t TimeSeriesStore::query(Tier tier, uint32_t from, uint32_t to, RowCallback callback) {
+    if (!ready || tier >= TIER_COUNT || from > to) return 0;
+
+    lock();
+    TierState& state = tiers[tier];
+    TimeSeriesRow row;
+    size_t delivered = 0;
+    bool stop = false;
+
+    TimeSeriesPage::RowVisitor visit = [&](uint32_t time, const int32_t* values) {
+        if (time < from) return true;
+        if (time > to) {
+            stop = true;
+            return false;
+        }
+        rowFromValues(tier, time, values, row);
+        delivered++;
+        if (!callback(row)) {
+            stop = true;
+            return false;
+        }
+        return true;
+    };
+
+    // Páginas fechadas do mais antigo para o mais novo; a do head está na RAM
+    uint32_t head = state.page.header().sequence - 1;
+    for (uint32_t index = firstClosed(state); index < head && !stop; index++) {
+        uint16_t slot = index % state.page_count;
+        if (state.slot_first[slot] > to) break;
+        if (state.slot_last[slot] < from) continue;
+
+        if (state.ring->readSlot(slot, io_buffer) && scratch.load(io_buffer, tier) &&
+            scratch.header().sequence == index + 1) {
+            scratch.decode(visit);
+        }
+    }
+    state.ring->endRead();
+
+    if (!stop && !state.page.isEmpty()) {
+        state.page.decode(visit);
+    }
+    unlock();
+    return delivered;
+}
+
+TimeSeriesStore::Tier TimeSeriesStore::selectTier(uint32_t from, uint32_t to, size_t max_points) const {
+    uint32_t span = to > from ? to - from : 0;
+
+    for (uint8_t t = TIER_RAW; t < TIER_QUARTER; t++) {
+        uint32_t step = t == TIER_RAW ? TS_RAW_INTERVAL_MS / 1000 : tiers[t].period_s;
+        // Fino o bastante para caber e ainda guarda o início do intervalo
+        if (span / step <= max_points && oldestTime((Tier)t) <= from) {
+            return (Tier)t;
+        }
+    }
+    return TIER_QUARTER;
+}
+
+bool TimeSeriesStore::summarize(uint8_t channel, uint32_t from, uint32_t to, TimeSeriesSummary& out) {
+    out.min = NAN;
+    out.max = NAN;
+    out.mean = NAN;
+    out.count = 0;
+    out.first_time = 0;
+    out.last_time = 0;
+    if (channel >= channel_count) return false;
+
+    Tier tier = selectTier(from, to, 1000);
+    double sum = 0.0;
+
+    query(tier, from, to, [&](const TimeSeriesRow& row) {
+        uint8_t column = tier == TIER_RAW ? channel : channel * 3;
+        float avg = row.values[column];
+        if (isnan(avg)) return true;
+
+        float low = tier == TIER_RAW ? avg : row.values[column + 1];
+        float high = tier == TIER_RAW ? avg : row.values[column + 2];
+
+        if (out.count == 0) {
+            out.min = low;
+            out.max = high;
+            out.first_time = row.time;
+        } else {
+            if (low < out.min) out.min = low;
+            if (high > out.max) out.max = high;
+        }
+        sum += avg;
+        out.count++;
+        out.last_time = row.time;
+        return true;
+    });
+
+    if (out.count == 0) return false;
+    out.mean = sum / out.count;
+    return true;
+}
+
+// ===== CANAIS =====
+int TimeSeriesStore::findChannel(const String& key) const {
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (key == getChannelKey(i)) return i;
+    }
+    return -1;
+}
+
+const char* TimeSeriesStore::getChannelKey(uint8_t channel) const {
+    if (channel >= channel_count || !bus) return "";
+    const SensorDescriptor* descriptor = bus->describe(channels[channel]);
+    return descriptor ? descriptor->key : "";
+}
+
+// ===== STATUS =====
+String TimeSeriesStore::getStatusJSON() const {
+    DynamicJsonDocument doc(1024);
+    doc["ready"] = ready;
+    doc["now"] = now();
+    doc["raw_interval_s"] = TS_RAW_INTERVAL_MS / 1000;
+    doc["page_size"] = TS_PAGE_SIZE;
+
+    JsonArray keys = doc.createNestedArray("channels");
+    for (uint8_t i = 0; i < channel_count; i++) {
+        keys.add(getChannelKey(i));
+    }
+
+    JsonArray tier_list = doc.createNestedArray("tiers");
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        const TierState& tier = tiers[t];
+        JsonObject entry = tier_list.createNestedObject();
+        entry["tier"] = TIER_NAMES[t];
+        entry["pages"] = tier.page_count;
+        entry["pages_used"] = tier.slots_used;
+        entry["head"] = tier.head_slot;
+        entry["rows_in_page"] = tier.page.getCount();
+        entry["rows_written"] = tier.rows_written;
+        entry["page_writes"] = tier.page_writes;
+        entry["oldest"] = oldestTime((Tier)t);
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+void TimeSeriesStore::printStatus() const {
+    Serial.println("\n📈 === HISTÓRICO LOCAL ===");
+    Serial.printf("Relógio: %lus | Pronto: %s\n", (unsigned long)now(), ready ? "SIM" : "NÃO");
+    for (uint8_t t = 0; t < TIER_COUNT; t++) {
+        const TierState& tier = tiers[t];
+        Serial.printf("%s: %u/%u páginas | head %u (%u linhas) | %lu linhas | %lu gravações\n",
+                     TIER_NAMES[t], tier.slots_used, tier.page_count, tier.head_slot,
+                     tier.page.getCount(), (unsigned long)tier.rows_written,
+                     (unsigned long)tier.page_writes);
+    }
+    Serial.println("=========================\n");
+}
+
+// ===== MÉTODOS INTERNOS =====
+void TimeSeriesStore::sample(unsigned long now_ms) {
+    if (!bus) return;
+
+    int32_t values[TS_MAX_COLUMNS / 3];
+    bool any = false;
+
+    for (uint8_t i = 0; i < channel_count; i++) {
+        SensorReading reading;
+        // Sensor degradado continua no histórico; inválido/velho vira ausente
+        if (bus->read(channels[i], reading, now_ms) &&
+            !(reading.quality & (SAMPLE_QUALITY_INVALID | SAMPLE_QUALITY_STALE | SAMPLE_QUALITY_NO_DATA))) {
+            values[i] = lroundf(reading.value * scales[i]);
+            any = true;
+        } else {
+            values[i] = TS_MISSING_VALUE;
+        }
+    }
+    if (!any) return;
+
+    lock();
+    uint32_t time = now();
+    appendRow(TIER_RAW, time, values);
+    feedAggregator(TIER_MINUTE, time, values, values, values);
+    unlock();
+}
+
+void TimeSeriesStore::advanceClock(unsigned long now_ms) {
+    // Acumula segundos inteiros para sobreviver ao overflow do millis()
+    unsigned long elapsed = now_ms - clock_origin;
+    if (elapsed >= 1000) {
+        clock_base += elapsed / 1000;
+        clock_origin += (elapsed / 1000) * 1000;
+    }
+}
+
+uint32_t TimeSeriesStore::oldestTime(Tier tier) const {
+    const TierState& state = tiers[tier];
+    if (state.slots_used > 0) {
+        return state.slot_first[firstClosed(state) % state.page_count];
+    }
+    return state.page.isEmpty() ? UINT32_MAX : state.page.header().first_time;
+}
+
+uint32_t TimeSeriesStore::firstClosed(const TierState& state) const {
+    // Páginas fechadas: do que o anel ainda guarda até a anterior à corrente
+    uint32_t head = state.page.header().sequence - 1;
+    return head > 0 ? state.ring->oldestKept(head - 1) : 0;
+}
+
+void TimeSeriesStore::recoverTier(Tier tier) {
+    TierState& state = tiers[tier];
+    uint8_t columns = columnsFor(tier);
+    const TimeSeriesPage::Header& header = *reinterpret_cast<const TimeSeriesPage::Header*>(io_buffer);
+
+    state.head_slot = 0;
+    state.slots_used = 0;
+    state.next_sequence = 1;
+    state.dirty = false;
+    state.last_checkpoint = millis();
+
+    // A maior sequência no anel é a última página fechada
+    uint32_t newest = 0;
+    for (uint16_t slot = 0; slot < state.page_count; slot++) {
+        if (state.ring->readSlot(slot, io_buffer) && header.magic == TimeSeriesPage::MAGIC &&
+            header.tier == tier && header.columns == columns && header.count > 0 &&
+            (header.sequence - 1) % state.page_count == slot && header.sequence > newest) {
+            newest = header.sequence;
+        }
+    }
+
+    // Continua a página corrente do checkpoint se for mais nova e íntegra
+    bool resumed = false;
+    File file = fs->exists(state.head_path) ? fs->open(state.head_path, "r") : File();
+    if (file) {
+        bool newer = file.read(io_buffer, TS_PAGE_SIZE) == TS_PAGE_SIZE && header.sequence > newest;
+        file.close();
+        resumed = newer && state.page.load(io_buffer, tier) && state.page.header().columns == columns;
+        if (newer && !resumed) {
+            Serial.printf("⚠️ TimeSeries: checkpoint de %s corrompido, iniciando a página seguinte\n",
+                         state.directory);
+        }
+    }
+    if (resumed) {
+        state.next_sequence = state.page.header().sequence + 1;
+        if (state.page.header().last_time > clock_base) {
+            clock_base = state.page.header().last_time;
+        }
+    } else {
+        state.next_sequence = newest + 1;
+        state.page.reset(tier, columns, state.next_sequence++);
+    }
+
+    // Índice em RAM só com as páginas fechadas que o anel ainda guarda
+    uint32_t head = state.page.header().sequence - 1;
+    uint32_t first = firstClosed(state);
+    state.head_slot = head % state.page_count;
+    for (uint16_t slot = 0; slot < state.page_count; slot++) {
+        state.slot_first[slot] = 0;
+        state.slot_last[slot] = 0;
+        if (!state.ring->readSlot(slot, io_buffer) || header.magic != TimeSeriesPage::MAGIC ||
+            header.tier != tier || header.columns != columns || header.count == 0 ||
+            header.sequence - 1 < first || header.sequence - 1 >= head ||
+            (header.sequence - 1) % state.page_count != slot) {
+            continue;
+        }
+        state.slot_first[slot] = header.first_time;
+        state.slot_last[slot] = header.last_time;
+        if (header.last_time > clock_base) {
+            clock_base = header.last_time;
+        }
+    }
+    state.ring->endRead();
+    state.slots_used = head - first;
+}
+
+void TimeSeriesStore::appendRow(Tier tier, uint32_t time, const int32_t* values) {
+    TierState& state = tiers[tier];
+
+    if (!state.page.append(time, values)) {
+        // Página cheia: anexa ao anel e abre a seguinte
+        closePage(tier);
+        state.head_slot = (state.head_slot + 1) % state.page_count;
+        state.page.reset(tier, columnsFor(tier), state.next_sequence++);
+        state.page.append(time, values);
+    }
+
+    state.dirty = true;
+    state.rows_written++;
+}
+
+void TimeSeriesStore::feedAggregator(Tier tier, uint32_t time, const int32_t* avg,
+                                     const int32_t* min, const int32_t* max) {
+    Aggregator& aggregator = aggregators[tier];
+    uint32_t bucket = time - time % tiers[tier].period_s;
+
+    if (aggregator.active && bucket != aggregator.bucket) {
+        emitAggregate(tier);
+    }
+    if (!aggregator.active) {
+        aggregator.active = true;
+        aggregator.bucket = bucket;
+        memset(aggregator.count, 0, sizeof(aggregator.count));
+        memset(aggregator.sum, 0, sizeof(aggregator.sum));
+    }
+
+    for (uint8_t c = 0; c < channel_count; c++) {
+        if (avg[c] == TS_MISSING_VALUE) continue;
+
+        if (aggregator.count[c] == 0) {
+            aggregator.min[c] = min[c];
+            aggregator.max[c] = max[c];
+        } else {
+            if (min[c] < aggregator.min[c]) aggregator.min[c] = min[c];
+            if (max[c] > aggregator.max[c]) aggregator.max[c] = max[c];
+        }
+        aggregator.sum[c] += avg[c];
+        aggregator.count[c]++;
+    }
+}
+
+void TimeSeriesStore::emitAggregate(Tier tier) {
+    Aggregator& aggregator = aggregators[tier];
+    int32_t values[TS_MAX_COLUMNS];
+    int32_t avg[TS_MAX_COLUMNS / 3];
+
+    for (uint8_t c = 0; c < channel_count; c++) {
+        bool empty = aggregator.count[c] == 0;
+        avg[c] = empty ? TS_MISSING_VALUE : (int32_t)lround(aggregator.sum[c] / aggregator.count[c]);
+        values[c * 3] = avg[c];
+        values[c * 3 + 1] = empty ? TS_MISSING_VALUE : aggregator.min[c];
+        values[c * 3 + 2] = empty ? TS_MISSING_VALUE : aggregator.max[c];
+    }
+
+    aggregator.active = false;
+    appendRow(tier, aggregator.bucket, values);
+
+    // 1 min alimenta 15 min preservando os extremos
+    if (tier + 1 < TIER_COUNT) {
+        feedAggregator((Tier)(tier + 1), aggregator.bucket, avg, aggregator.min, aggregator.max);
+    }
+}
+
+void TimeSeriesStore::closePage(Tier tier) {
+    TierState& state = tiers[tier];
+    uint32_t index = state.page.header().sequence - 1;
+    state.last_checkpoint = millis();
+    state.dirty = false;
+
+    // Início de segmento: as páginas antigas dele saem do índice
+    if (index % TS_SEGMENT_PAGES == 0) {
+        for (uint16_t i = 0; i < TS_SEGMENT_PAGES; i++) {
+            state.slot_first[state.head_slot + i] = 0;
+            state.slot_last[state.head_slot + i] = 0;
+        }
+    }
+
+    if (!state.ring->append(index, state.page.data())) {
+        Serial.printf("❌ TimeSeries: erro ao gravar página %lu de %s\n", (unsigned long)index, state.directory);
+        return;
+    }
+    state.slot_first[state.head_slot] = state.page.header().first_time;
+    state.slot_last[state.head_slot] = state.page.header().last_time;
+    state.page_writes++;
+    state.slots_used = index + 1 - state.ring->oldestKept(index);
+}
+
+void TimeSeriesStore::checkpoint(Tier tier) {
+    TierState& state = tiers[tier];
+    state.last_checkpoint = millis();
+    if (!state.dirty || state.page.isEmpty()) return;
+
+    // Só a página corrente, num arquivo próprio
+    File file = fs->open(state.head_path, "w");
+    bool ok = file && file.write(state.page.data(), TS_PAGE_SIZE) == TS_PAGE_SIZE;
+    if (file) file.close();
+
+    if (!ok) {
+        Serial.printf("❌ TimeSeries: erro ao gravar %s\n", state.head_path);
+        return;
+    }
+    state.page_writes++;
+    state.dirty = false;
+}
+
+void TimeSeriesStore::rowFromValues(Tier tier, uint32_t time, const int32_t* values, TimeSeriesRow& row) const {
+    row.time = time;
+    row.tier = tier;
+    row.columns = columnsFor(tier);
+    for (uint8_t c = 0; c < row.columns; c++) {
+        uint8_t channel = tier == TIER_RAW ? c : c / 3;
+        row.values[c] = values[c] == TS_MISSING_VALUE ? NAN : values[c] / scales[channel];
+    }
+}
+
+void TimeSeriesStore::lock() const {
+    if (mutex) xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void TimeSeriesStore::unlock() const {
+    if (mutex) xSemaphoreGive(mutex);
+}
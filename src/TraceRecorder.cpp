@@ -0,0 +1,316 @@
+#include "TraceRecorder.h"
+#include "LoopProfiler.h"
+#include <memory>
+#include <stdarg.h>
+
+namespace {
+
+/**
+ * @brief Estado de um envio em andamento (vive enquanto o TCP envia)
+ *
+ * Mesmo esquema do HistoryAPI: cada chamada do filler continua a partir
+ * de sequence; um trecho que não coube no buffer do TCP fica em pending.
+ */
+struct TraceExport {
+    enum Phase { PHASE_HEADER, PHASE_EVENTS, PHASE_FOOTER, PHASE_DONE };
+
+    TraceRecorder* recorder;
+    bool binary;
+    Phase phase;
+    uint32_t sequence;
+    uint32_t end;
+    uint32_t base_us;               // Menor início do anel (ts relativo, sem wrap do micros())
+    uint32_t emitted;
+
+    char pending[TRACE_LINE_SIZE];
+    size_t pending_len;
+    size_t pending_pos;
+
+    ~TraceExport() {
+        if (recorder) recorder->endExport();
+    }
+
+    void stage(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(pending + pending_len, sizeof(pending) - pending_len, format, args);
+        va_end(args);
+        if (length > 0) {
+            pending_len += min((size_t)length, sizeof(pending) - pending_len - 1);
+        }
+    }
+
+    void stageBytes(const void* data, size_t length) {
+        length = min(length, sizeof(pending) - pending_len);
+        memcpy(pending + pending_len, data, length);
+        pending_len += length;
+    }
+
+    void stageString(const char* text) {
+        stageBytes(text, strlen(text) + 1);
+    }
+
+    size_t drain(uint8_t* out, size_t max_len, size_t written) {
+        size_t length = min(pending_len - pending_pos, max_len - written);
+        memcpy(out + written, pending + pending_pos, length);
+        pending_pos += length;
+        if (pending_pos == pending_len) {
+            pending_len = 0;
+            pending_pos = 0;
+        }
+        return written + length;
+    }
+
+    bool hasPending() const { return pending_len > 0; }
+
+    /**
+     * @brief Eventos do anel podem terminar fora de ordem (o escopo externo
+     * grava depois do interno); a base é o menor início, em aritmética
+     * modular em relação ao primeiro
+     */
+    void computeBase() {
+        TraceEvent event;
+        bool first = true;
+        int32_t lowest = 0;
+        for (uint32_t seq = sequence; seq < end; seq++) {
+            if (!recorder->readEvent(seq, event)) continue;
+            if (first) {
+                base_us = event.start_us;
+                first = false;
+                continue;
+            }
+            int32_t offset = (int32_t)(event.start_us - base_us);
+            if (offset < lowest) lowest = offset;
+        }
+        base_us += lowest;
+    }
+
+    void stageHeader() {
+        LoopProfiler& profiler = LoopProfiler::shared();
+        uint8_t sections = profiler.getSectionCount();
+        uint8_t tracks = recorder->getTrackCount();
+
+        if (binary) {
+            // magic, versão, tamanho do registro, eventos, perdidos, base, nº de seções e tracks
+            uint16_t version = TRACE_BINARY_VERSION;
+            uint16_t record_size = sizeof(TraceEvent);
+            uint32_t count = end - sequence;
+            uint32_t dropped = recorder->getDropped();
+            stageBytes(TRACE_BINARY_MAGIC, 4);
+            stageBytes(&version, sizeof(version));
+            stageBytes(&record_size, sizeof(record_size));
+            stageBytes(&count, sizeof(count));
+            stageBytes(&dropped, sizeof(dropped));
+            stageBytes(&base_us, sizeof(base_us));
+            stageBytes(&sections, sizeof(sections));
+            stageBytes(&tracks, sizeof(tracks));
+            uint16_t reserved = 0;
+            stageBytes(&reserved, sizeof(reserved));
+            return;
+        }
+
+        stage("{\"displayTimeUnit\":\"ms\",\"otherData\":{\"base_us\":%lu,\"dropped\":%lu},\"traceEvents\":["
+              "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ESP32 HydroWave\"}}",
+              (unsigned long)base_us, (unsigned long)recorder->getDropped());
+    }
+
+    /**
+     * @brief Nomes de seções e tracks (binário) ou metadados de thread (JSON)
+     */
+    bool stageName(uint32_t index) {
+        LoopProfiler& profiler = LoopProfiler::shared();
+        uint8_t sections = profiler.getSectionCount();
+        uint8_t tracks = recorder->getTrackCount();
+
+        if (binary) {
+            if (index < sections) {
+                stageString(profiler.getSectionName(index));
+                return true;
+            }
+            if (index < (uint32_t)sections + tracks) {
+                stageString(recorder->getTrackName(index - sections));
+                return true;
+            }
+            return false;
+        }
+
+        if (index >= tracks) return false;
+        stage(",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+              (unsigned long)index, recorder->getTrackName(index));
+        return true;
+    }
+
+    void stageEvent(const TraceEvent& event) {
+        if (binary) {
+            stageBytes(&event, sizeof(event));
+            return;
+        }
+        const char* name = LoopProfiler::shared().getSectionName(event.section);
+        stage(",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"core\":%u}}",
+              name ? name : "?", (unsigned long)(event.start_us - base_us),
+              (unsigned long)event.duration_us, event.track, event.core);
+    }
+
+    /**
+     * @brief Preenche até max_len bytes; 0 = resposta completa
+     */
+    size_t fill(uint8_t* out, size_t max_len) {
+        size_t written = drain(out, max_len, 0);
+
+        while (written < max_len && phase != PHASE_DONE) {
+            if (hasPending()) break;
+
+            switch (phase) {
+                case PHASE_HEADER:
+                    // emitted conta os nomes já enviados nesta fase
+                    if (!stageName(emitted++)) {
+                        emitted = 0;
+                        phase = PHASE_EVENTS;
+                    }
+                    break;
+
+                case PHASE_EVENTS: {
+                    TraceEvent event;
+                    while (sequence < end && !hasPending()) {
+                        if (recorder->readEvent(sequence++, event)) {
+                            stageEvent(event);
+                            emitted++;
+                        }
+                    }
+                    if (sequence >= end && !hasPending()) phase = PHASE_FOOTER;
+                    break;
+                }
+
+                case PHASE_FOOTER:
+                    if (!binary) stage("]}");
+                    phase = PHASE_DONE;
+                    break;
+
+                case PHASE_DONE:
+                    break;
+            }
+            written = drain(out, max_len, written);
+        }
+        return written;
+    }
+};
+
+}  // namespace
+
+// ===== INSTÂNCIA =====
+TraceRecorder& TraceRecorder::shared() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder() :
+    enabled(TRACE_ENABLED_AT_BOOT),
+    exporting(false),
+    head(0),
+    dropped(0),
+    track_count(0) {
+    spinlock = portMUX_INITIALIZER_UNLOCKED;
+    memset(events, 0, sizeof(events));
+    memset(tracks, 0, sizeof(tracks));
+}
+
+// ===== GRAVAÇÃO =====
+void TraceRecorder::record(int8_t section, uint32_t start_us, uint32_t duration_us) {
+    if (!enabled || section < 0) return;
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&spinlock);
+    int8_t track = trackFor(task);
+    if (exporting || track < 0) {
+        dropped++;
+        portEXIT_CRITICAL(&spinlock);
+        return;
+    }
+
+    TraceEvent& event = events[head % TRACE_RING_EVENTS];
+    event.start_us = start_us;
+    event.duration_us = duration_us;
+    event.section = section;
+    event.track = track;
+    event.core = xPortGetCoreID();
+    event.reserved = 0;
+    head++;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+// ===== CONSULTA =====
+void TraceRecorder::attach(AsyncWebServer* server, const char* uri) {
+    server->on(uri, HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (request->hasParam("enable")) {
+            setEnabled(request->getParam("enable")->value() != "0");
+            request->send(200, "application/json", enabled ? "{\"enabled\":true}" : "{\"enabled\":false}");
+            return;
+        }
+
+        if (!beginExport()) {
+            request->send(503, "application/json", "{\"error\":\"Trace já em envio\"}");
+            return;
+        }
+
+        // make_shared inicializa por valor: todos os campos zerados
+        std::shared_ptr<TraceExport> state = std::make_shared<TraceExport>();
+        state->recorder = this;
+        state->binary = request->hasParam("format") && request->getParam("format")->value() == "bin";
+        state->phase = TraceExport::PHASE_HEADER;
+        state->sequence = getFirstSequence();
+        state->end = getEndSequence();
+        state->computeBase();
+        state->stageHeader();
+
+        AsyncWebServerResponse* response = request->beginChunkedResponse(
+            state->binary ? "application/octet-stream" : "application/json",
+            [state](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+                return state->fill(buffer, max_len);
+            });
+        response->addHeader("Cache-Control", "no-cache");
+        response->addHeader("Content-Disposition", state->binary ? "attachment; filename=\"trace.bin\"" :
+                                                                   "attachment; filename=\"trace.json\"");
+        request->send(response);
+    });
+}
+
+bool TraceRecorder::beginExport() {
+    portENTER_CRITICAL(&spinlock);
+    bool started = !exporting;
+    exporting = true;
+    portEXIT_CRITICAL(&spinlock);
+    return started;
+}
+
+void TraceRecorder::endExport() {
+    portENTER_CRITICAL(&spinlock);
+    exporting = false;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+uint32_t TraceRecorder::getFirstSequence() const {
+    return head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+}
+
+bool TraceRecorder::readEvent(uint32_t sequence, TraceEvent& out) const {
+    if (sequence < getFirstSequence() || sequence >= head) return false;
+    out = events[sequence % TRACE_RING_EVENTS];
+    return true;
+}
+
+const char* TraceRecorder::getTrackName(uint8_t track) const {
+    return track < track_count ? tracks[track].name : "?";
+}
+
+// ===== MÉTODOS INTERNOS =====
+int8_t TraceRecorder::trackFor(TaskHandle_t handle) {
+    for (uint8_t i = 0; i < track_count; i++) {
+        if (tracks[i].handle == handle) return i;
+    }
+    if (track_count >= TRACE_MAX_TRACKS) return -1;
+
+    Track& track = tracks[track_count];
+    track.handle = handle;
+    snprintf(track.name, sizeof(track.name), "%s", pcTaskGetTaskName(handle));
+    return track_count++;
+}
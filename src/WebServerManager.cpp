@@ -1,5 +1,8 @@
 #include "WebServerManager.h"
 #include "Config.h"
+#include "LoopProfiler.h"
+#include "TraceRecorder.h"
+#include "HeapMonitor.h"
 #include <SPIFFS.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
@@ -19,7 +22,8 @@ WebServerManager::WebServerManager() :
     relayStates(nullptr),
     tempRef(nullptr),
     phRef(nullptr),
-    tdsRef(nullptr) {
+    tdsRef(nullptr),
+    timeSeries(nullptr) {
 }
 
 WebServerManager::~WebServerManager() {
@@ -54,40 +58,35 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     // IMPORTANTE: Este servidor só funciona quando WiFi está conectado (modo Station)
     // NÃO interfere com o Access Point do WiFiManager (modo AP)
     adminServer = new AsyncWebServer(80);
+    assets.begin();
     
-    // ✅ USAR ARQUIVO index.html DO SPIFFS PARA PÁGINA PRINCIPAL
-    adminServer->serveStatic("/", SPIFFS, "/").setDefaultFile("index.html");
+    // ✅ USAR ARQUIVO index.html DO SPIFFS PARA PÁGINA PRINCIPAL (gzip + ETag)
+    assets.attach(adminServer, "/", "/index.html");
+    assets.attach(adminServer, "/index.html", "/index.html");
     
     // ✅ Servir arquivos estáticos (CSS, JS)
-    adminServer->serveStatic("/style.css", SPIFFS, "/style.css");
-    adminServer->serveStatic("/script.js", SPIFFS, "/script.js");
+    assets.attach(adminServer, "/style.css", "/style.css");
+    assets.attach(adminServer, "/script.js", "/script.js");
     
-    // ✅ API para informações do dispositivo
-    adminServer->on("/api/device-info", HTTP_GET, [&wifiManager](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(512);
-        
-        // Debug: obtener device_id con logs
-        String deviceId = wifiManager.getDeviceID();
-        Serial.printf("🔍 WebServer: Device ID solicitado: %s\n", deviceId.c_str());
-        Serial.printf("🔍 WebServer: MAC Address: %s\n", WiFi.macAddress().c_str());
-        
-        doc["device_id"] = deviceId;
+    // Demais arquivos do SPIFFS (sem manifesto de cache)
+    assets.attachFallback(adminServer);
+    
+    // ===== SNAPSHOTS DA API =====
+    // Serializados uma vez por geração; vários operadores no dashboard
+    // recebem o mesmo buffer (e 304 quando o ETag ainda vale)
+    int8_t deviceInfoTopic = snapshots.registerTopic("device-info", [&wifiManager](String& out) {
+        TaggedJsonDocument doc("web.api", 512);
+        doc["device_id"] = wifiManager.getDeviceID();
         doc["firmware_version"] = wifiManager.getFirmwareVersion();
         doc["ip_address"] = wifiManager.getStationIP();
         doc["connected"] = wifiManager.isConnected();
         doc["uptime"] = millis() / 1000;
         doc["free_heap"] = ESP.getFreeHeap();
-        
-        String response;
-        serializeJson(doc, response);
-        Serial.printf("🔍 WebServer: Respuesta JSON: %s\n", response.c_str());
-        
-        request->send(200, "application/json", response);
-    });
+        serializeJson(doc, out);
+    }, nullptr, 1000);
     
-    // ✅ API para sensores (COMPATÍVEL COM index.html)
-    adminServer->on("/api/sensors", HTTP_GET, [&hydroControl](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(512);
+    int8_t sensorsTopic = snapshots.registerTopic("sensors", [&hydroControl](String& out) {
+        TaggedJsonDocument doc("web.api", 512);
         doc["temperature"] = hydroControl.getTemperature();
         doc["humidity"] = 65.0; // Simulated - implementar DHT22 se necessário
         doc["ph"] = hydroControl.getpH();
@@ -95,15 +94,20 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
         doc["water_level_ok"] = hydroControl.isWaterLevelOk();
         doc["temp_water"] = hydroControl.getTemperature(); // Mesmo sensor por enquanto
         doc["timestamp"] = millis();
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
-    });
+        serializeJson(doc, out);
+    }, [&hydroControl]() { return hydroControl.getSensorGeneration(); });
     
-    // ✅ API para relés (COMPATÍVEL COM index.html)
-    adminServer->on("/api/relays", HTTP_GET, [&hydroControl, this](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(1024);
+    // Qualidade e idade das amostras envelhecem sem nova leitura: idade máxima de 1s
+    int8_t channelsTopic = snapshots.registerTopic("sensor-channels", [&hydroControl](String& out) {
+        out = hydroControl.getSensorBus().getStatusJSON(millis());
+    }, [&hydroControl]() { return hydroControl.getSensorGeneration(); }, 1000);
+    
+    int8_t healthTopic = snapshots.registerTopic("sensor-health", [&hydroControl](String& out) {
+        out = hydroControl.getSensorHealth().getStatusJSON();
+    }, [&hydroControl]() { return hydroControl.getSensorGeneration(); }, 1000);
+    
+    int8_t relaysTopic = snapshots.registerTopic("relays", [&hydroControl, this](String& out) {
+        TaggedJsonDocument doc("web.api", 1024);
         JsonArray relays = doc.createNestedArray("relays");
         
         bool* relayStates = hydroControl.getRelayStates();
@@ -113,11 +117,154 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
             relay["state"] = relayStates[i];
             relay["name"] = this->getRelayName(i);
         }
-        
+        serializeJson(doc, out);
+    }, [&hydroControl]() { return hydroControl.getRelayGeneration(); });
+    
+    int8_t systemTopic = snapshots.registerTopic("system-status", [](String& out) {
+        TaggedJsonDocument doc("web.api", 512);
+        doc["system_initialized"] = systemInitialized;
+        doc["supabase_connected"] = supabaseConnected;
+        doc["web_server_running"] = webServerRunning;
+        doc["free_heap"] = ESP.getFreeHeap();
+        doc["uptime_seconds"] = millis() / 1000;
+        serializeJson(doc, out);
+    }, []() { return (uint32_t)systemInitialized | (uint32_t)supabaseConnected << 1 | (uint32_t)webServerRunning << 2; }, 1000);
+    
+    // ✅ API para informações do dispositivo
+    snapshots.attach(adminServer, "/api/device-info", deviceInfoTopic);
+    
+    // ✅ API para sensores (COMPATÍVEL COM index.html)
+    snapshots.attach(adminServer, "/api/sensors", sensorsTopic);
+    
+    // ✅ API do registro de sensores (todos os canais, com unidade e qualidade)
+    snapshots.attach(adminServer, "/api/sensor-channels", channelsTopic);
+
+    // ✅ API de saúde dos sensores
+    snapshots.attach(adminServer, "/api/sensor-health", healthTopic);
+
+    // Reconhece a falta de resposta a doses (sonda limpa/trocada); sem "sensor" = todos
+    adminServer->on("/api/sensor-health/reset", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
+        SensorChannel channel = SENSOR_CHANNEL_COUNT;
+        if (request->hasParam("sensor", true)) {
+            String name = request->getParam("sensor", true)->value();
+            if (name == "ph") channel = SENSOR_PH;
+            else if (name == "tds" || name == "ec") channel = SENSOR_TDS;
+            else if (name == "temp_water") channel = SENSOR_WATER_TEMP;
+            else {
+                request->send(400, "application/json", "{\"error\":\"Unknown sensor\"}");
+                return;
+            }
+        }
+        hydroControl.getSensorHealth().acknowledgeResponse(channel);
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+    
+    // ✅ Estatísticas do cache de snapshots (builds x hits x 304)
+    adminServer->on("/api/cache-status", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", snapshots.getStatusJSON());
+    });
+    
+    adminServer->on("/api/assets", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", assets.getStatusJSON());
+    });
+    
+    // ✅ SSE: /events (ao vivo) e /events/kiosk (displays)
+    events.begin(adminServer, hydroControl);
+    adminServer->on("/api/events-status", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", events.getStatusJSON());
+    });
+    
+    // ✅ Tempos do loop, por subsistema e por task (?reset=1 zera)
+    LoopProfiler::shared().attach(adminServer, "/api/perf");
+    
+    // ✅ Timeline das mesmas seções (chrome://tracing / Perfetto)
+    TraceRecorder::shared().attach(adminServer, "/api/trace");
+    
+    // ✅ Fragmentação, tendência e retenção por subsistema (?history=1, ?reset=1)
+    HeapMonitor::shared().attach(adminServer, "/api/heap");
+    
+    // ✅ Histórico: /api/history (série reduzida, chunked direto da flash)
+    if (timeSeries) {
+        history.begin(adminServer, *timeSeries);
+    }
+
+    // ✅ API de calibração do pH
+    adminServer->on("/api/ph-calibration", HTTP_GET, [&hydroControl](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", hydroControl.getPHCalibration().getStatusJSON());
+    });
+
+    // Registra a leitura atual como um ponto (tampão informado em "ph")
+    adminServer->on("/api/ph-calibration/point", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
+        if (!request->hasParam("ph", true)) {
+            request->send(400, "application/json", "{\"error\":\"Missing ph parameter\"}");
+            return;
+        }
+
+        const SensorSampleStore& store = hydroControl.getSensorStore();
+        SensorSample voltage, temp;
+        if (!store.read(SENSOR_PH_VOLTAGE, voltage) || !store.isFresh(SENSOR_PH_VOLTAGE, 5000, millis())) {
+            request->send(503, "application/json", "{\"error\":\"No recent pH reading\"}");
+            return;
+        }
+        float temperature = (store.read(SENSOR_WATER_TEMP, temp) && temp.valid) ? temp.value : PH_CAL_REFERENCE_TEMP;
+
+        PHCalibration& cal = hydroControl.getPHCalibration();
+        float buffer_ph = request->getParam("ph", true)->value().toFloat();
+        String error;
+        if (!cal.addPoint(buffer_ph, voltage.value, temperature, error)) {
+            TaggedJsonDocument doc("web.api", 256);
+            doc["error"] = error;
+            String response;
+            serializeJson(doc, response);
+            request->send(400, "application/json", response);
+            return;
+        }
+
+        TaggedJsonDocument doc("web.api", 256);
+        doc["success"] = true;
+        doc["ph"] = buffer_ph;
+        doc["voltage"] = voltage.value;
+        doc["temperature"] = temperature;
+        doc["session_points"] = cal.getSessionPointCount();
         String response;
         serializeJson(doc, response);
         request->send(200, "application/json", response);
     });
+
+    // Ajusta a curva com os pontos da sessão (mode=piecewise|least_squares)
+    adminServer->on("/api/ph-calibration/commit", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
+        PHFitMode mode = PH_FIT_PIECEWISE;
+        if (request->hasParam("mode", true) &&
+            request->getParam("mode", true)->value() == "least_squares") {
+            mode = PH_FIT_LEAST_SQUARES;
+        }
+
+        PHCalibration& cal = hydroControl.getPHCalibration();
+        String error;
+        if (!cal.commit(mode, error)) {
+            TaggedJsonDocument doc("web.api", 256);
+            doc["error"] = error;
+            String response;
+            serializeJson(doc, response);
+            request->send(400, "application/json", response);
+            return;
+        }
+        request->send(200, "application/json", cal.getStatusJSON());
+    });
+
+    adminServer->on("/api/ph-calibration/cancel", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
+        hydroControl.getPHCalibration().cancelSession();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+
+    // Sonda trocada: zera horas de uso e a inclinação de referência
+    adminServer->on("/api/ph-calibration/new-probe", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
+        hydroControl.getPHCalibration().markNewProbe();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+
+    // ✅ API para relés (COMPATÍVEL COM index.html)
+    snapshots.attach(adminServer, "/api/relays", relaysTopic);
     
     // ✅ API para toggle de relés (COMPATÍVEL COM index.html)
     adminServer->on("/api/relay", HTTP_POST, [&hydroControl](AsyncWebServerRequest *request) {
@@ -132,7 +279,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
             if (relay >= 0 && relay < 16) {
                 hydroControl.toggleRelay(relay, duration);
                 
-                DynamicJsonDocument doc(256);
+                TaggedJsonDocument doc("web.api", 256);
                 doc["success"] = true;
                 doc["relay"] = relay;
                 doc["new_state"] = hydroControl.getRelayStates()[relay];
@@ -152,18 +299,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     });
     
     // ✅ API para status do sistema
-    adminServer->on("/api/system-status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(512);
-        doc["system_initialized"] = systemInitialized;
-        doc["supabase_connected"] = supabaseConnected;
-        doc["web_server_running"] = webServerRunning;
-        doc["free_heap"] = ESP.getFreeHeap();
-        doc["uptime_seconds"] = millis() / 1000;
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
-    });
+    snapshots.attach(adminServer, "/api/system-status", systemTopic);
     
     // ✅ API de compatibilidade (mantendo endpoints antigos)
     adminServer->on("/api/supabase-status", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -188,7 +324,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     
     // ✅ Reset do sistema
     adminServer->on("/reset", HTTP_GET, [](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(128);
+        TaggedJsonDocument doc("web.api", 128);
         doc["success"] = true;
         doc["message"] = "Sistema reiniciando em 3 segundos...";
         
@@ -203,7 +339,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     
     // ✅ API Reset do sistema (endpoint compatível com interface)
     adminServer->on("/api/reset", HTTP_GET, [](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(128);
+        TaggedJsonDocument doc("web.api", 128);
         doc["success"] = true;
         doc["message"] = "Sistema reiniciando em 3 segundos...";
         
@@ -223,7 +359,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     
     // ✅ Reconfiguração WiFi
     adminServer->on("/reconfigure-wifi", HTTP_GET, [&wifiManager](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(128);
+        TaggedJsonDocument doc("web.api", 128);
         doc["success"] = true;
         doc["message"] = "Resetando WiFi e voltando ao modo AP...";
         
@@ -244,7 +380,7 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
     
     // ✅ API Reconfiguração WiFi (endpoint compatível com interface)
     adminServer->on("/api/reconfigure-wifi", HTTP_GET, [](AsyncWebServerRequest *request) {
-        DynamicJsonDocument doc(128);
+        TaggedJsonDocument doc("web.api", 128);
         doc["success"] = true;
         doc["message"] = "Resetando WiFi e voltando ao modo AP...";
         
@@ -286,7 +422,8 @@ void WebServerManager::beginAdminServer(WiFiManager& wifiManager, HydroControl&
 }
 
 void WebServerManager::update() {
-    // Implementação futura se necessário
+    // Coalesce e envia o stream SSE
+    events.loop();
 }
 
 void WebServerManager::setupUnifiedRoutes() {
@@ -57,15 +57,14 @@ bool WiFiConfigServer::begin() {
     
     // Criar servidor HTTP
     server = new AsyncWebServer(80);
+    assets.begin();
     
     // ===== PÁGINA PRINCIPAL =====
-    server->on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
+    assets.attach(server, "/", [this](AsyncWebServerRequest *request) {
         if (!checkConnectionLimit(request)) return;
         
-        // Servir HTML do SPIFFS
-        if (SPIFFS.exists("/wifi-setup.html")) {
-            request->send(SPIFFS, "/wifi-setup.html", "text/html");
-        } else {
+        // Servir HTML do SPIFFS (gzip + ETag quando há manifesto)
+        if (!assets.serve(request, "/wifi-setup.html")) {
             // Fallback simples caso o arquivo não exista
             String fallbackHtml = "<!DOCTYPE html><html><head><title>WiFi Setup</title></head><body>";
             fallbackHtml += "<h1>ESP32 WiFi Setup</h1>";
@@ -17,6 +17,9 @@
 #include "SafetyWatchdog.h"
 #include "AutoCommunicationManager.h"  // 🧠 PILAR INTELIGENTE
 #include "ESPNowTask.h"  // 🚀 TASK DEDICADA ESP-NOW
+#include "Logger.h"
+#include "LoopProfiler.h"
+#include "HeapMonitor.h"
 #include "RelayBridge.h"  // 🌉 CAPA DE TRADUCCIÓN SUPABASE ↔ ESP-NOW
 #include <vector>
 
@@ -118,6 +121,9 @@ void handleSlaveRelayCommand(const String& command);
 
 // Função de proteção global de memória SIMPLIFICADA
 void globalMemoryProtection() {
+    // Maior bloco, fragmentação e tendência (/api/heap)
+    HeapMonitor::shared().loop();
+    
     if(millis() - lastMemoryCheck < 10000) return; // A cada 10s
     
     uint32_t freeHeap = ESP.getFreeHeap();
@@ -129,10 +135,12 @@ void globalMemoryProtection() {
     HydroSystemState currentState = stateManager.getCurrentState();
     
     // DEBUG SIMPLIFICADO POR ESTADO
-    Serial.printf("🔄 [%s] Heap: %d bytes (%.1f%%) | Uptime: %ds\n", 
+    Serial.printf("🔄 [%s] Heap: %d bytes (%.1f%%) | Maior bloco: %d (frag %u%%) | Uptime: %ds\n", 
                   stateManager.getStateString().c_str(),
                   freeHeap, 
                   (freeHeap*100.0)/totalHeap,
+                  maxBlock,
+                  HeapMonitor::shared().getFragmentation(),
                   (millis()-systemStartTime)/1000);
     
     // ALERTAS CRÍTICOS
@@ -151,6 +159,7 @@ void emergencyProtection() {
     // RESET CRÍTICO: Heap muito baixo
     if(freeHeap < 8000) {
         Serial.println("💀 RESET EMERGENCIAL - Heap crítico: " + String(freeHeap) + " bytes");
+        HeapMonitor::shared().recordRestart("heap_critical");
         delay(1000);
         ESP.restart();
     }
@@ -159,6 +168,7 @@ void emergencyProtection() {
     uint32_t fragmentationPercent = freeHeap > 0 ? (100 - (maxBlock*100)/freeHeap) : 100;
     if(freeHeap > 15000 && fragmentationPercent > 85) {
         Serial.println("🧩 RESET EMERGENCIAL - Fragmentação extrema: " + String(fragmentationPercent) + "%");
+        HeapMonitor::shared().recordRestart("fragmentation");
         delay(1000);
         ESP.restart();
     }
@@ -1747,6 +1757,12 @@ void setup() {
     Serial.begin(115200);
     delay(1000);
     
+    // Logs dos módulos saem por uma task própria (não bloqueiam o loop)
+    Logger::shared().begin();
+    
+    // Relatório de heap do boot anterior (se reiniciou por memória)
+    HeapMonitor::shared().begin();
+    
     systemStartTime = millis();
     
     // PROTEÇÃO GLOBAL - Watchdog com timeout maior
@@ -1989,28 +2005,42 @@ void setup() {
 }
 
 void loop() {
+    // Duração de cada iteração em /api/perf (conta o delay após o
+    // stateManager; o delay final fica de fora)
+    LoopProfiler::shared().loopStart();
+    
     // PROTEÇÃO GLOBAL (sempre ativa)
     esp_task_wdt_reset();
-    emergencyProtection();
-    globalMemoryProtection();
+    {
+        PROFILE_SCOPE("loop.protection");
+        emergencyProtection();
+        globalMemoryProtection();
+    }
     
     // GERENCIADOR DE ESTADOS (orquestrador principal)
-    stateManager.loop();
+    {
+        PROFILE_SCOPE("state.loop");
+        stateManager.loop();
+    }
     delay(100); // ✅ CORRIGIDO: Delay reduzido para evitar watchdog timeout
     
     // ===== ATUALIZAÇÕES ESP-NOW =====
 #ifdef MASTER_MODE
     // 🌉 RELAY BRIDGE - Processar comandos de Supabase
     if (relayBridge) {
+        PROFILE_SCOPE("relay_bridge.update");
         relayBridge->update();  // Polling automático de Supabase → ESP-NOW
     }
     
     // 🧠 SISTEMA INTELIGENTE (prioritário)
     if (autoComm) {
+        PROFILE_SCOPE("auto_comm.update");
         autoComm->update();  // ✨ CÉREBRO da comunicação
     }
     
     if (masterBridge) {
+        PROFILE_SCOPE("espnow.master");
+        
         // Alimentar watchdog de hardware (crítico)
         watchdog.feed();
         
@@ -2058,6 +2088,7 @@ void loop() {
     // COMANDOS SERIAIS
     handleGlobalSerialCommands();
     
+    LoopProfiler::shared().loopEnd();
     delay(100);
 }
 
@@ -0,0 +1,59 @@
+# Testes do scripts/trace_to_chrome.py (rodar com: python3 -m pytest test/scripts)
+#
+# fixtures/trace.bin é um GET /api/trace?format=bin com 50 eventos em 3
+# seções e 2 tracks, 7 perdidos e micros() dando a volta no meio;
+# fixtures/trace.json é o GET /api/trace (JSON gerado no dispositivo)
+# do mesmo anel. A conversão do binário precisa dar exatamente o mesmo.
+
+import json
+import subprocess
+import sys
+from pathlib import Path
+
+import pytest
+
+ROOT = Path(__file__).resolve().parents[2]
+SCRIPT = ROOT / "scripts" / "trace_to_chrome.py"
+FIXTURES = Path(__file__).resolve().parent / "fixtures"
+
+sys.path.insert(0, str(SCRIPT.parent))
+import trace_to_chrome  # noqa: E402
+
+
+def run(*args):
+    return subprocess.run([sys.executable, str(SCRIPT), *map(str, args)],
+                          capture_output=True, text=True)
+
+
+def test_binary_matches_device_json(tmp_path):
+    output = tmp_path / "trace.json"
+    result = run(FIXTURES / "trace.bin", "-o", output)
+    assert result.returncode == 0, result.stderr
+    assert output.read_text() == (FIXTURES / "trace.json").read_text()
+
+
+def test_wrapped_micros_stay_relative_to_base():
+    trace = trace_to_chrome.convert((FIXTURES / "trace.bin").read_bytes())
+    spans = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+    assert len(spans) == 50
+    assert trace["otherData"]["dropped"] == 7
+    assert all(0 <= event["ts"] < 10000 for event in spans)
+
+
+def test_truncated_file_keeps_complete_records(capsys):
+    data = (FIXTURES / "trace.bin").read_bytes()
+    trace = trace_to_chrome.convert(data[:-10])
+    spans = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+    assert len(spans) == 49
+    assert "truncado" in capsys.readouterr().err
+
+
+def test_rejects_foreign_file(tmp_path):
+    bogus = tmp_path / "bogus.bin"
+    bogus.write_bytes(b"NOPE" + bytes(40))
+    result = run(bogus)
+    assert result.returncode == 1
+    assert "magic" in result.stderr
+
+    with pytest.raises(ValueError):
+        trace_to_chrome.convert(b"HW")
@@ -0,0 +1,175 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Núcleo Arduino mínimo para os testes no host (pio test -e native).
+// Só o que os módulos testados usam; millis() é um relógio manual.
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h"                // O core do ESP32 também traz o FreeRTOS
+#include "freertos/task.h"
+
+using std::min;
+using std::max;
+
+#define HEX 16
+
+#ifndef constrain
+  #define constrain(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+#endif
+
+// ===== TEMPO =====
+namespace native {
+inline unsigned long& clockMs() {
+    static unsigned long now = 0;
+    return now;
+}
+inline void setMillis(unsigned long now) { clockMs() = now; }
+inline void advanceMillis(unsigned long delta) { clockMs() += delta; }
+}  // namespace native
+
+inline unsigned long millis() { return native::clockMs(); }
+inline unsigned long micros() { return native::clockMs() * 1000UL; }
+inline void delay(unsigned long ms) { native::advanceMillis(ms); }
+inline void yield() {}
+
+// ===== STRING =====
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number, unsigned char base = 10) : value(format(number, base)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number, unsigned char base = 10) : value(format(number, base)) {}
+    String(float number, unsigned int decimals = 2) : value(format(number, decimals)) {}
+    String(double number, unsigned int decimals = 2) : value(format(number, decimals)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* other) { value += other ? other : ""; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    bool concat(const char* other, unsigned int length) { value.append(other, length); return true; }
+
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == (other ? other : ""); }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool equals(const String& other) const { return value == other.value; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t position = value.find(c, from);
+        return position == std::string::npos ? -1 : (int)position;
+    }
+    int indexOf(const char* text, unsigned int from = 0) const {
+        size_t position = value.find(text, from);
+        return position == std::string::npos ? -1 : (int)position;
+    }
+    bool startsWith(const char* prefix) const { return value.compare(0, strlen(prefix), prefix) == 0; }
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < value.size() && to > from ? String(value.substr(from, to - from)) : String();
+    }
+    void replace(const char* from, const char* to) {
+        size_t length = strlen(from);
+        if (length == 0) return;
+        for (size_t at = value.find(from); at != std::string::npos; at = value.find(from, at + strlen(to))) {
+            value.replace(at, length, to);
+        }
+    }
+    void trim() {
+        size_t first = value.find_first_not_of(" \t\r\n");
+        size_t last = value.find_last_not_of(" \t\r\n");
+        value = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+    }
+    void toUpperCase() { for (char& c : value) c = toupper((unsigned char)c); }
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float)atof(value.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const String& a, const char* b) { return String(a.value + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.value); }
+
+private:
+    std::string value;
+
+    static std::string format(double number, unsigned int decimals) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+        return buffer;
+    }
+    static std::string format(unsigned long number, unsigned char base) {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), base == HEX ? "%lx" : "%lu", number);
+        return buffer;
+    }
+};
+
+// ===== SERIAL =====
+// Silenciosa: a saída dos testes fica só com o Unity (NATIVE_SERIAL=1 mostra)
+class NativeSerial {
+public:
+    void begin(unsigned long) {}
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = enabled() ? vprintf(format, args) : vsnprintf(nullptr, 0, format, args);
+        va_end(args);
+        return length;
+    }
+    template <typename T> void print(const T& value) { if (enabled()) write(value); }
+    template <typename T> void println(const T& value) { if (enabled()) { write(value); putchar('\n'); } }
+    void println() { if (enabled()) putchar('\n'); }
+    size_t write(const uint8_t* buffer, size_t length) {
+        if (enabled()) fwrite(buffer, 1, length, stdout);
+        if (captured) captured->append((const char*)buffer, length);
+        return length;
+    }
+    void flush() { fflush(stdout); }
+
+    // ===== AUXILIARES DOS TESTES =====
+    // Guarda o que passa por write(buffer, length) (nullptr desliga)
+    void capture(std::string* out) { captured = out; }
+
+private:
+    std::string* captured = nullptr;
+
+    static bool enabled() {
+        static const bool on = getenv("NATIVE_SERIAL") != nullptr;
+        return on;
+    }
+    void write(const String& value) { fputs(value.c_str(), stdout); }
+    void write(const char* value) { fputs(value, stdout); }
+    template <typename T> void write(const T& value) { fputs(String(value).c_str(), stdout); }
+};
+
+inline NativeSerial Serial;
+
+// ===== CHIP =====
+class EspClass {
+public:
+    uint64_t getEfuseMac() { return 0x0000ABCDEF286F24ULL; }
+    const char* getChipModel() { return "ESP32-native"; }
+    uint8_t getChipRevision() { return 3; }
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+
+inline EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
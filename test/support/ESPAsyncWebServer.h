@@ -0,0 +1,331 @@
+#ifndef NATIVE_ESP_ASYNC_WEB_SERVER_H
+#define NATIVE_ESP_ASYNC_WEB_SERVER_H
+
+// ESPAsyncWebServer mínimo, com o mesmo fluxo do 1.2.x:
+// linha da requisição -> canHandle() dos handlers em ordem ->
+// cabeçalhos (só os declarados com addInterestingHeader) -> handleRequest().
+// AsyncWebServer::dispatch() roda uma requisição e devolve a resposta.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <strings.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum WebRequestMethod : uint8_t {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111
+};
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerRequest;
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+// ===== CABEÇALHOS E PARÂMETROS =====
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : header_name(name), header_value(value) {}
+    const String& name() const { return header_name; }
+    const String& value() const { return header_value; }
+
+private:
+    String header_name;
+    String header_value;
+};
+
+class AsyncWebParameter {
+public:
+    AsyncWebParameter(const String& name, const String& value, bool post) :
+        param_name(name), param_value(value), post(post) {}
+    const String& name() const { return param_name; }
+    const String& value() const { return param_value; }
+    bool isPost() const { return post; }
+
+private:
+    String param_name;
+    String param_value;
+    bool post;
+};
+
+// ===== RESPOSTA =====
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse(int code, const String& content_type, const std::string& body) :
+        status(code), type(content_type), content(body), length(body.size()) {}
+    AsyncWebServerResponse(const String& content_type, size_t length, AwsResponseFiller filler) :
+        status(200), type(content_type), length(length), filler(filler) {}
+    virtual ~AsyncWebServerResponse() {}
+
+    void addHeader(const String& name, const String& value) {
+        headers[name.c_str()] = value.c_str();
+    }
+
+    // ===== AUXILIARES DOS TESTES =====
+    static const size_t CHUNKED = (size_t)-1;
+
+    int code() const { return status; }
+    const String& contentType() const { return type; }
+    std::string header(const char* name) const {
+        auto it = headers.find(name);
+        return it == headers.end() ? std::string() : it->second;
+    }
+    bool hasHeader(const char* name) const { return headers.count(name) > 0; }
+
+    /**
+     * @brief Corpo completo, chamando o filler em pedaços de chunk bytes
+     *        (como o AsyncTCP faria a cada janela de envio livre)
+     */
+    std::string body(size_t chunk = 64) {
+        if (!filler) return content;
+        std::string out;
+        std::vector<uint8_t> buffer(chunk);
+        while (length == CHUNKED || out.size() < length) {
+            size_t room = length == CHUNKED ? chunk : std::min(chunk, length - out.size());
+            size_t written = filler(buffer.data(), room, out.size());
+            if (written == 0) break;
+            out.append((const char*)buffer.data(), written);
+        }
+        return out;
+    }
+
+private:
+    int status;
+    String type;
+    std::string content;
+    size_t length;
+    AwsResponseFiller filler;
+    std::map<std::string, std::string> headers;
+};
+
+// ===== REQUISIÇÃO =====
+class AsyncWebServerRequest {
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method, const String& url) :
+        request_method(method), request_url(url), response(nullptr) {}
+    ~AsyncWebServerRequest() {
+        delete response;
+        for (AsyncWebHeader* header : headers) delete header;
+        for (AsyncWebParameter* param : params) delete param;
+    }
+
+    WebRequestMethodComposite method() const { return request_method; }
+    const String& url() const { return request_url; }
+
+    // ===== CABEÇALHOS =====
+    void addInterestingHeader(const String& name) { interesting.push_back(name); }
+    bool hasHeader(const String& name) const { return getHeader(name) != nullptr; }
+    AsyncWebHeader* getHeader(const String& name) const {
+        for (AsyncWebHeader* header : headers) {
+            if (strcasecmp(header->name().c_str(), name.c_str()) == 0) return header;
+        }
+        return nullptr;
+    }
+
+    // ===== PARÂMETROS =====
+    bool hasParam(const String& name, bool post = false) const { return getParam(name, post) != nullptr; }
+    AsyncWebParameter* getParam(const String& name, bool post = false) const {
+        for (AsyncWebParameter* param : params) {
+            if (param->name() == name && param->isPost() == post) return param;
+        }
+        return nullptr;
+    }
+
+    // ===== RESPOSTA =====
+    AsyncWebServerResponse* beginResponse(int code, const String& content_type = String(),
+                                          const String& content = String()) {
+        return new AsyncWebServerResponse(code, content_type, content.c_str());
+    }
+    AsyncWebServerResponse* beginResponse(const String& content_type, size_t length, AwsResponseFiller filler) {
+        return new AsyncWebServerResponse(content_type, length, filler);
+    }
+    AsyncWebServerResponse* beginChunkedResponse(const String& content_type, AwsResponseFiller filler) {
+        return new AsyncWebServerResponse(content_type, AsyncWebServerResponse::CHUNKED, filler);
+    }
+    AsyncWebServerResponse* beginResponse(fs::FS& filesystem, const String& path,
+                                          const String& content_type = String(), bool download = false) {
+        (void)download;
+        std::string body;
+        fs::File file = filesystem.open(path.c_str(), "r");
+        if (!file) return new AsyncWebServerResponse(404, "text/plain", "");
+        uint8_t buffer[256];
+        size_t length;
+        while ((length = file.read(buffer, sizeof(buffer))) > 0) {
+            body.append((const char*)buffer, length);
+        }
+        file.close();
+        return new AsyncWebServerResponse(200, content_type, body);
+    }
+
+    void send(AsyncWebServerResponse* next) {
+        delete response;
+        response = next;
+    }
+    void send(int code, const String& content_type = String(), const String& content = String()) {
+        send(beginResponse(code, content_type, content));
+    }
+    void send(fs::FS& filesystem, const String& path, const String& content_type = String()) {
+        send(beginResponse(filesystem, path, content_type));
+    }
+
+    // ===== AUXILIARES DOS TESTES =====
+    // Cabeçalho recebido: o 1.2.x só guarda os de interesse (ou "ANY")
+    void receiveHeader(const String& name, const String& value) {
+        for (const String& wanted : interesting) {
+            if (strcasecmp(wanted.c_str(), name.c_str()) == 0 || wanted == "ANY") {
+                headers.push_back(new AsyncWebHeader(name, value));
+                return;
+            }
+        }
+    }
+    void addParam(const String& name, const String& value, bool post = false) {
+        params.push_back(new AsyncWebParameter(name, value, post));
+    }
+    AsyncWebServerResponse* takeResponse() {
+        AsyncWebServerResponse* sent = response;
+        response = nullptr;
+        return sent;
+    }
+
+private:
+    WebRequestMethodComposite request_method;
+    String request_url;
+    std::vector<String> interesting;
+    std::vector<AsyncWebHeader*> headers;
+    std::vector<AsyncWebParameter*> params;
+    AsyncWebServerResponse* response;
+};
+
+// ===== HANDLERS =====
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+    AsyncWebHandler& setFilter(ArRequestFilterFunction fn) {
+        filter_function = fn;
+        return *this;
+    }
+    bool filter(AsyncWebServerRequest* request) { return !filter_function || filter_function(request); }
+    virtual bool canHandle(AsyncWebServerRequest* request) { (void)request; return false; }
+    virtual void handleRequest(AsyncWebServerRequest* request) { (void)request; }
+    virtual bool isRequestHandlerTrivial() { return true; }
+
+private:
+    ArRequestFilterFunction filter_function;
+};
+
+// server->on(): não declara cabeçalhos de interesse
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+    AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler) :
+        uri(uri), method(method), handler(handler) {}
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (!(method & request->method())) return false;
+        return request->url() == uri || request->url().startsWith((uri + "/").c_str());
+    }
+    void handleRequest(AsyncWebServerRequest* request) override { handler(request); }
+
+private:
+    String uri;
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction handler;
+};
+
+// serveStatic(): uri + resto da URL -> arquivo no fs (só se existir)
+class AsyncStaticWebHandler : public AsyncWebHandler {
+public:
+    AsyncStaticWebHandler(const String& uri, fs::FS& filesystem, const String& path) :
+        uri(uri), filesystem(filesystem), path(path) {}
+
+    AsyncStaticWebHandler& setCacheControl(const char* value) { cache_control = value; return *this; }
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (request->method() != HTTP_GET || !request->url().startsWith(uri.c_str())) return false;
+        return filesystem.exists(file(request));
+    }
+    void handleRequest(AsyncWebServerRequest* request) override {
+        AsyncWebServerResponse* response = request->beginResponse(filesystem, file(request));
+        if (!cache_control.isEmpty()) response->addHeader("Cache-Control", cache_control);
+        request->send(response);
+    }
+
+private:
+    String uri;
+    fs::FS& filesystem;
+    String path;
+    String cache_control;
+
+    String file(AsyncWebServerRequest* request) const {
+        String rest = request->url().substring(uri.length());
+        return path.length() && path.charAt(path.length() - 1) == '/' && rest.startsWith("/")
+            ? path + rest.substring(1) : path + rest;
+    }
+};
+
+// ===== SERVIDOR =====
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port = 80) { (void)port; }
+    ~AsyncWebServer() {
+        for (AsyncWebHandler* handler : handlers) delete handler;
+    }
+
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler) {
+        handlers.push_back(handler);
+        return *handler;
+    }
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler) {
+        AsyncCallbackWebHandler* route = new AsyncCallbackWebHandler(uri, method, handler);
+        addHandler(route);
+        return *route;
+    }
+    AsyncStaticWebHandler& serveStatic(const char* uri, fs::FS& filesystem, const char* path,
+                                       const char* cache_control = nullptr) {
+        AsyncStaticWebHandler* route = new AsyncStaticWebHandler(uri, filesystem, path);
+        if (cache_control) route->setCacheControl(cache_control);
+        addHandler(route);
+        return *route;
+    }
+    void begin() {}
+
+    // ===== AUXILIARES DOS TESTES =====
+    typedef std::vector<std::pair<String, String>> Pairs;
+
+    /**
+     * @brief Processa uma requisição; nullptr se nenhum handler respondeu
+     *        (o chamador libera a resposta)
+     */
+    AsyncWebServerResponse* dispatch(WebRequestMethodComposite method, const char* url,
+                                     const Pairs& request_headers = Pairs(), const Pairs& query = Pairs()) {
+        AsyncWebServerRequest request(method, url);
+        for (const auto& param : query) request.addParam(param.first, param.second);
+
+        AsyncWebHandler* chosen = nullptr;
+        for (AsyncWebHandler* handler : handlers) {
+            if (handler->filter(&request) && handler->canHandle(&request)) {
+                chosen = handler;
+                break;
+            }
+        }
+        for (const auto& header : request_headers) request.receiveHeader(header.first, header.second);
+
+        if (!chosen) return nullptr;
+        chosen->handleRequest(&request);
+        return request.takeResponse();
+    }
+
+private:
+    std::vector<AsyncWebHandler*> handlers;
+};
+
+#endif // NATIVE_ESP_ASYNC_WEB_SERVER_H
@@ -0,0 +1,163 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+// fs::FS em memória para os testes no host. Mesmos modos do VFS do
+// ESP32 ("r", "w", "a", "r+", "w+"); seek além do fim seguido de write
+// completa o arquivo com zeros, como o fseek do LittleFS.
+//
+// FS::programmed soma os bytes que o LittleFS gravaria na flash: ele é
+// copy-on-write, então cada write regrava do início do bloco alterado
+// até o fim do arquivo (anexar custa só o bloco parcial do fim).
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+static const size_t BLOCK_SIZE = 4096;        // Bloco de apagamento da flash
+
+typedef std::vector<uint8_t> FileData;
+
+class File {
+public:
+    File() : position_(0), readable(false), writable(false), programmed(nullptr) {}
+    File(std::shared_ptr<FileData> data, const char* path, bool readable, bool writable, bool append,
+         size_t* programmed = nullptr) :
+        data(data), name_(path), position_(append ? data->size() : 0),
+        readable(readable), writable(writable), programmed(programmed) {}
+
+    explicit operator bool() const { return data != nullptr; }
+
+    size_t write(const uint8_t* buffer, size_t length) {
+        if (!data || !writable) return 0;
+        if (programmed) {
+            size_t end = max(data->size(), position_ + length);
+            *programmed += end - position_ / BLOCK_SIZE * BLOCK_SIZE;
+        }
+        if (position_ + length > data->size()) data->resize(position_ + length, 0);
+        memcpy(data->data() + position_, buffer, length);
+        position_ += length;
+        return length;
+    }
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const String& text) { return print(text.c_str()); }
+
+    size_t read(uint8_t* buffer, size_t length) {
+        if (!data || !readable) return 0;
+        size_t count = position_ < data->size() ? min(length, data->size() - position_) : 0;
+        memcpy(buffer, data->data() + position_, count);
+        position_ += count;
+        return count;
+    }
+    int read() {
+        uint8_t byte;
+        return read(&byte, 1) == 1 ? byte : -1;
+    }
+    String readString() {
+        String text;
+        while (available()) text += (char)read();
+        return text;
+    }
+    String readStringUntil(char terminator) {
+        String text;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) text += (char)c;
+        return text;
+    }
+    int available() { return data && position_ < data->size() ? (int)(data->size() - position_) : 0; }
+
+    bool seek(uint32_t offset, SeekMode mode = SeekSet) {
+        if (!data) return false;
+        size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? position_ : data->size());
+        position_ = base + offset;
+        return true;
+    }
+    size_t position() const { return position_; }
+    size_t size() const { return data ? data->size() : 0; }
+    void flush() {}
+    void close() { data.reset(); }
+    const char* name() const { return name_.c_str(); }
+    bool isDirectory() const { return false; }
+
+private:
+    std::shared_ptr<FileData> data;
+    std::string name_;
+    size_t position_;
+    bool readable;
+    bool writable;
+    size_t* programmed;
+};
+
+class FS {
+public:
+    FS() : programmed(0) {}
+
+    File open(const char* path, const char* mode = "r", bool create = false) {
+        std::string key(path);
+        bool plus = strchr(mode, '+') != nullptr;
+        auto found = files.find(key);
+
+        if (mode[0] == 'r') {
+            if (found == files.end()) return File();
+            return File(found->second, path, true, plus, false, &programmed);
+        }
+        if (!parentExists(key)) return File();
+        if (mode[0] == 'w' || found == files.end()) {
+            files[key] = std::make_shared<FileData>();
+        }
+        return File(files[key], path, plus, true, mode[0] == 'a', &programmed);
+    }
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+
+    bool exists(const char* path) {
+        std::string key(path);
+        return files.count(key) || directories.count(key);
+    }
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool mkdir(const char* path) { directories.insert(path); return true; }
+    bool remove(const char* path) { return files.erase(path) > 0; }
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to) {
+        auto found = files.find(from);
+        if (found == files.end()) return false;
+        files[to] = found->second;
+        files.erase(found);
+        return true;
+    }
+
+    // ===== AUXILIARES DOS TESTES =====
+    size_t programmed;              // Bytes gravados na flash (modelo copy-on-write)
+
+    size_t fileSize(const char* path) const {
+        auto found = files.find(path);
+        return found == files.end() ? 0 : found->second->size();
+    }
+    FileData* fileData(const char* path) {
+        auto found = files.find(path);
+        return found == files.end() ? nullptr : found->second.get();
+    }
+    void wipe() { files.clear(); directories.clear(); programmed = 0; }
+
+private:
+    std::map<std::string, std::shared_ptr<FileData> > files;
+    std::set<std::string> directories;
+
+    // Como no LittleFS: criar arquivo exige o diretório
+    bool parentExists(const std::string& path) const {
+        size_t slash = path.rfind('/');
+        return slash == 0 || slash == std::string::npos || directories.count(path.substr(0, slash));
+    }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // NATIVE_FS_H
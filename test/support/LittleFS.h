@@ -0,0 +1,34 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+// LittleFS em memória; registra com que partição foi montado
+
+#include <FS.h>
+
+class LittleFSFS : public fs::FS {
+public:
+    LittleFSFS() : mounted(false), fail_mount(false) {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs") {
+        (void)formatOnFail;
+        (void)basePath;
+        (void)maxOpenFiles;
+        if (fail_mount) return false;
+        mounted = true;
+        partition = partitionLabel;
+        return true;
+    }
+    void end() { mounted = false; }
+    size_t totalBytes() { return 640 * 1024; }
+    size_t usedBytes() { return 0; }
+
+    // ===== AUXILIARES DOS TESTES =====
+    bool mounted;
+    bool fail_mount;
+    std::string partition;
+};
+
+inline LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
@@ -0,0 +1,79 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// NVS em memória para os testes no host. O conteúdo é global e sobrevive
+// a novas instâncias (simula um reboot); native::clearPreferences() apaga.
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+namespace native {
+typedef std::map<std::string, std::vector<uint8_t> > PreferencesNamespace;
+inline std::map<std::string, PreferencesNamespace>& preferencesStore() {
+    static std::map<std::string, PreferencesNamespace> store;
+    return store;
+}
+inline void clearPreferences() { preferencesStore().clear(); }
+}  // namespace native
+
+class Preferences {
+public:
+    Preferences() : open(nullptr), read_only(false) {}
+
+    bool begin(const char* name, bool readOnly = false) {
+        // Como na NVS: abrir só para leitura um namespace inexistente falha
+        auto& store = native::preferencesStore();
+        if (readOnly && store.find(name) == store.end()) return false;
+        open = &store[name];
+        read_only = readOnly;
+        return true;
+    }
+    void end() { open = nullptr; }
+
+    bool isKey(const char* key) { return open && open->count(key) > 0; }
+    bool remove(const char* key) { return writable() && open->erase(key) > 0; }
+    bool clear() { if (!writable()) return false; open->clear(); return true; }
+
+    size_t putBytes(const char* key, const void* value, size_t length) {
+        if (!writable()) return 0;
+        const uint8_t* bytes = (const uint8_t*)value;
+        (*open)[key].assign(bytes, bytes + length);
+        return length;
+    }
+    size_t getBytesLength(const char* key) {
+        if (!open || !open->count(key)) return 0;
+        return (*open)[key].size();
+    }
+    size_t getBytes(const char* key, void* buffer, size_t length) {
+        size_t stored = getBytesLength(key);
+        if (stored == 0 || stored > length) return 0;
+        memcpy(buffer, (*open)[key].data(), stored);
+        return stored;
+    }
+
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint16_t getUShort(const char* key, uint16_t fallback = 0) { return get(key, fallback); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t fallback = 0) { return get(key, fallback); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    uint32_t getULong(const char* key, uint32_t fallback = 0) { return getUInt(key, fallback); }
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    float getFloat(const char* key, float fallback = 0) { return get(key, fallback); }
+    size_t putBool(const char* key, bool value) { uint8_t byte = value; return putBytes(key, &byte, 1); }
+    bool getBool(const char* key, bool fallback = false) { return get<uint8_t>(key, fallback) != 0; }
+
+private:
+    native::PreferencesNamespace* open;
+    bool read_only;
+
+    bool writable() const { return open && !read_only; }
+
+    template <typename T>
+    T get(const char* key, T fallback) {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) ? value : fallback;
+    }
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,16 @@
+#ifndef NATIVE_SPIFFS_H
+#define NATIVE_SPIFFS_H
+
+// SPIFFS em memória (mesma base do LittleFS simulado)
+
+#include <FS.h>
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+    void end() {}
+};
+
+inline SPIFFSFS SPIFFS;
+
+#endif // NATIVE_SPIFFS_H
@@ -0,0 +1,15 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// WiFi mínimo: só o MAC fixo usado por DeviceID (ESP32_HIDRO_ABCDEF)
+
+#include <Arduino.h>
+
+class NativeWiFi {
+public:
+    String macAddress() { return "24:6F:28:AB:CD:EF"; }
+};
+
+inline NativeWiFi WiFi;
+
+#endif // NATIVE_WIFI_H
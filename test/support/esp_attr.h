@@ -0,0 +1,9 @@
+#ifndef NATIVE_ESP_ATTR_H
+#define NATIVE_ESP_ATTR_H
+
+// No host não há RTC nem IRAM: variáveis comuns
+
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+#endif // NATIVE_ESP_ATTR_H
@@ -0,0 +1,50 @@
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+// Heap simulado: o teste define livre, maior bloco e blocos livres
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+typedef struct {
+    size_t total_free_bytes;
+    size_t total_allocated_bytes;
+    size_t largest_free_block;
+    size_t minimum_free_bytes;
+    size_t allocated_blocks;
+    size_t free_blocks;
+    size_t total_blocks;
+} multi_heap_info_t;
+
+namespace native {
+
+struct Heap {
+    size_t free_bytes = 200000;
+    size_t largest_block = 110000;
+    size_t free_blocks = 4;
+    size_t minimum_free = 200000;
+};
+
+inline Heap heap;
+
+inline void setHeap(size_t free_bytes, size_t largest_block, size_t free_blocks = 4) {
+    heap.free_bytes = free_bytes;
+    heap.largest_block = largest_block;
+    heap.free_blocks = free_blocks;
+    if (free_bytes < heap.minimum_free) heap.minimum_free = free_bytes;
+}
+
+}  // namespace native
+
+inline void heap_caps_get_info(multi_heap_info_t* info, uint32_t) {
+    *info = {native::heap.free_bytes, 0, native::heap.largest_block, native::heap.minimum_free,
+             0, native::heap.free_blocks, 0};
+}
+inline size_t heap_caps_get_free_size(uint32_t) { return native::heap.free_bytes; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return native::heap.largest_block; }
+inline size_t heap_caps_get_minimum_free_size(uint32_t) { return native::heap.minimum_free; }
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
@@ -0,0 +1,42 @@
+#ifndef NATIVE_ESP_SYSTEM_H
+#define NATIVE_ESP_SYSTEM_H
+
+// Gerador aleatório (determinístico nos testes) e motivo do último reset
+
+#include <stdint.h>
+
+inline uint32_t esp_random() {
+    static uint32_t state = 0x2545F491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO
+} esp_reset_reason_t;
+
+// Variáveis RTC_NOINIT_ATTR são globais comuns no host: o teste escolhe
+// se o "boot" seguinte veio de ESP.restart() ou de ligar a placa
+namespace native {
+inline esp_reset_reason_t& resetReason() {
+    static esp_reset_reason_t reason = ESP_RST_POWERON;
+    return reason;
+}
+inline void setResetReason(esp_reset_reason_t reason) { resetReason() = reason; }
+}  // namespace native
+
+inline esp_reset_reason_t esp_reset_reason() { return native::resetReason(); }
+
+#endif // NATIVE_ESP_SYSTEM_H
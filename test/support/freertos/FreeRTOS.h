@@ -0,0 +1,58 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+// FreeRTOS mínimo para os testes no host: uma única thread, então
+// mutex e seção crítica só precisam existir (e contar o aninhamento)
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void* TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// ===== SEÇÃO CRÍTICA =====
+typedef struct { int depth; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+inline void vPortCPUInitializeMutex(portMUX_TYPE* mux) { mux->depth = 0; }
+#define portENTER_CRITICAL(mux) ((mux)->depth++)
+#define portEXIT_CRITICAL(mux) ((mux)->depth--)
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+// ===== SEMÁFOROS =====
+struct NativeSemaphore { int depth; };
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore{0}; }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeSemaphore{0}; }
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+// Sem concorrência no host: tomar um mutex já tomado é erro do teste
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t) {
+    if (semaphore->depth > 0) return pdFALSE;
+    semaphore->depth = 1;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->depth == 0) return pdFALSE;
+    semaphore->depth = 0;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t) {
+    semaphore->depth++;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    if (semaphore->depth == 0) return pdFALSE;
+    semaphore->depth--;
+    return pdTRUE;
+}
+
+#endif // NATIVE_FREERTOS_H
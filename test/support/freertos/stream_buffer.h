@@ -0,0 +1,46 @@
+#ifndef NATIVE_FREERTOS_STREAM_BUFFER_H
+#define NATIVE_FREERTOS_STREAM_BUFFER_H
+
+// Stream buffer de uma thread só: fila de bytes com capacidade fixa.
+// native::lastStreamBuffer() dá acesso ao último criado nos testes.
+
+#include "FreeRTOS.h"
+#include <string.h>
+#include <string>
+
+struct NativeStreamBuffer {
+    std::string data;
+    size_t capacity;
+};
+typedef NativeStreamBuffer* StreamBufferHandle_t;
+
+namespace native {
+inline StreamBufferHandle_t last_stream_buffer = nullptr;
+inline StreamBufferHandle_t lastStreamBuffer() { return last_stream_buffer; }
+}  // namespace native
+
+inline StreamBufferHandle_t xStreamBufferCreate(size_t capacity, size_t) {
+    native::last_stream_buffer = new NativeStreamBuffer{std::string(), capacity};
+    return native::last_stream_buffer;
+}
+inline void vStreamBufferDelete(StreamBufferHandle_t stream) {
+    if (stream == native::last_stream_buffer) native::last_stream_buffer = nullptr;
+    delete stream;
+}
+inline size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t stream) {
+    return stream->capacity - stream->data.size();
+}
+inline BaseType_t xStreamBufferIsEmpty(StreamBufferHandle_t stream) { return stream->data.empty(); }
+inline size_t xStreamBufferSend(StreamBufferHandle_t stream, const void* data, size_t length, TickType_t) {
+    length = length < xStreamBufferSpacesAvailable(stream) ? length : xStreamBufferSpacesAvailable(stream);
+    stream->data.append((const char*)data, length);
+    return length;
+}
+inline size_t xStreamBufferReceive(StreamBufferHandle_t stream, void* out, size_t length, TickType_t) {
+    length = length < stream->data.size() ? length : stream->data.size();
+    memcpy(out, stream->data.data(), length);
+    stream->data.erase(0, length);
+    return length;
+}
+
+#endif // NATIVE_FREERTOS_STREAM_BUFFER_H
@@ -0,0 +1,26 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+// Sem threads no host: criar task falha e quem chama segue sem ela
+// (o Logger, por exemplo, escreve direto na Serial). Com
+// native::setTaskCreation(true) a criação "funciona", mas a task nunca
+// roda: o teste inspeciona direto o que ela consumiria.
+
+typedef void (*TaskFunction_t)(void*);
+
+namespace native {
+inline bool task_creation = false;
+inline void setTaskCreation(bool ok) { task_creation = ok; }
+}  // namespace native
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, uint32_t,
+                                          TaskHandle_t* handle, BaseType_t) {
+    static int task;
+    if (handle) *handle = native::task_creation ? &task : nullptr;
+    return native::task_creation ? pdPASS : pdFAIL;
+}
+inline void vTaskDelay(TickType_t) {}
+
+#endif // NATIVE_FREERTOS_TASK_H
@@ -0,0 +1,199 @@
+#include <unity.h>
+#include <map>
+#include "AdminFrameEncoder.h"
+
+// Frames do painel admin decodificados como o DataView de
+// data/admin-panel.html: [tipo][seq] + campos [id][valor] little endian
+
+struct Peer {
+    uint8_t mac[6];
+    bool online;
+    int8_t rssi;
+};
+
+struct Decoded {
+    uint8_t type;
+    uint8_t seq;
+    std::map<uint8_t, int32_t> fields;          // id -> valor (peers fora)
+    std::map<uint8_t, Peer> peers;              // índice -> peer
+};
+
+static uint32_t readU(const uint8_t* in, size_t& pos, uint8_t bytes) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        value |= (uint32_t)in[pos++] << (8 * i);
+    }
+    return value;
+}
+
+static Decoded decode(const uint8_t* in, size_t length) {
+    Decoded frame;
+    size_t pos = 0;
+    frame.type = in[pos++];
+    frame.seq = in[pos++];
+    while (pos < length) {
+        uint8_t id = in[pos++];
+        if (id == FIELD_PEER) {
+            uint8_t index = in[pos++];
+            Peer& peer = frame.peers[index];
+            memcpy(peer.mac, in + pos, 6);
+            pos += 6;
+            peer.online = in[pos++] != 0;
+            peer.rssi = (int8_t)in[pos++];
+        } else if (id >= FIELD_SENSOR_BASE && id < FIELD_SENSOR_BASE + ADMIN_SENSOR_COUNT) {
+            frame.fields[id] = (int16_t)readU(in, pos, 2);
+        } else if (id == FIELD_RSSI) {
+            frame.fields[id] = (int8_t)readU(in, pos, 1);
+        } else if (id == FIELD_WS_CLIENTS || id == FIELD_PEER_COUNT) {
+            frame.fields[id] = readU(in, pos, 1);
+        } else if (id == FIELD_RELAY_MASK) {
+            frame.fields[id] = readU(in, pos, 2);
+        } else {
+            frame.fields[id] = readU(in, pos, 4);
+        }
+    }
+    TEST_ASSERT_EQUAL(length, pos);
+    return frame;
+}
+
+static AdminTelemetry sample() {
+    AdminTelemetry t;
+    memset(&t, 0, sizeof(t));
+    t.heapFree = 180000;
+    t.maxBlock = 110000;
+    t.heapTotal = 320000;
+    t.uptime = 3600;
+    t.rssi = -61;
+    t.wsClients = 1;
+    t.hasRelays = true;
+    t.relayMask = 0x0005;
+    t.sensors[ADMIN_SENSOR_PH] = 612;
+    t.sensors[ADMIN_SENSOR_EC] = 1450;
+    t.sensors[ADMIN_SENSOR_WATER_TEMP] = 2210;
+    t.sensors[ADMIN_SENSOR_AIR_TEMP] = ADMIN_SENSOR_NONE;
+    t.sensors[ADMIN_SENSOR_HUMIDITY] = 6500;
+    return t;
+}
+
+static uint8_t buffer[ADMIN_FRAME_SIZE];
+
+void setUp() {}
+void tearDown() {}
+
+// ===== SNAPSHOT =====
+void test_snapshot_round_trips_every_field() {
+    AdminFrameEncoder encoder;
+    AdminTelemetry t = sample();
+
+    size_t length = encoder.encode(t, true, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length > 2);
+
+    Decoded frame = decode(buffer, length);
+    TEST_ASSERT_EQUAL(ADMIN_FRAME_SNAPSHOT, frame.type);
+    TEST_ASSERT_EQUAL(0, frame.seq);
+    TEST_ASSERT_EQUAL(180000, frame.fields[FIELD_HEAP_FREE]);
+    TEST_ASSERT_EQUAL(110000, frame.fields[FIELD_MAX_BLOCK]);
+    TEST_ASSERT_EQUAL(320000, frame.fields[FIELD_HEAP_TOTAL]);
+    TEST_ASSERT_EQUAL(3600, frame.fields[FIELD_UPTIME]);
+    TEST_ASSERT_EQUAL(-61, frame.fields[FIELD_RSSI]);
+    TEST_ASSERT_EQUAL(1, frame.fields[FIELD_WS_CLIENTS]);
+    TEST_ASSERT_EQUAL(0x0005, frame.fields[FIELD_RELAY_MASK]);
+    TEST_ASSERT_EQUAL(612, frame.fields[FIELD_SENSOR_BASE + ADMIN_SENSOR_PH]);
+    TEST_ASSERT_EQUAL(ADMIN_SENSOR_NONE, frame.fields[FIELD_SENSOR_BASE + ADMIN_SENSOR_AIR_TEMP]);
+    TEST_ASSERT_EQUAL(0, frame.fields[FIELD_PEER_COUNT]);
+}
+
+void test_worst_case_fits_frame_buffer() {
+    AdminFrameEncoder encoder;
+    AdminTelemetry t = sample();
+    t.peerCount = ADMIN_MAX_PEERS;
+    for (uint8_t i = 0; i < ADMIN_MAX_PEERS; i++) {
+        for (uint8_t b = 0; b < 6; b++) t.peers[i].mac[b] = 0x10 * i + b;
+        t.peers[i].online = i % 2;
+        t.peers[i].rssi = -40 - i;
+    }
+
+    size_t length = encoder.encode(t, true, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length <= ADMIN_FRAME_SIZE);
+
+    Decoded frame = decode(buffer, length);
+    TEST_ASSERT_EQUAL(ADMIN_MAX_PEERS, (int)frame.peers.size());
+    TEST_ASSERT_EQUAL_HEX8(0x73, frame.peers[7].mac[3]);
+    TEST_ASSERT_TRUE(frame.peers[7].online);
+    TEST_ASSERT_EQUAL(-47, frame.peers[7].rssi);
+
+    // Buffer menor que o pior caso é recusado
+    TEST_ASSERT_EQUAL(0, (int)encoder.encode(t, true, buffer, ADMIN_FRAME_SIZE - 1));
+}
+
+// ===== DELTA =====
+void test_delta_skips_changes_inside_deadband() {
+    AdminFrameEncoder encoder;
+    AdminTelemetry t = sample();
+    encoder.encode(t, true, buffer, sizeof(buffer));
+
+    // Tudo abaixo das bandas: nada a enviar, sequência não anda
+    t.heapFree += 511;
+    t.uptime += 4;
+    t.rssi -= 2;
+    t.sensors[ADMIN_SENSOR_PH] += 1;
+    TEST_ASSERT_EQUAL(0, (int)encoder.encode(t, false, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(1, encoder.getSequence());
+
+    // A banda conta do último valor enviado, não do tick anterior
+    t.heapFree += 1;
+    t.sensors[ADMIN_SENSOR_PH] += 1;
+    size_t length = encoder.encode(t, false, buffer, sizeof(buffer));
+    Decoded frame = decode(buffer, length);
+    TEST_ASSERT_EQUAL(ADMIN_FRAME_DELTA, frame.type);
+    TEST_ASSERT_EQUAL(1, frame.seq);
+    TEST_ASSERT_EQUAL(2, (int)frame.fields.size());
+    TEST_ASSERT_EQUAL(180512, frame.fields[FIELD_HEAP_FREE]);
+    TEST_ASSERT_EQUAL(614, frame.fields[FIELD_SENSOR_BASE + ADMIN_SENSOR_PH]);
+}
+
+void test_delta_reports_sensor_presence_and_relays() {
+    AdminFrameEncoder encoder;
+    AdminTelemetry t = sample();
+    encoder.encode(t, true, buffer, sizeof(buffer));
+
+    // Sensor que aparece/some entra mesmo sem passar da banda
+    t.sensors[ADMIN_SENSOR_AIR_TEMP] = 2400;
+    t.sensors[ADMIN_SENSOR_HUMIDITY] = ADMIN_SENSOR_NONE;
+    t.relayMask = 0x0004;
+    size_t length = encoder.encode(t, false, buffer, sizeof(buffer));
+    Decoded frame = decode(buffer, length);
+    TEST_ASSERT_EQUAL(3, (int)frame.fields.size());
+    TEST_ASSERT_EQUAL(2400, frame.fields[FIELD_SENSOR_BASE + ADMIN_SENSOR_AIR_TEMP]);
+    TEST_ASSERT_EQUAL(ADMIN_SENSOR_NONE, frame.fields[FIELD_SENSOR_BASE + ADMIN_SENSOR_HUMIDITY]);
+    TEST_ASSERT_EQUAL(0x0004, frame.fields[FIELD_RELAY_MASK]);
+}
+
+void test_delta_sends_only_changed_peers() {
+    AdminFrameEncoder encoder;
+    AdminTelemetry t = sample();
+    t.peerCount = 2;
+    t.peers[0].rssi = -50;
+    t.peers[1].rssi = -70;
+    encoder.encode(t, true, buffer, sizeof(buffer));
+
+    t.peers[1].online = true;
+    t.peerCount = 3;
+    t.peers[2].rssi = -80;
+    size_t length = encoder.encode(t, false, buffer, sizeof(buffer));
+    Decoded frame = decode(buffer, length);
+    TEST_ASSERT_EQUAL(3, frame.fields[FIELD_PEER_COUNT]);
+    TEST_ASSERT_EQUAL(2, (int)frame.peers.size());
+    TEST_ASSERT_TRUE(frame.peers.count(1) && frame.peers.count(2));
+    TEST_ASSERT_TRUE(frame.peers[1].online);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_round_trips_every_field);
+    RUN_TEST(test_worst_case_fits_frame_buffer);
+    RUN_TEST(test_delta_skips_changes_inside_deadband);
+    RUN_TEST(test_delta_reports_sensor_presence_and_relays);
+    RUN_TEST(test_delta_sends_only_changed_peers);
+    return UNITY_END();
+}
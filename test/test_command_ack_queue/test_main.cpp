@@ -0,0 +1,156 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "CommandAckQueue.h"
+
+// Confirmações de comandos com um sender falso no lugar do
+// SupabaseClient::markCommands (registra cada PATCH em lote)
+
+struct Patch {
+    std::vector<int> ids;
+    std::string status;
+    std::string error;
+};
+
+static std::vector<Patch> patches;
+static bool cloud_up = true;
+
+static bool capture(const int* ids, uint8_t count, const char* status, const char* error) {
+    if (!cloud_up) return false;
+    patches.push_back({std::vector<int>(ids, ids + count), status, error ? error : ""});
+    return true;
+}
+
+static size_t patchedIds() {
+    size_t total = 0;
+    for (const Patch& patch : patches) total += patch.ids.size();
+    return total;
+}
+
+void setUp() {
+    native::setMillis(1000);
+    patches.clear();
+    cloud_up = true;
+}
+
+void tearDown() {}
+
+// ===== AGRUPAMENTO =====
+void test_window_groups_by_status_and_error() {
+    CommandAckQueue acks(capture);
+    TEST_ASSERT_TRUE(acks.add(1, COMMAND_ACK_COMPLETED));
+    TEST_ASSERT_TRUE(acks.add(2, COMMAND_ACK_FAILED, "Relé inválido"));
+    TEST_ASSERT_TRUE(acks.add(3, COMMAND_ACK_COMPLETED));
+    TEST_ASSERT_TRUE(acks.add(4, COMMAND_ACK_FAILED, "Timeout"));
+
+    // Dentro da janela nada sai
+    acks.loop();
+    TEST_ASSERT_EQUAL(0, (int)patches.size());
+
+    native::advanceMillis(COMMAND_ACK_FLUSH_WINDOW_MS);
+    acks.loop();
+    TEST_ASSERT_EQUAL(0, acks.pending());
+    TEST_ASSERT_EQUAL(3, (int)patches.size());
+
+    TEST_ASSERT_EQUAL_STRING("completed", patches[0].status.c_str());
+    TEST_ASSERT_EQUAL(2, (int)patches[0].ids.size());
+    TEST_ASSERT_EQUAL(1, patches[0].ids[0]);
+    TEST_ASSERT_EQUAL(3, patches[0].ids[1]);
+    TEST_ASSERT_EQUAL_STRING("Relé inválido", patches[1].error.c_str());
+    TEST_ASSERT_EQUAL_STRING("Timeout", patches[2].error.c_str());
+}
+
+void test_later_state_replaces_pending_one() {
+    CommandAckQueue acks(capture);
+    TEST_ASSERT_TRUE(acks.add(7, COMMAND_ACK_SENT));
+    TEST_ASSERT_TRUE(acks.add(7, COMMAND_ACK_COMPLETED));
+    TEST_ASSERT_TRUE(acks.add(7, COMMAND_ACK_SENT));     // Atrasado: não regride
+    TEST_ASSERT_EQUAL(1, acks.pending());
+
+    TEST_ASSERT_TRUE(acks.flush());
+    TEST_ASSERT_EQUAL(1, (int)patches.size());
+    TEST_ASSERT_EQUAL_STRING("completed", patches[0].status.c_str());
+}
+
+void test_batch_is_capped_per_patch() {
+    CommandAckQueue acks(capture);
+    for (int id = 1; id <= COMMAND_ACK_BATCH_MAX + 3; id++) {
+        TEST_ASSERT_TRUE(acks.add(id, COMMAND_ACK_COMPLETED));
+    }
+    TEST_ASSERT_TRUE(acks.flush());
+    TEST_ASSERT_EQUAL(2, (int)patches.size());
+    TEST_ASSERT_EQUAL(COMMAND_ACK_BATCH_MAX, (int)patches[0].ids.size());
+    TEST_ASSERT_EQUAL(3, (int)patches[1].ids.size());
+}
+
+// ===== FALHAS =====
+void test_failed_patch_keeps_entries_and_waits() {
+    CommandAckQueue acks(capture);
+    TEST_ASSERT_TRUE(acks.add(1, COMMAND_ACK_COMPLETED));
+
+    cloud_up = false;
+    native::advanceMillis(COMMAND_ACK_FLUSH_WINDOW_MS);
+    acks.loop();
+    TEST_ASSERT_EQUAL(1, acks.pending());
+
+    // Nuvem voltou, mas a espera ainda vale
+    cloud_up = true;
+    native::advanceMillis(COMMAND_ACK_RETRY_MS - 1);
+    acks.loop();
+    TEST_ASSERT_EQUAL(0, (int)patches.size());
+
+    native::advanceMillis(1);
+    acks.loop();
+    TEST_ASSERT_EQUAL(0, acks.pending());
+    TEST_ASSERT_EQUAL(1, (int)patches.size());
+}
+
+// ===== CONTRAPRESSÃO =====
+void test_full_queue_flushes_instead_of_dropping() {
+    CommandAckQueue acks(capture);
+    for (int id = 1; id <= COMMAND_ACK_CAPACITY; id++) {
+        TEST_ASSERT_TRUE(acks.add(id, id % 2 ? COMMAND_ACK_COMPLETED : COMMAND_ACK_FAILED));
+    }
+    TEST_ASSERT_TRUE(acks.isFull());
+
+    // Cheia com a nuvem OK: esvazia na hora e aceita a nova
+    TEST_ASSERT_TRUE(acks.add(COMMAND_ACK_CAPACITY + 1, COMMAND_ACK_COMPLETED));
+    TEST_ASSERT_EQUAL(1, acks.pending());
+    TEST_ASSERT_EQUAL(COMMAND_ACK_CAPACITY, (int)patchedIds());
+}
+
+void test_full_queue_offline_refuses_and_keeps_completions() {
+    CommandAckQueue acks(capture);
+    cloud_up = false;
+    for (int id = 1; id <= COMMAND_ACK_CAPACITY; id++) {
+        TEST_ASSERT_TRUE(acks.add(id, COMMAND_ACK_COMPLETED));
+    }
+
+    // Nenhuma conclusão aceita é descartada: a nova é recusada
+    TEST_ASSERT_FALSE(acks.add(COMMAND_ACK_CAPACITY + 1, COMMAND_ACK_COMPLETED));
+    TEST_ASSERT_EQUAL(COMMAND_ACK_CAPACITY, acks.pending());
+
+    // Transição de um comando já na fila continua aceita (funde)
+    TEST_ASSERT_TRUE(acks.add(5, COMMAND_ACK_FAILED, "Timeout"));
+
+    cloud_up = true;
+    TEST_ASSERT_TRUE(acks.flush());
+    TEST_ASSERT_EQUAL(COMMAND_ACK_CAPACITY, (int)patchedIds());
+    for (const Patch& patch : patches) {
+        for (int id : patch.ids) {
+            TEST_ASSERT_TRUE(id >= 1 && id <= COMMAND_ACK_CAPACITY);
+        }
+    }
+    TEST_ASSERT_TRUE(acks.add(COMMAND_ACK_CAPACITY + 1, COMMAND_ACK_COMPLETED));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_window_groups_by_status_and_error);
+    RUN_TEST(test_later_state_replaces_pending_one);
+    RUN_TEST(test_batch_is_capped_per_patch);
+    RUN_TEST(test_failed_patch_keeps_entries_and_waits);
+    RUN_TEST(test_full_queue_flushes_instead_of_dropping);
+    RUN_TEST(test_full_queue_offline_refuses_and_keeps_completions);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include <unity.h>
+#include <random>
+#include "DecimationFilter.h"
+
+// Cadeia do AdcDmaSampler (boxcar 64 -> mediana de 3 -> IIR) sobre
+// contagens sintéticas do ADC de 12 bits
+
+static std::mt19937 rng;
+
+// Box-Muller próprio: std::normal_distribution muda entre bibliotecas
+static float gaussian(float sigma) {
+    std::uniform_real_distribution<double> uniform(1e-12, 1.0);
+    double u1 = uniform(rng), u2 = uniform(rng);
+    return (float)(sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2));
+}
+
+static uint16_t adc(float value) {
+    return (uint16_t)constrain(lroundf(value), 0L, 4095L);
+}
+
+void setUp() {
+    rng.seed(1234);
+}
+
+void tearDown() {}
+
+// ===== SAÍDA =====
+void test_outputs_once_per_block() {
+    DecimationFilter filter(64, 0.05);
+
+    for (int i = 0; i < 63; i++) {
+        TEST_ASSERT_FALSE(filter.push(2000));
+    }
+    TEST_ASSERT_FALSE(filter.hasOutput());
+    TEST_ASSERT_TRUE(filter.push(2000));
+    TEST_ASSERT_TRUE(filter.hasOutput());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2000.0, filter.getOutput());
+
+    for (int i = 0; i < 64 * 9; i++) filter.push(2000);
+    TEST_ASSERT_EQUAL_UINT32(10, filter.getOutputCount());
+
+    filter.reset();
+    TEST_ASSERT_FALSE(filter.hasOutput());
+    TEST_ASSERT_EQUAL_UINT32(0, filter.getOutputCount());
+}
+
+// ===== RUÍDO =====
+void test_gaussian_noise_is_attenuated() {
+    DecimationFilter filter;
+    const float level = 2000.0, sigma = 30.0;
+
+    double error_sq = 0;
+    int outputs = 0;
+    for (int block = 0; block < 400; block++) {
+        for (int i = 0; i < ADC_DMA_DECIMATION; i++) {
+            if (!filter.push(adc(level + gaussian(sigma)))) continue;
+            if (block < 100) continue;   // Assentamento do IIR
+            float error = filter.getOutput() - level;
+            error_sq += error * error;
+            outputs++;
+        }
+    }
+
+    // sigma 30 -> ~3.75 após o boxcar; IIR e mediana levam abaixo de 1
+    float rms = sqrt(error_sq / outputs);
+    TEST_ASSERT_EQUAL_INT(300, outputs);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0, rms);
+    TEST_ASSERT_FLOAT_WITHIN(1.5, level, filter.getOutput());
+}
+
+// ===== PICOS =====
+void test_spikes_are_rejected() {
+    DecimationFilter filter;
+    const float level = 1500.0;
+
+    float worst = 0;
+    for (int block = 0; block < 400; block++) {
+        // Fases distintas de 7 blocos: nunca dois blocos ruins numa janela
+        // de 3, que é o que a mediana consegue descartar
+        bool burst = block % 7 == 0;            // Bloco inteiro saturado
+        bool spikes = block % 7 == 3;           // Alguns picos de 1 amostra
+        for (int i = 0; i < ADC_DMA_DECIMATION; i++) {
+            float value = level + gaussian(20.0);
+            if (burst) value = (block % 2) ? 4095 : 0;
+            else if (spikes && i % 16 == 5) value = 4095;
+
+            if (filter.push(adc(value)) && block >= 200) {   // Depois do assentamento
+                worst = max(worst, fabsf(filter.getOutput() - level));
+            }
+        }
+    }
+
+    // Sem a mediana cada surto deslocaria a saída em ~75 contagens
+    // (0.05 x 1500) e os picos em ~8
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0, worst);
+}
+
+// ===== DERIVA =====
+void test_drift_is_tracked_with_bounded_lag() {
+    DecimationFilter filter;
+    const float start = 1000.0, slope = 0.5;   // Contagens por bloco (deriva do eletrodo)
+    const float alpha = ADC_DMA_IIR_ALPHA;
+
+    float previous = 0, truth = start;
+    int rising = 0, outputs = 0;
+    for (int block = 0; block < 600; block++) {
+        for (int i = 0; i < ADC_DMA_DECIMATION; i++) {
+            truth = start + slope * (block + (float)i / ADC_DMA_DECIMATION);
+            if (!filter.push(adc(truth + gaussian(10.0)))) continue;
+            if (block >= 200) {
+                if (filter.getOutput() > previous) rising++;
+                outputs++;
+            }
+            previous = filter.getOutput();
+        }
+    }
+
+    // Atraso em regime: (1 - a) / a blocos do IIR + ~1 da mediana + meio
+    // bloco do boxcar
+    float expected_lag = slope * ((1.0 - alpha) / alpha + 1.5);
+    TEST_ASSERT_FLOAT_WITHIN(2.0, truth - expected_lag, filter.getOutput());
+    TEST_ASSERT_GREATER_THAN(outputs * 9 / 10, rising);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_outputs_once_per_block);
+    RUN_TEST(test_gaussian_noise_is_attenuated);
+    RUN_TEST(test_spikes_are_rejected);
+    RUN_TEST(test_drift_is_tracked_with_bounded_lag);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+#include <unity.h>
+#include <Preferences.h>
+#include <esp_system.h>
+#include <time.h>
+#include "DosingLimiter.h"
+
+// Bomba de 1 ml/s no relé 1: 1000 ms = 1 ml
+static const int PUMP = 1;
+static const unsigned long HOUR = DosingLimiter::HOUR_MS;
+
+// Hora de parede do teste no lugar da time() da libc (0 = NTP ausente)
+static time_t wall_clock = 0;
+extern "C" time_t time(time_t* out) noexcept {
+    if (out) *out = wall_clock;
+    return wall_clock;
+}
+
+// Avança millis() e, com NTP, a hora de parede junto
+static void advance(unsigned long ms) {
+    native::advanceMillis(ms);
+    if (wall_clock) wall_clock += ms / 1000;
+}
+
+// Reinício da placa: millis() volta a zero; a RTC só vale no reset por software
+static void reboot(DosingLimiter& limiter, esp_reset_reason_t reason, unsigned long boot_ms = 2000) {
+    native::setResetReason(reason);
+    native::setMillis(0);
+    if (wall_clock) wall_clock += boot_ms / 1000;
+    advance(0);
+    limiter.begin();
+}
+
+static PumpModel pump(float per_hour, float per_day, unsigned long mix_ms) {
+    PumpModel model;
+    model.enabled = true;
+    model.ml_per_second = 1.0;
+    model.max_ml_per_hour = per_hour;
+    model.max_ml_per_day = per_day;
+    model.min_mix_delay_ms = mix_ms;
+    return model;
+}
+
+void setUp() {
+    native::clearPreferences();
+    native::setMillis(0);
+    native::setResetReason(ESP_RST_POWERON);
+    wall_clock = 0;
+}
+
+void tearDown() {}
+
+// ===== LIMITE HORÁRIO =====
+void test_hourly_bucket_blocks_and_refills() {
+    DosingLimiter limiter;
+    limiter.configurePump(PUMP, pump(20, 0, 0));
+
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 15000, 15000, 0));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 10000, 10000, 1000));   // 5 ml restantes
+    TEST_ASSERT_EQUAL_UINT32(1, limiter.getTotalBlocked(PUMP));
+
+    // Meia hora repõe 10 ml
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 15.0, limiter.getAvailableMl(PUMP, DosingLimiter::HOUR_MS / 2));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, DosingLimiter::HOUR_MS / 2));
+
+    // O balde não passa da capacidade
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, limiter.getAvailableMl(PUMP, 10 * DosingLimiter::HOUR_MS));
+}
+
+// ===== LIMITE DIÁRIO =====
+void test_daily_window_slides_after_24h() {
+    DosingLimiter limiter;
+    limiter.configurePump(PUMP, pump(0, 30, 0));
+
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, 0));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, 5 * HOUR));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, 10 * HOUR));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, 23 * HOUR));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 30.0, limiter.getDailyMl(PUMP, 23 * HOUR));
+
+    // A primeira dose sai da janela; as outras duas continuam
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, limiter.getDailyMl(PUMP, 24 * HOUR + 1));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, 24 * HOUR + 1));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, 24 * HOUR + 2));
+
+    // Dois dias parado: janela vazia
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, limiter.getDailyMl(PUMP, 60 * HOUR));
+}
+
+// ===== MISTURA =====
+void test_mix_delay_counts_from_end_of_run() {
+    DosingLimiter limiter;
+    limiter.configurePump(PUMP, pump(0, 0, 60000));
+
+    // PWM a 25% por 60 s: 15 s ligados, bomba ciclando até t = 60 s
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 15000, 60000, 0));
+
+    // 15 s + 60 s já passaram, mas o ciclo só terminou em 60 s
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, 75000));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, 119999));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 1000, 1000, 120000));
+}
+
+void test_zero_duration_is_refused() {
+    DosingLimiter limiter;
+    limiter.configurePump(PUMP, pump(20, 100, 0));
+
+    String reason;
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 0, 0, 0, &reason));
+    TEST_ASSERT_TRUE(reason.length() > 0);
+
+    // Relés que não são bombas passam sem limite
+    TEST_ASSERT_TRUE(limiter.tryDose(6, 0, 0, 0));
+}
+
+// ===== OVERFLOW DO MILLIS() =====
+void test_limits_survive_millis_rollover() {
+    const unsigned long before_wrap = (unsigned long)0 - HOUR / 2;   // 30 min antes do overflow
+    native::setMillis(before_wrap);
+
+    DosingLimiter limiter;
+    limiter.configurePump(PUMP, pump(20, 30, 60000));
+
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 20000, 20000, before_wrap));
+
+    // Depois do overflow: balde reposto só pelo tempo decorrido (1h = cheio)
+    unsigned long after_wrap = before_wrap + HOUR;
+    TEST_ASSERT_TRUE(after_wrap < before_wrap);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, limiter.getAvailableMl(PUMP, after_wrap));
+
+    // A janela diária continua com a dose de antes do overflow
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, limiter.getDailyMl(PUMP, after_wrap));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 15000, 15000, after_wrap));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, after_wrap));
+
+    // Mistura medida através do overflow
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, after_wrap + 30000));
+}
+
+// ===== CONTADORES =====
+void test_counters_persist_across_reboot() {
+    {
+        DosingLimiter limiter;
+        limiter.begin();
+        native::setMillis(DOSING_MIN_MIX_DELAY_MS);
+        TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 1000, 1000, millis()));
+        limiter.saveCounters();
+    }
+
+    DosingLimiter rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT32(1, rebooted.getTotalDoses(PUMP));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 1.0 * DOSING_DEFAULT_ML_PER_SEC, rebooted.getTotalMl(PUMP));
+}
+
+// ===== REBOOT =====
+void test_boot_without_state_is_conservative() {
+    DosingLimiter limiter;
+    limiter.begin();
+
+    // Bucket vazio e mistura correndo, não uma janela nova
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, limiter.getAvailableMl(PUMP, 0));
+    String reason;
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, 0, &reason));
+    TEST_ASSERT_TRUE(reason.indexOf("mistura") >= 0);
+
+    native::setMillis(DOSING_MIN_MIX_DELAY_MS);
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 1000, 1000, millis()));
+}
+
+void test_reboot_loop_keeps_hourly_cap_and_mix_delay() {
+    // Boot frio, 1 h parado: bucket cheio (20 ml)
+    wall_clock = 1700000000;
+    DosingLimiter limiter;
+    limiter.begin();
+    advance(HOUR);
+    limiter.loop();
+
+    // Regra dosando 10 ml a cada boot, com reset 10 s depois (watchdog)
+    int doses = 0;
+    unsigned long elapsed_ms = 0;
+    for (int boot = 0; boot < 100; boot++) {
+        reboot(limiter, ESP_RST_TASK_WDT);
+        limiter.loop();
+        if (limiter.tryDose(PUMP, 10000, 10000, millis())) doses++;
+        advance(10000);
+        limiter.loop();
+        elapsed_ms += 12000;
+    }
+
+    // 20 min de reboots: 20 ml do bucket + 6,7 ml repostos, não 1000 ml
+    float allowed = DOSING_MAX_ML_PER_HOUR * (1.0 + (float)elapsed_ms / HOUR);
+    TEST_ASSERT_LESS_OR_EQUAL((int)(allowed / 10), doses);
+    TEST_ASSERT_LESS_OR_EQUAL((int)(elapsed_ms / DOSING_MIN_MIX_DELAY_MS) + 1, doses);
+    TEST_ASSERT_EQUAL(2, doses);
+}
+
+void test_hourly_reboots_keep_daily_cap() {
+    wall_clock = 1700000000;
+    DosingLimiter limiter;
+    limiter.begin();
+
+    // Um reboot por hora por 20 h (dentro da janela), tentando 5 ml a cada 6 min
+    float dosed = 0;
+    for (int hour = 0; hour < 20; hour++) {
+        for (int attempt = 0; attempt < 10; attempt++) {
+            advance(HOUR / 10);
+            limiter.loop();
+            if (limiter.tryDose(PUMP, 5000, 5000, millis())) dosed += 5;
+        }
+        reboot(limiter, ESP_RST_SW);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01, DOSING_MAX_ML_PER_DAY, dosed);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, DOSING_MAX_ML_PER_DAY, limiter.getDailyMl(PUMP, millis()));
+}
+
+void test_power_loss_restores_window_from_nvs() {
+    wall_clock = 1700000000;
+    {
+        DosingLimiter limiter;
+        limiter.begin();
+        advance(HOUR);
+        TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 15000, 15000, millis()));
+    }
+
+    // Volta 2 h depois, ainda sem NTP: nada é creditado
+    wall_clock = 0;
+    DosingLimiter limiter;
+    reboot(limiter, ESP_RST_POWERON);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 5.0, limiter.getAvailableMl(PUMP, millis()));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 15.0, limiter.getDailyMl(PUMP, millis()));
+    TEST_ASSERT_FALSE(limiter.tryDose(PUMP, 1000, 1000, millis()));
+
+    // NTP sincroniza: as 2 h desligado enchem o bucket e encerram a mistura
+    wall_clock = 1700000000 + 3 * 3600 + 30;
+    advance(30000);
+    limiter.loop();
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, limiter.getAvailableMl(PUMP, millis()));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 15.0, limiter.getDailyMl(PUMP, millis()));
+    TEST_ASSERT_TRUE(limiter.tryDose(PUMP, 10000, 10000, millis()));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hourly_bucket_blocks_and_refills);
+    RUN_TEST(test_daily_window_slides_after_24h);
+    RUN_TEST(test_mix_delay_counts_from_end_of_run);
+    RUN_TEST(test_zero_duration_is_refused);
+    RUN_TEST(test_limits_survive_millis_rollover);
+    RUN_TEST(test_counters_persist_across_reboot);
+    RUN_TEST(test_boot_without_state_is_conservative);
+    RUN_TEST(test_reboot_loop_keeps_hourly_cap_and_mix_delay);
+    RUN_TEST(test_hourly_reboots_keep_daily_cap);
+    RUN_TEST(test_power_loss_restores_window_from_nvs);
+    return UNITY_END();
+}
@@ -0,0 +1,125 @@
+#include <unity.h>
+#include <vector>
+#include "EventLog.h"
+#include "HistoryFS.h"
+
+// Anel de eventos com despejo no LittleFS em memória
+
+static std::vector<EventRecord> collect(EventLog& log, uint32_t from = 0) {
+    std::vector<EventRecord> records;
+    log.forEach(from, EVENT_LOG_FLASH_RECORDS, [&](const EventRecord& record) {
+        records.push_back(record);
+        return true;
+    });
+    return records;
+}
+
+void setUp() {
+    native::setMillis(1000);
+    LittleFS.wipe();
+    LittleFS.fail_mount = false;
+}
+
+void tearDown() {}
+
+// ===== PARTIÇÃO =====
+// Primeiro teste: HistoryFS memoriza a montagem que deu certo
+void test_unmounted_partition_falls_back_to_ram() {
+    LittleFS.fail_mount = true;
+
+    EventLog log;
+    TEST_ASSERT_TRUE(log.begin());
+    for (int i = 0; i < EVENT_LOG_SPILL_BATCH; i++) log.record(EVENT_RELAY_ON, 1, 500);
+    log.loop();
+    log.flush();
+
+    TEST_ASSERT_FALSE(LittleFS.exists(EVENT_LOG_DIRECTORY "/0.seg"));
+    TEST_ASSERT_EQUAL(EVENT_LOG_SPILL_BATCH, (int)collect(log).size());
+}
+
+void test_mounts_history_partition() {
+    EventLog log;
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(LittleFS.mounted);
+    TEST_ASSERT_EQUAL_STRING(HISTORY_FS_PARTITION, LittleFS.partition.c_str());
+    TEST_ASSERT_TRUE(HistoryFS::isMounted());
+}
+
+// ===== PERSISTÊNCIA =====
+void test_spilled_events_survive_reboot() {
+    {
+        EventLog log;
+        TEST_ASSERT_TRUE(log.begin());
+        for (int i = 0; i < EVENT_LOG_SPILL_BATCH + 8; i++) {
+            log.record(EVENT_RELAY_PULSE, i % 4, 100.0f * i);
+        }
+        // Lote cheio: todo o pendente vai para a flash
+        log.loop();
+        TEST_ASSERT_EQUAL_UINT32((EVENT_LOG_SPILL_BATCH + 8) * sizeof(EventRecord),
+                                 LittleFS.fileSize(EVENT_LOG_DIRECTORY "/0.seg"));
+    }
+
+    EventLog rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(EVENT_LOG_SPILL_BATCH + 8, rebooted.getNextSequence());
+
+    rebooted.record(EVENT_EMERGENCY_MODE, EVENT_LOG_NO_RELAY, 1);
+    std::vector<EventRecord> records = collect(rebooted);
+    TEST_ASSERT_EQUAL(EVENT_LOG_SPILL_BATCH + 9, (int)records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, records[i].sequence);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(3900.0f, records[39].value);
+    TEST_ASSERT_EQUAL(EVENT_EMERGENCY_MODE, records.back().code);
+}
+
+// ===== DESGASTE =====
+void test_spill_rewrite_stays_bounded_after_wraparound() {
+    EventLog log;
+    TEST_ASSERT_TRUE(log.begin());
+
+    // Duas voltas no anel da flash; mede cada lote da segunda
+    size_t worst = 0;
+    for (uint32_t i = 0; i < 2 * EVENT_LOG_FLASH_RECORDS; i++) {
+        log.record(EVENT_RELAY_ON, i % 8, i);
+        size_t before = LittleFS.programmed;
+        log.loop();
+        if (i >= EVENT_LOG_FLASH_RECORDS) {
+            worst = max(worst, LittleFS.programmed - before);
+        }
+    }
+
+    // Um lote anexado custa no máximo o bloco parcial do fim do segmento
+    // mais os 512 bytes do lote (antes copiava até o fim de /events.bin)
+    TEST_ASSERT_LESS_OR_EQUAL(fs::BLOCK_SIZE + EVENT_LOG_SPILL_BATCH * sizeof(EventRecord), worst);
+
+    // Reboot: continua a numeração e lê o que o anel ainda guarda
+    EventLog rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(2 * EVENT_LOG_FLASH_RECORDS, rebooted.getNextSequence());
+    std::vector<EventRecord> records = collect(rebooted, rebooted.getOldestSequence());
+    TEST_ASSERT_EQUAL_UINT32(EVENT_LOG_FLASH_RECORDS, records.size());
+    TEST_ASSERT_EQUAL_UINT32(EVENT_LOG_FLASH_RECORDS, records.front().sequence);
+    TEST_ASSERT_EQUAL_FLOAT(2 * EVENT_LOG_FLASH_RECORDS - 1, records.back().value);
+}
+
+// ===== SEM FLASH =====
+void test_ram_only_ring_counts_dropped() {
+    EventLog log;
+    TEST_ASSERT_TRUE(log.begin(nullptr));
+    for (int i = 0; i < EVENT_LOG_RAM_RECORDS + 6; i++) log.record(EVENT_RELAY_OFF, 2);
+
+    TEST_ASSERT_EQUAL_UINT32(6, log.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(6, log.getOldestSequence());
+    TEST_ASSERT_EQUAL(EVENT_LOG_RAM_RECORDS, (int)collect(log).size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unmounted_partition_falls_back_to_ram);
+    RUN_TEST(test_mounts_history_partition);
+    RUN_TEST(test_spilled_events_survive_reboot);
+    RUN_TEST(test_spill_rewrite_stays_bounded_after_wraparound);
+    RUN_TEST(test_ram_only_ring_counts_dropped);
+    return UNITY_END();
+}
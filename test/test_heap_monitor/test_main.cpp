@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <esp_heap_caps.h>
+#include "HeapMonitor.h"
+
+// Vazamento constante simulado no heap_caps de test/support.
+// HeapMonitor é singleton e não volta ao estado inicial: os testes são
+// fases de um mesmo boot e rodam na ordem de main()
+
+static size_t heap_free = 120000;
+static size_t heap_block = 60000;
+
+// Uma hora de amostras pelo loop(); o vazamento sai em 10 degraus
+// dentro do escopo de "cloud.https", e "web.api" devolve tudo o que pega
+static void runHour(size_t free_leak, size_t block_leak) {
+    HeapMonitor& monitor = HeapMonitor::shared();
+    int8_t cloud = monitor.tag("cloud.https");
+    int8_t web = monitor.tag("web.api");
+
+    for (uint32_t s = 0; s < 3600000UL / HEAP_SAMPLE_INTERVAL_MS; s++) {
+        if (s % 36 == 0 && (free_leak || block_leak)) {
+            ScopedHeapTag scope(cloud);
+            heap_free -= free_leak / 10;
+            heap_block -= block_leak / 10;
+            native::setHeap(heap_free, heap_block);
+        }
+        {
+            ScopedHeapTag scope(web);
+            native::setHeap(heap_free - 2048, heap_block);
+            native::setHeap(heap_free, heap_block);
+        }
+        native::advanceMillis(HEAP_SAMPLE_INTERVAL_MS);
+        monitor.loop();
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ===== HEAP ESTÁVEL =====
+void test_flat_heap_stays_ok() {
+    native::setMillis(1000);
+    native::setHeap(heap_free, heap_block);
+
+    HeapMonitor& monitor = HeapMonitor::shared();
+    monitor.begin();
+    TEST_ASSERT_NULL(monitor.getTopTag());
+
+    for (int hour = 0; hour < 4; hour++) runHour(0, 0);
+    TEST_ASSERT_EQUAL(HEAP_ALERT_OK, monitor.getAlert());
+    TEST_ASSERT_EQUAL_UINT32(60000, monitor.getLargestBlock());
+    TEST_ASSERT_EQUAL(50, monitor.getFragmentation());
+
+    // Escopo que devolve o que pegou não acumula retenção
+    TEST_ASSERT_EQUAL_STRING("web.api", monitor.getTopTag());
+}
+
+void test_loop_respects_sample_interval() {
+    HeapMonitor& monitor = HeapMonitor::shared();
+    native::advanceMillis(HEAP_SAMPLE_INTERVAL_MS);
+    monitor.loop();
+
+    // Queda entre amostras só aparece na próxima
+    native::setHeap(heap_free, 1000);
+    native::advanceMillis(HEAP_SAMPLE_INTERVAL_MS - 1);
+    monitor.loop();
+    TEST_ASSERT_EQUAL_UINT32(60000, monitor.getLargestBlock());
+    TEST_ASSERT_EQUAL(HEAP_ALERT_OK, monitor.getAlert());
+
+    native::setHeap(heap_free, heap_block);
+    native::advanceMillis(1);
+    monitor.loop();
+    TEST_ASSERT_EQUAL_UINT32(60000, monitor.getLargestBlock());
+}
+
+// ===== TENDÊNCIA =====
+void test_steady_leak_raises_trend_before_limit() {
+    HeapMonitor& monitor = HeapMonitor::shared();
+
+    // -3000 B/h de livre e -4000 B/h de maior bloco: cruza os 16384 em ~11h
+    int hours = 0;
+    while (monitor.getAlert() == HEAP_ALERT_OK && hours < 10) {
+        runHour(3000, 4000);
+        hours++;
+    }
+    TEST_ASSERT_EQUAL(HEAP_ALERT_TREND, monitor.getAlert());
+    TEST_ASSERT_LESS_OR_EQUAL(3, hours);
+    TEST_ASSERT_GREATER_THAN(HEAP_DEFAULT_MIN_BLOCK + HEAP_DEFAULT_MIN_BLOCK / 10, monitor.getLargestBlock());
+
+    // Quem vazou lidera a retenção
+    TEST_ASSERT_EQUAL_STRING("cloud.https", monitor.getTopTag());
+}
+
+// ===== LIMITE =====
+void test_low_alert_needs_headroom_to_clear() {
+    HeapMonitor& monitor = HeapMonitor::shared();
+
+    native::setHeap(HEAP_DEFAULT_MIN_FREE - 1000, 20000);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_LOW, monitor.getAlert());
+
+    // Acima do limite, mas dentro dos 10% de histerese
+    native::setHeap(HEAP_DEFAULT_MIN_FREE + 2000, 20000);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_LOW, monitor.getAlert());
+
+    // Saiu do "low", mas a queda das últimas horas ainda projeta o limite
+    native::setHeap(HEAP_DEFAULT_MIN_FREE + 4000, 20000);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_TREND, monitor.getAlert());
+}
+
+void test_fragmented_block_alone_triggers_low() {
+    HeapMonitor& monitor = HeapMonitor::shared();
+
+    // Livre de sobra, mas sem bloco para o buffer TLS
+    native::setHeap(100000, HEAP_DEFAULT_MIN_BLOCK - 384);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_LOW, monitor.getAlert());
+    TEST_ASSERT_EQUAL(84, monitor.getFragmentation());
+
+    native::setHeap(100000, HEAP_DEFAULT_MIN_BLOCK + 616);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_LOW, monitor.getAlert());
+
+    native::setHeap(100000, HEAP_DEFAULT_MIN_BLOCK + HEAP_DEFAULT_MIN_BLOCK / 10);
+    monitor.sample();
+    TEST_ASSERT_EQUAL(HEAP_ALERT_TREND, monitor.getAlert());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_flat_heap_stays_ok);
+    RUN_TEST(test_loop_respects_sample_interval);
+    RUN_TEST(test_steady_leak_raises_trend_before_limit);
+    RUN_TEST(test_low_alert_needs_headroom_to_clear);
+    RUN_TEST(test_fragmented_block_alone_triggers_low);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+#include <unity.h>
+#include <memory>
+#include <string>
+#include "HistoryAPI.h"
+
+// Respostas chunked do /api/history sobre um TimeSeriesStore em FS de
+// memória, lidas em pedaços de tamanhos diferentes (janela do AsyncTCP)
+
+typedef std::unique_ptr<AsyncWebServerResponse> Response;
+
+static fs::FS memory;
+
+// pH sobe 0.01 a cada amostra de 10 s: valores previsíveis na resposta
+static void record(TimeSeriesStore& store, SensorBus& bus, uint32_t samples) {
+    for (uint32_t i = 0; i < samples; i++) {
+        native::advanceMillis(TS_RAW_INTERVAL_MS);
+        bus.publish(SENSOR_PH, 6.0 + 0.01 * (i % 100), millis());
+        store.loop();
+    }
+}
+
+static std::string series(AsyncWebServer& server, const AsyncWebServer::Pairs& query, size_t chunk = 64) {
+    Response response(server.dispatch(HTTP_GET, "/api/history", {}, query));
+    TEST_ASSERT_NOT_NULL(response.get());
+    TEST_ASSERT_EQUAL(200, response->code());
+    return response->body(chunk);
+}
+
+static int countPoints(const std::string& body) {
+    size_t start = body.find("\"points\":[");
+    int points = 0;
+    for (size_t at = body.find("[", start + 10); at != std::string::npos; at = body.find("[", at + 1)) {
+        points++;
+    }
+    return points;
+}
+
+static uint32_t nextOf(const std::string& body) {
+    size_t at = body.find("\"next\":");
+    return at == std::string::npos ? 0 : strtoul(body.c_str() + at + 7, nullptr, 10);
+}
+
+struct Fixture {
+    SensorBus bus;
+    TimeSeriesStore store;
+    AsyncWebServer server;
+    HistoryAPI api;
+
+    Fixture() {
+        TEST_ASSERT_TRUE(store.begin(&bus, memory));
+        api.begin(&server, store);
+    }
+};
+
+void setUp() {
+    memory.wipe();
+    native::setMillis(0);
+}
+
+void tearDown() {}
+
+// ===== CHUNKS =====
+void test_small_chunks_match_single_pass() {
+    Fixture f;
+    record(f.store, f.bus, 360);
+    AsyncWebServer::Pairs query = {{"channels", "ph,ec"}, {"tier", "raw"}, {"points", "60"}, {"minmax", "1"}};
+
+    std::string whole = series(f.server, query, 64 * 1024);
+    std::string pieces = series(f.server, query, 7);
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), pieces.c_str());
+
+    TEST_ASSERT_EQUAL(0, (int)whole.find("{\"tier\":\"raw\""));
+    TEST_ASSERT_TRUE(whole.find("\"channels\":[\"ph\",\"ec\"]") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING("]}", whole.substr(whole.size() - 2).c_str());
+    TEST_ASSERT_TRUE(countPoints(whole) >= 59 && countPoints(whole) <= 61);
+    TEST_ASSERT_EQUAL(0, f.api.getActiveStreams());
+}
+
+void test_rows_beyond_one_batch_are_all_sent() {
+    Fixture f;
+    record(f.store, f.bus, HISTORY_CHUNK_ROWS * 5 + 3);
+
+    std::string body = series(f.server, {{"channels", "ph"}, {"tier", "raw"}, {"points", "0"}}, 5);
+    TEST_ASSERT_EQUAL(HISTORY_CHUNK_ROWS * 5 + 3, countPoints(body));
+    TEST_ASSERT_TRUE(body.find("\"next\"") == std::string::npos);
+}
+
+// ===== PAGINAÇÃO =====
+void test_pages_follow_next_without_gaps() {
+    Fixture f;
+    record(f.store, f.bus, 50);
+    int total = 0;
+    uint32_t next = 1;
+    for (int page = 0; page < 20 && next; page++) {
+        std::string body = series(f.server, {{"channels", "ph"}, {"tier", "raw"}, {"from", String(next)},
+                                             {"points", "0"}, {"limit", "12"}}, 16);
+        int points = countPoints(body);
+        TEST_ASSERT_TRUE(points <= 12);
+        total += points;
+        uint32_t following = nextOf(body);
+        if (following) TEST_ASSERT_GREATER_THAN(next, following);
+        next = following;
+    }
+    TEST_ASSERT_EQUAL(50, total);
+    TEST_ASSERT_EQUAL(0, next);
+}
+
+void test_zero_limit_is_clamped_to_one() {
+    Fixture f;
+    record(f.store, f.bus, 3);
+
+    std::string body = series(f.server, {{"channels", "ph"}, {"tier", "raw"}, {"points", "0"}, {"limit", "0"}});
+    TEST_ASSERT_EQUAL(1, countPoints(body));
+    TEST_ASSERT_GREATER_THAN(0, nextOf(body));
+}
+
+void test_empty_range_closes_json() {
+    Fixture f;
+    record(f.store, f.bus, 10);
+
+    // Antes da primeira amostra (10 s)
+    std::string body = series(f.server, {{"channels", "ph"}, {"tier", "raw"}, {"from", "1"},
+                                         {"to", "5"}, {"points", "0"}}, 3);
+    TEST_ASSERT_EQUAL(0, countPoints(body));
+    TEST_ASSERT_EQUAL_STRING("\"points\":[]}", body.substr(body.size() - 12).c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_small_chunks_match_single_pass);
+    RUN_TEST(test_rows_beyond_one_batch_are_all_sent);
+    RUN_TEST(test_pages_follow_next_without_gaps);
+    RUN_TEST(test_zero_limit_is_clamped_to_one);
+    RUN_TEST(test_empty_range_closes_json);
+    return UNITY_END();
+}
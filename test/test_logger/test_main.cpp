@@ -0,0 +1,154 @@
+#include <unity.h>
+#include <string>
+#include "Logger.h"
+
+// Logger sobre a Serial e o stream buffer de test/support. Logger é
+// singleton e não volta ao estado inicial: os testes são fases de um
+// mesmo boot e rodam na ordem de main()
+
+static std::string out;
+
+// Tempo para o balde de linhas encher de novo
+static void refill() {
+    native::advanceMillis(LOG_RATE_BURST * 1000 / LOG_RATE_LINES_PER_S + 1000);
+}
+
+static std::string expected(char level, const char* module, const char* text) {
+    char buffer[LOG_LINE_SIZE];
+    snprintf(buffer, sizeof(buffer), "[%lu][%c][%s] %s\n", millis(), level, module, text);
+    return buffer;
+}
+
+static size_t countLines(const std::string& text) {
+    size_t lines = 0;
+    for (char c : text) lines += c == '\n';
+    return lines;
+}
+
+void setUp() {
+    out.clear();
+    Serial.capture(&out);
+}
+
+void tearDown() {
+    Serial.capture(nullptr);
+}
+
+// ===== FORMATAÇÃO =====
+void test_write_formats_one_line_per_call() {
+    native::setMillis(1000);
+    Logger& logger = Logger::shared();
+
+    logger.write(LOG_LEVEL_INFO, "TEST", "pH %.2f", 6.5);
+    TEST_ASSERT_EQUAL_STRING(expected('I', "TEST", "pH 6.50").c_str(), out.c_str());
+
+    // Mensagem antiga que já termina em \n não ganha linha em branco
+    out.clear();
+    logger.write(LOG_LEVEL_WARN, "TEST", "pronto\n");
+    TEST_ASSERT_EQUAL_STRING(expected('W', "TEST", "pronto").c_str(), out.c_str());
+
+    // Nível fora da tabela não lê além das letras
+    out.clear();
+    logger.write(9, "TEST", "x");
+    TEST_ASSERT_EQUAL_STRING(expected('-', "TEST", "x").c_str(), out.c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, logger.getLinesWritten());
+}
+
+void test_long_message_is_cut_and_still_ends_the_line() {
+    Logger& logger = Logger::shared();
+    std::string big(LOG_LINE_SIZE * 2, 'x');
+
+    logger.write(LOG_LEVEL_INFO, "TEST", "%s", big.c_str());
+    TEST_ASSERT_EQUAL(LOG_LINE_SIZE - 1, (int)out.size());
+    TEST_ASSERT_EQUAL('\n', out.back());
+    TEST_ASSERT_EQUAL(1, (int)countLines(out));
+    std::string prefix = expected('I', "TEST", "");
+    prefix.pop_back();
+    TEST_ASSERT_EQUAL(0, (int)out.find(prefix + "xxx"));
+}
+
+// ===== LIMITE DE TAXA =====
+void test_token_bucket_suppresses_bursts() {
+    Logger& logger = Logger::shared();
+    refill();
+    uint32_t written = logger.getLinesWritten();
+    uint32_t suppressed = logger.getLinesSuppressed();
+
+    for (int i = 0; i < LOG_RATE_BURST + 5; i++) {
+        logger.write(LOG_LEVEL_INFO, "TEST", "linha %d", i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(written + LOG_RATE_BURST, logger.getLinesWritten());
+    TEST_ASSERT_EQUAL_UINT32(suppressed + 5, logger.getLinesSuppressed());
+    TEST_ASSERT_TRUE(out.find("linha 79\n") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("linha 80\n") == std::string::npos);
+}
+
+void test_suppressed_lines_are_reported_once_before_the_next() {
+    Logger& logger = Logger::shared();
+
+    // Balde vazio (fase anterior), mas erros passam sempre e levam o aviso
+    logger.write(LOG_LEVEL_ERROR, "TEST", "falha");
+    TEST_ASSERT_EQUAL_STRING((expected('W', "LOG", "5 linhas suprimidas") + expected('E', "TEST", "falha")).c_str(),
+                             out.c_str());
+
+    out.clear();
+    logger.write(LOG_LEVEL_ERROR, "TEST", "outra");
+    TEST_ASSERT_EQUAL_STRING(expected('E', "TEST", "outra").c_str(), out.c_str());
+
+    // Reposição de LOG_RATE_LINES_PER_S por segundo: 50 ms dão 2 linhas
+    native::advanceMillis(2000 / LOG_RATE_LINES_PER_S);
+    out.clear();
+    logger.write(LOG_LEVEL_INFO, "TEST", "a");
+    logger.write(LOG_LEVEL_INFO, "TEST", "b");
+    logger.write(LOG_LEVEL_INFO, "TEST", "c");
+    TEST_ASSERT_EQUAL_STRING((expected('I', "TEST", "a") + expected('I', "TEST", "b")).c_str(), out.c_str());
+
+    native::advanceMillis(1000 / LOG_RATE_LINES_PER_S);
+    out.clear();
+    logger.write(LOG_LEVEL_INFO, "TEST", "d");
+    TEST_ASSERT_EQUAL_STRING((expected('W', "LOG", "1 linhas suprimidas") + expected('I', "TEST", "d")).c_str(),
+                             out.c_str());
+}
+
+// ===== FILA =====
+void test_full_queue_drops_whole_lines() {
+    Logger& logger = Logger::shared();
+    native::setTaskCreation(true);
+    TEST_ASSERT_TRUE(logger.begin());
+    NativeStreamBuffer* stream = native::lastStreamBuffer();
+    TEST_ASSERT_NOT_NULL(stream);
+
+    // A task de drenagem nunca roda aqui: a fila só enche
+    refill();
+    std::string body(80, 'x');
+    uint32_t dropped = logger.getLinesDropped();
+    int lines = 0;
+    while (logger.getLinesDropped() == dropped && lines < LOG_RATE_BURST) {
+        logger.write(LOG_LEVEL_INFO, "TEST", "%s", body.c_str());
+        lines++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped + 1, logger.getLinesDropped());
+    TEST_ASSERT_TRUE(out.empty());
+
+    // Só linhas inteiras na fila; a que não coube saiu por completo
+    size_t line_size = expected('I', "TEST", body.c_str()).size();
+    TEST_ASSERT_EQUAL(lines - 1, (int)countLines(stream->data));
+    TEST_ASSERT_EQUAL_UINT32((lines - 1) * line_size, stream->data.size());
+    TEST_ASSERT_LESS_THAN(line_size, LOGGER_QUEUE_BYTES - stream->data.size());
+
+    // Drenada, volta a aceitar
+    stream->data.clear();
+    logger.write(LOG_LEVEL_INFO, "TEST", "%s", body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(dropped + 1, logger.getLinesDropped());
+    TEST_ASSERT_EQUAL_UINT32(line_size, stream->data.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_write_formats_one_line_per_call);
+    RUN_TEST(test_long_message_is_cut_and_still_ends_the_line);
+    RUN_TEST(test_token_bucket_suppresses_bursts);
+    RUN_TEST(test_suppressed_lines_are_reported_once_before_the_next);
+    RUN_TEST(test_full_queue_drops_whole_lines);
+    return UNITY_END();
+}
@@ -0,0 +1,161 @@
+#include <unity.h>
+#include <functional>
+#include "SensorHealth.h"
+
+// Monitor de saúde alimentado pelo SensorSampleStore, uma amostra de pH
+// por segundo (cadência do SensorTask); a bomba de pH- é o relé 3
+
+static const int PH_PUMP = 3;
+
+static SensorSampleStore* store;
+static SensorHealthMonitor* monitor;
+
+// Publica e avalia uma amostra por segundo durante seconds
+static void run(unsigned long seconds, std::function<float(unsigned long)> value) {
+    for (unsigned long s = 0; s < seconds; s++) {
+        native::advanceMillis(1000);
+        store->publish(SENSOR_PH, value(millis() / 1000), true, millis());
+        monitor->update(*store, millis());
+    }
+}
+
+// Tanque calmo: ±0,001 pH (dentro do limiar de valor parado)
+static float quiet(unsigned long t) { return 6.5 + 0.001 * (t % 2); }
+
+// Sonda viva: variação pequena acima do limiar de valor parado
+static float live(unsigned long t) { return 6.5 + 0.01 * (t % 3); }
+
+static const SensorHealthStatus& ph() { return monitor->getStatus(SENSOR_PH); }
+
+// Dose sem efeito: a leitura segue igual até o prazo de resposta
+static void unansweredDose(std::function<float(unsigned long)> value) {
+    monitor->notifyDosing(PH_PUMP, millis());
+    run(SENSOR_HEALTH_RESPONSE_TIMEOUT_MS / 1000 + 1, value);
+}
+
+void setUp() {
+    native::setMillis(0);
+    store = new SensorSampleStore();
+    monitor = new SensorHealthMonitor();
+}
+
+void tearDown() {
+    delete monitor;
+    delete store;
+}
+
+// ===== VALOR PARADO =====
+void test_quiet_tank_warns_but_stays_usable() {
+    run(SENSOR_HEALTH_STUCK_MS / 1000 + SENSOR_HEALTH_WINDOW + 1, quiet);
+
+    TEST_ASSERT_TRUE(ph().flags & SENSOR_FLAG_STUCK);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_WARNING, ph().level);
+    TEST_ASSERT_TRUE(monitor->isUsable(SENSOR_PH));
+    TEST_ASSERT_FALSE(monitor->hasFailure());
+
+    // Voltou a variar: aviso some
+    run(SENSOR_HEALTH_WINDOW, live);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+}
+
+void test_stuck_probe_degrades_after_unanswered_dose() {
+    run(SENSOR_HEALTH_STUCK_MS / 1000 + SENSOR_HEALTH_WINDOW + 1, quiet);
+    TEST_ASSERT_TRUE(monitor->isUsable(SENSOR_PH));
+
+    // Uma dose sem resposta basta quando o valor já estava parado
+    unansweredDose(quiet);
+    TEST_ASSERT_EQUAL(1, ph().response_failures);
+    TEST_ASSERT_FALSE(ph().flags & SENSOR_FLAG_NO_RESPONSE);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_DEGRADED, ph().level);
+    TEST_ASSERT_FALSE(monitor->isUsable(SENSOR_PH));
+    TEST_ASSERT_FALSE(monitor->isUsable("ph"));
+}
+
+void test_silent_channel_fails() {
+    run(SENSOR_HEALTH_WINDOW, live);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+
+    // Sem publicação além do prazo
+    native::advanceMillis(SENSOR_HEALTH_STALE_MS + 1000);
+    monitor->update(*store, millis());
+    TEST_ASSERT_TRUE(ph().flags & SENSOR_FLAG_STALE);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_FAILED, ph().level);
+    TEST_ASSERT_TRUE(monitor->hasFailure());
+}
+
+// ===== RUÍDO =====
+void test_noise_degrades_with_hysteresis() {
+    // ±0,3 alternado: desvio estimado ~0,42 (limite 0,15)
+    run(SENSOR_HEALTH_WINDOW, [](unsigned long t) { return 6.5 + (t % 2 ? 0.3 : -0.3); });
+    TEST_ASSERT_TRUE(ph().flags & SENSOR_FLAG_NOISY);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_DEGRADED, ph().level);
+
+    // ~0,127: abaixo do limite, acima dos 70% para sair
+    run(SENSOR_HEALTH_WINDOW, [](unsigned long t) { return 6.5 + (t % 2 ? 0.09 : -0.09); });
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.127, ph().noise);
+    TEST_ASSERT_TRUE(ph().flags & SENSOR_FLAG_NOISY);
+
+    run(SENSOR_HEALTH_WINDOW, [](unsigned long t) { return 6.5 + (t % 2 ? 0.03 : -0.03); });
+    TEST_ASSERT_FALSE(ph().flags & SENSOR_FLAG_NOISY);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+}
+
+// ===== RESPOSTA À DOSAGEM =====
+void test_two_unanswered_doses_degrade() {
+    run(SENSOR_HEALTH_WINDOW, live);
+
+    unansweredDose(live);
+    TEST_ASSERT_EQUAL(1, ph().response_failures);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+
+    unansweredDose(live);
+    TEST_ASSERT_TRUE(ph().flags & SENSOR_FLAG_NO_RESPONSE);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_DEGRADED, ph().level);
+
+    // Reconhecimento manual (sonda limpa) libera na próxima avaliação
+    monitor->acknowledgeResponse(SENSOR_PH);
+    run(1, live);
+    TEST_ASSERT_EQUAL(0, ph().response_failures);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+}
+
+void test_retry_window_forgives_one_failure_for_a_probe_dose() {
+    run(SENSOR_HEALTH_WINDOW, live);
+    unansweredDose(live);
+    unansweredDose(live);
+    TEST_ASSERT_FALSE(monitor->isUsable(SENSOR_PH));
+
+    // Antes das 2 h continua bloqueado
+    run(SENSOR_HEALTH_RESPONSE_RETRY_MS / 1000 - 60, live);
+    TEST_ASSERT_FALSE(monitor->isUsable(SENSOR_PH));
+
+    // Depois, uma falha é perdoada e a dose de prova é liberada
+    run(61, live);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_RESPONSE_FAILURES - 1, ph().response_failures);
+    TEST_ASSERT_TRUE(monitor->isUsable(SENSOR_PH));
+
+    // Prova sem resposta: volta a degradar
+    unansweredDose(live);
+    TEST_ASSERT_FALSE(monitor->isUsable(SENSOR_PH));
+
+    // Nova prova, desta vez a leitura se move: falhas zeradas
+    run(SENSOR_HEALTH_RESPONSE_RETRY_MS / 1000, live);
+    TEST_ASSERT_TRUE(monitor->isUsable(SENSOR_PH));
+    unsigned long dose_s = millis() / 1000;
+    monitor->notifyDosing(PH_PUMP, millis());
+    run(SENSOR_HEALTH_WINDOW, [dose_s](unsigned long t) { return live(t) - (t > dose_s + 5 ? 0.2 : 0.0); });
+    TEST_ASSERT_EQUAL(0, ph().response_failures);
+    TEST_ASSERT_TRUE(ph().last_response_ms > 0);
+    TEST_ASSERT_EQUAL(SENSOR_HEALTH_OK, ph().level);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_quiet_tank_warns_but_stays_usable);
+    RUN_TEST(test_stuck_probe_degrades_after_unanswered_dose);
+    RUN_TEST(test_silent_channel_fails);
+    RUN_TEST(test_noise_degrades_with_hysteresis);
+    RUN_TEST(test_two_unanswered_doses_degrade);
+    RUN_TEST(test_retry_window_forgives_one_failure_for_a_probe_dose);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "SignalFilters.h"
+
+using namespace SignalFilters;
+
+static std::mt19937 rng;
+
+// Conta comparações: o custo do quickselect sem depender do relógio
+struct Counted {
+    int value;
+    static unsigned long comparisons;
+    bool operator<(const Counted& other) const { comparisons++; return value < other.value; }
+    operator float() const { return (float)value; }
+};
+unsigned long Counted::comparisons = 0;
+
+// Mediana antiga do TDSReaderSerial (bubble sort sobre uma cópia)
+static float bubbleMedian(const int* data, int n) {
+    std::vector<int> tab(data, data + n);
+    for (int j = 0; j < n - 1; j++) {
+        for (int i = 0; i < n - j - 1; i++) {
+            if (tab[i] > tab[i + 1]) std::swap(tab[i], tab[i + 1]);
+        }
+    }
+    return (n & 1) ? tab[(n - 1) / 2] : (tab[n / 2] + tab[n / 2 - 1]) / 2.0f;
+}
+
+static std::vector<int> samples(size_t n, int distinct) {
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; i++) data[i] = 2000 + (int)(rng() % distinct);
+    return data;
+}
+
+void setUp() {
+    rng.seed(42);
+    Counted::comparisons = 0;
+}
+
+void tearDown() {}
+
+// ===== SELEÇÃO =====
+void test_select_matches_sort() {
+    const int distincts[] = {1, 2, 5, 4096};
+    for (int distinct : distincts) {
+        for (size_t n = 1; n <= 64; n++) {
+            std::vector<int> data = samples(n, distinct);
+            std::vector<int> sorted = data;
+            std::sort(sorted.begin(), sorted.end());
+
+            for (size_t k = 0; k < n; k++) {
+                std::vector<int> work = data;
+                select(work.data(), 0, n, k);
+                TEST_ASSERT_EQUAL_INT(sorted[k], work[k]);
+                for (size_t i = 0; i < k; i++) TEST_ASSERT_TRUE(work[i] <= work[k]);
+                for (size_t i = k + 1; i < n; i++) TEST_ASSERT_TRUE(work[k] <= work[i]);
+            }
+        }
+    }
+}
+
+void test_select_is_linear_on_repeated_values() {
+    // Lomuto com '<' estrito fazia ~n^2/2 comparações com todos iguais
+    const size_t n = 3000;
+    std::vector<Counted> equal(n, Counted{2048});
+    median(equal.data(), n);
+    TEST_ASSERT_LESS_THAN(4 * n, Counted::comparisons);
+
+    // ADC parado: poucas contagens distintas
+    Counted::comparisons = 0;
+    std::vector<Counted> quantized(n);
+    for (size_t i = 0; i < n; i++) quantized[i].value = 2047 + (int)(rng() % 3);
+    median(quantized.data(), n);
+    TEST_ASSERT_LESS_THAN(8 * n, Counted::comparisons);
+
+    // Já ordenado (pivô pela mediana de 3)
+    Counted::comparisons = 0;
+    std::vector<Counted> ascending(n);
+    for (size_t i = 0; i < n; i++) ascending[i].value = (int)i;
+    median(ascending.data(), n);
+    TEST_ASSERT_LESS_THAN(8 * n, Counted::comparisons);
+}
+
+void test_median_and_trimmed_mean() {
+    int odd[] = {5, 1, 4, 2, 3};
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.0, median(odd, 5));
+    int even[] = {7, 1, 3, 5};
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 4.0, median(even, 4));
+    int same[] = {9, 9, 9, 9};
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 9.0, median(same, 4));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, median(odd, 0));
+
+    // Como o phSensor: 10 leituras, descarta 2 + 2
+    int readings[] = {100, 2010, 2000, 2005, 4095, 1990, 2000, 2015, 0, 1995};
+    float expected = (1995 + 2000 + 2000 + 2005 + 2010 + 1990) / 6.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.001, expected, trimmedMean(readings, 10, 2));
+}
+
+// ===== FILTROS DE JANELA =====
+void test_running_median_window() {
+    RunningMedian<int, 5> window;
+    const int input[] = {5, 1, 9, 3, 7, 2, 2, 8};
+    for (int value : input) window.push(value);
+
+    // Janela = {3, 7, 2, 2, 8}
+    TEST_ASSERT_TRUE(window.isFull());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.0, window.get());
+    TEST_ASSERT_EQUAL_INT(2, window.getMin());
+    TEST_ASSERT_EQUAL_INT(8, window.getMax());
+}
+
+void test_hampel_rejects_outliers() {
+    HampelFilter<int, 9> hampel(3.0f, 10.0f);
+    for (int i = 0; i < 9; i++) hampel.filter(2000 + (i % 3));
+
+    TEST_ASSERT_FLOAT_WITHIN(2.0, 2001.0, hampel.filter(4095));
+    TEST_ASSERT_EQUAL_UINT32(1, hampel.getOutlierCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2005.0, hampel.filter(2005));   // Dentro do desvio mínimo
+    TEST_ASSERT_EQUAL_UINT32(1, hampel.getOutlierCount());
+}
+
+// ===== BENCHMARK =====
+void test_benchmark_against_bubble_sort_median() {
+    const size_t sizes[] = {30, 300, 3000};
+    const int distincts[] = {3, 4096};
+    for (size_t n : sizes) {
+        for (int distinct : distincts) {
+            std::vector<int> data = samples(n, distinct);
+            std::vector<int> scratch(n);
+            const int rounds = n <= 300 ? 200 : 5;
+
+            float fast = 0, slow = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < rounds; r++) fast = medianCopy(data.data(), scratch.data(), n);
+            auto t1 = std::chrono::steady_clock::now();
+            for (int r = 0; r < rounds; r++) slow = bubbleMedian(data.data(), (int)n);
+            auto t2 = std::chrono::steady_clock::now();
+
+            TEST_ASSERT_FLOAT_WITHIN(0.001, slow, fast);
+
+            char line[96];
+            snprintf(line, sizeof(line), "n=%zu distintos=%d: select %.2f us, bubble sort %.2f us",
+                     n, distinct,
+                     std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds,
+                     std::chrono::duration<double, std::micro>(t2 - t1).count() / rounds);
+            TEST_MESSAGE(line);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_select_matches_sort);
+    RUN_TEST(test_select_is_linear_on_repeated_values);
+    RUN_TEST(test_median_and_trimmed_mean);
+    RUN_TEST(test_running_median_window);
+    RUN_TEST(test_hampel_rejects_outliers);
+    RUN_TEST(test_benchmark_against_bubble_sort_median);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <unity.h>
+#include <memory>
+#include "SnapshotCache.h"
+
+// Cache de snapshots atrás do ESPAsyncWebServer simulado (test/support),
+// que descarta os cabeçalhos não declarados como o 1.2.x
+
+typedef std::unique_ptr<AsyncWebServerResponse> Response;
+
+static int state;
+static int builds;
+
+static void buildState(String& out) {
+    builds++;
+    out = String("{\"state\":") + String(state) + "}";
+}
+
+static Response get(AsyncWebServer& server, const char* url, const std::string& etag = "") {
+    AsyncWebServer::Pairs headers;
+    if (!etag.empty()) headers.push_back({"If-None-Match", etag.c_str()});
+    return Response(server.dispatch(HTTP_GET, url, headers));
+}
+
+void setUp() {
+    state = 1;
+    builds = 0;
+}
+
+void tearDown() {}
+
+// ===== 304 =====
+void test_second_get_returns_304() {
+    SnapshotCache cache;
+    AsyncWebServer server;
+    int8_t topic = cache.registerTopic("state", buildState);
+    cache.attach(&server, "/api/state", topic);
+
+    Response first = get(server, "/api/state");
+    TEST_ASSERT_NOT_NULL(first.get());
+    TEST_ASSERT_EQUAL(200, first->code());
+    TEST_ASSERT_EQUAL_STRING("{\"state\":1}", first->body().c_str());
+    std::string etag = first->header("ETag");
+    TEST_ASSERT_FALSE(etag.empty());
+
+    Response second = get(server, "/api/state", etag);
+    TEST_ASSERT_EQUAL(304, second->code());
+    TEST_ASSERT_EQUAL_STRING(etag.c_str(), second->header("ETag").c_str());
+    TEST_ASSERT_TRUE(second->body().empty());
+    TEST_ASSERT_EQUAL(1, builds);
+}
+
+void test_plain_route_never_sees_if_none_match() {
+    // O motivo do attach(): com server->on() o cabeçalho é descartado
+    SnapshotCache cache;
+    AsyncWebServer server;
+    int8_t topic = cache.registerTopic("state", buildState);
+    server.on("/api/state", HTTP_GET, [&cache, topic](AsyncWebServerRequest* request) {
+        cache.send(request, topic);
+    });
+
+    Response first = get(server, "/api/state");
+    Response second = get(server, "/api/state", first->header("ETag"));
+    TEST_ASSERT_EQUAL(200, second->code());
+}
+
+void test_state_change_invalidates_etag() {
+    SnapshotCache cache;
+    AsyncWebServer server;
+    int8_t topic = cache.registerTopic("state", buildState, []() { return (uint32_t)state; });
+    cache.attach(&server, "/api/state", topic);
+
+    std::string etag = get(server, "/api/state")->header("ETag");
+
+    state = 2;
+    Response changed = get(server, "/api/state", etag);
+    TEST_ASSERT_EQUAL(200, changed->code());
+    TEST_ASSERT_EQUAL_STRING("{\"state\":2}", changed->body().c_str());
+    TEST_ASSERT_TRUE(changed->header("ETag") != etag);
+
+    // invalidate() também avança a geração
+    etag = changed->header("ETag");
+    cache.invalidate(topic);
+    TEST_ASSERT_EQUAL(200, get(server, "/api/state", etag)->code());
+}
+
+void test_in_flight_response_keeps_its_buffer() {
+    SnapshotCache cache;
+    AsyncWebServer server;
+    int8_t topic = cache.registerTopic("state", buildState, []() { return (uint32_t)state; });
+    cache.attach(&server, "/api/state", topic);
+
+    // Resposta ainda não enviada quando o estado muda e outro cliente pede
+    Response slow = get(server, "/api/state");
+    state = 2;
+    Response fast = get(server, "/api/state");
+
+    TEST_ASSERT_EQUAL_STRING("{\"state\":2}", fast->body().c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"state\":1}", slow->body(4).c_str());
+}
+
+void test_custom_handler_route_keeps_header() {
+    // Forma usada pelo DiagWebServer (verifica o estado antes de send())
+    SnapshotCache cache;
+    AsyncWebServer server;
+    int8_t topic = cache.registerTopic("state", buildState);
+    bool available = true;
+    cache.attach(&server, "/status", [&](AsyncWebServerRequest* request) {
+        if (!available) {
+            request->send(503, "application/json", "{}");
+            return;
+        }
+        cache.send(request, topic);
+    });
+
+    std::string etag = get(server, "/status")->header("ETag");
+    TEST_ASSERT_EQUAL(304, get(server, "/status", etag)->code());
+    available = false;
+    TEST_ASSERT_EQUAL(503, get(server, "/status", etag)->code());
+
+    // Só GET no caminho exato
+    TEST_ASSERT_NULL(server.dispatch(HTTP_POST, "/status"));
+    TEST_ASSERT_NULL(server.dispatch(HTTP_GET, "/status/extra"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_second_get_returns_304);
+    RUN_TEST(test_plain_route_never_sees_if_none_match);
+    RUN_TEST(test_state_change_invalidates_etag);
+    RUN_TEST(test_in_flight_response_keeps_its_buffer);
+    RUN_TEST(test_custom_handler_route_keeps_header);
+    return UNITY_END();
+}
@@ -0,0 +1,118 @@
+#include <unity.h>
+#include <memory>
+#include "StaticAssets.h"
+
+// Assets do SPIFFS em memória atrás do ESPAsyncWebServer simulado,
+// que descarta os cabeçalhos não declarados como o 1.2.x
+
+typedef std::unique_ptr<AsyncWebServerResponse> Response;
+
+static void writeFile(const char* path, const char* content) {
+    File file = SPIFFS.open(path, "w");
+    file.print(content);
+    file.close();
+}
+
+static Response get(AsyncWebServer& server, const char* url, const AsyncWebServer::Pairs& headers = {}) {
+    return Response(server.dispatch(HTTP_GET, url, headers));
+}
+
+void setUp() {
+    SPIFFS.wipe();
+    writeFile("/style.css", "body{}");
+    writeFile("/style.css.gz", "GZ-CSS");
+    writeFile("/logo.svg", "<svg/>");
+    writeFile(ASSET_MANIFEST_PATH, "/style.css 0123456789abcdef\n");
+}
+
+void tearDown() {}
+
+// ===== CABEÇALHOS =====
+void test_gzip_when_client_accepts() {
+    StaticAssets assets;
+    AsyncWebServer server;
+    TEST_ASSERT_TRUE(assets.begin());
+    assets.attach(&server, "/style.css", "/style.css");
+
+    Response gz = get(server, "/style.css", {{"Accept-Encoding", "gzip, deflate"}});
+    TEST_ASSERT_EQUAL(200, gz->code());
+    TEST_ASSERT_EQUAL_STRING("GZ-CSS", gz->body().c_str());
+    TEST_ASSERT_EQUAL_STRING("gzip", gz->header("Content-Encoding").c_str());
+    TEST_ASSERT_EQUAL_STRING("\"0123456789abcdef-gz\"", gz->header("ETag").c_str());
+
+    Response raw = get(server, "/style.css");
+    TEST_ASSERT_EQUAL_STRING("body{}", raw->body().c_str());
+    TEST_ASSERT_FALSE(raw->hasHeader("Content-Encoding"));
+    TEST_ASSERT_EQUAL_STRING("\"0123456789abcdef\"", raw->header("ETag").c_str());
+}
+
+void test_matching_etag_returns_304() {
+    StaticAssets assets;
+    AsyncWebServer server;
+    assets.begin();
+    assets.attach(&server, "/style.css", "/style.css");
+
+    AsyncWebServer::Pairs headers = {{"Accept-Encoding", "gzip"}};
+    std::string etag = get(server, "/style.css", headers)->header("ETag");
+    headers.push_back({"If-None-Match", etag.c_str()});
+
+    Response cached = get(server, "/style.css", headers);
+    TEST_ASSERT_EQUAL(304, cached->code());
+    TEST_ASSERT_TRUE(cached->body().empty());
+
+    // ETag do gzip não vale para a representação raw
+    TEST_ASSERT_EQUAL(200, get(server, "/style.css", {{"If-None-Match", etag.c_str()}})->code());
+}
+
+void test_custom_handler_route_keeps_headers() {
+    // Forma usada pelo AdminWebSocketServer/WiFiConfigServer (fallback próprio)
+    StaticAssets assets;
+    AsyncWebServer server;
+    assets.begin();
+    assets.attach(&server, "/", [&assets](AsyncWebServerRequest* request) {
+        if (!assets.serve(request, "/style.css")) request->send(200, "text/html", "fallback");
+    });
+
+    Response gz = get(server, "/", {{"Accept-Encoding", "gzip"}});
+    TEST_ASSERT_EQUAL_STRING("gzip", gz->header("Content-Encoding").c_str());
+}
+
+// ===== FALLBACK =====
+void test_fallback_serves_files_but_hides_manifest() {
+    StaticAssets assets;
+    AsyncWebServer server;
+    assets.begin();
+    assets.attach(&server, "/style.css", "/style.css");
+    assets.attachFallback(&server);
+
+    TEST_ASSERT_EQUAL_STRING("<svg/>", get(server, "/logo.svg")->body().c_str());
+    TEST_ASSERT_NULL(server.dispatch(HTTP_GET, ASSET_MANIFEST_PATH));
+
+    // Rotas de attach() continuam na frente do serveStatic
+    TEST_ASSERT_TRUE(get(server, "/style.css")->hasHeader("ETag"));
+}
+
+void test_without_manifest_serves_plain_file() {
+    SPIFFS.remove(ASSET_MANIFEST_PATH);
+    StaticAssets assets;
+    AsyncWebServer server;
+    TEST_ASSERT_FALSE(assets.begin());
+    assets.attach(&server, "/style.css", "/style.css");
+
+    Response raw = get(server, "/style.css", {{"Accept-Encoding", "gzip"}});
+    TEST_ASSERT_EQUAL_STRING("body{}", raw->body().c_str());
+    TEST_ASSERT_FALSE(raw->hasHeader("ETag"));
+
+    assets.attach(&server, "/missing.css", "/missing.css");
+    TEST_ASSERT_EQUAL(404, get(server, "/missing.css")->code());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_gzip_when_client_accepts);
+    RUN_TEST(test_matching_etag_returns_304);
+    RUN_TEST(test_custom_handler_route_keeps_headers);
+    RUN_TEST(test_fallback_serves_files_but_hides_manifest);
+    RUN_TEST(test_without_manifest_serves_plain_file);
+    return UNITY_END();
+}
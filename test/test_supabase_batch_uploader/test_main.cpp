@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "SupabaseBatchUploader.h"
+
+// Lotes por tabela com um sender que registra cada POST; a fila
+// persistente roda sobre o LittleFS em memória
+
+struct Post {
+    std::string table;
+    std::string rows;
+};
+
+static std::vector<Post> posts;
+static bool cloud_up = true;
+
+static bool capture(const char* table, const char* rows, size_t length) {
+    if (!cloud_up) return false;
+    posts.push_back({table, std::string(rows, length)});
+    return true;
+}
+
+static size_t countRows(const std::string& body) {
+    size_t rows = 0;
+    for (size_t at = body.find("\"device_id\""); at != std::string::npos; at = body.find("\"device_id\"", at + 1)) {
+        rows++;
+    }
+    return rows;
+}
+
+static void addReading(SupabaseBatchUploader& uploader, int n, bool online = true) {
+    char payload[32];
+    snprintf(payload, sizeof(payload), "{\"n\":%d}", n);
+    uploader.add(TELEMETRY_HYDRO, payload, online);
+}
+
+static TelemetryQueue* queue;
+static SupabaseBatchUploader* uploader;
+
+void setUp() {
+    native::clearPreferences();
+    native::setMillis(1000);
+    LittleFS.wipe();
+    posts.clear();
+    cloud_up = true;
+
+    queue = new TelemetryQueue();
+    TEST_ASSERT_TRUE(queue->begin());
+    queue->setSender(capture);
+    uploader = new SupabaseBatchUploader(*queue);
+    uploader->setSender(capture);
+    uploader->setBatchSize(3);
+    uploader->setFlushInterval(60000);
+}
+
+void tearDown() {
+    delete uploader;
+    delete queue;
+}
+
+// ===== GATILHOS =====
+void test_full_batch_flushes_in_one_post() {
+    addReading(*uploader, 1);
+    addReading(*uploader, 2);
+    uploader->loop(true);
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+
+    addReading(*uploader, 3);
+    uploader->loop(true);
+    TEST_ASSERT_EQUAL(1, (int)posts.size());
+    TEST_ASSERT_EQUAL_STRING(SUPABASE_HYDRO_TABLE, posts[0].table.c_str());
+    TEST_ASSERT_EQUAL(3, (int)countRows(posts[0].rows));
+    TEST_ASSERT_EQUAL(0, uploader->pending());
+    TEST_ASSERT_TRUE(queue->isEmpty());
+}
+
+void test_partial_batch_flushes_after_interval() {
+    addReading(*uploader, 1);
+
+    native::advanceMillis(59999);
+    uploader->loop(true);
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+    TEST_ASSERT_EQUAL(1, uploader->pending());
+
+    native::advanceMillis(1);
+    uploader->loop(true);
+    TEST_ASSERT_EQUAL(1, (int)posts.size());
+    TEST_ASSERT_EQUAL(1, (int)countRows(posts[0].rows));
+    TEST_ASSERT_EQUAL(0, uploader->pending());
+}
+
+// ===== FILA OFFLINE =====
+void test_failed_post_hands_batch_to_queue() {
+    cloud_up = false;
+    for (int n = 1; n <= 3; n++) addReading(*uploader, n);
+    uploader->loop(true);
+
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+    TEST_ASSERT_EQUAL(0, uploader->pending());
+    TEST_ASSERT_EQUAL_UINT32(3, queue->size());
+
+    // A fila reenvia quando a nuvem volta
+    cloud_up = true;
+    native::advanceMillis(TELEMETRY_BACKOFF_MAX_MS);
+    queue->loop(true);
+    TEST_ASSERT_TRUE(queue->isEmpty());
+    TEST_ASSERT_EQUAL(1, (int)posts.size());
+    TEST_ASSERT_EQUAL(3, (int)countRows(posts[0].rows));
+}
+
+void test_offline_flush_skips_sender() {
+    for (int n = 1; n <= 2; n++) addReading(*uploader, n, false);
+    uploader->flush(false);
+
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+    TEST_ASSERT_EQUAL_UINT32(2, queue->size());
+}
+
+// ===== ORDEM =====
+void test_new_batch_waits_behind_queue_backlog() {
+    TEST_ASSERT_TRUE(queue->enqueue(TELEMETRY_HYDRO, "{\"n\":0}", 1700000000, 0));
+
+    // Nuvem OK, mas a fila tem atraso: o lote entra atrás dela
+    for (int n = 1; n <= 3; n++) addReading(*uploader, n);
+    uploader->loop(true);
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+    TEST_ASSERT_EQUAL_UINT32(4, queue->size());
+
+    native::advanceMillis(TELEMETRY_BACKOFF_MAX_MS);
+    queue->loop(true);
+    TEST_ASSERT_TRUE(queue->isEmpty());
+
+    // Grupos com e sem created_at saem em POSTs separados, mais antigo primeiro
+    std::string all;
+    for (const Post& post : posts) all += post.rows;
+    TEST_ASSERT_EQUAL(4, (int)countRows(all));
+    size_t previous = all.find("\"n\":0");
+    TEST_ASSERT_TRUE(previous != std::string::npos);
+    for (int n = 1; n <= 3; n++) {
+        char key[16];
+        snprintf(key, sizeof(key), "\"n\":%d", n);
+        size_t at = all.find(key);
+        TEST_ASSERT_TRUE(at != std::string::npos && at > previous);
+        previous = at;
+    }
+}
+
+void test_without_sender_batches_go_to_queue() {
+    SupabaseBatchUploader detached(*queue);
+    detached.setBatchSize(1);
+    addReading(detached, 1);
+    detached.loop(true);
+
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+    TEST_ASSERT_EQUAL_UINT32(1, queue->size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_batch_flushes_in_one_post);
+    RUN_TEST(test_partial_batch_flushes_after_interval);
+    RUN_TEST(test_failed_post_hands_batch_to_queue);
+    RUN_TEST(test_offline_flush_skips_sender);
+    RUN_TEST(test_new_batch_waits_behind_queue_backlog);
+    RUN_TEST(test_without_sender_batches_go_to_queue);
+    return UNITY_END();
+}
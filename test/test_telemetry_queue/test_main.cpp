@@ -0,0 +1,230 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "TelemetryQueue.h"
+#include "HistoryFS.h"
+
+// Fila persistente sobre o LittleFS em memória, com um sender que
+// registra cada POST em lote
+
+struct Post {
+    std::string table;
+    std::string rows;
+};
+
+static std::vector<Post> posts;
+static bool cloud_up = true;
+
+static bool capture(const char* table, const char* rows, size_t length) {
+    if (!cloud_up) return false;
+    posts.push_back({table, std::string(rows, length)});
+    return true;
+}
+
+static size_t countRows(const std::string& body) {
+    size_t rows = 0;
+    for (size_t at = body.find("\"device_id\""); at != std::string::npos; at = body.find("\"device_id\"", at + 1)) {
+        rows++;
+    }
+    return rows;
+}
+
+// Roda o loop até esvaziar (ou desistir), respeitando o intervalo de reenvio
+static void drain(TelemetryQueue& queue, int rounds = 50) {
+    while (rounds-- > 0 && !queue.isEmpty()) {
+        native::advanceMillis(TELEMETRY_BACKOFF_MAX_MS);
+        queue.loop(true);
+    }
+}
+
+void setUp() {
+    native::clearPreferences();
+    native::setMillis(1000);
+    LittleFS.wipe();
+    LittleFS.fail_mount = false;
+    posts.clear();
+    cloud_up = true;
+}
+
+void tearDown() {}
+
+// ===== PARTIÇÃO =====
+// Primeiro teste: HistoryFS memoriza a montagem que deu certo
+void test_unmounted_partition_rejects_and_counts() {
+    LittleFS.fail_mount = true;
+
+    TelemetryQueue queue;
+    TEST_ASSERT_FALSE(queue.begin());
+    TEST_ASSERT_FALSE(queue.isReady());
+
+    TEST_ASSERT_FALSE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.1}"));
+    TEST_ASSERT_FALSE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.2}"));
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(2, queue.getRejected());
+}
+
+void test_mounts_history_partition() {
+    TelemetryQueue queue;
+    TEST_ASSERT_TRUE(queue.begin());
+    TEST_ASSERT_TRUE(LittleFS.mounted);
+    TEST_ASSERT_EQUAL_STRING(HISTORY_FS_PARTITION, LittleFS.partition.c_str());
+}
+
+// ===== REENVIO =====
+void test_drains_in_order_one_post_per_table() {
+    TelemetryQueue queue;
+    TEST_ASSERT_TRUE(queue.begin());
+    queue.setSender(capture);
+
+    TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.0}", 1700000000, 0));
+    TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_ENVIRONMENT, "{\"temperature\":24.5}", 1700000010, 0));
+    TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.1}", 1700000020, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, queue.size());
+
+    drain(queue);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(2, (int)posts.size());
+
+    // O grupo da tabela do registro mais antigo vai primeiro
+    TEST_ASSERT_EQUAL_STRING(SUPABASE_HYDRO_TABLE, posts[0].table.c_str());
+    TEST_ASSERT_EQUAL(2, (int)countRows(posts[0].rows));
+    TEST_ASSERT_TRUE(posts[0].rows.find("6.0") < posts[0].rows.find("6.1"));
+    TEST_ASSERT_TRUE(posts[0].rows.find("\"created_at\":\"2023-11-14T22:13:20Z\"") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING(SUPABASE_ENVIRONMENT_TABLE, posts[1].table.c_str());
+}
+
+void test_failed_post_keeps_records_and_backs_off() {
+    TelemetryQueue queue;
+    TEST_ASSERT_TRUE(queue.begin());
+    queue.setSender(capture);
+    TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.0}", 1700000000, 0));
+
+    cloud_up = false;
+    native::advanceMillis(TELEMETRY_DRAIN_INTERVAL_MS);
+    queue.loop(true);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.size());
+
+    // Dentro do backoff (2x o intervalo) não tenta de novo
+    cloud_up = true;
+    native::advanceMillis(TELEMETRY_DRAIN_INTERVAL_MS);
+    queue.loop(true);
+    TEST_ASSERT_EQUAL(0, (int)posts.size());
+
+    native::advanceMillis(TELEMETRY_DRAIN_INTERVAL_MS);
+    queue.loop(true);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(1, (int)posts.size());
+}
+
+// ===== PERSISTÊNCIA =====
+void test_pending_records_survive_reboot() {
+    {
+        TelemetryQueue queue;
+        TEST_ASSERT_TRUE(queue.begin());
+        queue.setSender(capture);
+        for (int i = 0; i < 5; i++) {
+            char payload[32];
+            snprintf(payload, sizeof(payload), "{\"ph\":%d.5}", i);
+            TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, payload, 1700000000 + i, 0));
+        }
+        native::advanceMillis(TELEMETRY_DRAIN_INTERVAL_MS);
+        cloud_up = false;
+        queue.loop(true);
+    }
+
+    TelemetryQueue rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(5, rebooted.size());
+
+    rebooted.setSender(capture);
+    cloud_up = true;
+    drain(rebooted);
+    TEST_ASSERT_TRUE(rebooted.isEmpty());
+    TEST_ASSERT_EQUAL(5, (int)countRows(posts[0].rows));
+}
+
+void test_full_queue_drops_oldest_segment() {
+    TelemetryQueue queue;
+    TEST_ASSERT_TRUE(queue.begin());
+    for (uint32_t i = 0; i < TELEMETRY_QUEUE_CAPACITY + 3; i++) {
+        TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.0}", 1700000000 + i, 0));
+    }
+
+    // Reciclar o primeiro segmento leva junto os seus registros
+    TEST_ASSERT_EQUAL_UINT32(TELEMETRY_QUEUE_CAPACITY - TELEMETRY_QUEUE_SEGMENT_RECORDS + 3, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(TELEMETRY_QUEUE_SEGMENT_RECORDS, queue.getDropped());
+}
+
+void test_torn_record_is_cut_on_next_append() {
+    {
+        TelemetryQueue queue;
+        TEST_ASSERT_TRUE(queue.begin());
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.0}", 1700000000 + i, 0));
+        }
+    }
+
+    // Reset no meio de uma gravação: meio registro no fim do segmento
+    fs::FileData* segment = LittleFS.fileData(TELEMETRY_QUEUE_DIRECTORY "/0.seg");
+    TEST_ASSERT_NOT_NULL(segment);
+    segment->resize(segment->size() + TELEMETRY_RECORD_SIZE / 2, 0xA5);
+
+    TelemetryQueue rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(3, rebooted.size());
+    TEST_ASSERT_TRUE(rebooted.enqueue(TELEMETRY_HYDRO, "{\"ph\":6.3}", 1700000003, 0));
+    TEST_ASSERT_EQUAL_UINT32(4 * TELEMETRY_RECORD_SIZE, LittleFS.fileSize(TELEMETRY_QUEUE_DIRECTORY "/0.seg"));
+
+    rebooted.setSender(capture);
+    drain(rebooted);
+    TEST_ASSERT_TRUE(rebooted.isEmpty());
+    TEST_ASSERT_EQUAL(4, (int)countRows(posts[0].rows));
+    TEST_ASSERT_EQUAL_UINT32(0, rebooted.getDropped());
+}
+
+// ===== DESGASTE =====
+void test_enqueue_rewrite_stays_bounded_after_wraparound() {
+    TelemetryQueue queue;
+    TEST_ASSERT_TRUE(queue.begin());
+
+    // Duas voltas no anel; mede cada enqueue da segunda
+    size_t worst = 0;
+    for (uint32_t i = 0; i < 2 * TELEMETRY_QUEUE_CAPACITY; i++) {
+        char payload[32];
+        snprintf(payload, sizeof(payload), "{\"n\":%lu}", (unsigned long)i);
+        size_t before = LittleFS.programmed;
+        TEST_ASSERT_TRUE(queue.enqueue(TELEMETRY_HYDRO, payload, 1700000000 + i, 0));
+        if (i >= TELEMETRY_QUEUE_CAPACITY) {
+            worst = max(worst, LittleFS.programmed - before);
+        }
+    }
+
+    // No máximo o bloco parcial do fim do segmento mais o registro novo
+    // (regravar no lugar num arquivo de 256KB copiava até o fim do arquivo)
+    TEST_ASSERT_LESS_OR_EQUAL(fs::BLOCK_SIZE + TELEMETRY_RECORD_SIZE, worst);
+
+    // Depois das voltas o reboot acha o mesmo começo da fila
+    TelemetryQueue rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(queue.size(), rebooted.size());
+
+    rebooted.setSender(capture);
+    drain(rebooted, 100);
+    TEST_ASSERT_TRUE(rebooted.isEmpty());
+    char oldest[32];
+    snprintf(oldest, sizeof(oldest), "\"n\":%lu}", (unsigned long)(2 * TELEMETRY_QUEUE_CAPACITY - queue.size()));
+    TEST_ASSERT_TRUE(posts[0].rows.find(oldest) != std::string::npos);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unmounted_partition_rejects_and_counts);
+    RUN_TEST(test_mounts_history_partition);
+    RUN_TEST(test_drains_in_order_one_post_per_table);
+    RUN_TEST(test_failed_post_keeps_records_and_backs_off);
+    RUN_TEST(test_pending_records_survive_reboot);
+    RUN_TEST(test_full_queue_drops_oldest_segment);
+    RUN_TEST(test_torn_record_is_cut_on_next_append);
+    RUN_TEST(test_enqueue_rewrite_stays_bounded_after_wraparound);
+    return UNITY_END();
+}
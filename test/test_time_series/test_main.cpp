@@ -0,0 +1,300 @@
+#include <unity.h>
+#include <map>
+#include <random>
+#include <vector>
+#include "TimeSeriesStore.h"
+
+// Páginas e anéis do histórico sobre um fs::FS em memória, com o
+// SensorBus real publicando pH, TDS, EC e temperatura a cada 10 s
+
+static const uint8_t CHANNELS = 4;                 // pH, TDS, EC, temp (ordem do histórico)
+static const float SCALES[CHANNELS] = {100, 1, 1, 10};
+
+struct Row {
+    uint32_t time;
+    int32_t values[CHANNELS];
+};
+
+static std::mt19937 rng;
+static fs::FS memory;
+static std::vector<Row> published;                 // O que foi publicado, em contagens
+
+static int32_t walk(int32_t value, int32_t step, int32_t low, int32_t high) {
+    int32_t next = value + (int32_t)(rng() % (2 * step + 1)) - step;
+    return constrain(next, low, high);
+}
+
+// Avança 'steps' amostras de 10 s e registra o tempo de cada linha bruta
+static void run(TimeSeriesStore& store, SensorBus& bus, uint32_t steps) {
+    static int32_t ph = 600, tds = 800, temp = 220;
+    for (uint32_t i = 0; i < steps; i++) {
+        ph = walk(ph, 3, 450, 750);
+        tds = walk(tds, 6, 500, 1200);
+        temp = walk(temp, 1, 180, 260);
+
+        native::advanceMillis(TS_RAW_INTERVAL_MS);
+        unsigned long now = millis();
+        bus.publish(SENSOR_PH, ph / SCALES[0], now);
+        bus.publish(SENSOR_TDS, tds / SCALES[1], now);
+        bus.publish(SENSOR_EC, 2 * tds / SCALES[2], now);
+        bus.publish(SENSOR_WATER_TEMP, temp / SCALES[3], now);
+        store.loop();
+
+        published.push_back({store.now(), {ph, tds, 2 * tds, temp}});
+    }
+}
+
+static std::vector<TimeSeriesRow> queryAll(TimeSeriesStore& store, TimeSeriesStore::Tier tier,
+                                           uint32_t from = 0, uint32_t to = UINT32_MAX) {
+    std::vector<TimeSeriesRow> rows;
+    store.query(tier, from, to, [&](const TimeSeriesRow& row) {
+        rows.push_back(row);
+        return true;
+    });
+    return rows;
+}
+
+void setUp() {
+    rng.seed(7);
+    memory.wipe();
+    published.clear();
+    native::setMillis(0);
+}
+
+void tearDown() {}
+
+// ===== CODIFICAÇÃO =====
+void test_page_round_trip() {
+    TimeSeriesPage page;
+    page.reset(TimeSeriesStore::TIER_RAW, CHANNELS, 1);
+
+    // Intervalo regular com jitter, lacuna longa, ausentes e saltos grandes
+    std::vector<Row> rows;
+    uint32_t time = 1000;
+    int32_t values[CHANNELS] = {600, 800, -40, 0};
+    for (int i = 0; i < 40; i++) {
+        time += i == 20 ? 86400 : 10 + (int32_t)(rng() % 3) - 1;
+        values[0] += (int32_t)(rng() % 7) - 3;
+        values[1] = i % 9 == 0 ? TS_MISSING_VALUE : 800 + (int32_t)(rng() % 200);
+        values[2] -= 70000;                          // Delta acima de 16 bits
+        values[3] = i % 2 ? INT32_MAX : INT32_MIN + 1;
+        if (!page.append(time, values)) break;
+        Row row = {time, {}};
+        memcpy(row.values, values, sizeof(values));
+        rows.push_back(row);
+    }
+    TEST_ASSERT_GREATER_THAN(10, (int)rows.size());
+    TEST_ASSERT_EQUAL_UINT32(rows.size(), page.getCount());
+
+    uint8_t stored[TS_PAGE_SIZE];
+    memcpy(stored, page.data(), TS_PAGE_SIZE);
+
+    TimeSeriesPage loaded;
+    TEST_ASSERT_TRUE(loaded.load(stored, TimeSeriesStore::TIER_RAW));
+    size_t index = 0;
+    TEST_ASSERT_TRUE(loaded.decode([&](uint32_t t, const int32_t* decoded) {
+        TEST_ASSERT_EQUAL_UINT32(rows[index].time, t);
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            TEST_ASSERT_EQUAL_INT32(rows[index].values[c], decoded[c]);
+        }
+        index++;
+        return true;
+    }));
+    TEST_ASSERT_EQUAL_UINT32(rows.size(), index);
+
+    // A página recarregada continua de onde parou (estado do codificador)
+    TimeSeriesPage resumed;
+    resumed.load(stored, TimeSeriesStore::TIER_RAW);
+    int32_t next[CHANNELS] = {601, 805, 0, 5};
+    if (resumed.append(time + 10, next)) {
+        uint32_t last = 0;
+        int32_t last_values[CHANNELS];
+        resumed.decode([&](uint32_t t, const int32_t* decoded) {
+            last = t;
+            memcpy(last_values, decoded, sizeof(last_values));
+            return true;
+        });
+        TEST_ASSERT_EQUAL_UINT32(time + 10, last);
+        TEST_ASSERT_EQUAL_MEMORY(next, last_values, sizeof(next));
+    }
+
+    // Checksum e nível errado são rejeitados
+    stored[sizeof(TimeSeriesPage::Header) + 3] ^= 0x10;
+    TEST_ASSERT_FALSE(loaded.load(stored, TimeSeriesStore::TIER_RAW));
+    stored[sizeof(TimeSeriesPage::Header) + 3] ^= 0x10;
+    TEST_ASSERT_FALSE(loaded.load(stored, TimeSeriesStore::TIER_MINUTE));
+}
+
+void test_page_fills_without_losing_rows() {
+    TimeSeriesPage page;
+    page.reset(TimeSeriesStore::TIER_MINUTE, TS_MAX_COLUMNS, 1);
+
+    int32_t values[TS_MAX_COLUMNS];
+    uint32_t appended = 0;
+    for (uint32_t time = 0; appended < 1000; time += 60) {
+        for (uint8_t c = 0; c < TS_MAX_COLUMNS; c++) values[c] = (int32_t)(rng() % 5000);
+        if (!page.append(time, values)) break;
+        appended++;
+    }
+
+    // Página cheia recusa a linha sem corromper as anteriores
+    TEST_ASSERT_LESS_THAN(1000, appended);
+    TEST_ASSERT_EQUAL_UINT32(appended, page.getCount());
+    TEST_ASSERT_LESS_OR_EQUAL(TimeSeriesPage::CAPACITY_BITS, page.header().bit_length);
+
+    TimeSeriesPage loaded;
+    TEST_ASSERT_TRUE(loaded.load(page.data(), TimeSeriesStore::TIER_MINUTE));
+    uint32_t decoded = 0;
+    TEST_ASSERT_TRUE(loaded.decode([&](uint32_t, const int32_t*) { decoded++; return true; }));
+    TEST_ASSERT_EQUAL_UINT32(appended, decoded);
+}
+
+// ===== ANEL =====
+void test_raw_ring_wraps_and_recovers() {
+    SensorBus bus;
+    TimeSeriesStore store;
+    TEST_ASSERT_TRUE(store.begin(&bus, memory));
+
+    // 3 dias a cada 10 s: o anel bruto dá a volta
+    run(store, bus, 3 * 8640);
+    store.flush();
+
+    // Segmentos de até TS_SEGMENT_PAGES páginas + o checkpoint da corrente
+    for (uint16_t segment = 0; segment < TS_RAW_PAGES / TS_SEGMENT_PAGES; segment++) {
+        char path[32];
+        snprintf(path, sizeof(path), TS_DIRECTORY "/raw/%u.seg", segment);
+        TEST_ASSERT_TRUE(memory.exists(path));
+        TEST_ASSERT_LESS_OR_EQUAL(TS_SEGMENT_PAGES * TS_PAGE_SIZE, memory.fileSize(path));
+    }
+    TEST_ASSERT_EQUAL_UINT32(TS_PAGE_SIZE, memory.fileSize(TS_DIRECTORY "/raw/head.bin"));
+
+    std::vector<TimeSeriesRow> rows = queryAll(store, TimeSeriesStore::TIER_RAW);
+    // Ao menos 56 páginas fechadas (o segmento reciclado sai inteiro) + a da
+    // RAM, ~150 linhas por página com estes dados; o início foi descartado
+    TEST_ASSERT_GREATER_THAN((TS_RAW_PAGES - TS_SEGMENT_PAGES) * 100, rows.size());
+    TEST_ASSERT_LESS_THAN(published.size(), rows.size());
+
+    // Linhas contíguas, em ordem, iguais ao publicado e terminando na última
+    size_t offset = published.size() - rows.size();
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Row& expected = published[offset + i];
+        TEST_ASSERT_EQUAL_UINT32(expected.time, rows[i].time);
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            TEST_ASSERT_FLOAT_WITHIN(0.001, expected.values[c] / SCALES[c], rows[i].values[c]);
+        }
+    }
+
+    // Reboot: índice reconstruído dos cabeçalhos e relógio continua
+    uint32_t last_time = published.back().time;
+    TimeSeriesStore rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin(&bus, memory));
+    TEST_ASSERT_GREATER_THAN(last_time, rebooted.now());
+    std::vector<TimeSeriesRow> recovered = queryAll(rebooted, TimeSeriesStore::TIER_RAW);
+    TEST_ASSERT_EQUAL_UINT32(rows.size(), recovered.size());
+    TEST_ASSERT_EQUAL_UINT32(rows.front().time, recovered.front().time);
+    TEST_ASSERT_EQUAL_UINT32(last_time, recovered.back().time);
+}
+
+// ===== DESGASTE =====
+void test_flash_rewrite_stays_bounded_after_wraparound() {
+    SensorBus bus;
+    TimeSeriesStore store;
+    TEST_ASSERT_TRUE(store.begin(&bus, memory));
+
+    // 3 dias dão a volta no anel bruto; o dia seguinte é medido a cada amostra
+    run(store, bus, 3 * 8640);
+    size_t worst = 0;
+    for (uint32_t i = 0; i < 8640; i++) {
+        size_t before = memory.programmed;
+        run(store, bus, 1);
+        worst = max(worst, memory.programmed - before);
+    }
+
+    // Cada nível grava no máximo um bloco parcial + uma página (fechar) ou
+    // só a página em head.bin (checkpoint); regravar no lugar nos arquivos
+    // de 32-64KB copiava até o fim do arquivo
+    TEST_ASSERT_LESS_OR_EQUAL(TimeSeriesStore::TIER_COUNT * (fs::BLOCK_SIZE + TS_PAGE_SIZE), worst);
+}
+
+// ===== REDUÇÃO =====
+void test_downsampled_tiers_match_raw() {
+    SensorBus bus;
+    TimeSeriesStore store;
+    TEST_ASSERT_TRUE(store.begin(&bus, memory));
+    run(store, bus, 6 * 360);                  // 6 h
+
+    uint32_t now = store.now();
+    TEST_ASSERT_EQUAL(TimeSeriesStore::TIER_RAW, store.selectTier(now - 600, now, 100));
+    TEST_ASSERT_EQUAL(TimeSeriesStore::TIER_MINUTE, store.selectTier(now - 3600, now, 100));
+    TEST_ASSERT_EQUAL(TimeSeriesStore::TIER_QUARTER, store.selectTier(now - 5 * 3600, now, 100));
+
+    // Cada linha de 1 min: média/mín/máx das brutas do mesmo minuto
+    std::vector<TimeSeriesRow> minutes = queryAll(store, TimeSeriesStore::TIER_MINUTE);
+    TEST_ASSERT_GREATER_THAN(300, minutes.size());
+    for (const TimeSeriesRow& minute : minutes) {
+        TEST_ASSERT_EQUAL_UINT8(CHANNELS * 3, minute.columns);
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            int64_t sum = 0;
+            int32_t low = INT32_MAX, high = INT32_MIN, count = 0;
+            for (const Row& row : published) {
+                if (row.time < minute.time || row.time >= minute.time + 60) continue;
+                sum += row.values[c];
+                low = min(low, row.values[c]);
+                high = max(high, row.values[c]);
+                count++;
+            }
+            TEST_ASSERT_GREATER_THAN(0, count);
+            TEST_ASSERT_FLOAT_WITHIN(0.001, lround((double)sum / count) / SCALES[c], minute.values[3 * c]);
+            TEST_ASSERT_FLOAT_WITHIN(0.001, low / SCALES[c], minute.values[3 * c + 1]);
+            TEST_ASSERT_FLOAT_WITHIN(0.001, high / SCALES[c], minute.values[3 * c + 2]);
+        }
+    }
+
+    // 15 min preservam os extremos dos minutos
+    std::vector<TimeSeriesRow> quarters = queryAll(store, TimeSeriesStore::TIER_QUARTER);
+    TEST_ASSERT_GREATER_THAN(20, quarters.size());
+    for (const TimeSeriesRow& quarter : quarters) {
+        float low = INFINITY, high = -INFINITY;
+        for (const TimeSeriesRow& minute : minutes) {
+            if (minute.time < quarter.time || minute.time >= quarter.time + 900) continue;
+            low = min(low, minute.values[1]);
+            high = max(high, minute.values[2]);
+        }
+        TEST_ASSERT_FLOAT_WITHIN(0.001, low, quarter.values[1]);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, high, quarter.values[2]);
+    }
+
+    // summarize() do pH na última hora (nível de 1 min)
+    TimeSeriesSummary summary;
+    TEST_ASSERT_TRUE(store.summarize(0, now - 3600, now, summary));
+    float low = INFINITY, high = -INFINITY;
+    for (const Row& row : published) {
+        if (row.time >= summary.first_time && row.time < summary.last_time + 60) {
+            low = min(low, row.values[0] / SCALES[0]);
+            high = max(high, row.values[0] / SCALES[0]);
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, low, summary.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, high, summary.max);
+    TEST_ASSERT_TRUE(summary.mean >= summary.min && summary.mean <= summary.max);
+}
+
+// ===== PARTIÇÃO =====
+void test_default_filesystem_mounts_history_partition() {
+    SensorBus bus;
+    TimeSeriesStore store;
+    TEST_ASSERT_TRUE(store.begin(&bus));
+    TEST_ASSERT_TRUE(LittleFS.mounted);
+    TEST_ASSERT_EQUAL_STRING("history", LittleFS.partition.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_page_round_trip);
+    RUN_TEST(test_page_fills_without_losing_rows);
+    RUN_TEST(test_raw_ring_wraps_and_recovers);
+    RUN_TEST(test_flash_rewrite_stays_bounded_after_wraparound);
+    RUN_TEST(test_downsampled_tiers_match_raw);
+    RUN_TEST(test_default_filesystem_mounts_history_partition);
+    return UNITY_END();
+}